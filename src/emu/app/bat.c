@@ -0,0 +1,832 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * rp6502-batch: many --script runs, in a few warm processes.
+ *
+ * A manifest lists the cases, one per line:
+ *
+ *   # name     rom                  script         checks
+ *   gamepad    roms/gamepad.rp6502  gamepad.txt
+ *   hello      hello.rp6502         -              frames=60 crc=1A2B3C4D
+ *   quits      quits.rp6502         -              frames=600 exit=3
+ *
+ * Paths are relative to the manifest. A script is run exactly as --script
+ * runs it; "-" runs frames= frames (default 120) instead. crc= is the canvas
+ * after the last frame, as the script's crc verb prints it; exit= wants the
+ * program to have exited with that code. A case passes when its script does
+ * and every check it names holds.
+ *
+ * The cases are dealt to a pool of worker processes, one at a time as each
+ * worker comes free. A worker is forked from a parent that has already
+ * initialized the machine, and every case starts from the savestate the
+ * parent took then, so a case runs as it would in a fresh rp6502-emu
+ * whichever worker gets it and whatever that worker ran before. A worker
+ * that dies or overruns --timeout is replaced and its case is an error.
+ */
+
+#include "emu/app/rand.h"
+#include "emu/app/scr.h"
+#include "emu/emu/aud.h"
+#include "emu/emu/pro.h"
+#include "emu/emu/rom.h"
+#include "emu/main.h"
+#include "emu/sys/cpu.h"
+#include "emu/sys/mem.h"
+#include "emu/sys/sst.h"
+#include "emu/sys/sys.h"
+#include "emu/sys/vga.h"
+#include "host/host.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BAT_MAX_WORKERS 256
+#define BAT_MESSAGE_MAX 512 /* a result stays under PIPE_BUF, so it moves whole */
+#define BAT_DEFAULT_FRAMES 120
+
+typedef struct
+{
+    char *name, *rom, *script; /* script NULL: run frames instead */
+    int frames;
+    bool have_crc;
+    uint32_t crc;
+    bool have_exit;
+    int exit_code;
+} bat_case_t;
+
+typedef enum
+{
+    BAT_PASS,
+    BAT_FAIL,  /* ran, and a check did not hold */
+    BAT_ERROR, /* did not run to a verdict */
+} bat_status_t;
+
+/* What a worker sends back, one per case. */
+typedef struct
+{
+    uint32_t index;
+    int32_t status;
+    int32_t exit_code; /* the program's, valid when halted */
+    bool halted;
+    uint32_t crc;
+    uint64_t frames;
+    uint64_t cycles;
+    double wall; /* seconds */
+    char message[BAT_MESSAGE_MAX];
+} bat_result_t;
+
+typedef struct
+{
+    pid_t pid;
+    int cmd_fd, res_fd;
+    long current; /* case index, or -1 when idle */
+    double started;
+} bat_worker_t;
+
+static bat_case_t *bat_cases;
+static size_t bat_n_cases;
+static bat_result_t *bat_results;
+
+static bat_worker_t bat_workers[BAT_MAX_WORKERS];
+static int bat_n_workers;
+
+static void *bat_cold;
+static size_t bat_cold_len;
+static uint32_t bat_fb[VGA_MAX_WIDTH * VGA_MAX_HEIGHT];
+
+static double bat_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool bat_read_full(int fd, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    while (len)
+    {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool bat_write_full(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Manifest                                                            */
+/* ------------------------------------------------------------------ */
+
+/* path as written in the manifest, made relative to the manifest's directory. */
+static char *bat_path(const char *dir, const char *path)
+{
+    size_t len = strlen(dir) + strlen(path) + 2;
+    char *out = malloc(len);
+    if (!out)
+        return NULL;
+    if (path[0] == '/' || !dir[0])
+        snprintf(out, len, "%s", path);
+    else
+        snprintf(out, len, "%s/%s", dir, path);
+    return out;
+}
+
+static bool bat_load_manifest(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "rp6502-batch: cannot open manifest '%s'\n", path);
+        return false;
+    }
+    char dir[4096];
+    snprintf(dir, sizeof dir, "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash)
+        *slash = 0;
+    else
+        dir[0] = 0;
+
+    size_t cap = 0;
+    char line[4096];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof line, f))
+    {
+        line_no++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = 0;
+        char *name = strtok(line, " \t\r\n");
+        if (!name)
+            continue;
+        char *rom = strtok(NULL, " \t\r\n");
+        char *script = strtok(NULL, " \t\r\n");
+        if (!rom || !script)
+        {
+            fprintf(stderr, "rp6502-batch: %s:%d: want <name> <rom> <script|->\n",
+                    path, line_no);
+            ok = false;
+            break;
+        }
+        if (bat_n_cases == cap)
+        {
+            cap = cap ? cap * 2 : 64;
+            bat_case_t *grown = realloc(bat_cases, cap * sizeof *bat_cases);
+            if (!grown)
+            {
+                fprintf(stderr, "rp6502-batch: out of memory\n");
+                ok = false;
+                break;
+            }
+            bat_cases = grown;
+        }
+        bat_case_t *c = &bat_cases[bat_n_cases];
+        memset(c, 0, sizeof *c);
+        c->frames = BAT_DEFAULT_FRAMES;
+        c->name = strdup(name);
+        c->rom = bat_path(dir, rom);
+        c->script = strcmp(script, "-") ? bat_path(dir, script) : NULL;
+        if (!c->name || !c->rom || (strcmp(script, "-") && !c->script))
+        {
+            fprintf(stderr, "rp6502-batch: out of memory\n");
+            ok = false;
+            break;
+        }
+        bat_n_cases++;
+        char *opt;
+        while ((opt = strtok(NULL, " \t\r\n")) != NULL)
+        {
+            char *end;
+            if (!strncmp(opt, "frames=", 7))
+            {
+                long v = strtol(opt + 7, &end, 0);
+                if (*end || v < 1)
+                    ok = false;
+                c->frames = (int)v;
+            }
+            else if (!strncmp(opt, "crc=", 4))
+            {
+                unsigned long v = strtoul(opt + 4, &end, 16);
+                if (*end || v > 0xFFFFFFFFul)
+                    ok = false;
+                c->crc = (uint32_t)v;
+                c->have_crc = true;
+            }
+            else if (!strncmp(opt, "exit=", 5))
+            {
+                long v = strtol(opt + 5, &end, 0);
+                if (*end)
+                    ok = false;
+                c->exit_code = (int)v;
+                c->have_exit = true;
+            }
+            else
+                ok = false;
+            if (!ok)
+            {
+                fprintf(stderr, "rp6502-batch: %s:%d: bad check '%s' "
+                                "(want frames=<n>, crc=<hex> or exit=<n>)\n",
+                        path, line_no, opt);
+                break;
+            }
+        }
+    }
+    fclose(f);
+    if (ok && !bat_n_cases)
+    {
+        fprintf(stderr, "rp6502-batch: %s lists no cases\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+/* ------------------------------------------------------------------ */
+/* Worker                                                              */
+/* ------------------------------------------------------------------ */
+
+/* One case, on the machine the parent initialized. Everything it has to say
+ * goes to stderr, which the worker keeps for the report. */
+static void bat_run_case(const bat_case_t *c, bat_result_t *r)
+{
+    main_stop();
+    pro_init();
+    if (!emu_state_restore(bat_cold, bat_cold_len))
+    {
+        r->status = BAT_ERROR;
+        return;
+    }
+    char rom[4096];
+    if (!os_argv_to_oem(c->rom, rom, sizeof rom) || !rom_load(rom) ||
+        !pro_set_argv(rom, 0, NULL))
+    {
+        fprintf(stderr, "rp6502-batch: cannot load '%s'\n", c->rom);
+        r->status = BAT_ERROR;
+        return;
+    }
+    /* Armed before the machine starts, as rp6502-emu arms it. */
+    if (c->script && !scr_load(c->script))
+    {
+        r->status = BAT_ERROR;
+        return;
+    }
+    main_run();
+
+    const double t0 = bat_now();
+    const unsigned long f0 = sys_frame_count();
+    const uint64_t c0 = sys_cpu_cycles();
+    if (c->script)
+    {
+        /* main.c's loop: one frame for every scr_task that owes one. */
+        while (scr_running())
+        {
+            scr_task();
+            if (scr_running())
+                sys_run_frame();
+        }
+    }
+    else
+    {
+        /* As --screenshot settles: only the last frame is looked at. */
+        for (int i = 0; i < c->frames - 1; i++)
+            sys_run_frame_norender();
+        sys_run_frame();
+    }
+    r->wall = bat_now() - t0;
+    r->frames = sys_frame_count() - f0;
+    r->cycles = sys_cpu_cycles() - c0;
+
+    int w, h;
+    vga_canvas_size(&w, &h);
+    r->crc = mem_crc32(0, bat_fb, (size_t)w * h * sizeof *bat_fb);
+    r->halted = cpu_halted();
+    r->exit_code = pro_get_exit_code();
+
+    r->status = BAT_PASS;
+    if (c->script && scr_exit_code())
+        r->status = BAT_FAIL; /* scr.c said why */
+    if (c->have_crc && r->crc != c->crc)
+    {
+        fprintf(stderr, "rp6502-batch: canvas crc %08X, expected %08X\n",
+                (unsigned)r->crc, (unsigned)c->crc);
+        r->status = BAT_FAIL;
+    }
+    if (c->have_exit && (!r->halted || r->exit_code != c->exit_code))
+    {
+        if (r->halted)
+            fprintf(stderr, "rp6502-batch: exit code %d, expected %d\n",
+                    (int)r->exit_code, c->exit_code);
+        else
+            fprintf(stderr, "rp6502-batch: still running, expected exit code %d\n",
+                    c->exit_code);
+        r->status = BAT_FAIL;
+    }
+}
+
+/* The end of what the case wrote to stderr: the line that says why. */
+static void bat_log_tail(int log_fd, char *out)
+{
+    off_t end = lseek(log_fd, 0, SEEK_END);
+    off_t from = end > BAT_MESSAGE_MAX - 1 ? end - (BAT_MESSAGE_MAX - 1) : 0;
+    ssize_t n = pread(log_fd, out, (size_t)(end - from), from);
+    n = n < 0 ? 0 : n;
+    while (n > 0 && (out[n - 1] == '\n' || out[n - 1] == '\r'))
+        n--;
+    out[n] = 0;
+}
+
+static void bat_worker(int cmd_fd, int res_fd)
+{
+    /* The program's console goes nowhere; stderr is kept per case. */
+    int null_fd = open("/dev/null", O_WRONLY);
+    FILE *log = tmpfile();
+    if (null_fd < 0 || !log)
+        _exit(1);
+    const int log_fd = fileno(log);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(log_fd, STDERR_FILENO);
+
+    uint32_t index;
+    while (bat_read_full(cmd_fd, &index, sizeof index))
+    {
+        if (ftruncate(log_fd, 0))
+            _exit(1);
+        bat_result_t r;
+        memset(&r, 0, sizeof r);
+        r.index = index;
+        bat_run_case(&bat_cases[index], &r);
+        if (r.status != BAT_PASS)
+            bat_log_tail(log_fd, r.message);
+        if (!bat_write_full(res_fd, &r, sizeof r))
+            break;
+    }
+    _exit(0);
+}
+
+/* ------------------------------------------------------------------ */
+/* Pool                                                                */
+/* ------------------------------------------------------------------ */
+
+static bool bat_spawn(bat_worker_t *w)
+{
+    int cmd[2], res[2];
+    if (pipe(cmd))
+        return false;
+    if (pipe(res))
+    {
+        close(cmd[0]);
+        close(cmd[1]);
+        return false;
+    }
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(cmd[0]);
+        close(cmd[1]);
+        close(res[0]);
+        close(res[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        /* The other workers' ends too, or a worker holds a sibling's command
+         * pipe open and that sibling never sees the end of it. */
+        for (int i = 0; i < bat_n_workers; i++)
+            if (&bat_workers[i] != w && bat_workers[i].pid > 0)
+            {
+                close(bat_workers[i].cmd_fd);
+                close(bat_workers[i].res_fd);
+            }
+        close(cmd[1]);
+        close(res[0]);
+        bat_worker(cmd[0], res[1]);
+    }
+    close(cmd[0]);
+    close(res[1]);
+    w->pid = pid;
+    w->cmd_fd = cmd[1];
+    w->res_fd = res[0];
+    w->current = -1;
+    return true;
+}
+
+/* A worker that will not finish its case: its case is an error, and a fresh
+ * worker takes its place. */
+static bool bat_replace(bat_worker_t *w, const char *why)
+{
+    kill(w->pid, SIGKILL);
+    int status;
+    waitpid(w->pid, &status, 0);
+    close(w->cmd_fd);
+    close(w->res_fd);
+    w->pid = 0;
+    if (w->current >= 0)
+    {
+        bat_result_t *r = &bat_results[w->current];
+        memset(r, 0, sizeof *r);
+        r->index = (uint32_t)w->current;
+        r->status = BAT_ERROR;
+        r->wall = bat_now() - w->started;
+        if (WIFSIGNALED(status) && WTERMSIG(status) != SIGKILL)
+            snprintf(r->message, sizeof r->message, "worker died on signal %d",
+                     WTERMSIG(status));
+        else
+            snprintf(r->message, sizeof r->message, "%s", why);
+    }
+    if (!bat_spawn(w))
+    {
+        fprintf(stderr, "rp6502-batch: cannot start a worker\n");
+        return false;
+    }
+    return true;
+}
+
+static void bat_print(const bat_result_t *r)
+{
+    static const char *const tag[] = {"PASS ", "FAIL ", "ERROR"};
+    const bat_case_t *c = &bat_cases[r->index];
+    printf("%s %s (%llu frames, %.2f s, %.2f Mcycles/s)", tag[r->status], c->name,
+           (unsigned long long)r->frames, r->wall,
+           r->wall > 0 ? r->cycles / r->wall / 1e6 : 0.0);
+    if (r->status != BAT_PASS && r->message[0])
+    {
+        const char *last = strrchr(r->message, '\n');
+        printf(": %s", last ? last + 1 : r->message);
+    }
+    putchar('\n');
+    fflush(stdout);
+}
+
+/* Deal every case out and collect every result. False only when the pool
+ * itself fails; a case that fails is a result. */
+static bool bat_run_pool(double timeout)
+{
+    size_t next = 0, done = 0;
+    for (int i = 0; i < bat_n_workers; i++)
+        if (!bat_spawn(&bat_workers[i]))
+        {
+            fprintf(stderr, "rp6502-batch: cannot start a worker\n");
+            return false;
+        }
+    struct pollfd fds[BAT_MAX_WORKERS];
+    while (done < bat_n_cases)
+    {
+        /* Deal to whoever is idle. */
+        for (int i = 0; i < bat_n_workers && next < bat_n_cases; i++)
+        {
+            bat_worker_t *w = &bat_workers[i];
+            if (w->current >= 0)
+                continue;
+            uint32_t index = (uint32_t)next;
+            w->current = (long)next++;
+            w->started = bat_now();
+            if (bat_write_full(w->cmd_fd, &index, sizeof index))
+                continue;
+            if (!bat_replace(w, "worker stopped taking cases"))
+                return false;
+            bat_print(&bat_results[index]); /* replaced: its case is recorded */
+            done++;
+        }
+
+        int n = 0;
+        double wait = -1;
+        const double now = bat_now();
+        for (int i = 0; i < bat_n_workers; i++)
+        {
+            fds[i].fd = bat_workers[i].current >= 0 ? bat_workers[i].res_fd : -1;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+            if (bat_workers[i].current >= 0)
+            {
+                n++;
+                double left = bat_workers[i].started + timeout - now;
+                if (wait < 0 || left < wait)
+                    wait = left > 0 ? left : 0;
+            }
+        }
+        if (!n)
+            continue;
+        int ms = timeout > 0 ? (int)(wait * 1000) + 1 : -1;
+        if (poll(fds, (nfds_t)bat_n_workers, ms) < 0 && errno != EINTR)
+        {
+            perror("rp6502-batch: poll");
+            return false;
+        }
+
+        for (int i = 0; i < bat_n_workers; i++)
+        {
+            bat_worker_t *w = &bat_workers[i];
+            if (w->current < 0)
+                continue;
+            const long index = w->current;
+            if (fds[i].revents)
+            {
+                bat_result_t r;
+                if (bat_read_full(w->res_fd, &r, sizeof r) && r.index == (uint32_t)index)
+                {
+                    bat_results[index] = r;
+                    w->current = -1;
+                }
+                else if (!bat_replace(w, "worker died"))
+                    return false;
+            }
+            else if (timeout > 0 && bat_now() - w->started > timeout)
+            {
+                char why[64];
+                snprintf(why, sizeof why, "timed out after %.0f s", timeout);
+                if (!bat_replace(w, why))
+                    return false;
+            }
+            else
+                continue;
+            w->current = -1;
+            bat_print(&bat_results[index]);
+            done++;
+        }
+    }
+    for (int i = 0; i < bat_n_workers; i++)
+    {
+        close(bat_workers[i].cmd_fd); /* the end of the cases: the worker exits */
+        close(bat_workers[i].res_fd);
+        waitpid(bat_workers[i].pid, NULL, 0);
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Reports                                                             */
+/* ------------------------------------------------------------------ */
+
+static void bat_json_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++)
+    {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\')
+            fprintf(f, "\\%c", ch);
+        else if (ch == '\n')
+            fputs("\\n", f);
+        else if (ch < 0x20)
+            fprintf(f, "\\u%04x", ch);
+        else
+            fputc(ch, f);
+    }
+    fputc('"', f);
+}
+
+static void bat_xml_string(FILE *f, const char *s)
+{
+    for (; *s; s++)
+    {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '&')
+            fputs("&amp;", f);
+        else if (ch == '<')
+            fputs("&lt;", f);
+        else if (ch == '>')
+            fputs("&gt;", f);
+        else if (ch == '"')
+            fputs("&quot;", f);
+        else if (ch < 0x20 && ch != '\n' && ch != '\t')
+            fputc('?', f); /* XML 1.0 has no spelling for these */
+        else
+            fputc(ch, f);
+    }
+}
+
+static const char *const bat_status_name[] = {"pass", "fail", "error"};
+
+static bool bat_write_json(const char *path, double wall, const size_t counts[3])
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        fprintf(stderr, "rp6502-batch: cannot write '%s'\n", path);
+        return false;
+    }
+    fprintf(f, "{\n  \"passed\": %zu,\n  \"failed\": %zu,\n  \"errors\": %zu,\n"
+               "  \"workers\": %d,\n  \"wall_s\": %.3f,\n  \"cases\": [\n",
+            counts[BAT_PASS], counts[BAT_FAIL], counts[BAT_ERROR], bat_n_workers, wall);
+    for (size_t i = 0; i < bat_n_cases; i++)
+    {
+        const bat_case_t *c = &bat_cases[i];
+        const bat_result_t *r = &bat_results[i];
+        fputs("    {\"name\": ", f);
+        bat_json_string(f, c->name);
+        fputs(", \"rom\": ", f);
+        bat_json_string(f, c->rom);
+        fputs(", \"script\": ", f);
+        if (c->script)
+            bat_json_string(f, c->script);
+        else
+            fputs("null", f);
+        fprintf(f, ", \"status\": \"%s\", \"frames\": %llu, \"wall_s\": %.3f, "
+                   "\"cycles\": %llu, \"cycles_per_s\": %.0f, \"crc\": \"%08X\", "
+                   "\"exit_code\": ",
+                bat_status_name[r->status], (unsigned long long)r->frames, r->wall,
+                (unsigned long long)r->cycles, r->wall > 0 ? r->cycles / r->wall : 0.0,
+                (unsigned)r->crc);
+        if (r->halted)
+            fprintf(f, "%d", (int)r->exit_code);
+        else
+            fputs("null", f);
+        fputs(", \"message\": ", f);
+        bat_json_string(f, r->message);
+        fprintf(f, "}%s\n", i + 1 < bat_n_cases ? "," : "");
+    }
+    fputs("  ]\n}\n", f);
+    return fclose(f) == 0;
+}
+
+static bool bat_write_junit(const char *path, double wall, const size_t counts[3])
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        fprintf(stderr, "rp6502-batch: cannot write '%s'\n", path);
+        return false;
+    }
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<testsuites>\n"
+               "  <testsuite name=\"rp6502-batch\" tests=\"%zu\" failures=\"%zu\" "
+               "errors=\"%zu\" time=\"%.3f\">\n",
+            bat_n_cases, counts[BAT_FAIL], counts[BAT_ERROR], wall);
+    for (size_t i = 0; i < bat_n_cases; i++)
+    {
+        const bat_case_t *c = &bat_cases[i];
+        const bat_result_t *r = &bat_results[i];
+        fputs("    <testcase classname=\"rp6502\" name=\"", f);
+        bat_xml_string(f, c->name);
+        fprintf(f, "\" time=\"%.3f\">\n", r->wall);
+        fprintf(f, "      <properties><property name=\"frames\" value=\"%llu\"/>"
+                   "<property name=\"cycles\" value=\"%llu\"/>"
+                   "<property name=\"crc\" value=\"%08X\"/></properties>\n",
+                (unsigned long long)r->frames, (unsigned long long)r->cycles,
+                (unsigned)r->crc);
+        if (r->status != BAT_PASS)
+        {
+            fprintf(f, "      <%s message=\"", r->status == BAT_FAIL ? "failure" : "error");
+            const char *last = strrchr(r->message, '\n');
+            bat_xml_string(f, last ? last + 1 : r->message);
+            fputs("\">", f);
+            bat_xml_string(f, r->message);
+            fprintf(f, "</%s>\n", r->status == BAT_FAIL ? "failure" : "error");
+        }
+        fputs("    </testcase>\n", f);
+    }
+    fputs("  </testsuite>\n</testsuites>\n", f);
+    return fclose(f) == 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* Main                                                                */
+/* ------------------------------------------------------------------ */
+
+static void bat_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [options] <manifest>\n"
+            "  -j, --jobs <n>            worker processes (default: one per CPU)\n"
+            "  --json <file>             write the results as JSON\n"
+            "  --junit <file>            write the results as JUnit XML\n"
+            "  --timeout <seconds>       per case, 0 = none (default 300)\n"
+            "  --seed <n>                RNG seed and memory fill (default 1)\n"
+            "  --mute                    skip audio synthesis\n"
+            "\nmanifest lines: <name> <rom> <script|-> [frames=<n>] [crc=<hex>]"
+            " [exit=<n>]\n",
+            argv0);
+}
+
+enum
+{
+    OPT_JSON = 256, OPT_JUNIT, OPT_TIMEOUT, OPT_SEED, OPT_MUTE,
+};
+static const struct option longopts[] = {
+    {"jobs",    required_argument, NULL, 'j'},
+    {"json",    required_argument, NULL, OPT_JSON},
+    {"junit",   required_argument, NULL, OPT_JUNIT},
+    {"timeout", required_argument, NULL, OPT_TIMEOUT},
+    {"seed",    required_argument, NULL, OPT_SEED},
+    {"mute",    no_argument,       NULL, OPT_MUTE},
+    {"help",    no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0},
+};
+
+int main(int argc, char **argv)
+{
+    const char *json = NULL, *junit = NULL;
+    double timeout = 300;
+    unsigned long long seed = 1;
+    bool mute = false;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    int ch;
+    while ((ch = getopt_long(argc, argv, "j:h", longopts, NULL)) != -1)
+    {
+        switch (ch)
+        {
+        case 'j': jobs = atol(optarg); break;
+        case OPT_JSON: json = optarg; break;
+        case OPT_JUNIT: junit = optarg; break;
+        case OPT_TIMEOUT: timeout = atof(optarg); break;
+        case OPT_SEED: seed = strtoull(optarg, NULL, 0); break;
+        case OPT_MUTE: mute = true; break;
+        default:
+            bat_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        bat_usage(argv[0]);
+        return 2;
+    }
+    if (!bat_load_manifest(argv[optind]))
+        return 2;
+    bat_results = calloc(bat_n_cases, sizeof *bat_results);
+    if (!bat_results)
+    {
+        fprintf(stderr, "rp6502-batch: out of memory\n");
+        return 1;
+    }
+    if (jobs < 1)
+        jobs = 1;
+    if (jobs > BAT_MAX_WORKERS)
+        jobs = BAT_MAX_WORKERS;
+    if ((size_t)jobs > bat_n_cases)
+        jobs = (long)bat_n_cases;
+    bat_n_workers = (int)jobs;
+
+    /* The machine every case starts from, taken once here and inherited by
+     * every worker: rp6502-emu's boot with --seed, before any ROM. */
+    rand_set_seed((uint64_t)seed);
+    mem_set_fill(true, 0, rand_seed_value());
+    main_init();
+    vga_set_framebuffer(bat_fb);
+    if (mute)
+        aud_set_enabled(false);
+    bat_cold = emu_state_snapshot(&bat_cold_len);
+    if (!bat_cold)
+    {
+        fprintf(stderr, "rp6502-batch: out of memory\n");
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN); /* a dead worker is a result, not our death */
+    const double t0 = bat_now();
+    if (!bat_run_pool(timeout))
+        return 1;
+    const double wall = bat_now() - t0;
+
+    size_t counts[3] = {0, 0, 0};
+    uint64_t cycles = 0;
+    for (size_t i = 0; i < bat_n_cases; i++)
+    {
+        counts[bat_results[i].status]++;
+        cycles += bat_results[i].cycles;
+    }
+    printf("rp6502-batch: %zu passed, %zu failed, %zu errors in %.2f s "
+           "(%d workers, %.2f Mcycles/s)\n",
+           counts[BAT_PASS], counts[BAT_FAIL], counts[BAT_ERROR], wall,
+           bat_n_workers, wall > 0 ? cycles / wall / 1e6 : 0.0);
+
+    bool ok = true;
+    if (json)
+        ok = bat_write_json(json, wall, counts) && ok;
+    if (junit)
+        ok = bat_write_junit(junit, wall, counts) && ok;
+    if (!ok)
+        return 1;
+    return counts[BAT_PASS] == bat_n_cases ? 0 : 1;
+}
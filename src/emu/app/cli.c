@@ -31,6 +31,7 @@ void cli_options_init(cli_options *o)
     o->vsync = true;
     o->scale_filter = WINDOW_FILTER_SHARP;
     o->fill_random = true;
+    o->rewind = -1;
 }
 
 /* "RRGGBB" (optional leading '#') -> three 0-255 channels. */
@@ -75,7 +76,9 @@ enum
     OPT_SCREENSHOT = 256, OPT_FRAMES, OPT_SCALE, OPT_FILTER, OPT_SCRIPT,
     OPT_TMPDRIVE, OPT_ROM, OPT_BGCOLOR, OPT_PHI2, OPT_CP, OPT_SEED, OPT_FILL,
     OPT_MUTE, OPT_DEBUG, OPT_DAP, OPT_CREDITS, OPT_VERSION, OPT_INI,
-    OPT_VSYNC, OPT_NO_VSYNC,
+    OPT_VSYNC, OPT_NO_VSYNC, OPT_LOAD_STATE, OPT_SAVE_STATE, OPT_CYCLE_CPU,
+    OPT_VGA_PROFILE, OPT_RENDER_THREADS, OPT_TURBO, OPT_REWIND, OPT_CHECK_SPRITES,
+    OPT_VGA_BUDGET, OPT_VGA_OVERRUNS, OPT_WAV,
 };
 static const struct option longopts[] = {
     {"screenshot",   required_argument, NULL, OPT_SCREENSHOT},
@@ -83,18 +86,29 @@ static const struct option longopts[] = {
     {"scale",        required_argument, NULL, OPT_SCALE},
     {"vsync",        no_argument,       NULL, OPT_VSYNC},
     {"no-vsync",     no_argument,       NULL, OPT_NO_VSYNC},
+    {"turbo",        no_argument,       NULL, OPT_TURBO},
     {"filter",       required_argument, NULL, OPT_FILTER},
     {"script",       required_argument, NULL, OPT_SCRIPT},
+    {"load-state",   required_argument, NULL, OPT_LOAD_STATE},
+    {"save-state",   required_argument, NULL, OPT_SAVE_STATE},
+    {"vga-profile",  required_argument, NULL, OPT_VGA_PROFILE},
+    {"check-sprites", no_argument,      NULL, OPT_CHECK_SPRITES},
+    {"vga-budget",   no_argument,       NULL, OPT_VGA_BUDGET},
+    {"vga-overruns", no_argument,       NULL, OPT_VGA_OVERRUNS},
+    {"wav",          required_argument, NULL, OPT_WAV},
+    {"render-threads", required_argument, NULL, OPT_RENDER_THREADS},
     {"tmpdrive",     no_argument,       NULL, OPT_TMPDRIVE},
     {"rom",          required_argument, NULL, OPT_ROM},
     {"bgcolor",      required_argument, NULL, OPT_BGCOLOR},
     {"phi2",         required_argument, NULL, OPT_PHI2},
+    {"cycle-cpu",    no_argument,       NULL, OPT_CYCLE_CPU},
     {"cp",           required_argument, NULL, OPT_CP},
     {"seed",         required_argument, NULL, OPT_SEED},
     {"fill",         required_argument, NULL, OPT_FILL},
     {"mute",         no_argument,       NULL, OPT_MUTE},
     {"debug",        no_argument,       NULL, OPT_DEBUG},
     {"dap",          no_argument,       NULL, OPT_DAP},
+    {"rewind",       required_argument, NULL, OPT_REWIND},
     {"credits",      no_argument,       NULL, OPT_CREDITS},
     {"version",      no_argument,       NULL, OPT_VERSION},
     {"ini",          required_argument, NULL, OPT_INI},
@@ -110,14 +124,34 @@ void cli_usage(const char *argv0)
             "  --scale <n>               window scale, fractional ok (default 1.5)\n"
             "  --vsync                   sync presentation to the display (default)\n"
             "  --no-vsync                present uncapped instead of syncing to the display\n"
+            "  --turbo                   run as fast as the host can, not at 60 frames a\n"
+            "                            second (Ctrl+Alt+F toggles it in the window)\n"
             "  --filter <f>              nearest|linear|sharp (default sharp)\n"
             "  --script <file>           drive input and check results ('-' = stdin);\n"
             "                            always headless: the script is the only clock\n"
+            "  --load-state <file>       start from a saved machine state instead of the\n"
+            "                            ROM's reset (the ROM is still loaded for its files)\n"
+            "  --save-state <file>       save the machine state when the run ends\n"
+            "  --vga-profile <file.csv>  time every scanline's renderers, per plane, and\n"
+            "                            write mean/max per line when the run ends\n"
+            "  --check-sprites           name each mode 4 sprite whose opacity metadata\n"
+            "                            disagrees with its pixels, on stderr\n"
+            "  --vga-budget              estimate every scanline's RP2350 render time and\n"
+            "                            name the worst late lines, on stderr\n"
+            "  --vga-overruns            --vga-budget, and show late lines blue as the\n"
+            "                            VGA does\n"
+            "  --wav <file.wav>          record the machine's audio as it makes it, 16-bit\n"
+            "                            stereo at its own rate, until the run ends\n"
+            "  --render-threads <n|auto> draw scanlines on n worker threads behind the\n"
+            "                            CPU (same pixels; auto = one per spare core,\n"
+            "                            default 0 = on the emulation thread)\n"
             "  --tmpdrive                MSC0: = a fresh throwaway temp dir (isolate the ROM)\n"
             "  --rom <file>              install a .rp6502 on the null drive, reached\n"
             "                            as :basename; repeatable, the first one boots\n"
             "  --bgcolor RRGGBB          letterbox/pillarbox fill color (default 000000)\n"
             "  --phi2 <khz>              6502 clock in kHz (100-8000, default 8000)\n"
+            "  --cycle-cpu               tick every device on every 6502 cycle, without\n"
+            "                            the fast path (same machine, slower)\n"
             "  --cp <n>                  OEM code page (437/720/737/771/775/850/852/855/\n"
             "                            857/860-866/869, default 437)\n"
             "  --seed <n>                fixed RNG seed for reproducible runs\n"
@@ -129,6 +163,9 @@ void cli_usage(const char *argv0)
             "                            the window open on stop for inspection; no window\n"
             "                            with --script\n"
             "  --dap                     act as a DAP debug adapter on stdio (implies --debug)\n"
+            "  --rewind <frames>         keep a machine state every n frames for the\n"
+            "                            debugger's step back and reverse continue\n"
+            "                            (default 30 with --debug/--dap, else 0 = off)\n"
             "  --credits                 print third-party credits/licenses and exit\n"
             "  --version                 print the version and exit\n"
             "  --ini <file>              config file for the debugger UI layout\n"
@@ -158,7 +195,13 @@ void cli_usage(const char *argv0)
             "  dump [xram:]<addr> [count]          print memory as hex\n"
             "  crc / expect-crc <hash>             the canvas as a CRC-32\n"
             "  mark, expect-same, expect-changed   the canvas against a remembered one\n"
-            "  shot \"file.png\"           write the canvas\n");
+            "  audio-mark                start an audio window (a load starts one)\n"
+            "  audio-crc / expect-audio-crc <hash> the window's audio as a CRC-32\n"
+            "  expect-silence            nothing but zero in the window\n"
+            "  expect-audio-changed      the window moved off the level it was marked at\n"
+            "  shot \"file.png\"           write the canvas\n"
+            "  save-state \"file\"         save the machine state\n"
+            "  load-state \"file\"         replace the machine with a saved state\n");
 }
 
 /* Reset getopt's global state so the parser starts clean each call. glibc/musl
@@ -202,6 +245,7 @@ int cli_parse_args(int argc, char **argv, cli_options *o)
         case OPT_SCALE: o->scale = atof(optarg); o->have_scale = true; break;
         case OPT_VSYNC: o->vsync = true; break;
         case OPT_NO_VSYNC: o->vsync = false; break;
+        case OPT_TURBO: o->turbo = true; break;
         case OPT_FILTER:
             if (!strcmp(optarg, "nearest"))
                 o->scale_filter = WINDOW_FILTER_NEAREST;
@@ -217,6 +261,29 @@ int cli_parse_args(int argc, char **argv, cli_options *o)
             }
             break;
         case OPT_SCRIPT: o->script = optarg; break;
+        case OPT_LOAD_STATE: o->load_state = optarg; break;
+        case OPT_SAVE_STATE: o->save_state = optarg; break;
+        case OPT_VGA_PROFILE: o->vga_profile = optarg; break;
+        case OPT_CHECK_SPRITES: o->check_sprites = true; break;
+        case OPT_VGA_BUDGET: o->vga_budget = true; break;
+        case OPT_VGA_OVERRUNS: o->vga_budget = o->vga_overruns = true; break;
+        case OPT_WAV: o->wav = optarg; break;
+        case OPT_RENDER_THREADS:
+            if (!strcmp(optarg, "auto"))
+                o->render_threads = -1;
+            else
+            {
+                char *end;
+                long n = strtol(optarg, &end, 10);
+                if (end == optarg || *end || n < 0 || n > 64)
+                {
+                    fprintf(stderr, "rp6502-emu: bad --render-threads '%s' "
+                                    "(want 0-64 or auto)\n", optarg);
+                    return 2;
+                }
+                o->render_threads = (int)n;
+            }
+            break;
         case OPT_TMPDRIVE: o->tmpdrive = true; break;
         case OPT_ROM:
             if (o->n_installs < (int)(sizeof(o->installs) / sizeof(o->installs[0])))
@@ -231,6 +298,7 @@ int cli_parse_args(int argc, char **argv, cli_options *o)
             o->have_bg = true;
             break;
         case OPT_PHI2: o->phi2_khz = atoi(optarg); break;
+        case OPT_CYCLE_CPU: o->cycle_cpu = true; break;
         case OPT_CP: o->code_page = atoi(optarg); break;
         case OPT_SEED:
             o->seed = strtoull(optarg, NULL, 0);
@@ -247,6 +315,19 @@ int cli_parse_args(int argc, char **argv, cli_options *o)
         case OPT_MUTE: o->mute = true; break;
         case OPT_DEBUG: o->debug = true; break;
         case OPT_DAP: o->dap = true; break;
+        case OPT_REWIND:
+        {
+            char *end;
+            long n = strtol(optarg, &end, 10);
+            if (end == optarg || *end || n < 0 || n > 3600)
+            {
+                fprintf(stderr, "rp6502-emu: bad --rewind '%s' "
+                                "(want 0-3600 frames)\n", optarg);
+                return 2;
+            }
+            o->rewind = (int)n;
+            break;
+        }
         case OPT_CREDITS: o->credits = true; break;
         case OPT_VERSION: o->version = true; break;
         case OPT_INI: o->inidir = optarg; break;
@@ -17,6 +17,14 @@
 typedef struct
 {
     const char *rom, *shot, *script;
+    const char *load_state, *save_state; /* --load-state / --save-state files */
+    const char *vga_profile; /* --vga-profile: per-scanline render cost CSV at exit */
+    const char *wav;         /* --wav: record the machine's audio */
+    bool check_sprites;      /* --check-sprites: name sprites whose metadata is wrong */
+    bool vga_budget;         /* --vga-budget: name late scanlines on stderr */
+    bool vga_overruns;       /* --vga-overruns: and show them blue */
+    int render_threads;      /* --render-threads: 0 = serial, -1 = one per spare core */
+    int rewind;              /* --rewind: frames between rewind states, -1 = default */
     bool tmpdrive;
     const char *installs[16];
     int n_installs;
@@ -26,8 +34,10 @@ typedef struct
     double scale;
     bool have_scale;
     bool vsync; /* --no-vsync turns it off (default on) */
+    bool turbo; /* --turbo: start running as fast as the host can */
     window_scale_filter_t scale_filter;
     int phi2_khz;  /* 0 = leave at default */
+    bool cycle_cpu; /* --cycle-cpu: no 6502 fast path */
     int code_page; /* 0 = leave at the default 437 */
     bool mute;
     bool debug;   /* --debug: on-screen machine debugger */
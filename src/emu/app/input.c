@@ -435,6 +435,16 @@ void input_event(const sapp_event *e)
             sapp_lock_mouse(false); /* matches the browser's pointer-lock exit */
             break;
         }
+        /* Ctrl+Alt+F toggles turbo (window.h), a host chord the program never
+         * sees. Where AltGr is Ctrl+Alt a composed CHAR may follow; drop it. */
+        if (e->key_code == SAPP_KEYCODE_F && (e->modifiers & SAPP_MODIFIER_CTRL) &&
+            (e->modifiers & SAPP_MODIFIER_ALT))
+        {
+            if (!e->key_repeat)
+                window_set_turbo(!window_turbo());
+            suppress_char = true;
+            break;
+        }
         input_key(e);
         break;
     case SAPP_EVENTTYPE_KEY_UP:
@@ -18,11 +18,14 @@
 #include "emu/emu/tmp.h"
 #include "emu/sys/mem.h"
 #include "emu/sys/cpu.h"
+#include "emu/sys/rwd.h"
+#include "emu/sys/sst.h"
 #include "emu/main.h"
 #include "emu/sys/sys.h"
 #include "emu/sys/vga.h"
 #include "emu/app/cli.h"
 #include "emu/app/scr.h"
+#include "emu/app/wav.h"
 #include "emu/app/credits.h"
 #include "emu/app/version.h"
 #include <stdio.h>
@@ -42,8 +45,28 @@ static void apply_options(const cli_options *o)
     if (o->have_bg)
         window_set_bgcolor((uint8_t)o->bg_r, (uint8_t)o->bg_g, (uint8_t)o->bg_b);
     window_set_scale_filter(o->scale_filter);
+    if (o->turbo)
+        window_set_turbo(true);
     if (o->mute)
         aud_set_enabled(false);
+    /* Rewind is for the debugger: on by default only when there is one. */
+    if (o->rewind > 0 || (o->rewind < 0 && (o->debug || o->dap)))
+        rwd_set_interval(o->rewind > 0 ? (unsigned)o->rewind : 30);
+}
+
+/* What a run leaves behind when it ends, however it ends: the machine
+ * (--save-state), the render profile (--vga-profile) and the recording
+ * (--wav). False if any could not be written. */
+static bool write_on_exit(const cli_options *o)
+{
+    bool ok = true;
+    if (o->wav && !wav_close())
+        ok = false;
+    if (o->save_state && !emu_state_save(o->save_state))
+        ok = false;
+    if (o->vga_profile && !vga_profile_write_csv(o->vga_profile))
+        ok = false;
+    return ok;
 }
 
 #ifdef EMU_WITH_DEBUGGER
@@ -125,6 +148,21 @@ int main(int argc, char **argv)
             return 1;
         }
     }
+    if (o.cycle_cpu)
+        sys_set_fast_cpu(false);
+    if (o.vga_profile)
+        vga_set_profile(true);
+    if (o.check_sprites)
+        vga_set_sprite_check(true);
+    if (o.vga_budget)
+        vga_set_budget(VGA_BUDGET_REPORT | (o.vga_overruns ? VGA_BUDGET_SHOW : 0));
+    if (o.render_threads)
+    {
+        const int n = o.render_threads < 0 ? os_cpu_count() - 1 : o.render_threads;
+        if (n > 0 && !vga_set_render_threads(n))
+            fprintf(stderr, "rp6502-emu: no render threads on this host; "
+                            "drawing on the emulation thread\n");
+    }
     if (o.code_page > 0)
     {
         if (o.code_page > UINT16_MAX || !oem_set_code_page((uint16_t)o.code_page))
@@ -269,6 +307,25 @@ int main(int argc, char **argv)
 
     main_run(); /* start the machine — main_init only initialized the drivers */
 
+    /* A saved state replaces the machine main_run just reset, wholesale. The ROM
+     * was still loaded above: a state carries the machine, not the host, and the
+     * files the program opens and execs come from the ROM's drive. */
+    if (o.load_state && !emu_state_load(o.load_state))
+        return 1;
+
+    /* Recording from before the first frame, so nothing the program plays is
+     * missing from the front of it. */
+    if (o.wav)
+    {
+        if (o.mute)
+        {
+            fprintf(stderr, "rp6502-emu: --wav has nothing to record with --mute\n");
+            return 2;
+        }
+        if (!wav_open(o.wav))
+            return 1;
+    }
+
     /* A script is the clock, always: it runs the machine here rather than under a
      * window, so a frame elapses only because the script asked for one and its
      * verdict is the process exit code. Pacing a script against the host's clock
@@ -281,8 +338,13 @@ int main(int argc, char **argv)
             if (scr_running())
                 sys_run_frame(); /* rendered: shot and crc must see real pixels */
         }
-        if (scr_exit_code() || !o.shot)
-            return scr_exit_code(); /* a passing script may still want the shot */
+        if (scr_exit_code())
+        {
+            wav_close(); /* a failing run's audio is the one worth hearing */
+            return scr_exit_code();
+        }
+        if (!o.shot) /* a passing script may still want the shot */
+            return write_on_exit(&o) ? 0 : 1;
     }
 
     if (o.shot)
@@ -290,9 +352,13 @@ int main(int argc, char **argv)
         int frames = o.frames < 1 ? 1 : o.frames;
         /* Only the final frame is captured, so settle the earlier ones without
          * the per-scanline pixel work (most of the per-frame cost); render the
-         * last one and snapshot it. */
+         * last one and snapshot it. A profile or a budget wants every frame
+         * drawn. */
         for (int i = 0; i < frames - 1; i++)
-            sys_run_frame_norender();
+            if (o.vga_profile || o.vga_budget)
+                sys_run_frame();
+            else
+                sys_run_frame_norender();
         sys_run_frame(); /* renders into g_fb (registered above) */
         int cw, ch;
         vga_canvas_size(&cw, &ch); /* PNG is the canvas's native resolution */
@@ -300,9 +366,11 @@ int main(int argc, char **argv)
             return 1;
         printf("rp6502-emu: wrote %s (%d frames; cpu %s, exit code %d)\n",
                o.shot, frames, cpu_halted() ? "halted" : "running", pro_get_exit_code());
-        return 0;
+        return write_on_exit(&o) ? 0 : 1;
     }
 
     int code = window_run(g_fb, o.scale, o.have_scale, o.vsync, !o.debug);
+    if (!write_on_exit(&o)) /* where the user closed it */
+        return 1;
     return scr_exit_code() ? scr_exit_code() : code;
 }
@@ -10,6 +10,7 @@
 #include "pico/rand.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 /* An LCG step (the PCG/musl multiplier) feeding a Murmur3 fmix64 finalizer: cheap,
  * full-period, and well-distributed across all 64 output bits. */
@@ -41,3 +42,27 @@ uint64_t get_rand_64(void)
     x ^= x >> 33;
     return x;
 }
+
+/* Savestates: where the stream is, so every run forked from one state draws the
+ * same numbers. Always seeded first, so a state never carries "unseeded". */
+size_t rand_state_save(void *buf)
+{
+    if (buf)
+    {
+        uint64_t s[2] = {rand_seed_value(), rand_state};
+        memcpy(buf, s, sizeof s);
+    }
+    return 2 * sizeof(uint64_t);
+}
+
+bool rand_state_load(const void *buf, size_t len)
+{
+    uint64_t s[2];
+    if (len != sizeof s)
+        return false;
+    memcpy(s, buf, sizeof s);
+    rand_seed = s[0];
+    rand_state = s[1];
+    rand_seeded = true;
+    return true;
+}
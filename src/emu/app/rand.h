@@ -8,6 +8,8 @@
 #ifndef _EMU_APP_RAND_H_
 #define _EMU_APP_RAND_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* Force a fixed lrand seed for reproducible runs. With no seed set,
@@ -19,4 +21,8 @@ void rand_set_seed(uint64_t seed);
  * which the 6502's rand() syscall reads and which nothing else may disturb. */
 uint64_t rand_seed_value(void);
 
+/* Savestate section (sys/sst.h): the seed and the stream's position. */
+size_t rand_state_save(void *buf);
+bool rand_state_load(const void *buf, size_t len);
+
 #endif /* _EMU_APP_RAND_H_ */
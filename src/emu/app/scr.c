@@ -7,6 +7,7 @@
 
 #include "emu/app/scr.h"
 #include "emu/app/png.h"
+#include "emu/emu/aud.h"
 #include "emu/emu/pro.h"
 #include "emu/hid/kbd.h"
 #include "emu/hid/mou.h"
@@ -15,6 +16,7 @@
 #include "emu/sys/com.h"
 #include "emu/sys/cpu.h"
 #include "emu/sys/mem.h"
+#include "emu/sys/sst.h"
 #include "emu/sys/vga.h"
 #include <stdarg.h>
 #include <stdio.h>
@@ -56,6 +58,20 @@ static int scr_exit_want;
 static uint32_t scr_mark;
 static bool scr_marked;
 
+/* The audio since `audio-mark`, or since the load, heard as it is rendered.
+ * Sound has no single frame to hash, so a window is what the checks see: its
+ * CRC, which is of the 16-bit little-endian stereo a --wav of the same frames
+ * holds after its header, its loudest sample, and whether it ever left the
+ * level the output stood at when the window opened. */
+static struct
+{
+    uint32_t crc;
+    int peak;
+    bool moved;
+    int16_t level[2]; /* the last frame before the window */
+    int16_t last[2];
+} scr_audio;
+
 /* Every player's report, assembled here and handed to pad_host_report — the
  * same shape the web and Android hosts keep, so a scripted pad reaches XRAM
  * through the code a real one does. */
@@ -101,6 +117,40 @@ static void scr_cap_take(const char *through)
     scr_cap_len -= used;
 }
 
+/* ------------------------------------------------------------------ */
+/* Audio capture                                                       */
+/* ------------------------------------------------------------------ */
+
+static void scr_audio_tap(const int16_t *l, const int16_t *r, unsigned n, uint32_t rate)
+{
+    (void)rate;
+    for (unsigned i = 0; i < n; i++)
+    {
+        const uint8_t b[4] = {(uint8_t)l[i], (uint8_t)((uint16_t)l[i] >> 8),
+                              (uint8_t)r[i], (uint8_t)((uint16_t)r[i] >> 8)};
+        scr_audio.crc = mem_crc32(scr_audio.crc, b, sizeof b);
+        const int al = abs(l[i]), ar = abs(r[i]);
+        if (al > scr_audio.peak)
+            scr_audio.peak = al;
+        if (ar > scr_audio.peak)
+            scr_audio.peak = ar;
+        if (l[i] != scr_audio.level[0] || r[i] != scr_audio.level[1])
+            scr_audio.moved = true;
+        scr_audio.last[0] = l[i];
+        scr_audio.last[1] = r[i];
+    }
+}
+
+/* Open a new window where the last one ended. */
+static void scr_audio_mark(void)
+{
+    scr_audio.crc = 0;
+    scr_audio.peak = 0;
+    scr_audio.moved = false;
+    scr_audio.level[0] = scr_audio.last[0];
+    scr_audio.level[1] = scr_audio.last[1];
+}
+
 /* ------------------------------------------------------------------ */
 /* Parsing                                                             */
 /* ------------------------------------------------------------------ */
@@ -613,6 +663,8 @@ bool scr_command(const char *line)
             if (addr + i > 0xFFFF)
                 return scr_error("poke runs past the end of memory");
             base[addr + i] = (uint8_t)value;
+            if (base == xram)
+                mem_xram_wrote((uint16_t)(addr + i));
             i++;
         }
         if (!i)
@@ -671,6 +723,45 @@ bool scr_command(const char *line)
         return true;
     }
 
+    if (!strcasecmp(cmd, "audio-mark") || !strcasecmp(cmd, "audio-crc") ||
+        !strcasecmp(cmd, "expect-audio-crc") || !strcasecmp(cmd, "expect-silence") ||
+        !strcasecmp(cmd, "expect-audio-changed"))
+    {
+        /* Muted, nothing is rendered, and every window would pass for silence. */
+        if (!aud_enabled())
+            return scr_error("%s with the audio muted", cmd);
+        if (!strcasecmp(cmd, "audio-mark"))
+        {
+            scr_audio_mark();
+            return true;
+        }
+        if (!strcasecmp(cmd, "audio-crc"))
+        {
+            printf("%08X\n", scr_audio.crc);
+            fflush(stdout);
+            return true;
+        }
+        if (!strcasecmp(cmd, "expect-audio-crc"))
+        {
+            unsigned long want;
+            if (!scr_hash(&p, &want))
+                return scr_error("expect-audio-crc wants a hash");
+            if (scr_audio.crc != (uint32_t)want)
+                return scr_error("audio is %08X, expected %08lX", scr_audio.crc, want);
+            return true;
+        }
+        if (!strcasecmp(cmd, "expect-silence"))
+        {
+            if (scr_audio.peak)
+                return scr_error("the audio since the mark is not silent (peak %d)",
+                                 scr_audio.peak);
+            return true;
+        }
+        if (!scr_audio.moved)
+            return scr_error("the audio has not changed since the mark");
+        return true;
+    }
+
     if (!strcasecmp(cmd, "shot"))
     {
         char path[512];
@@ -686,6 +777,20 @@ bool scr_command(const char *line)
         return true;
     }
 
+    /* A state is the machine, not the script: the console capture, the marks and
+     * anything pending stay as they are, so a load is followed by the same
+     * checks a fresh boot would be. */
+    if (!strcasecmp(cmd, "save-state") || !strcasecmp(cmd, "load-state"))
+    {
+        char path[512];
+        if (!scr_string(&p, path, sizeof path))
+            return scr_error("%s wants a quoted path", cmd);
+        bool save = !strcasecmp(cmd, "save-state");
+        if (!(save ? emu_state_save(path) : emu_state_load(path)))
+            return scr_error("cannot %s '%s'", save ? "save state to" : "load state from", path);
+        return true;
+    }
+
     return scr_error("unknown command '%s'", cmd);
 }
 
@@ -769,6 +874,10 @@ void scr_task(void)
 
 bool scr_load(const char *path)
 {
+    /* A host running many scripts in one process loads each over the last. */
+    if (scr_file && scr_file != stdin)
+        fclose(scr_file);
+    scr_file = NULL;
     if (!strcmp(path, "-"))
     {
         scr_file = stdin;
@@ -785,6 +894,7 @@ bool scr_load(const char *path)
         scr_path = path;
     }
     com_set_tx_tap(scr_tap);
+    aud_add_tap(scr_audio_tap);
     /* Arm a clean run: a load inherits nothing from a script that ran before it,
      * not a half-finished wait, not console text nobody matched, not a verdict. */
     scr_line_no = 0;
@@ -793,6 +903,8 @@ bool scr_load(const char *path)
     scr_cap_len = 0;
     scr_cap[0] = 0;
     scr_marked = false;
+    memset(&scr_audio, 0, sizeof scr_audio); /* the window opens on silence */
+    memset(scr_pad, 0, sizeof scr_pad); /* nothing is plugged in until it says */
     scr_fail = false;
     scr_run = true;
     return true;
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "emu/app/wav.h"
+#include "emu/emu/aud.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define WAV_HEADER 44
+/* A RIFF's sizes are 32 bits: about six hours at 48 kHz. */
+#define WAV_DATA_MAX (UINT32_MAX - WAV_HEADER)
+
+static FILE *wav_file;
+static const char *wav_path;
+static uint32_t wav_rate; /* 0 until the first block says what it is */
+static uint32_t wav_bytes;
+static bool wav_failed, wav_full, wav_moved;
+
+static void put_le16(uint8_t *dst, uint16_t v)
+{
+    dst[0] = v & 0xFF;
+    dst[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(uint8_t *dst, uint32_t v)
+{
+    put_le16(dst, v & 0xFFFF);
+    put_le16(dst + 2, v >> 16);
+}
+
+static bool wav_header(void)
+{
+    uint8_t h[WAV_HEADER];
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, wav_bytes + WAV_HEADER - 8);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le32(h + 16, 16);
+    put_le16(h + 20, 1); /* PCM */
+    put_le16(h + 22, 2);
+    put_le32(h + 24, wav_rate);
+    put_le32(h + 28, wav_rate * 4);
+    put_le16(h + 32, 4);
+    put_le16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    put_le32(h + 40, wav_bytes);
+    return fseek(wav_file, 0, SEEK_SET) == 0 && fwrite(h, 1, sizeof h, wav_file) == sizeof h;
+}
+
+/* A file has one rate and the machine does not: the OPL2 makes 49716 Hz
+ * wherever everything else makes the host's. The first rate heard is the
+ * file's, and a run that moves off it is told so rather than resampled, since
+ * this is for checking what was made, not for listening to. */
+static void wav_tap(const int16_t *l, const int16_t *r, unsigned n, uint32_t rate)
+{
+    if (!wav_rate)
+        wav_rate = rate;
+    if (rate != wav_rate && !wav_moved)
+    {
+        fprintf(stderr, "rp6502-emu: %s: the machine moved from %u to %u Hz; "
+                        "it is all written at %u\n",
+                wav_path, (unsigned)wav_rate, (unsigned)rate, (unsigned)wav_rate);
+        wav_moved = true;
+    }
+    uint8_t buf[256 * 4];
+    unsigned done = 0;
+    while (done < n && !wav_failed && !wav_full)
+    {
+        unsigned len = n - done;
+        if (len > sizeof buf / 4)
+            len = sizeof buf / 4;
+        if (len * 4 > WAV_DATA_MAX - wav_bytes)
+        {
+            len = (WAV_DATA_MAX - wav_bytes) / 4;
+            wav_full = true;
+            fprintf(stderr, "rp6502-emu: %s: full; the rest is not recorded\n", wav_path);
+        }
+        for (unsigned i = 0; i < len; i++)
+        {
+            put_le16(buf + i * 4, (uint16_t)l[done + i]);
+            put_le16(buf + i * 4 + 2, (uint16_t)r[done + i]);
+        }
+        if (fwrite(buf, 4, len, wav_file) != len)
+            wav_failed = true;
+        wav_bytes += len * 4;
+        done += len;
+    }
+}
+
+bool wav_open(const char *path)
+{
+    wav_file = fopen(path, "wb");
+    if (!wav_file)
+    {
+        fprintf(stderr, "rp6502-emu: cannot write '%s'\n", path);
+        return false;
+    }
+    wav_path = path;
+    wav_rate = 0;
+    wav_bytes = 0;
+    wav_failed = wav_full = wav_moved = false;
+    /* Sizes of zero until the close puts the real ones in. */
+    if (!wav_header() || !aud_add_tap(wav_tap))
+    {
+        fprintf(stderr, "rp6502-emu: cannot record '%s'\n", path);
+        fclose(wav_file);
+        wav_file = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool wav_close(void)
+{
+    if (!wav_file)
+        return true;
+    aud_remove_tap(wav_tap);
+    if (!wav_rate) /* nothing was played; the header still wants a rate */
+        wav_rate = aud_native_rate();
+    bool ok = !wav_failed && wav_header();
+    if (fclose(wav_file))
+        ok = false;
+    wav_file = NULL;
+    if (!ok)
+        fprintf(stderr, "rp6502-emu: cannot write '%s'\n", wav_path);
+    return ok;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _EMU_APP_WAV_H_
+#define _EMU_APP_WAV_H_
+
+#include <stdbool.h>
+
+/* --wav: record what the machine plays, 16-bit stereo at the rate it is made
+ * at, from wav_open until wav_close. The header's sizes are only right once
+ * it is closed. */
+bool wav_open(const char *path);
+bool wav_close(void);
+
+#endif /* _EMU_APP_WAV_H_ */
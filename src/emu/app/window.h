@@ -73,4 +73,17 @@ bool window_canvas_from_fb(float px, float py, int *cx, int *cy);
  * letterbox. */
 void window_set_pointer_on_canvas(bool on);
 
+/* Turbo: run as many frames as the host can between presents instead of 60 a
+ * second, drawing only the one presented, for getting through a loading screen
+ * or a long computation. The title carries the achieved frame rate and 6502
+ * clock. Audio is squeezed into real time (higher pitch) up to a few times
+ * real time and dropped beyond. Ctrl+Alt+F, --turbo, or the DAP rp6502/turbo
+ * request. */
+void window_set_turbo(bool on);
+bool window_turbo(void);
+
+/* The emulation's achieved speed over the last half second: VGA frames and
+ * 6502 MHz per host second. */
+void window_speed(double *fps, double *mhz);
+
 #endif /* _EMU_APP_WINDOW_H_ */
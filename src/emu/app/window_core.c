@@ -60,7 +60,8 @@ static struct
     sfb_framebuffer sfb;          /* presents fb: upload, prescale, letterboxed blit */
     window_scale_filter_t filter; /* 0 == NEAREST default */
     float bg_r, bg_g, bg_b; /* letterbox/pillarbox fill (default black) */
-    int title_variant;     /* last window-title state (running/stopped/mouse) */
+    char title[96];        /* the window title last set */
+    bool turbo;            /* uncapped: every frame the host can run per present */
     uint32_t *fb;          /* caller's framebuffer: vga renders in, frame_cb uploads */
 } app;
 
@@ -69,6 +70,51 @@ static struct
  * sub-60 display: 6 supports presents down to ~10 Hz, caps catch-up to ~100 ms. */
 #define WINDOW_MAX_SKIP 6
 
+/* Turbo spends this much of a present period running frames, leaving the rest
+ * for the present itself and the host's input. */
+#define WINDOW_TURBO_SHARE 0.75
+
+void window_set_turbo(bool on)
+{
+    app.turbo = on;
+    if (!on)
+        aud_set_speed(1.0);
+}
+
+bool window_turbo(void) { return app.turbo; }
+
+/* Achieved speed, sampled over half-second windows of host time. */
+static struct
+{
+    uint64_t t0;
+    unsigned long frames0;
+    uint64_t cycles0;
+    double fps, mhz;
+} speed;
+
+static void speed_sample(void)
+{
+    const uint64_t now = os_mono_ns();
+    if (!speed.t0 || now - speed.t0 >= 500000000ull)
+    {
+        if (speed.t0)
+        {
+            const double s = (double)(now - speed.t0) / 1e9;
+            speed.fps = (double)(sys_frame_count() - speed.frames0) / s;
+            speed.mhz = (double)(sys_cpu_cycles() - speed.cycles0) / s / 1e6;
+        }
+        speed.t0 = now;
+        speed.frames0 = sys_frame_count();
+        speed.cycles0 = sys_cpu_cycles();
+    }
+}
+
+void window_speed(double *fps, double *mhz)
+{
+    *fps = speed.fps;
+    *mhz = speed.mhz;
+}
+
 void window_set_bgcolor(uint8_t r, uint8_t g, uint8_t b)
 {
     app.bg_r = r / 255.0f;
@@ -322,35 +368,28 @@ static void update_cursor(void)
 }
 
 /* Reflect run + mouse-capture state in the window title, only when it changes.
- * When a program has mapped the mouse, the title carries the capture hint. */
+ * When a program has mapped the mouse, the title carries the capture hint; in
+ * turbo, the speed readout. */
 static void update_title(void)
 {
-    int v;
     const char *t;
     if (cpu_halted())
-    {
-        v = 1;
         t = "Picocomputer 6502 (stopped)";
-    }
     else if (mou_is_mapped() && sapp_mouse_locked())
-    {
-        v = 3;
         t = "Picocomputer 6502  -  Esc releases mouse";
-    }
     else if (mou_is_mapped() && !tab_is_mapped())
-    {
-        v = 2;
         t = "Picocomputer 6502  -  click to capture mouse";
-    }
     else
-    {
-        v = 0;
         t = "Picocomputer 6502";
-    }
-    if (v != app.title_variant)
+    char title[sizeof app.title];
+    if (app.turbo)
+        snprintf(title, sizeof title, "%s  -  turbo %.0f FPS, %.1f MHz", t, speed.fps, speed.mhz);
+    else
+        snprintf(title, sizeof title, "%s", t);
+    if (strcmp(title, app.title))
     {
-        app.title_variant = v;
-        sapp_set_window_title(t);
+        memcpy(app.title, title, sizeof title);
+        sapp_set_window_title(title);
     }
 }
 
@@ -421,7 +460,7 @@ void window_core_frame(void)
      * skip per-scanline pixel work (most of the per-frame cost), so falling
      * behind stays cheap. The present clock is the vsync swap (vsync) or the
      * software sleep at the bottom (no-vsync). */
-    double dt = sapp_frame_duration(); /* smoothed; only the EMU_BENCH_MS block uses it */
+    double dt = sapp_frame_duration(); /* smoothed; the present period for turbo and EMU_BENCH_MS */
     static uint64_t start_ns, done;
     static bool started;
     if (!started)
@@ -438,7 +477,40 @@ void window_core_frame(void)
         done += behind - WINDOW_MAX_SKIP;
         behind = WINDOW_MAX_SKIP;
     }
-    for (uint64_t i = 0; i < behind; i++)
+    const bool turbo = app.turbo && !host_window_menu_active() &&
+                       !(dbg_is_active() && dbg_is_stopped());
+    if (turbo)
+    {
+        /* Turbo: undrawn frames until this present's share of the period is
+         * spent, then the drawn one. Audio is pumped every frame, the ring
+         * holding only a few, and told how fast the machine is going: the
+         * frames this present has run so far over the time they took, scaled
+         * to the whole period they share, so the first turbo present already
+         * has its own rate. The clock is re-anchored after, so leaving turbo
+         * resumes real time from here instead of owing or being owed the
+         * difference. */
+        const double period = dt > 0.0 && dt < 1.0 / VGA_HZ ? dt : 1.0 / VGA_HZ;
+        const uint64_t t0 = os_mono_ns();
+        const uint64_t budget = (uint64_t)(period * WINDOW_TURBO_SHARE * 1e9);
+        uint64_t ran;
+        behind = 0;
+        do
+        {
+            sys_run_frame_norender();
+            behind++;
+            ran = os_mono_ns() - t0;
+            if (saudio_isvalid())
+            {
+                aud_set_speed(ran ? behind * WINDOW_TURBO_SHARE * 1e9 / ((double)ran * VGA_HZ) : 1.0);
+                aud_pump(saudio_sample_rate(), saudio_push);
+            }
+        } while (ran < budget && !cpu_halted());
+        sys_run_frame();
+        behind++;
+        done += behind;
+        start_ns = os_mono_ns() - done * (1000000000ull / VGA_HZ);
+    }
+    for (uint64_t i = 0; !turbo && i < behind; i++)
     {
         if (i + 1 < behind)
             sys_run_frame_norender(); /* catch-up frame: CPU/timing only, no pixels */
@@ -446,6 +518,7 @@ void window_core_frame(void)
             sys_run_frame(); /* the frame we'll present: render it */
         done++;
     }
+    speed_sample();
 
     if (saudio_isvalid()) /* --mute opens no device; skip the resample+push */
         aud_pump(saudio_sample_rate(), saudio_push);
@@ -592,7 +665,7 @@ void window_core_frame(void)
      * frame is due — start + (done+1)·period (absolute → no drift). Sleeping to
      * done·period would target a deadline already past and busy-loop. With vsync
      * the swap-block above already paces the loop. */
-    if (!app.vsync)
+    if (!app.vsync && !turbo)
         os_sleep_until_ns(start_ns + (done + 1) * (1000000000ull / VGA_HZ));
 }
 
@@ -36,6 +36,7 @@ extern "C"
 #include "emu/dbg/dwarf_info.h"
 #include "emu/dbg/dwarf_frame.h"
 #include "emu/dbg/cc65dbg.h"
+#include "emu/app/window.h" /* window_set_turbo (rp6502/turbo) */
 }
 #include "chips/chips/w65c02.h"
 #include "chips/util/w65c02dasm.h"
@@ -77,6 +78,24 @@ DAP_IMPLEMENT_STRUCT_TYPEINFO_EXT(RP6502LaunchRequest, LaunchRequest, "launch",
                                   DAP_FIELD(dbg, "dbg"),
                                   DAP_FIELD(stopOnEntry, "stopOnEntry"),
                                   DAP_FIELD(stopOnExit, "stopOnExit"));
+
+/* ---- rp6502/turbo: run uncapped (window.h window_set_turbo); on absent toggles ---- */
+struct RP6502TurboResponse : public Response
+{
+    boolean turbo; /* the state it is now in */
+};
+DAP_DECLARE_STRUCT_TYPEINFO(RP6502TurboResponse);
+DAP_IMPLEMENT_STRUCT_TYPEINFO(RP6502TurboResponse, "",
+                              DAP_FIELD(turbo, "turbo"));
+
+struct RP6502TurboRequest : public Request
+{
+    using Response = RP6502TurboResponse;
+    optional<boolean> on;
+};
+DAP_DECLARE_STRUCT_TYPEINFO(RP6502TurboRequest);
+DAP_IMPLEMENT_STRUCT_TYPEINFO(RP6502TurboRequest, "rp6502/turbo",
+                              DAP_FIELD(on, "on"));
 } // namespace dap
 
 namespace
@@ -1441,6 +1460,7 @@ extern "C" void dap_start(void)
         r.supportsLogPoints = true;
         r.supportsDataBreakpoints = true;
         r.supportsFunctionBreakpoints = true;
+        r.supportsStepBack = true;
         /* Variable.type + Variable.memoryReference are gated on CLIENT caps
          * (supportsVariableType / supportsMemoryReferences), which VS Code sends;
          * the adapter need not advertise anything for them. */
@@ -1808,6 +1828,13 @@ extern "C" void dap_start(void)
         r.allThreadsContinued = true;
         return r;
     });
+    g_session->registerHandler([](const dap::RP6502TurboRequest &req) {
+        const bool on = req.on.value(!window_turbo());
+        post([on]() { window_set_turbo(on); });
+        dap::RP6502TurboResponse r;
+        r.turbo = on;
+        return r;
+    });
     g_session->registerHandler([](const dap::PauseRequest &) {
         dbg_request_pause(); /* atomic; safe from the reader thread */
         return dap::PauseResponse();
@@ -1828,6 +1855,23 @@ extern "C" void dap_start(void)
         post([]() { dbg_step(DBG_STEP_LINE_OUT); });
         return dap::StepOutResponse();
     });
+    /* Backwards over the rewind history; always one instruction (dbg.h). With
+     * none to go back to the machine stays put, and says so with the stop it
+     * is still at, as the client waits for one. */
+    g_session->registerHandler([](const dap::StepBackRequest &) {
+        post([]() {
+            if (!dbg_step_back())
+                on_stopped(dbg_stop_reason(), dbg_stop_pc());
+        });
+        return dap::StepBackResponse();
+    });
+    g_session->registerHandler([](const dap::ReverseContinueRequest &) {
+        post([]() {
+            if (!dbg_reverse_continue())
+                on_stopped(dbg_stop_reason(), dbg_stop_pc());
+        });
+        return dap::ReverseContinueResponse();
+    });
 
     g_session->registerHandler([](const dap::SetInstructionBreakpointsRequest &req) {
         dap::SetInstructionBreakpointsResponse r;
@@ -21,6 +21,8 @@
  */
 
 #include "emu/dbg/dbg.h"
+#include "emu/sys/rwd.h"
+#include "emu/sys/sys.h"
 #include <stdatomic.h>
 #include <string.h>
 
@@ -36,6 +38,7 @@ static uint8_t g_stop_sp;      /* SP captured at the last stop */
 static int g_step_line;        /* source line at the step start (0 = unknown) */
 static const char *g_step_file; /* source file at the step start */
 static uint8_t g_step_sp;      /* SP at the step start (call-depth reference) */
+static uint64_t g_cur_clk;     /* system clock at the current instruction boundary */
 
 static atomic_bool g_pause_req;
 static bool g_break_req;
@@ -116,8 +119,35 @@ int dbg_get_segments(const dbg_segment_t **out)
 
 unsigned dbg_segments_generation(void) { return g_seg_generation; }
 
+/* Where the machine has stopped since the oldest rewind state. A stop ends the
+ * frame there and the resume starts a fresh one (sys.c), so the frame phase a
+ * program runs in depends on them: a replay stops at each too, quietly, or it
+ * would not run the instructions that were run. Oldest first. */
+#define DBG_SPLITS_MAX 4096
+static uint64_t g_splits[DBG_SPLITS_MAX];
+static size_t g_nsplits;
+
+static void note_split(uint64_t clk)
+{
+    while (g_nsplits && g_splits[g_nsplits - 1] >= clk)
+        g_nsplits--; /* a future left behind by going back */
+    if (g_nsplits == DBG_SPLITS_MAX)
+    {
+        const uint64_t oldest = rwd_count() ? rwd_clock(0) : clk;
+        size_t keep = 0;
+        while (keep < g_nsplits && g_splits[keep] < oldest)
+            keep++;
+        if (!keep)
+            keep = 1; /* replays from before it may go their own way */
+        memmove(g_splits, g_splits + keep, (g_nsplits - keep) * sizeof *g_splits);
+        g_nsplits -= keep;
+    }
+    g_splits[g_nsplits++] = clk;
+}
+
 static void enter_stop(int reason, uint16_t pc)
 {
+    note_split(g_cur_clk);
     g_stopped = true;
     g_stop_reason = reason;
     g_stop_pc = pc;
@@ -183,9 +213,116 @@ static bool step_should_stop(uint16_t pc, uint8_t sp)
     return false;
 }
 
-bool dbg_at_instruction(uint16_t pc, uint8_t sp)
+/* Reverse execution: put the machine back to a rewind state and run it forward
+ * to just short of where it was, counting the boundaries it could have stopped
+ * at; then do it again and stop at the last of them. */
+static struct
+{
+    bool on;
+    bool done;       /* reached the target or until */
+    bool all;        /* every boundary counts (step back), not just breakpoints */
+    int reason;      /* of the stop at the target */
+    uint64_t until;  /* where the machine was */
+    unsigned target; /* stop at this hit; 0 only counts */
+    unsigned hits;
+    size_t split;    /* the next of g_splits to come */
+} g_rev;
+
+static void quiet_stop(uint16_t pc)
+{
+    g_stopped = true;
+    g_stop_pc = pc;
+    g_stop_sp = g_cur_sp;
+}
+
+/* dbg_at_instruction while replaying. Breakpoints are the bitmap alone: a
+ * condition or hit count (the DAP filter) would count again, and a logpoint
+ * log again, for instructions that already ran. */
+static bool replay_at(uint16_t pc, uint64_t clk)
+{
+    if (clk >= g_rev.until)
+    {
+        g_rev.done = true;
+        quiet_stop(pc);
+        return true;
+    }
+    bool split = false;
+    while (g_rev.split < g_nsplits && g_splits[g_rev.split] <= clk)
+        split = g_splits[g_rev.split++] == clk;
+    if ((g_rev.all || bp_test(pc)) && ++g_rev.hits == g_rev.target)
+    {
+        g_rev.done = true;
+        enter_stop(g_rev.reason, pc);
+        return true;
+    }
+    if (split)
+    {
+        quiet_stop(pc);
+        return true;
+    }
+    return false;
+}
+
+static bool replay(size_t state, uint64_t until, bool all, unsigned target, int reason)
+{
+    if (!rwd_restore(state))
+        return false;
+    const uint64_t from = rwd_clock(state);
+    g_rev.on = true;
+    g_rev.done = false;
+    g_rev.all = all;
+    g_rev.reason = reason;
+    g_rev.until = until;
+    g_rev.target = target;
+    g_rev.hits = 0;
+    g_rev.split = 0;
+    while (g_rev.split < g_nsplits && g_splits[g_rev.split] <= from)
+        g_rev.split++;
+    rwd_hold(true);
+    while (!g_rev.done && sys_clk_now() < until)
+    {
+        g_stopped = false;
+        sys_run_frame_norender();
+    }
+    rwd_hold(false);
+    g_rev.on = false;
+    g_stopped = true; /* a halted CPU reaches until without a boundary */
+    if (target && g_rev.hits < target)
+        enter_stop(reason, g_stop_pc); /* went another way: stop where it got */
+    g_data_pending = false;
+    atomic_store(&g_pause_req, false);
+    return true;
+}
+
+static bool reverse(bool all, int reason)
+{
+    const uint64_t now = sys_clk_now();
+    if (!g_active || !g_stopped || !rwd_count() || rwd_clock(0) >= now)
+        return false;
+    uint64_t until = now;
+    for (size_t k = rwd_count(); k--;)
+    {
+        if (rwd_clock(k) >= until)
+            continue;
+        if (!replay(k, until, all, 0, reason))
+            return false;
+        if (g_rev.hits)
+            return replay(k, until, all, g_rev.hits, reason);
+        until = rwd_clock(k); /* none since k: look before it */
+    }
+    /* Nothing to go back to: the first instruction there is history for. */
+    return replay(0, now, true, 1, DBG_REASON_STEP);
+}
+
+bool dbg_reverse_continue(void) { return reverse(false, DBG_REASON_BREAKPOINT); }
+bool dbg_step_back(void) { return reverse(true, DBG_REASON_STEP); }
+
+bool dbg_at_instruction(uint16_t pc, uint8_t sp, uint64_t clk)
 {
     g_cur_sp = sp;
+    g_cur_clk = clk;
+    if (g_rev.on)
+        return replay_at(pc, clk);
 
     if (atomic_load(&g_pause_req))
     {
@@ -53,6 +53,19 @@ void dbg_stop_at_entry(void);  /* arm a one-shot stop at the first instruction *
  * until the client disconnects. */
 void dbg_note_stop(uint16_t pc);
 
+/* Reverse execution, from a stop, over the rewind history (sys/rwd.h): the
+ * machine goes back to a rewind state and runs forward again to the last
+ * breakpoint before where it was (reverse continue, reason BREAKPOINT) or the
+ * last instruction boundary (step back, reason STEP; always one instruction,
+ * whatever a forward step's granularity). With no earlier breakpoint it stops
+ * at the oldest instruction there is history for. The run forward has no host
+ * input and evaluates no breakpoint conditions, hit counts or logpoints; a
+ * program steered by the keyboard, the host clock or a file that changed since
+ * may not go where it went. False, still stopped where it was, when there is
+ * no history from before the stop. */
+bool dbg_reverse_continue(void);
+bool dbg_step_back(void);
+
 /* Address breakpoints (the source-line mapper resolves lines to addresses). */
 void dbg_clear_breakpoints(void);
 void dbg_add_breakpoint(uint16_t addr);
@@ -98,8 +111,9 @@ void dbg_set_segments(const dbg_segment_t *segs, int count); /* copies; clamps t
 int dbg_get_segments(const dbg_segment_t **out);             /* count; *out -> the table */
 unsigned dbg_segments_generation(void);                      /* bumps on each set (cheap change check) */
 
-/* Called by main.c at each instruction fetch (W65C02_SYNC) while active. Returns
- * true if the machine must stop BEFORE running the instruction's effect at pc. */
-bool dbg_at_instruction(uint16_t pc, uint8_t sp);
+/* Called by main.c at each instruction fetch (W65C02_SYNC) while active, clk the
+ * system clock there. Returns true if the machine must stop BEFORE running the
+ * instruction's effect at pc. */
+bool dbg_at_instruction(uint16_t pc, uint8_t sp, uint64_t clk);
 
 #endif /* _EMU_DBG_DBG_H_ */
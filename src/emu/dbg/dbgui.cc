@@ -24,6 +24,7 @@ extern "C"
 #include "emu/dbg/dbg.h"
 #include "emu/sys/cpu.h"
 #include "emu/sys/mem.h"
+#include "emu/sys/rwd.h"
 #include "emu/sys/sys.h"
 #include "ria/api/oem.h" /* oem_get_code_page_run (RIA panel status) */
 #include "emu/emu/pro.h" /* pro_get_exit_code (exit-code display) */
@@ -80,6 +81,8 @@ static bool g_inited;
 static bool g_control_open = false;  /* the native "Debug Control" window */
 static bool g_credits_open = false;  /* the native "Credits" about box */
 static bool g_rom_help_open = false; /* the loaded ROM's "help" asset viewer */
+static bool g_vga_profile_open = false; /* the per-scanline render cost heatmap */
+static bool g_vga_budget_open = false;  /* the per-scanline RP2350 render budget */
 static float g_menu_h;              /* main-menu-bar height in ImGui points (see dbgui_menu_height) */
 
 /* UI scale. Native ProggyClean is DBGUI_FONT_BASE px; the Options menu offers these
@@ -253,6 +256,7 @@ static void memedit_write(int layer, uint16_t addr, uint8_t data, void *user)
     {
     case 1:
         xram[addr] = data;
+        mem_xram_wrote(addr);
         break;
     case 2:
         if (addr < XSTACK_SIZE)
@@ -290,6 +294,18 @@ static void draw_control(void)
             ImGui::SameLine();
             if (ImGui::Button("Step Over"))
                 dbg_step(DBG_STEP_LINE_OVER);
+            if (rwd_count())
+            {
+                /* Back over the rewind history (--rewind); no-ops without any. */
+                if (ImGui::Button("Step Back"))
+                    dbg_step_back();
+                ImGui::SameLine();
+                if (ImGui::Button("Reverse Continue"))
+                    dbg_reverse_continue();
+                ImGui::SameLine();
+                ImGui::TextDisabled("%u states, %u KB", (unsigned)rwd_count(),
+                                    (unsigned)(rwd_bytes() >> 10));
+            }
         }
         else if (!cpu_halted() && ImGui::Button("Pause"))
             dbg_request_pause();
@@ -369,6 +385,180 @@ static void draw_rom_help(void)
     ImGui::End();
 }
 
+/* Black through red and yellow to white as t goes 0..1. */
+static ImU32 heat_color(float t)
+{
+    auto ramp = [](float v) { return v < 0.0f ? 0 : v > 1.0f ? 255 : (int)(v * 255.0f); };
+    t *= 3.0f;
+    return IM_COL32(ramp(t), ramp(t - 1.0f), ramp(t - 2.0f), 255);
+}
+
+/* What each scanline's renderers cost, as a heatmap: one column per plane
+ * (its fill and sprites together) and one for the sprites drawn, a row per
+ * line, scaled to the frame's hottest cell. The profile runs while the
+ * window is open; a --vga-profile run has it on already and keeps it. */
+static void draw_vga_profile(void)
+{
+    static bool enabled_here;
+    if (!g_vga_profile_open)
+    {
+        if (enabled_here)
+            vga_set_profile(false);
+        enabled_here = false;
+        return;
+    }
+    if (!vga_profiling())
+    {
+        vga_set_profile(true);
+        enabled_here = true;
+    }
+    ImGui::SetNextWindowSize(ImVec2(300, 560), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("VGA Profile", &g_vga_profile_open))
+    {
+        int w, h;
+        vga_canvas_size(&w, &h);
+        const vga_line_cost_t *lines = vga_profile_lines();
+        uint32_t max_ns = 1, max_sprites = 1, worst_ns = 0;
+        int worst = 0;
+        uint64_t frame_ns = 0;
+        for (int y = 0; y < h; y++)
+        {
+            uint32_t line_ns = 0, sprites = 0;
+            for (int i = 0; i < VGA_PLANE_COUNT; i++)
+            {
+                const uint32_t ns = lines[y].fill_ns[i] + lines[y].sprite_ns[i];
+                line_ns += ns;
+                sprites += lines[y].sprites[i];
+                if (ns > max_ns)
+                    max_ns = ns;
+            }
+            if (sprites > max_sprites)
+                max_sprites = sprites;
+            if (line_ns > worst_ns)
+            {
+                worst_ns = line_ns;
+                worst = y;
+            }
+            frame_ns += line_ns;
+        }
+        ImGui::Text("frame %.1f us, worst line %d at %.2f us",
+                    frame_ns / 1000.0, worst, worst_ns / 1000.0);
+        ImGui::TextUnformatted("plane 0   plane 1   plane 2   sprites");
+
+        const int cols = VGA_PLANE_COUNT + 1;
+        const float col_w = ImGui::CalcTextSize("plane 0 ").x;
+        const float gap = ImGui::GetStyle().ItemSpacing.x;
+        const float avail = ImGui::GetContentRegionAvail().y;
+        const float row_h = (avail > (float)h ? avail : (float)h) / (float)h;
+        const ImVec2 org = ImGui::GetCursorScreenPos();
+        ImDrawList *dl = ImGui::GetWindowDrawList();
+        for (int y = 0; y < h; y++)
+        {
+            const float y0 = org.y + y * row_h, y1 = y0 + row_h;
+            uint32_t sprites = 0;
+            for (int c = 0; c < cols; c++)
+            {
+                float t;
+                if (c < VGA_PLANE_COUNT)
+                {
+                    t = (float)(lines[y].fill_ns[c] + lines[y].sprite_ns[c]) / max_ns;
+                    sprites += lines[y].sprites[c];
+                }
+                else
+                    t = (float)sprites / max_sprites;
+                const float x0 = org.x + c * (col_w + gap);
+                dl->AddRectFilled(ImVec2(x0, y0), ImVec2(x0 + col_w, y1), heat_color(t));
+            }
+        }
+        ImGui::InvisibleButton("heatmap", ImVec2(cols * (col_w + gap), row_h * h));
+        if (ImGui::IsItemHovered())
+        {
+            int y = (int)((ImGui::GetMousePos().y - org.y) / row_h);
+            y = y < 0 ? 0 : y >= h ? h - 1 : y;
+            ImGui::BeginTooltip();
+            ImGui::Text("line %d", y);
+            for (int i = 0; i < VGA_PLANE_COUNT; i++)
+                ImGui::Text("plane %d: fill %u ns, sprites %u ns (%u drawn)", i,
+                            (unsigned)lines[y].fill_ns[i], (unsigned)lines[y].sprite_ns[i],
+                            (unsigned)lines[y].sprites[i]);
+            ImGui::EndTooltip();
+        }
+    }
+    ImGui::End();
+}
+
+/* What each scanline would cost the VGA's RP2350, as a bar per line against
+ * what one core has for it (the line mark), red when the line would be
+ * late, and the worst late lines. The budget runs while the window is open;
+ * a --vga-budget run has it on already and keeps it. */
+static void draw_vga_budget(void)
+{
+    static bool enabled_here;
+    if (!g_vga_budget_open)
+    {
+        if (enabled_here)
+            vga_set_budget(0);
+        enabled_here = false;
+        return;
+    }
+    if (!vga_budget())
+    {
+        vga_set_budget(VGA_BUDGET_ON);
+        enabled_here = true;
+    }
+    ImGui::SetNextWindowSize(ImVec2(300, 560), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("VGA Budget", &g_vga_budget_open))
+    {
+        int w, h;
+        vga_canvas_size(&w, &h);
+        const vga_line_budget_t *lines = vga_budget_lines();
+        const uint32_t line_cycles = vga_budget_line_cycles();
+        enum { WORST = 8 };
+        int16_t worst[WORST];
+        const int late = vga_budget_late(worst, WORST);
+        ImGui::Text("%d of %d lines late; a core has %u cycles a line", late, h,
+                    (unsigned)line_cycles);
+        bool show = (vga_budget() & VGA_BUDGET_SHOW) != 0;
+        if (ImGui::Checkbox("Show late lines blue", &show))
+            vga_set_budget((vga_budget() & ~VGA_BUDGET_SHOW) | (show ? VGA_BUDGET_SHOW : 0));
+        for (int i = 0; i < late && i < WORST; i++)
+            ImGui::Text("line %d: %ld cycles late, costs %u", worst[i],
+                        -(long)lines[worst[i]].slack, (unsigned)lines[worst[i]].cycles);
+
+        /* Bars run to two lines' worth, the mark at one. */
+        const float bar_w = ImGui::GetContentRegionAvail().x;
+        const float avail = ImGui::GetContentRegionAvail().y;
+        const float row_h = (avail > (float)h ? avail : (float)h) / (float)h;
+        const ImVec2 org = ImGui::GetCursorScreenPos();
+        ImDrawList *dl = ImGui::GetWindowDrawList();
+        for (int y = 0; y < h; y++)
+        {
+            const float y0 = org.y + y * row_h, y1 = y0 + row_h;
+            float t = (float)lines[y].cycles / (2.0f * line_cycles);
+            t = t > 1.0f ? 1.0f : t;
+            const ImU32 color = lines[y].slack < 0 ? IM_COL32(255, 64, 64, 255)
+                                                   : IM_COL32(64, 192, 64, 255);
+            dl->AddRectFilled(ImVec2(org.x, y0), ImVec2(org.x + t * bar_w, y1), color);
+        }
+        dl->AddLine(ImVec2(org.x + bar_w / 2, org.y), ImVec2(org.x + bar_w / 2, org.y + row_h * h),
+                    IM_COL32(255, 255, 255, 128));
+        ImGui::InvisibleButton("bars", ImVec2(bar_w > 1.0f ? bar_w : 1.0f, row_h * h));
+        if (ImGui::IsItemHovered())
+        {
+            int y = (int)((ImGui::GetMousePos().y - org.y) / row_h);
+            y = y < 0 ? 0 : y >= h ? h - 1 : y;
+            ImGui::BeginTooltip();
+            ImGui::Text("line %d: %u cycles", y, (unsigned)lines[y].cycles);
+            if (lines[y].slack < 0)
+                ImGui::Text("%ld cycles late", -(long)lines[y].slack);
+            else
+                ImGui::Text("ready %ld cycles early", (long)lines[y].slack);
+            ImGui::EndTooltip();
+        }
+    }
+    ImGui::End();
+}
+
 /* Pin diagrams for the chip windows. ui_chip requires a named desc with pins. */
 static const ui_chip_pin_t pins_6502[] = {
     {"D0", 0, W65C02_D0},
@@ -462,6 +652,8 @@ static void dbgui_collect_settings(void)
     ui_settings_add(&g_settings, "Debug Control", g_control_open);
     ui_settings_add(&g_settings, "Credits", g_credits_open);
     ui_settings_add(&g_settings, "ROM Help", g_rom_help_open);
+    ui_settings_add(&g_settings, "VGA Profile", g_vga_profile_open);
+    ui_settings_add(&g_settings, "VGA Budget", g_vga_budget_open);
 }
 
 /* A bit signature of every window's open flag, for cheap per-frame change
@@ -504,6 +696,8 @@ static void chips_ini_applyall(ImGuiContext *, ImGuiSettingsHandler *)
     g_control_open = ui_settings_isopen(&g_settings, "Debug Control");
     g_credits_open = ui_settings_isopen(&g_settings, "Credits");
     g_rom_help_open = ui_settings_isopen(&g_settings, "ROM Help");
+    g_vga_profile_open = ui_settings_isopen(&g_settings, "VGA Profile");
+    g_vga_budget_open = ui_settings_isopen(&g_settings, "VGA Budget");
 }
 static void chips_ini_writeall(ImGuiContext *, ImGuiSettingsHandler *handler, ImGuiTextBuffer *buf)
 {
@@ -644,6 +838,9 @@ static void dbgui_draw_menu(void)
             ImGui::MenuItem("Memory", nullptr, &g_memedit.open);
             ImGui::MenuItem("Memory Heatmap", nullptr, &g_dbg.ui.heatmap.open);
             ImGui::MenuItem("Memory Segments", nullptr, &g_memmap.open);
+            ImGui::Separator();
+            ImGui::MenuItem("VGA Profile", nullptr, &g_vga_profile_open);
+            ImGui::MenuItem("VGA Budget", nullptr, &g_vga_budget_open);
             ImGui::EndMenu();
         }
         /* Our own Options (replaces vendor ui_util_options_menu, whose trailing
@@ -702,11 +899,20 @@ static void dbgui_draw_menu(void)
         }
         /* Host frame time + emulated VGA rate, right-aligned (e.g. "2.1 ms  59.9 FPS")
          * and held a few pixels off the window edge. The ms is ImGui's rolling host
-         * frame average; the FPS is the emulation keeping pace at ~60. */
+         * frame average; the FPS is the emulation keeping pace at ~60. In turbo it
+         * is how far past 60 the host gets, with the 6502 clock that makes. */
         float host_rate = ImGui::GetIO().Framerate;
-        char stats[24];
-        std::snprintf(stats, sizeof stats, "%.1f ms  %.1f FPS",
-                      host_rate > 0.0f ? 1000.0f / host_rate : 0.0f, dbgui_vga_fps());
+        char stats[48];
+        if (window_turbo())
+        {
+            double fps, mhz;
+            window_speed(&fps, &mhz);
+            std::snprintf(stats, sizeof stats, "%.1f ms  turbo %.0f FPS  %.1f MHz",
+                          host_rate > 0.0f ? 1000.0f / host_rate : 0.0f, fps, mhz);
+        }
+        else
+            std::snprintf(stats, sizeof stats, "%.1f ms  %.1f FPS",
+                          host_rate > 0.0f ? 1000.0f / host_rate : 0.0f, dbgui_vga_fps());
         float pad = ImGui::GetStyle().ItemSpacing.x + ImGui::GetFontSize() * 0.5f;
         ImGui::SameLine(ImGui::GetWindowWidth() - ImGui::CalcTextSize(stats).x - pad);
         ImGui::TextUnformatted(stats);
@@ -1088,6 +1294,8 @@ void dbgui_draw(void)
     draw_control();
     draw_credits();
     draw_rom_help();
+    draw_vga_profile();
+    draw_vga_budget();
     ui_ria_draw(&g_ria);
 
     /* dbg.c is the authoritative run/stop engine + EXEC breakpoint store (shared
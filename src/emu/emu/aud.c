@@ -7,6 +7,8 @@
 
 #include "emu/emu/aud.h"
 #include "emu/sys/mem.h"
+#include "emu/sys/sst.h"
+#include "emu/sys/sys.h"
 #include "emu/sys/vga.h"
 #include "emu/emu/rsmp.h"
 #include "ria/aud/bel.h"
@@ -17,8 +19,11 @@
 
 int16_t aud_sine_table[256];
 
-/* The active device's sample handler + rate, installed by aud_setup. */
+/* The active device's sample handler, its block renderer and its rate,
+ * installed by aud_setup. Only the renderer runs here; the handler is what
+ * identifies the device, as it does on the RP2350. */
 static void (*aud_irq_fn)(void);
+static void (*aud_render_fn)(int16_t *l, int16_t *r, unsigned n);
 static uint32_t aud_irq_rate;
 
 /* What the machine generates at. The default is what we ask the host for;
@@ -51,19 +56,14 @@ void aud_set_native_rate(uint32_t rate)
     aud_stop();
 }
 
-void aud_setup(void (*irq_fn)(void), uint32_t rate)
-{
-    aud_irq_fn = irq_fn;
-    aud_irq_rate = rate;
-}
-
 /* ------------------------------------------------------------------ */
 /* Stereo output capture: the seam the audio drivers write through.    */
 /* ------------------------------------------------------------------ */
 
-/* The last stereo level the active handler wrote, signed with silence at
- * zero; aud_task reads it back each sample and scales it to the float the
- * host wants. Nothing here knows the RP2350's PWM depth any more. */
+/* The last stereo level the active device made, signed with silence at
+ * zero. The renderers hand theirs back in blocks and aud_generate keeps the
+ * last; a handler run by itself writes it here. Nothing here knows the
+ * RP2350's PWM depth any more. */
 static int16_t g_out_l, g_out_r;
 
 void aud_out(int16_t left, int16_t right)
@@ -94,6 +94,15 @@ static int g_viz_pos;
  * stays pitch-accurate: each frame is owed rate/60 samples on average. */
 static uint32_t g_sample_acc;
 
+/* Where this frame's samples fall on the system clock. The firmware's
+ * interrupt runs once a sample and sees every write made before it, so a
+ * write to the device's page first catches the synth up to its own sample
+ * (aud_sync) and aud_task finishes the frame. Sample i of the n a frame is
+ * owed falls at i/n of the way through it. */
+#define AUD_FRAME_TICKS ((uint64_t)SYS_TICKS_PER_US * 1000000 / VGA_HZ)
+static uint64_t g_frame_clk; /* sys clock the frame started at */
+static unsigned g_frame_done; /* samples of it already generated */
+
 static void ring_push(float l, float r)
 {
     unsigned next = (g_head + 1) % AUD_RING_FRAMES;
@@ -114,27 +123,157 @@ static bool g_enabled = true;
 void aud_set_enabled(bool on) { g_enabled = on; }
 bool aud_enabled(void) { return g_enabled; }
 
-void aud_task(void)
+/* Whatever listens to the machine's own output: a --wav recording, a script's
+ * audio checks. Each sees every block as it is rendered, at the rate it was
+ * rendered at, before the ring or the host's converter can drop or filter any
+ * of it — so what they hear depends on the frames run and nothing else. */
+#define AUD_TAPS 4
+static aud_tap_fn g_taps[AUD_TAPS];
+
+bool aud_add_tap(aud_tap_fn tap)
 {
-    if (!g_enabled)
-        return;
+    aud_remove_tap(tap);
+    for (int i = 0; i < AUD_TAPS; i++)
+        if (!g_taps[i])
+        {
+            g_taps[i] = tap;
+            return true;
+        }
+    return false;
+}
+
+void aud_remove_tap(aud_tap_fn tap)
+{
+    for (int i = 0; i < AUD_TAPS; i++)
+        if (g_taps[i] == tap)
+            g_taps[i] = NULL;
+}
+
+/* The most one render call makes. A frame is 800 samples at 48 kHz, so a
+ * frame with no writes in it is a handful of calls. */
+#define AUD_RENDER_BLOCK 256
+
+static void aud_generate(unsigned n)
+{
+    /* The active device: PSG, OPL, or the standing BEL (silent until rung),
+     * always installed like the firmware. */
+    int16_t l[AUD_RENDER_BLOCK], r[AUD_RENDER_BLOCK];
+    while (g_frame_done < n)
+    {
+        unsigned len = n - g_frame_done;
+        if (len > AUD_RENDER_BLOCK)
+            len = AUD_RENDER_BLOCK;
+        aud_render_fn(l, r, len);
+        for (unsigned i = 0; i < len; i++)
+            ring_push(l[i] / 32768.0f, r[i] / 32768.0f);
+        for (int t = 0; t < AUD_TAPS; t++)
+            if (g_taps[t])
+                g_taps[t](l, r, len, aud_irq_rate);
+        g_out_l = l[len - 1];
+        g_out_r = r[len - 1];
+        g_frame_done += len;
+    }
+}
+
+/* The samples of the frame at rate whose time is at or before clk, of what
+ * aud_task will owe it unless the device changes first. */
+static unsigned aud_due(uint64_t clk, uint32_t rate)
+{
+    const unsigned n = (g_sample_acc + rate) / VGA_HZ;
+    const uint64_t into = clk - g_frame_clk;
+    const unsigned due = into < AUD_FRAME_TICKS ? (unsigned)(into * n / AUD_FRAME_TICKS) + 1 : n;
+    return due < n ? due : n;
+}
 
-    /* The active device handler: PSG, OPL, or the standing BEL (silent until
-     * rung), always installed like the firmware. */
-    void (*handler)(void) = aud_irq_fn;
-    if (!handler)
+void aud_sync(uint64_t clk)
+{
+    if (!g_enabled || !aud_render_fn || clk < g_frame_clk)
         return;
-    uint32_t rate = aud_irq_rate;
+    aud_generate(aud_due(clk, aud_irq_rate));
+}
+
+void aud_setup(void (*irq_fn)(void),
+               void (*render_fn)(int16_t *l, int16_t *r, unsigned n),
+               uint32_t rate)
+{
+    /* The outgoing device sounds up to the write that replaced it, and the
+     * incoming one takes the frame from there, counted in its own samples. */
+    const uint64_t clk = sys_clk_cycle();
+    aud_sync(clk);
+    if (g_frame_done && rate != aud_irq_rate)
+        g_frame_done = aud_due(clk, rate);
+    aud_irq_fn = irq_fn;
+    aud_render_fn = render_fn;
+    aud_irq_rate = rate;
+}
 
-    g_sample_acc += rate;
-    unsigned n = g_sample_acc / VGA_HZ;
-    g_sample_acc -= n * VGA_HZ;
+void aud_task(void)
+{
+    if (g_enabled && aud_render_fn)
+    {
+        g_sample_acc += aud_irq_rate;
+        unsigned n = g_sample_acc / VGA_HZ;
+        g_sample_acc -= n * VGA_HZ;
+        aud_generate(n);
+    }
+    g_frame_done = 0;
+    g_frame_clk = sys_clk_now();
+}
 
-    for (unsigned i = 0; i < n; i++)
+/* Savestates (sys/sst.h): which device is installed, at what rate, and where
+ * it is in its frame. The handler and renderer are code addresses, so they
+ * travel packed.
+ * A device installed at the native rate (the PSG, the standing bell) comes
+ * back at this session's native rate, which a window's sound card may have
+ * moved; the OPL2's rate is its own and comes back as it was. The host ring
+ * is the host's and is left alone. */
+typedef struct
+{
+    uint64_t irq_fn;
+    uint64_t render_fn;
+    uint32_t irq_rate;
+    uint32_t native_rate;
+    uint32_t sample_acc;
+    uint32_t frame_done;
+    uint64_t frame_clk;
+    int16_t out_l, out_r;
+} aud_state_t;
+
+size_t aud_state_save(void *buf)
+{
+    if (buf)
     {
-        handler(); /* advances the synth + writes g_out_l/g_out_r via aud_out */
-        ring_push(g_out_l / 32768.0f, g_out_r / 32768.0f);
+        aud_state_t s;
+        memset(&s, 0, sizeof s);
+        s.irq_fn = sst_fn_pack(aud_irq_fn);
+        s.render_fn = sst_fn_pack((void (*)(void))aud_render_fn);
+        s.irq_rate = aud_irq_rate;
+        s.native_rate = g_native_rate;
+        s.sample_acc = g_sample_acc;
+        s.frame_done = g_frame_done;
+        s.frame_clk = g_frame_clk;
+        s.out_l = g_out_l;
+        s.out_r = g_out_r;
+        memcpy(buf, &s, sizeof s);
     }
+    return sizeof(aud_state_t);
+}
+
+bool aud_state_load(const void *buf, size_t len)
+{
+    aud_state_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    aud_irq_fn = sst_fn_unpack(s.irq_fn);
+    aud_render_fn = (void (*)(int16_t *, int16_t *, unsigned))sst_fn_unpack(s.render_fn);
+    aud_irq_rate = s.irq_rate == s.native_rate ? g_native_rate : s.irq_rate;
+    g_sample_acc = s.sample_acc;
+    g_frame_done = s.frame_done;
+    g_frame_clk = s.frame_clk;
+    g_out_l = s.out_l;
+    g_out_r = s.out_r;
+    return true;
 }
 
 int aud_rate(void)
@@ -157,10 +296,10 @@ int aud_read(float *dst, int max_frames)
     return got;
 }
 
-/* One resampler per channel, carried across frames so the phase is
- * continuous. Only the OPL2 ever reaches these: everything else is generated
- * at aud_native_rate(), which is the device's own rate. */
-static rsmp_t g_rs_l, g_rs_r;
+/* The resampler, both channels in one pass, carried across frames so the
+ * phase is continuous. Only the OPL2 ever reaches it: everything else is
+ * generated at aud_native_rate(), which is the device's own rate. */
+static rsmp_stereo_t g_rs;
 
 /* The ring is float only because that is what the host wants; every value in
  * it is an exact int16 over 32768, so this round trip loses nothing. */
@@ -194,9 +333,13 @@ static void push_all(const float *f, int n,
     }
 }
 
+static double g_speed = 1.0;
+
+void aud_set_speed(double speed) { g_speed = speed; }
+
 void aud_pump(int out_rate, int (*push)(const float *frames, int num_frames))
 {
-    const int in_rate = aud_rate();
+    int in_rate = aud_rate();
     if (in_rate <= 0 || out_rate <= 0)
         return;
 
@@ -204,6 +347,17 @@ void aud_pump(int out_rate, int (*push)(const float *frames, int num_frames))
     static float out[4096 * 2];
     int navail;
 
+    if (g_speed > AUD_STRETCH_MAX)
+    {
+        while (aud_read(in, 4096) > 0)
+            ;
+        return;
+    }
+    /* Faster than real time, the samples are played as if made that much
+     * faster, so a second of output still takes a second. */
+    if (g_speed > 1.0)
+        in_rate = (int)lround(in_rate * g_speed);
+
     /* The usual case, and not merely an optimisation: a resampler run at
      * unity still rounds, and a voice generated at the device's own rate has
      * nothing to gain from being filtered. */
@@ -220,13 +374,13 @@ void aud_pump(int out_rate, int (*push)(const float *frames, int num_frames))
         int oc = 0;
         for (int i = 0; i < navail; i++)
         {
-            int32_t bl[8], br[8];
-            const int n = rsmp_push(&g_rs_l, to_i(in[i * 2 + 0]), step, bl, 8);
-            rsmp_push(&g_rs_r, to_i(in[i * 2 + 1]), step, br, 8);
+            int32_t b[8 * 2];
+            const int n = rsmp_stereo_push(&g_rs, to_i(in[i * 2 + 0]), to_i(in[i * 2 + 1]),
+                                           step, b, 8);
             for (int k = 0; k < n; k++)
             {
-                out[oc * 2 + 0] = to_f(bl[k]);
-                out[oc * 2 + 1] = to_f(br[k]);
+                out[oc * 2 + 0] = to_f(b[k * 2 + 0]);
+                out[oc * 2 + 1] = to_f(b[k * 2 + 1]);
                 if (++oc == 4096)
                 {
                     push_all(out, oc, push);
@@ -255,6 +409,7 @@ void aud_stop(void)
      * rings through (CLAUDE.md); only this host-side ring is cleared. */
     g_head = g_tail = 0;
     g_sample_acc = 0;
+    g_frame_done = 0;
     xram_queue_head = xram_queue_tail = 0;
     xram_queue_page = 0;
     g_out_l = g_out_r = 0;
@@ -262,6 +417,5 @@ void aud_stop(void)
     g_viz_pos = 0;
     /* The resampler's phase and history outlived a program stop and put a
      * discontinuity at the start of the next one. */
-    rsmp_reset(&g_rs_l);
-    rsmp_reset(&g_rs_r);
+    rsmp_stereo_reset(&g_rs);
 }
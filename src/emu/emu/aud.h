@@ -9,13 +9,19 @@
 #define _EMU_AUD_AUD_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "ria/aud/aud.h"
 
 /* Main events
  */
 
-void aud_task(void); /* generate this frame's samples from the active device */
+void aud_task(void); /* generate the rest of this frame's samples */
+
+/* Generate the samples due by system clock clk (sys/sys.h), so a write about
+ * to land on the device's page is heard from its own sample on, as the
+ * firmware's per-sample interrupt hears it, rather than from the next frame. */
+void aud_sync(uint64_t clk);
 
 /* --mute: disable audio entirely — the synth stops running (no per-frame
  * CPU work) and the window app opens no OS audio device. Default enabled. */
@@ -43,8 +49,29 @@ int aud_read(float *dst, int max_frames);
  * any host audio backend. */
 void aud_pump(int out_rate, int (*push)(const float *frames, int num_frames));
 
+/* How many times real time the machine is running (the window's turbo); 1
+ * normally. aud_pump squeezes what a faster machine makes back into real
+ * time through the resampler, which raises the pitch, up to AUD_STRETCH_MAX
+ * times; beyond that the audio is only noise and it drops it. */
+#define AUD_STRETCH_MAX 4.0
+void aud_set_speed(double speed);
+
+/* Tap the native-rate stream: every block the active device renders, as it
+ * goes into the ring, with the rate it was rendered at (the OPL2's is its own,
+ * so a run that switches devices can change it). Nothing is tapped while
+ * muted, because nothing is rendered. Up to a few at once; adding one twice
+ * keeps one. False if there is no room. */
+typedef void (*aud_tap_fn)(const int16_t *l, const int16_t *r, unsigned n, uint32_t rate);
+bool aud_add_tap(aud_tap_fn tap);
+void aud_remove_tap(aud_tap_fn tap);
+
 /* Rolling mono downmix of the produced output, for waveform display. */
 const float *aud_viz_buffer(int *num_samples);
 int aud_viz_pos(void); /* current write position in that buffer */
 
+/* Savestate section (sys/sst.h): the installed device and its sample clock.
+ * The devices' own state is in their sections. */
+size_t aud_state_save(void *buf);
+bool aud_state_load(const void *buf, size_t len);
+
 #endif /* _EMU_AUD_AUD_H_ */
@@ -33,6 +33,8 @@ static char exec_path[MSC_MAX_PATH];
 void pro_init(void)
 {
     exec_pending = false;
+    pro_launcher_path[0] = '\0';
+    pro_exit_code = 0;
 }
 
 void pro_exec(const char *rom_path)
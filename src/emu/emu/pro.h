@@ -16,7 +16,7 @@ bool pro_api_exec(void); /* op 0x09: replace the program */
 /* Seed the initial program's argv: its own path + args. False on overflow. */
 bool pro_set_argv(const char *rom, int argc, char *const *args);
 void pro_run(void); /* snapshot argv[0] of the starting program */
-void pro_init(void); /* clear any pending exec (cold boot) */
+void pro_init(void); /* clear any pending exec, the launcher and the exit code (cold boot) */
 
 /* Request an exec: load rom_path (a host/drive path or overlay ROM name) as the
  * new program at the next frame boundary. Stops the current program; the frame
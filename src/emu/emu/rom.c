@@ -499,6 +499,8 @@ bool rom_load(const char *path)
         bool guard = addr < 0x10000 && addr < 0xFFFA && addr + len > 0xFF00;
         if (guard)
             memcpy(guard_save, &ram[0xFF00], sizeof guard_save);
+        if (addr > 0xFFFF)
+            mem_xram_touch(addr - 0x10000, len);
         if (fread(dst, 1, len, f) != len)
         {
             fprintf(stderr, "rp6502-emu: truncated data record at $%X\n", addr);
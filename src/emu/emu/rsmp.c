@@ -5,6 +5,22 @@
  */
 
 #include "emu/emu/rsmp.h"
+#include "host/simd.h"
+
+/* SSE4.1 and AVX2 are both chosen at run time; see host/simd.h. SSE4.1 is
+ * the floor: pmuldq is its signed 32x32->64 multiply, and SSE2 has only the
+ * unsigned one. */
+#if SIMD_X86
+#define RSMP_SSE41 1
+#define RSMP_AVX2 1
+#define RSMP_SSE41_FN SIMD_SSE41_FN
+#define RSMP_AVX2_FN SIMD_AVX2_FN
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define RSMP_NEON 1
+#include <arm_neon.h>
+#endif
 
 /* src/gen/rsmp_coef_gen.py designs and emits these; aud_rsmp.sv reads the
  * same numbers out of the package the same script writes. */
@@ -14,8 +30,18 @@ const int32_t rsmp_coef[RSMP_PHASES + 1][RSMP_TAPS] = {
 
 void rsmp_reset(rsmp_t *r)
 {
-    for (int i = 0; i < RSMP_TAPS; i++)
+    for (int i = 0; i < 2 * RSMP_TAPS; i++)
         r->hist[i] = 0;
+    r->head = 0;
+    r->phase = 0;
+    r->primed = false;
+}
+
+void rsmp_stereo_reset(rsmp_stereo_t *r)
+{
+    for (int i = 0; i < 2 * RSMP_TAPS; i++)
+        r->hist[i][0] = r->hist[i][1] = 0;
+    r->head = 0;
     r->phase = 0;
     r->primed = false;
 }
@@ -31,7 +57,8 @@ uint64_t rsmp_step(uint32_t in_rate, uint32_t out_rate)
  * with the row above — and a straight line between the results. That is the
  * same number as interpolating the coefficients and filtering once, because
  * both are linear, and it is the cheaper of the two in fabric: one MAC
- * engine run twice, one coefficient read per tap.
+ * engine run twice, one coefficient read per tap. In software the two passes
+ * are one loop, the dual-row MAC below.
  *
  * The fraction is taken to sixteen bits rather than the twenty-five that
  * are there. The difference of two accumulators reaches 2^38, and 2^38
@@ -39,16 +66,9 @@ uint64_t rsmp_step(uint32_t in_rate, uint32_t out_rate)
  * A sixteenth of a 128th of a sample is 1.2e-7 of an input sample; the
  * coefficients are quantised far more coarsely than that.
  */
-static int32_t rsmp_at(const int32_t *h, uint32_t mu)
+static int32_t rsmp_lerp(int64_t a, int64_t b, uint32_t mu)
 {
-    const unsigned p = mu >> 25;               /* 0 .. RSMP_PHASES-1 */
-    const int64_t f = (mu >> 9) & 0xFFFF;      /* Q16 between p and p+1 */
-    int64_t a = 0, b = 0;
-    for (int i = 0; i < RSMP_TAPS; i++)
-    {
-        a += (int64_t)rsmp_coef[p][i] * h[i];
-        b += (int64_t)rsmp_coef[p + 1][i] * h[i];
-    }
+    const int64_t f = (mu >> 9) & 0xFFFF; /* Q16 between p and p+1 */
     const int64_t v = a + (((b - a) * f) >> 16);
     /* Round, do not truncate. An arithmetic shift floors, and a floor on
      * every sample is a systematic half-LSB offset — which measures as a
@@ -56,29 +76,281 @@ static int32_t rsmp_at(const int32_t *h, uint32_t mu)
     return (int32_t)((v + (1 << (RSMP_Q - 1))) >> RSMP_Q);
 }
 
+/* ------------------------------------------------------------------ */
+/* Scalar: the reference                                               */
+/* ------------------------------------------------------------------ */
+
+static void rsmp_mac_scalar(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                            int64_t *a, int64_t *b)
+{
+    int64_t sa = 0, sb = 0;
+    for (int i = 0; i < RSMP_TAPS; i++)
+    {
+        sa += (int64_t)c0[i] * h[i];
+        sb += (int64_t)c1[i] * h[i];
+    }
+    *a = sa;
+    *b = sb;
+}
+
+static void rsmp_mac2_scalar(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                             int64_t *a, int64_t *b)
+{
+    int64_t al = 0, ar = 0, bl = 0, br = 0;
+    for (int i = 0; i < RSMP_TAPS; i++)
+    {
+        al += (int64_t)c0[i] * h[i * 2 + 0];
+        ar += (int64_t)c0[i] * h[i * 2 + 1];
+        bl += (int64_t)c1[i] * h[i * 2 + 0];
+        br += (int64_t)c1[i] * h[i * 2 + 1];
+    }
+    a[0] = al;
+    a[1] = ar;
+    b[0] = bl;
+    b[1] = br;
+}
+
+/* ------------------------------------------------------------------ */
+/* SSE4.1                                                              */
+/* ------------------------------------------------------------------ */
+
+/* The AVX2 variant at half the width: two taps to a register. */
+#if RSMP_SSE41
+
+static inline RSMP_SSE41_FN int64_t rsmp_sse41_sum(__m128i x)
+{
+    x = _mm_add_epi64(x, _mm_unpackhi_epi64(x, x));
+    int64_t v;
+    _mm_storel_epi64((__m128i *)&v, x);
+    return v;
+}
+
+static inline RSMP_SSE41_FN __m128i rsmp_sse41_widen(const int32_t *p)
+{
+    return _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i *)p));
+}
+
+static RSMP_SSE41_FN void rsmp_mac_sse41(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                                         int64_t *a, int64_t *b)
+{
+    __m128i sa = _mm_setzero_si128();
+    __m128i sb = _mm_setzero_si128();
+    for (int i = 0; i < RSMP_TAPS; i += 2)
+    {
+        const __m128i x = rsmp_sse41_widen(&h[i]);
+        sa = _mm_add_epi64(sa, _mm_mul_epi32(x, rsmp_sse41_widen(&c0[i])));
+        sb = _mm_add_epi64(sb, _mm_mul_epi32(x, rsmp_sse41_widen(&c1[i])));
+    }
+    *a = rsmp_sse41_sum(sa);
+    *b = rsmp_sse41_sum(sb);
+}
+
+static RSMP_SSE41_FN void rsmp_mac2_sse41(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                                          int64_t *a, int64_t *b)
+{
+    __m128i al = _mm_setzero_si128(), ar = al, bl = al, br = al;
+    for (int i = 0; i < RSMP_TAPS; i += 2)
+    {
+        const __m128i l = _mm_loadu_si128((const __m128i *)&h[i * 2]);
+        const __m128i r = _mm_srli_epi64(l, 32);
+        const __m128i k0 = rsmp_sse41_widen(&c0[i]);
+        const __m128i k1 = rsmp_sse41_widen(&c1[i]);
+        al = _mm_add_epi64(al, _mm_mul_epi32(l, k0));
+        ar = _mm_add_epi64(ar, _mm_mul_epi32(r, k0));
+        bl = _mm_add_epi64(bl, _mm_mul_epi32(l, k1));
+        br = _mm_add_epi64(br, _mm_mul_epi32(r, k1));
+    }
+    a[0] = rsmp_sse41_sum(al);
+    a[1] = rsmp_sse41_sum(ar);
+    b[0] = rsmp_sse41_sum(bl);
+    b[1] = rsmp_sse41_sum(br);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* AVX2                                                                */
+/* ------------------------------------------------------------------ */
+
+/* Four taps to a register, each widened to a 64-bit lane so the signed
+ * multiply takes its low half and keeps the whole product. */
+#if RSMP_AVX2
+
+static inline RSMP_AVX2_FN int64_t rsmp_avx2_sum(__m256i x)
+{
+    __m128i h = _mm_add_epi64(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    h = _mm_add_epi64(h, _mm_unpackhi_epi64(h, h));
+    int64_t v;
+    _mm_storel_epi64((__m128i *)&v, h);
+    return v;
+}
+
+static inline RSMP_AVX2_FN __m256i rsmp_avx2_widen(const int32_t *p)
+{
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+
+static RSMP_AVX2_FN void rsmp_mac_avx2(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                                       int64_t *a, int64_t *b)
+{
+    __m256i sa = _mm256_setzero_si256();
+    __m256i sb = _mm256_setzero_si256();
+    for (int i = 0; i < RSMP_TAPS; i += 4)
+    {
+        const __m256i x = rsmp_avx2_widen(&h[i]);
+        sa = _mm256_add_epi64(sa, _mm256_mul_epi32(x, rsmp_avx2_widen(&c0[i])));
+        sb = _mm256_add_epi64(sb, _mm256_mul_epi32(x, rsmp_avx2_widen(&c1[i])));
+    }
+    *a = rsmp_avx2_sum(sa);
+    *b = rsmp_avx2_sum(sb);
+}
+
+/* The frames need no widening: left is already the low half of each 64-bit
+ * lane, and right comes down to it with one shift. */
+static RSMP_AVX2_FN void rsmp_mac2_avx2(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                                        int64_t *a, int64_t *b)
+{
+    __m256i al = _mm256_setzero_si256(), ar = al, bl = al, br = al;
+    for (int i = 0; i < RSMP_TAPS; i += 4)
+    {
+        const __m256i l = _mm256_loadu_si256((const __m256i *)&h[i * 2]);
+        const __m256i r = _mm256_srli_epi64(l, 32);
+        const __m256i k0 = rsmp_avx2_widen(&c0[i]);
+        const __m256i k1 = rsmp_avx2_widen(&c1[i]);
+        al = _mm256_add_epi64(al, _mm256_mul_epi32(l, k0));
+        ar = _mm256_add_epi64(ar, _mm256_mul_epi32(r, k0));
+        bl = _mm256_add_epi64(bl, _mm256_mul_epi32(l, k1));
+        br = _mm256_add_epi64(br, _mm256_mul_epi32(r, k1));
+    }
+    a[0] = rsmp_avx2_sum(al);
+    a[1] = rsmp_avx2_sum(ar);
+    b[0] = rsmp_avx2_sum(bl);
+    b[1] = rsmp_avx2_sum(br);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* NEON                                                                */
+/* ------------------------------------------------------------------ */
+
+#if RSMP_NEON
+
+static inline int64_t rsmp_neon_sum(int64x2_t x)
+{
+    return vgetq_lane_s64(x, 0) + vgetq_lane_s64(x, 1);
+}
+
+static inline int64x2_t rsmp_neon_mac(int64x2_t acc, int32x4_t x, int32x4_t k)
+{
+    acc = vmlal_s32(acc, vget_low_s32(x), vget_low_s32(k));
+    return vmlal_s32(acc, vget_high_s32(x), vget_high_s32(k));
+}
+
+static void rsmp_mac_neon(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                          int64_t *a, int64_t *b)
+{
+    int64x2_t sa = vdupq_n_s64(0), sb = sa;
+    for (int i = 0; i < RSMP_TAPS; i += 4)
+    {
+        const int32x4_t x = vld1q_s32(&h[i]);
+        sa = rsmp_neon_mac(sa, x, vld1q_s32(&c0[i]));
+        sb = rsmp_neon_mac(sb, x, vld1q_s32(&c1[i]));
+    }
+    *a = rsmp_neon_sum(sa);
+    *b = rsmp_neon_sum(sb);
+}
+
+/* vld2 takes the frames apart on the way in. */
+static void rsmp_mac2_neon(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                           int64_t *a, int64_t *b)
+{
+    int64x2_t al = vdupq_n_s64(0), ar = al, bl = al, br = al;
+    for (int i = 0; i < RSMP_TAPS; i += 4)
+    {
+        const int32x4x2_t x = vld2q_s32(&h[i * 2]);
+        const int32x4_t k0 = vld1q_s32(&c0[i]);
+        const int32x4_t k1 = vld1q_s32(&c1[i]);
+        al = rsmp_neon_mac(al, x.val[0], k0);
+        ar = rsmp_neon_mac(ar, x.val[1], k0);
+        bl = rsmp_neon_mac(bl, x.val[0], k1);
+        br = rsmp_neon_mac(br, x.val[1], k1);
+    }
+    a[0] = rsmp_neon_sum(al);
+    a[1] = rsmp_neon_sum(ar);
+    b[0] = rsmp_neon_sum(bl);
+    b[1] = rsmp_neon_sum(br);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Selection                                                           */
+/* ------------------------------------------------------------------ */
+
+static rsmp_variant_t rsmp_table[4];
+static size_t rsmp_count;
+
+/* Widest last. Idempotent: a second caller racing the first writes the same
+ * table. */
+static void rsmp_select(void)
+{
+    size_t n = 0;
+    rsmp_table[n++] = (rsmp_variant_t){"scalar", rsmp_mac_scalar, rsmp_mac2_scalar};
+#if RSMP_SSE41
+    if (simd_cpu_sse41())
+        rsmp_table[n++] = (rsmp_variant_t){"sse4.1", rsmp_mac_sse41, rsmp_mac2_sse41};
+#endif
+#if RSMP_AVX2
+    if (simd_cpu_avx2())
+        rsmp_table[n++] = (rsmp_variant_t){"avx2", rsmp_mac_avx2, rsmp_mac2_avx2};
+#endif
+#if RSMP_NEON
+    rsmp_table[n++] = (rsmp_variant_t){"neon", rsmp_mac_neon, rsmp_mac2_neon};
+#endif
+    rsmp_count = n;
+}
+
+size_t rsmp_variants(const rsmp_variant_t **variants)
+{
+    if (!rsmp_count)
+        rsmp_select();
+    *variants = rsmp_table;
+    return rsmp_count;
+}
+
+/* ------------------------------------------------------------------ */
+/* Pushes                                                              */
+/* ------------------------------------------------------------------ */
+
 int rsmp_push(rsmp_t *r, int32_t x, uint64_t step, int32_t *out, int max_out)
 {
     /* A cold filter would ring against twenty-three zeros and put a click
      * at the start of every sound. Start it flat at the first sample. */
     if (!r->primed)
     {
-        for (int i = 0; i < RSMP_TAPS; i++)
+        for (int i = 0; i < 2 * RSMP_TAPS; i++)
             r->hist[i] = x;
         r->primed = true;
     }
     else
     {
-        for (int i = 0; i < RSMP_TAPS - 1; i++)
-            r->hist[i] = r->hist[i + 1];
-        r->hist[RSMP_TAPS - 1] = x;
+        /* The oldest goes, both copies, and the run moves up one. */
+        r->hist[r->head] = r->hist[r->head + RSMP_TAPS] = x;
+        r->head = r->head + 1 == RSMP_TAPS ? 0 : r->head + 1;
     }
 
+    if (!rsmp_count)
+        rsmp_select();
+    const rsmp_mac_fn_t mac = rsmp_table[rsmp_count - 1].mono;
+    const int32_t *h = &r->hist[r->head];
     int n = 0;
     while (r->phase < ((uint64_t)1 << 32))
     {
         if (n == max_out)
             break;
-        out[n++] = rsmp_at(r->hist, (uint32_t)r->phase);
+        const uint32_t mu = (uint32_t)r->phase;
+        const unsigned p = mu >> 25; /* 0 .. RSMP_PHASES-1 */
+        int64_t a, b;
+        mac(h, rsmp_coef[p], rsmp_coef[p + 1], &a, &b);
+        out[n++] = rsmp_lerp(a, b, mu);
         r->phase += step;
     }
     /* One input consumed, so the interval moves on by one whether or not it
@@ -87,3 +359,45 @@ int rsmp_push(rsmp_t *r, int32_t x, uint64_t step, int32_t *out, int max_out)
         r->phase -= (uint64_t)1 << 32;
     return n;
 }
+
+int rsmp_stereo_push(rsmp_stereo_t *r, int32_t left, int32_t right, uint64_t step,
+                     int32_t *out, int max_out)
+{
+    if (!r->primed)
+    {
+        for (int i = 0; i < 2 * RSMP_TAPS; i++)
+        {
+            r->hist[i][0] = left;
+            r->hist[i][1] = right;
+        }
+        r->primed = true;
+    }
+    else
+    {
+        r->hist[r->head][0] = r->hist[r->head + RSMP_TAPS][0] = left;
+        r->hist[r->head][1] = r->hist[r->head + RSMP_TAPS][1] = right;
+        r->head = r->head + 1 == RSMP_TAPS ? 0 : r->head + 1;
+    }
+
+    if (!rsmp_count)
+        rsmp_select();
+    const rsmp_mac_fn_t mac = rsmp_table[rsmp_count - 1].stereo;
+    const int32_t *h = r->hist[r->head];
+    int n = 0;
+    while (r->phase < ((uint64_t)1 << 32))
+    {
+        if (n == max_out)
+            break;
+        const uint32_t mu = (uint32_t)r->phase;
+        const unsigned p = mu >> 25;
+        int64_t a[2], b[2];
+        mac(h, rsmp_coef[p], rsmp_coef[p + 1], a, b);
+        out[n * 2 + 0] = rsmp_lerp(a[0], b[0], mu);
+        out[n * 2 + 1] = rsmp_lerp(a[1], b[1], mu);
+        n++;
+        r->phase += step;
+    }
+    if (r->phase >= ((uint64_t)1 << 32))
+        r->phase -= (uint64_t)1 << 32;
+    return n;
+}
@@ -8,6 +8,7 @@
 #define _EMU_EMU_RSMP_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* Arbitrary-ratio resampling, for the one voice whose rate is not ours to
@@ -40,6 +41,14 @@
  * never resamples — its OPL runs at 49716 into a PWM that will carry any
  * rate — so this is emulator and fabric code, and emu_core is the oracle the
  * RTL is held to in any case.
+ *
+ * The history is a ring written twice over, so the 24 taps are always one
+ * contiguous run and a push writes two words instead of moving 23. The
+ * multiply-accumulate comes in SSE4.1, AVX2 and NEON variants beside the
+ * scalar reference. They are integer, so they are the same sums in another order
+ * and held to the scalar one exactly (tests/aud/test_rsmp.c). There is a
+ * stereo form as well, left and right interleaved through one filter pass,
+ * which is what aud_pump uses.
  */
 
 #define RSMP_TAPS 24
@@ -48,10 +57,12 @@
 
 typedef struct
 {
-    /* x[n-23] .. x[n], newest last. The interpolation interval is between
-     * hist[11] and hist[12]; the samples either side are the context that
-     * lets it be a filter rather than a straight line. */
-    int32_t hist[RSMP_TAPS];
+    /* x[n-23] .. x[n], oldest first, at hist + head. Every sample is kept at
+     * i and i + RSMP_TAPS so that run never wraps. The interpolation
+     * interval is between its [11] and [12]; the samples either side are the
+     * context that lets it be a filter rather than a straight line. */
+    int32_t hist[2 * RSMP_TAPS];
+    unsigned head;
     /* Q32 position inside that interval. Wider than 32 bits because the
      * step exceeds 1.0 whenever the source outruns the sink, which is the
      * case this exists for. */
@@ -59,6 +70,15 @@ typedef struct
     bool primed;
 } rsmp_t;
 
+/* Two channels on one phase, a frame of left and right to each tap. */
+typedef struct
+{
+    int32_t hist[2 * RSMP_TAPS][2];
+    unsigned head;
+    uint64_t phase;
+    bool primed;
+} rsmp_stereo_t;
+
 /* Row p is the filter for a delay of p/RSMP_PHASES. There are PHASES+1 of
  * them: the last is the first shifted by one tap, so interpolating between
  * p and p+1 never has to special-case the wrap. */
@@ -74,4 +94,27 @@ uint64_t rsmp_step(uint32_t in_rate, uint32_t out_rate);
  * stretching. Returns the count written to out. */
 int rsmp_push(rsmp_t *r, int32_t x, uint64_t step, int32_t *out, int max_out);
 
+/* rsmp_push for both channels at once. out takes interleaved frames and the
+ * count is of frames; each channel's samples are what rsmp_push would give. */
+void rsmp_stereo_reset(rsmp_stereo_t *r);
+int rsmp_stereo_push(rsmp_stereo_t *r, int32_t left, int32_t right, uint64_t step,
+                     int32_t *out, int max_out);
+
+/* The filter's inner loop: the taps of h against rows c0 and c1, into a and
+ * b. mono takes RSMP_TAPS samples; stereo takes RSMP_TAPS frames and gives
+ * a[0], b[0] for left and a[1], b[1] for right. */
+typedef void (*rsmp_mac_fn_t)(const int32_t *h, const int32_t *c0, const int32_t *c1,
+                              int64_t *a, int64_t *b);
+
+/* Every variant this build has and this CPU can run, the scalar reference
+ * first and the one the pushes use last. */
+typedef struct
+{
+    const char *name;
+    rsmp_mac_fn_t mono;
+    rsmp_mac_fn_t stereo;
+} rsmp_variant_t;
+
+size_t rsmp_variants(const rsmp_variant_t **variants);
+
 #endif /* _EMU_EMU_RSMP_H_ */
@@ -8,6 +8,7 @@
 #define CHIPS_IMPL
 #include "chips/chips/m6522.h"
 #include "emu/emu/via.h"
+#include <string.h>
 
 static m6522_t via;
 
@@ -43,3 +44,38 @@ bool via_tick(uint16_t addr, bool read, uint8_t *data)
         *data = M6522_GET_DATA(pins);
     return (pins & M6522_IRQ) != 0;
 }
+
+/* While no interrupt is enabled the VIA's IRQ cannot rise, and nothing else it
+ * does reaches the 6502 except through its window — so sys.c may stop ticking it
+ * across a fast-path run and catch it up afterwards with via_idle. */
+bool via_quiet(void)
+{
+    return (via.intr.ier & 0x7F) == 0;
+}
+
+/* Cycles the VIA was not selected in. Deselected, it only counts: the register
+ * select, data and direction on its pins are ignored, and the ports read low on
+ * every cycle regardless. The next via_tick lays the real bus over the pins these
+ * leave behind. */
+void via_idle(uint32_t cycles)
+{
+    while (cycles--)
+        (void)m6522_tick(&via, M6522_RW);
+}
+
+/* Savestates: the m6522 is plain data. Its pins are rebuilt every cycle, so the
+ * chip is all there is. */
+size_t via_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, &via, sizeof via);
+    return sizeof via;
+}
+
+bool via_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof via)
+        return false;
+    memcpy(&via, buf, sizeof via);
+    return true;
+}
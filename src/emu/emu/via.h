@@ -9,6 +9,7 @@
 #define _EMU_SYS_VIA_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* 6502 memory map: 16 registers, A4-A15 decoded off-chip into CS1 (os.rst). */
@@ -22,7 +23,19 @@ void via_run(void);
  * the address is in the VIA's window. data is in/out. Returns the VIA's IRQ. */
 bool via_tick(uint16_t addr, bool read, uint8_t *data);
 
+/* True while the VIA has no interrupt enabled, so its IRQ stays low however its
+ * timers run. */
+bool via_quiet(void);
+
+/* Advance the timers through cycles in which the VIA was not selected, as that
+ * many via_tick calls off its window would. */
+void via_idle(uint32_t cycles);
+
 /* The live chip instance (m6522_t*), for the debugger UI + DAP register access. */
 void *via_chip(void);
 
+/* Savestate section (sys/sst.h). */
+size_t via_state_save(void *buf);
+bool via_state_load(const void *buf, size_t len);
+
 #endif /* _EMU_SYS_VIA_H_ */
@@ -66,6 +66,7 @@ static void tab_write_xram(void)
         return;
     memcpy(&xram[tab_xram + TAB_OFF_STATUS], &tab_block[TAB_OFF_STATUS],
            TAB_BLOCK_SIZE - TAB_OFF_STATUS);
+    mem_xram_touch(tab_xram + TAB_OFF_STATUS, TAB_BLOCK_SIZE - TAB_OFF_STATUS);
 }
 
 bool tab_set_xram(uint16_t addr)
@@ -78,7 +79,10 @@ bool tab_set_xram(uint16_t addr)
     for (int i = 0; i < TAB_MAX_CONTACTS; ++i)
         tab_clear_contact(i);
     if (tab_xram != 0xFFFF) /* one-time full write also seeds control=0 (ROM draws its own) */
+    {
         memcpy(&xram[tab_xram], tab_block, TAB_BLOCK_SIZE);
+        mem_xram_touch(tab_xram, TAB_BLOCK_SIZE);
+    }
     return true;
 }
 
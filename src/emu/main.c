@@ -23,6 +23,7 @@
 #include "emu/hid/pad.h"
 #include "emu/hid/tab.h"
 #include "emu/sys/ria.h"
+#include "emu/sys/rwd.h"
 #include "ria/api/api.h"
 #include "ria/api/atr.h"
 #include "ria/api/std.h"
@@ -44,6 +45,7 @@
 #include "vga/modes/mode3.h"
 #include "vga/modes/mode4.h"
 #include "vga/modes/mode5.h"
+#include "vga/modes/mode6.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -92,6 +94,7 @@ void main_stop(void)
     pad_stop();
     tab_stop();
     aud_stop();
+    rwd_stop(); /* rewind history belongs to the run */
 }
 
 /* ------------------------------------------------------------------ */
@@ -145,6 +148,7 @@ bool main_xreg_1(uint8_t channel, uint8_t address, uint16_t word)
             /* Mode select (xregs[1]); params at addresses 2.. were stored first
              * by the high->low dispatch. Mirrors vga main_prog, then clears the
              * registers so the next program starts fresh. */
+            vga_render_wait(); /* queued lines read the options a mode replaces */
             bool ok;
             switch (word)
             {
@@ -166,6 +170,9 @@ bool main_xreg_1(uint8_t channel, uint8_t address, uint16_t word)
             case 5:
                 ok = mode5_prog(xregs);
                 break;
+            case 6:
+                ok = mode6_prog(xregs);
+                break;
             default:
                 ok = false; /* all VGA modes modeled */
                 break;
@@ -199,6 +206,19 @@ bool main_xreg_1(uint8_t channel, uint8_t address, uint16_t word)
  * fat_api_* (ria/api/fat.c) when --tmpdrive mounts a RAM FatFs. The dir slots
  * default to host below; main_dir_ops_set() swaps them. */
 typedef bool (*api_op_fn)(void);
+
+/* read_xram fills XRAM straight from the driver and only then sends it over
+ * PIX, and the addresses live inside std.c. The VGA here reads xram[] itself,
+ * so while the op works its whole destination is as good as anywhere: call
+ * all of XRAM written, which costs a loading screen its dirty-line savings
+ * and nothing else. */
+static bool main_api_read_xram(void)
+{
+    bool done = std_api_read_xram();
+    mem_xram_touch(0, 0x10000);
+    return done;
+}
+
 static api_op_fn api_ops[0x40] = {
     [0x01] = pix_api_xreg,
     [0x02] = atr_api_phi2,
@@ -216,7 +236,7 @@ static api_op_fn api_ops[0x40] = {
     [0x14] = std_api_open,
     [0x15] = std_api_close,
     [0x16] = std_api_read_xstack,
-    [0x17] = std_api_read_xram,
+    [0x17] = main_api_read_xram,
     [0x18] = std_api_write_xstack,
     [0x19] = std_api_write_xram,
     [0x1A] = std_api_lseek_cc65,
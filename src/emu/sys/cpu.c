@@ -8,7 +8,9 @@
 #define CHIPS_IMPL
 #include "chips/chips/w65c02.h"
 #include "emu/sys/cpu.h"
+#include "emu/sys/mem.h"
 #include "ria/sys/sys.h"
+#include <string.h>
 
 static w65c02_t cpu;
 
@@ -111,6 +113,57 @@ void cpu_tick(uint16_t *addr, bool *read, uint8_t *data, bool irq)
     *data = W65C02_GET_DATA(pins);
 }
 
+/* The fast path's per-cycle observer (declared in cpu.h), for the lockstep
+ * suite. NULL in the emulator, and then cpu_exec runs the untraced loop. */
+void (*cpu_exec_trace)(uint16_t addr, uint8_t data, bool read, bool sync);
+
+/* The same core cpu_tick steps, with the board cut out of the cycles that only
+ * reach the SRAM: each is serviced here as mem_tick would service it, and the
+ * loop goes straight on. The cycle that leaves the SRAM's window, or the last one
+ * asked for, is handed back unserviced. traced is a constant at both call sites,
+ * so the observer costs the untraced loop nothing. */
+static inline uint32_t cpu_exec_loop(uint8_t *mem, uint32_t cycles, uint64_t *pp,
+                                     bool traced)
+{
+    uint64_t p = *pp;
+    uint32_t n = 0;
+    for (;;)
+    {
+        p = w65c02_tick(&cpu, p);
+        n++;
+        const uint16_t addr = W65C02_GET_ADDR(p);
+        if (n == cycles || addr > MEM_MMAP_HI)
+            break;
+        if (p & W65C02_RW)
+            W65C02_SET_DATA(p, mem[addr]);
+        else
+            mem[addr] = W65C02_GET_DATA(p);
+        if (traced)
+            cpu_exec_trace(addr, W65C02_GET_DATA(p), (p & W65C02_RW) != 0,
+                           (p & W65C02_SYNC) != 0);
+    }
+    *pp = p;
+    return n;
+}
+
+uint32_t cpu_exec(uint8_t *mem, uint32_t cycles, uint16_t *addr, bool *read,
+                  uint8_t *data, bool irq)
+{
+    if (irq)
+        pins |= W65C02_IRQ;
+    else
+        pins &= ~W65C02_IRQ;
+    W65C02_SET_DATA(pins, *data);
+
+    const uint32_t n = cpu_exec_trace ? cpu_exec_loop(mem, cycles, &pins, true)
+                                      : cpu_exec_loop(mem, cycles, &pins, false);
+
+    *addr = W65C02_GET_ADDR(pins);
+    *read = (pins & W65C02_RW) != 0;
+    *data = W65C02_GET_DATA(pins);
+    return n;
+}
+
 uint32_t cpu_cycle_ticks(void) { return cycle_ticks; }
 
 /* The raw pin mask, for the debugger's per-cycle observer only — its callback
@@ -125,3 +178,45 @@ bool cpu_opcode_fetch(uint16_t *pc, uint8_t *sp)
     *sp = w65c02_s(&cpu);
     return true;
 }
+
+/* Savestates (sys/sst.h). The w65c02 is plain data, so it goes as it is, with
+ * the pins it is between cycles on. PHI2 goes too: the config default does not,
+ * but the run clock is the program's to change (the phi2 attribute). */
+typedef struct
+{
+    w65c02_t cpu;
+    uint64_t pins;
+    uint16_t phi2_khz_run;
+    uint32_t cycle_ticks;
+    bool halted;
+} cpu_state_t;
+
+size_t cpu_state_save(void *buf)
+{
+    if (buf)
+    {
+        cpu_state_t s;
+        memset(&s, 0, sizeof s); /* no stray padding: equal machines, equal blobs */
+        memcpy(&s.cpu, &cpu, sizeof cpu);
+        s.pins = pins;
+        s.phi2_khz_run = phi2_khz_run;
+        s.cycle_ticks = cycle_ticks;
+        s.halted = halted;
+        memcpy(buf, &s, sizeof s);
+    }
+    return sizeof(cpu_state_t);
+}
+
+bool cpu_state_load(const void *buf, size_t len)
+{
+    cpu_state_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    memcpy(&cpu, &s.cpu, sizeof cpu);
+    pins = s.pins;
+    phi2_khz_run = s.phi2_khz_run;
+    cycle_ticks = s.cycle_ticks;
+    halted = s.halted;
+    return true;
+}
@@ -9,6 +9,7 @@
 #define _EMU_SYS_CPU_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* The firmware contract cpu.c implements: cpu_init, cpu_active,
@@ -29,6 +30,21 @@ void cpu_stop(void);
  * drives. The w65c02 pin mask stays inside cpu.c; the board speaks decoded signals. */
 void cpu_tick(uint16_t *addr, bool *read, uint8_t *data, bool irq);
 
+/* The fast path: up to cycles PHI2 cycles (at least one) with every access that
+ * stays in $0000-$FEFF serviced directly against mem, as mem_tick would, and no
+ * other device ticked. Returns how many cycles ran. The last of them is NOT
+ * serviced: it returns in addr/read/data exactly as cpu_tick returns its cycle,
+ * for the board to finish. The run stops there early when that cycle drives an
+ * address above MEM_MMAP_HI, so the VIA and the RIA only ever see their windows
+ * on the board's own path. irq is held for the whole run; the caller runs this
+ * only while nothing that could move the line is being skipped. */
+uint32_t cpu_exec(uint8_t *mem, uint32_t cycles, uint16_t *addr, bool *read,
+                  uint8_t *data, bool irq);
+
+/* Optional observer of each cycle cpu_exec services itself (not the one it
+ * hands back), for the lockstep suite. NULL in the emulator. */
+extern void (*cpu_exec_trace)(uint16_t addr, uint8_t data, bool read, bool sync);
+
 uint32_t cpu_cycle_ticks(void); /* system-clock ticks per 6502 cycle */
 
 /* True on an opcode fetch (SYNC); out-writes the fetch PC and SP. */
@@ -53,4 +69,9 @@ void *cpu_chip(void); /* w65c02_t* */
  * observer is registered. */
 extern void (*cpu_dbg_cycle_cb)(uint64_t pins);
 
+/* Savestate section (sys/sst.h): save returns the size and writes buf unless it
+ * is NULL; load refuses a blob of any other size. */
+size_t cpu_state_save(void *buf);
+bool cpu_state_load(const void *buf, size_t len);
+
 #endif /* _EMU_SYS_CPU_H_ */
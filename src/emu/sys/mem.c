@@ -13,6 +13,7 @@ uint8_t ram[0x10000];
 
 static uint8_t xram_mem[0x10000];
 uint8_t *const xram = xram_mem;
+_Thread_local volatile uint8_t *modes_xram = xram_mem;
 
 alignas(4) volatile uint8_t regs[0x20];
 
@@ -24,6 +25,12 @@ volatile uint8_t xram_queue_head;
 volatile uint8_t xram_queue_tail;
 volatile uint8_t xram_queue[256][2];
 
+/* From 1, so a scanline's "drawn at 0" always reads as never drawn. */
+uint64_t mem_xram_writes = 1;
+uint64_t mem_xram_page_written[0x10000 >> MEM_XRAM_PAGE_SHIFT];
+_Thread_local const volatile uint64_t *modes_xram_stamp = &mem_xram_writes;
+_Thread_local const uint64_t *modes_xram_pages = mem_xram_page_written;
+
 /* mem_fill writes whole words, so both are a multiple of one. */
 static_assert(!(sizeof(ram) % sizeof(uint64_t)));
 static_assert(!(sizeof(xram_mem) % sizeof(uint64_t)));
@@ -58,6 +65,7 @@ static void mem_fill(uint8_t *dst, size_t len, uint64_t *state)
 
 void mem_init(void)
 {
+    mem_xram_touch(0, sizeof xram_mem);
     if (!mem_fill_random)
     {
         memset(ram, mem_fill_value, sizeof ram);
@@ -69,6 +77,44 @@ void mem_init(void)
     mem_fill(xram_mem, sizeof xram_mem, &state);
 }
 
+void mem_xram_touch(uint32_t addr, uint32_t len)
+{
+    if (addr >= sizeof xram_mem || !len)
+        return;
+    uint32_t end = len > sizeof xram_mem - addr ? (uint32_t)sizeof xram_mem : addr + len;
+    const uint64_t now = ++mem_xram_writes;
+    for (uint32_t page = addr >> MEM_XRAM_PAGE_SHIFT;
+         page <= (end - 1) >> MEM_XRAM_PAGE_SHIFT; page++)
+        mem_xram_page_written[page] = now;
+}
+
+static bool mem_written_since(uint64_t writes, const uint64_t *pages,
+                              uint32_t begin, uint32_t end, uint64_t since)
+{
+    if (writes <= since)
+        return false; /* nothing at all: the common case on a still screen */
+    if (end > sizeof xram_mem)
+        end = sizeof xram_mem;
+    if (begin >= end)
+        return false;
+    for (uint32_t page = begin >> MEM_XRAM_PAGE_SHIFT;
+         page <= (end - 1) >> MEM_XRAM_PAGE_SHIFT; page++)
+        if (pages[page] > since)
+            return true;
+    return false;
+}
+
+bool mem_xram_written_since(uint32_t begin, uint32_t end, uint64_t since)
+{
+    return mem_written_since(mem_xram_writes, mem_xram_page_written, begin, end, since);
+}
+
+/* The same, of the XRAM this thread's renderers see. */
+bool modes_xram_written_since(uint32_t begin, uint32_t end, uint64_t since)
+{
+    return mem_written_since(*modes_xram_stamp, modes_xram_pages, begin, end, since);
+}
+
 /* The SRAM's bus cycle. Every write lands — ram[] shadows the whole space, which is
  * what the debug memory views and the ROM loader read — but only $0000-$FEFF drives
  * the bus on a read (os.rst). Above that the VIA and RIA answer, and the unassigned
@@ -81,6 +127,65 @@ void mem_tick(uint16_t addr, bool read, uint8_t *data)
         *data = ram[addr];
 }
 
+/* Savestates (sys/sst.h). Everything here is the machine's: both RAMs, the RIA
+ * register file, the XSTACK and the audio write queue. The fill settings are
+ * how the run began, not where it is, so they stay. regs and the queue are
+ * volatile for the firmware's IRQs; the emulator has none, so plain copies. */
+#define MEM_STATE_SIZE (sizeof ram + sizeof xram_mem + sizeof regs +  \
+                        sizeof xstack + sizeof(uint32_t) +            \
+                        sizeof xram_queue + 3)
+
+static uint8_t *mem_put(uint8_t *p, const volatile void *src, size_t len)
+{
+    memcpy(p, (const void *)src, len);
+    return p + len;
+}
+
+static const uint8_t *mem_get(const uint8_t *p, volatile void *dst, size_t len)
+{
+    memcpy((void *)dst, p, len);
+    return p + len;
+}
+
+size_t mem_state_save(void *buf)
+{
+    if (buf)
+    {
+        uint8_t *p = buf;
+        uint32_t ptr = (uint32_t)xstack_ptr;
+        p = mem_put(p, ram, sizeof ram);
+        p = mem_put(p, xram_mem, sizeof xram_mem);
+        p = mem_put(p, regs, sizeof regs);
+        p = mem_put(p, xstack, sizeof xstack);
+        p = mem_put(p, &ptr, sizeof ptr);
+        p = mem_put(p, xram_queue, sizeof xram_queue);
+        *p++ = xram_queue_page;
+        *p++ = xram_queue_head;
+        *p++ = xram_queue_tail;
+    }
+    return MEM_STATE_SIZE;
+}
+
+bool mem_state_load(const void *buf, size_t len)
+{
+    if (len != MEM_STATE_SIZE)
+        return false;
+    const uint8_t *p = buf;
+    uint32_t ptr;
+    p = mem_get(p, ram, sizeof ram);
+    p = mem_get(p, xram_mem, sizeof xram_mem);
+    mem_xram_touch(0, sizeof xram_mem);
+    p = mem_get(p, regs, sizeof regs);
+    p = mem_get(p, xstack, sizeof xstack);
+    p = mem_get(p, &ptr, sizeof ptr);
+    p = mem_get(p, xram_queue, sizeof xram_queue);
+    xram_queue_page = *p++;
+    xram_queue_head = *p++;
+    xram_queue_tail = *p++;
+    xstack_ptr = ptr > XSTACK_SIZE ? XSTACK_SIZE : ptr;
+    return true;
+}
+
 /* Standalone CRC-32/ISO-HDLC (zlib): the firmware reuses littlefs's lfs_crc, but
  * the emulator doesn't link littlefs. Same polynomial, so the values match the
  * .rp6502 headers and the firmware. */
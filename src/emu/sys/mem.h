@@ -18,6 +18,10 @@
 
 extern uint8_t ram[0x10000];
 
+/* The renderers' view of XRAM (vga/sys/mem.h under MODES_THREADS): xram on
+ * every thread until sys/vga.c points a render worker at a copy. */
+extern _Thread_local volatile uint8_t *modes_xram;
+
 /* What ram[] and xram[] hold before anything writes them. Hardware zeroes
  * neither — the 6502's SRAM keeps whatever was last in it, and both firmwares
  * declare xram __uninitialized_ram() — so random is the default and a program
@@ -29,7 +33,40 @@ void mem_set_fill(bool random, uint8_t value, uint64_t seed);
  * of the fill, which is the order the hardware does it in. */
 void mem_init(void);
 
+/* XRAM writes, for the VGA's dirty lines (sys/vga.c). The VGA keeps last
+ * frame's pixels and redraws a scanline only when XRAM it reads was written
+ * after it was drawn, so every writer of xram[] reports here: the 6502's
+ * window, read_xram, the ROM loader, the HID blocks, a script's poke. Each
+ * report bumps mem_xram_writes and stamps the pages it covers with it. */
+#define MEM_XRAM_PAGE_SHIFT 8
+
+extern uint64_t mem_xram_writes;
+extern uint64_t mem_xram_page_written[0x10000 >> MEM_XRAM_PAGE_SHIFT];
+
+/* One byte: the RW0/RW1 path, once per 6502 write. */
+static inline void mem_xram_wrote(uint16_t addr)
+{
+    mem_xram_page_written[addr >> MEM_XRAM_PAGE_SHIFT] = ++mem_xram_writes;
+}
+
+/* Any run of bytes; clipped to XRAM. */
+void mem_xram_touch(uint32_t addr, uint32_t len);
+
+/* Whether XRAM [begin, end) was written after mem_xram_writes read since. */
+bool mem_xram_written_since(uint32_t begin, uint32_t end, uint64_t since);
+
+/* The same for the renderers (vga/modes/modes.h), asked of modes_xram: the
+ * write count and page stamps it is as of. These are the live ones until
+ * sys/vga.c points a render worker at a snapshot's. */
+extern _Thread_local const volatile uint64_t *modes_xram_stamp;
+extern _Thread_local const uint64_t *modes_xram_pages;
+bool modes_xram_written_since(uint32_t begin, uint32_t end, uint64_t since);
+
 /* One PHI2 tick of the SRAM. data is in/out. */
 void mem_tick(uint16_t addr, bool read, uint8_t *data);
 
+/* Savestate section (sys/sst.h). */
+size_t mem_state_save(void *buf);
+bool mem_state_load(const void *buf, size_t len);
+
 #endif /* _EMU_SYS_MEM_H_ */
@@ -5,12 +5,15 @@
  *
  */
 
+#include "emu/emu/aud.h"
 #include "emu/emu/pro.h"
 #include "emu/sys/com.h"
 #include "emu/sys/cpu.h"
 #include "emu/sys/mem.h"
+#include "emu/sys/sys.h"
 #include "emu/main.h"
 #include "ria/api/api.h"
+#include "ria/api/oem.h"
 #include "emu/sys/ria.h"
 #include <string.h>
 
@@ -122,10 +125,16 @@ static void rw_write(int which, uint8_t data)
 {
     uint16_t addr = which ? REGSW(0xFFEA) : REGSW(0xFFE6);
     int8_t step = (int8_t)(which ? regs[0x09] : regs[0x05]);
+    /* The active audio device reads its page at every sample: let it sound
+     * the samples before this write with the page as it was. */
+    const bool audio = xram_queue_page == (uint8_t)(addr >> 8);
+    if (audio)
+        aud_sync(sys_clk_cycle());
     xram[addr] = data;
+    mem_xram_wrote(addr);
     /* Notify the active audio device of writes to its page (ria/sys/ria.c):
      * record (low byte, value) for its handler to drain. */
-    if (xram_queue_page == (uint8_t)(addr >> 8))
+    if (audio)
     {
         uint8_t next = (uint8_t)(xram_queue_head + 1);
         if (next != xram_queue_tail)
@@ -314,3 +323,38 @@ void ria_run(void)
     ria.irq_pending = 0;
     regs[0x10] = 0;
 }
+
+/* Savestates (sys/sst.h): the latches, and the code page the program is running
+ * in, which it may have changed and which the font, the file system and the
+ * keyboard all follow. Everything the 6502 reads back through the registers
+ * lives in regs[] and the XSTACK, which travel with memory. */
+typedef struct
+{
+    ria_t ria;
+    uint16_t code_page;
+} ria_state_t;
+
+size_t ria_state_save(void *buf)
+{
+    if (buf)
+    {
+        ria_state_t s;
+        memset(&s, 0, sizeof s);
+        memcpy(&s.ria, &ria, sizeof ria);
+        s.code_page = oem_get_code_page_run();
+        memcpy(buf, &s, sizeof s);
+    }
+    return sizeof(ria_state_t);
+}
+
+bool ria_state_load(const void *buf, size_t len)
+{
+    ria_state_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    memcpy(&ria, &s.ria, sizeof ria);
+    if (s.code_page != oem_get_code_page_run())
+        oem_set_code_page_run(s.code_page);
+    return true;
+}
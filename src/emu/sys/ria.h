@@ -69,6 +69,10 @@ void *ria_chip(void); /* ria_t* — the live chip instance, for the debugger UI
  * contract) latches the VSYNC source, raising IRQB only while it is enabled. */
 bool ria_irq_asserted(void);
 
+/* Savestate section (sys/sst.h). */
+size_t ria_state_save(void *buf);
+bool ria_state_load(const void *buf, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "emu/sys/rwd.h"
+#include "emu/sys/sst.h"
+#include "emu/sys/sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* States held at most, whatever the budget: an hour at the default interval
+ * under the debugger. */
+#define RWD_MAX 8192
+
+typedef struct
+{
+    uint64_t clock;
+    uint8_t *delta; /* this state XOR the one before; NULL for the oldest */
+    size_t len;
+} rwd_entry_t;
+
+static unsigned g_interval;
+static size_t g_budget = (size_t)64 << 20;
+static bool g_hold;
+
+static rwd_entry_t g_ring[RWD_MAX];
+static size_t g_first, g_count;
+static size_t g_bytes;        /* the deltas */
+static uint8_t *g_newest;     /* the newest state, whole */
+static size_t g_state_len;    /* every state's, within one build */
+static uint8_t *g_work;       /* a state being rebuilt, or a delta being coded */
+static size_t g_work_len;
+
+static rwd_entry_t *rwd_at(size_t i)
+{
+    return &g_ring[(g_first + i) % RWD_MAX];
+}
+
+static size_t rwd_put_varint(uint8_t *p, size_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t rwd_get_varint(const uint8_t **p)
+{
+    size_t v = 0;
+    for (unsigned shift = 0;; shift += 7)
+    {
+        const uint8_t b = *(*p)++;
+        v |= (size_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+}
+
+/* a XOR b as runs of (equal bytes to skip, bytes that differ, their XOR). A
+ * run of differing bytes carries a lone equal one rather than pay two
+ * counts to skip it. out holds at least twice n. */
+static size_t rwd_encode(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t o = 0, i = 0;
+    while (i < n)
+    {
+        const size_t skip = i;
+        while (i < n && a[i] == b[i])
+            i++;
+        if (i == n)
+            break;
+        const size_t lit = i;
+        while (i < n && (a[i] != b[i] || (i + 1 < n && a[i + 1] != b[i + 1])))
+            i++;
+        o += rwd_put_varint(out + o, lit - skip);
+        o += rwd_put_varint(out + o, i - lit);
+        for (size_t k = lit; k < i; k++)
+            out[o++] = a[k] ^ b[k];
+    }
+    return o;
+}
+
+/* XOR a delta into a state, taking it to the other side of the delta. */
+static void rwd_apply(uint8_t *state, const uint8_t *delta, size_t len)
+{
+    const uint8_t *p = delta, *end = delta + len;
+    size_t i = 0;
+    while (p < end)
+    {
+        i += rwd_get_varint(&p);
+        for (size_t n = rwd_get_varint(&p); n; n--)
+            state[i++] ^= *p++;
+    }
+}
+
+static bool rwd_work(size_t len)
+{
+    if (g_work_len >= len)
+        return true;
+    uint8_t *w = realloc(g_work, len);
+    if (!w)
+        return false;
+    g_work = w;
+    g_work_len = len;
+    return true;
+}
+
+static void rwd_drop_oldest(void)
+{
+    /* The new oldest's delta only led to the state going. */
+    rwd_entry_t *e = rwd_at(1);
+    free(e->delta);
+    g_bytes -= e->len;
+    e->delta = NULL;
+    e->len = 0;
+    g_first = (g_first + 1) % RWD_MAX;
+    g_count--;
+}
+
+static void rwd_drop_newest(void)
+{
+    rwd_entry_t *e = rwd_at(g_count - 1);
+    if (e->delta)
+        rwd_apply(g_newest, e->delta, e->len);
+    free(e->delta);
+    g_bytes -= e->len;
+    e->delta = NULL;
+    e->len = 0;
+    if (!--g_count)
+    {
+        free(g_newest);
+        g_newest = NULL;
+    }
+}
+
+void rwd_stop(void)
+{
+    while (g_count)
+        rwd_drop_newest();
+    g_first = 0;
+}
+
+void rwd_set_interval(unsigned frames)
+{
+    g_interval = frames;
+    if (!frames)
+        rwd_stop();
+}
+
+unsigned rwd_interval(void) { return g_interval; }
+
+void rwd_set_budget(size_t bytes) { g_budget = bytes; }
+
+void rwd_hold(bool on) { g_hold = on; }
+
+void rwd_frame(void)
+{
+    if (!g_interval || g_hold || sys_frame_count() % g_interval)
+        return;
+    const uint64_t now = sys_clk_now();
+    while (g_count && rwd_at(g_count - 1)->clock >= now)
+        rwd_drop_newest(); /* a future the machine has left */
+    size_t len;
+    uint8_t *s = emu_state_snapshot(&len);
+    if (!s)
+        return;
+    if (g_count && len != g_state_len)
+        rwd_stop();
+    if (g_count == RWD_MAX)
+        rwd_drop_oldest();
+    rwd_entry_t *e = rwd_at(g_count);
+    e->clock = now;
+    e->delta = NULL;
+    e->len = 0;
+    if (g_count)
+    {
+        if (!rwd_work(2 * len))
+        {
+            free(s);
+            return;
+        }
+        const size_t n = rwd_encode(g_work, s, g_newest, len);
+        e->delta = malloc(n ? n : 1);
+        if (!e->delta)
+        {
+            free(s);
+            return;
+        }
+        memcpy(e->delta, g_work, n);
+        e->len = n;
+        g_bytes += n;
+        free(g_newest);
+    }
+    g_newest = s;
+    g_state_len = len;
+    g_count++;
+    while (g_count > 1 && g_bytes > g_budget)
+        rwd_drop_oldest();
+}
+
+size_t rwd_count(void) { return g_count; }
+
+uint64_t rwd_clock(size_t i)
+{
+    return i < g_count ? rwd_at(i)->clock : 0;
+}
+
+bool rwd_restore(size_t i)
+{
+    if (i >= g_count)
+    {
+        fprintf(stderr, "rp6502-emu: no rewind state %lu\n", (unsigned long)i);
+        return false;
+    }
+    if (!rwd_work(g_state_len))
+    {
+        fprintf(stderr, "rp6502-emu: out of memory rewinding\n");
+        return false;
+    }
+    memcpy(g_work, g_newest, g_state_len);
+    for (size_t k = g_count - 1; k > i; k--)
+        rwd_apply(g_work, rwd_at(k)->delta, rwd_at(k)->len);
+    return emu_state_restore(g_work, g_state_len);
+}
+
+size_t rwd_bytes(void)
+{
+    return g_bytes + (g_count ? g_state_len : 0);
+}
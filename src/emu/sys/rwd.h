@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _EMU_SYS_RWD_H_
+#define _EMU_SYS_RWD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Rewind: a savestate (sys/sst.h) every few frames, kept as far back as a
+ * memory budget allows, for the debugger to go back to and run forward from
+ * (dbg_reverse_continue, dbg_step_back).
+ *
+ * Consecutive states differ in a few hundred bytes — the stack, some
+ * variables, the clocks — so only the newest is kept whole. Each older one
+ * is the XOR of it and the one after, run-length coded on the zeros, which
+ * takes a state back a step when XORed in again. Forgetting the oldest is
+ * dropping a delta. A state is newest-first work to reach, but the debugger
+ * only ever wants recent ones.
+ *
+ * History belongs to the run: it is cleared when a program stops, and a
+ * state from later than the machine now is forgotten at the next one taken,
+ * as the machine has gone somewhere else since. */
+
+/* A state every frames frames, 0 for none (the default). */
+void rwd_set_interval(unsigned frames);
+unsigned rwd_interval(void);
+
+/* The most the deltas may take, in bytes; the oldest go first. */
+void rwd_set_budget(size_t bytes);
+
+/* At a frame boundary (sys.c, end of every whole frame). */
+void rwd_frame(void);
+
+/* Hold: no states taken, none forgotten, while the debugger replays. */
+void rwd_hold(bool on);
+
+/* main_stop: forget them all. */
+void rwd_stop(void);
+
+/* States held, oldest first; the system clock (sys_clk_now) each was at. */
+size_t rwd_count(void);
+uint64_t rwd_clock(size_t i);
+
+/* Put the machine back to state i. History is kept: the states after i are
+ * still there to go to until the next one is taken. Prints why on stderr and
+ * returns false. */
+bool rwd_restore(size_t i);
+
+size_t rwd_bytes(void); /* diagnostic: the deltas and the newest state */
+
+#endif /* _EMU_SYS_RWD_H_ */
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "emu/sys/sst.h"
+#include "emu/app/rand.h"
+#include "emu/emu/aud.h"
+#include "emu/emu/via.h"
+#include "emu/main.h"
+#include "emu/sys/cpu.h"
+#include "emu/sys/mem.h"
+#include "emu/sys/ria.h"
+#include "emu/sys/sys.h"
+#include "emu/sys/vga.h"
+#include "ria/aud/bel.h"
+#include "ria/aud/opl.h"
+#include "ria/aud/psg.h"
+#include "vga/modes/mode0.h"
+#include "vga/modes/mode1.h"
+#include "vga/modes/mode2.h"
+#include "vga/modes/mode3.h"
+#include "vga/modes/mode6.h"
+#include "vga/term/term.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The blob:
+ *
+ *   header   "RP6502ST", version, section count, build check
+ *   section  4-char tag, payload length, payload, zero pad to 8
+ *   ...
+ *   trailer  CRC-32 of everything before it
+ *
+ * Payloads start 8-aligned in a malloc'd blob, so a device may lay its struct
+ * directly over one. The sections are always all present and always in this
+ * order; the tags are there to make a mismatch say which device disagreed. */
+static const struct
+{
+    char tag[4];
+    size_t (*save)(void *buf);
+    bool (*load)(const void *buf, size_t len);
+    /* Optional. Whatever load could fail on (allocation), done for every
+     * section before any section is loaded. */
+    bool (*reserve)(const void *buf, size_t len);
+} sst_sections[] = {
+    {{'S', 'Y', 'S', ' '}, sys_state_save, sys_state_load, NULL},
+    {{'C', 'P', 'U', ' '}, cpu_state_save, cpu_state_load, NULL},
+    {{'V', 'I', 'A', ' '}, via_state_save, via_state_load, NULL},
+    {{'M', 'E', 'M', ' '}, mem_state_save, mem_state_load, NULL},
+    {{'R', 'I', 'A', ' '}, ria_state_save, ria_state_load, NULL},
+    {{'R', 'A', 'N', 'D'}, rand_state_save, rand_state_load, NULL},
+    {{'V', 'G', 'A', ' '}, vga_state_save, vga_state_load, NULL},
+    {{'M', 'O', 'D', '0'}, mode0_state_save, mode0_state_load, NULL},
+    {{'M', 'O', 'D', '1'}, mode1_state_save, mode1_state_load, NULL},
+    {{'M', 'O', 'D', '2'}, mode2_state_save, mode2_state_load, NULL},
+    {{'M', 'O', 'D', '3'}, mode3_state_save, mode3_state_load, NULL},
+    {{'M', 'O', 'D', '6'}, mode6_state_save, mode6_state_load, NULL},
+    {{'T', 'E', 'R', 'M'}, term_state_save, term_state_load, NULL},
+    {{'A', 'U', 'D', ' '}, aud_state_save, aud_state_load, NULL},
+    {{'P', 'S', 'G', ' '}, psg_state_save, psg_state_load, NULL},
+    {{'O', 'P', 'L', ' '}, opl_state_save, opl_state_load, opl_state_reserve},
+    {{'B', 'E', 'L', ' '}, bel_state_save, bel_state_load, NULL},
+};
+#define SST_SECTIONS (sizeof sst_sections / sizeof *sst_sections)
+
+static const char sst_magic[8] = {'R', 'P', '6', '5', '0', '2', 'S', 'T'};
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t sections;
+    uint64_t build;
+} sst_header_t;
+
+typedef struct
+{
+    char tag[4];
+    uint32_t len;
+} sst_section_t;
+
+static size_t sst_pad(size_t len)
+{
+    return (len + 7) & ~(size_t)7;
+}
+
+/* The fixed function every packed address is measured from. */
+static void sst_anchor(void) {}
+
+uint64_t sst_fn_pack(void (*fn)(void))
+{
+    if (!fn)
+        return 0;
+    return (uint64_t)((uintptr_t)fn - (uintptr_t)sst_anchor) + 1;
+}
+
+void (*sst_fn_unpack(uint64_t packed))(void)
+{
+    if (!packed)
+        return NULL;
+    return (void (*)(void))((uintptr_t)sst_anchor + (uintptr_t)(packed - 1));
+}
+
+/* Two functions a long way apart in the link: the distance between them moves
+ * with almost any change to the code, so a blob from another build is refused
+ * before one of its packed addresses is ever called. Not a hash of the binary —
+ * a cheap tripwire for the mistake anyone makes first. */
+static uint64_t sst_build(void)
+{
+    return sst_fn_pack((void (*)(void))main_init) ^
+           ((uint64_t)sizeof(sst_header_t) << 56);
+}
+
+void *emu_state_snapshot(size_t *len)
+{
+    size_t total = sizeof(sst_header_t) + sizeof(uint32_t);
+    size_t sizes[SST_SECTIONS];
+    for (size_t i = 0; i < SST_SECTIONS; i++)
+    {
+        sizes[i] = sst_sections[i].save(NULL);
+        total += sizeof(sst_section_t) + sst_pad(sizes[i]);
+    }
+    uint8_t *blob = calloc(1, total);
+    if (!blob)
+        return NULL;
+    sst_header_t h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, sst_magic, sizeof h.magic);
+    h.version = EMU_STATE_VERSION;
+    h.sections = (uint32_t)SST_SECTIONS;
+    h.build = sst_build();
+    memcpy(blob, &h, sizeof h);
+    uint8_t *p = blob + sizeof h;
+    for (size_t i = 0; i < SST_SECTIONS; i++)
+    {
+        sst_section_t sec;
+        memcpy(sec.tag, sst_sections[i].tag, sizeof sec.tag);
+        sec.len = (uint32_t)sizes[i];
+        memcpy(p, &sec, sizeof sec);
+        p += sizeof sec;
+        sst_sections[i].save(p);
+        p += sst_pad(sizes[i]);
+    }
+    uint32_t crc = mem_crc32(0, blob, (size_t)(p - blob));
+    memcpy(p, &crc, sizeof crc);
+    *len = total;
+    return blob;
+}
+
+/* Check everything before changing anything: a blob is applied whole or not at
+ * all. Returns the reason it was refused, or NULL. */
+static const char *sst_check(const uint8_t *blob, size_t len)
+{
+    sst_header_t h;
+    if (len < sizeof h + sizeof(uint32_t))
+        return "too short to be a state";
+    memcpy(&h, blob, sizeof h);
+    if (memcmp(h.magic, sst_magic, sizeof h.magic))
+        return "not a state";
+    if (h.version != EMU_STATE_VERSION)
+        return "a different state version";
+    uint32_t crc;
+    memcpy(&crc, blob + len - sizeof crc, sizeof crc);
+    if (crc != mem_crc32(0, blob, len - sizeof crc))
+        return "corrupt (CRC mismatch)";
+    if (h.sections != SST_SECTIONS || h.build != sst_build())
+        return "from a different build of the emulator";
+    const uint8_t *p = blob + sizeof h;
+    const uint8_t *end = blob + len - sizeof crc;
+    for (size_t i = 0; i < SST_SECTIONS; i++)
+    {
+        sst_section_t sec;
+        if ((size_t)(end - p) < sizeof sec)
+            return "truncated";
+        memcpy(&sec, p, sizeof sec);
+        p += sizeof sec;
+        if (memcmp(sec.tag, sst_sections[i].tag, sizeof sec.tag) ||
+            sec.len != sst_sections[i].save(NULL))
+            return "from a different build of the emulator";
+        if ((size_t)(end - p) < sst_pad(sec.len))
+            return "truncated";
+        p += sst_pad(sec.len);
+    }
+    return p == end ? NULL : "has trailing data";
+}
+
+bool emu_state_restore(const void *blob, size_t len)
+{
+    const char *why = sst_check(blob, len);
+    if (why)
+    {
+        fprintf(stderr, "rp6502-emu: state is %s\n", why);
+        return false;
+    }
+    const uint8_t *p = (const uint8_t *)blob + sizeof(sst_header_t);
+    for (size_t i = 0; i < SST_SECTIONS; i++)
+    {
+        sst_section_t sec;
+        memcpy(&sec, p, sizeof sec);
+        p += sizeof sec;
+        /* Only allocation can fail past the check (the OPL2 is malloc'd on
+         * first use). Do it now, while nothing has changed. */
+        if (sst_sections[i].reserve && !sst_sections[i].reserve(p, sec.len))
+        {
+            fprintf(stderr, "rp6502-emu: out of memory loading state\n");
+            return false;
+        }
+        p += sst_pad(sec.len);
+    }
+    vga_render_wait(); /* the modes' sections change what queued lines read */
+    p = (const uint8_t *)blob + sizeof(sst_header_t);
+    for (size_t i = 0; i < SST_SECTIONS; i++)
+    {
+        sst_section_t sec;
+        memcpy(&sec, p, sizeof sec);
+        p += sizeof sec;
+        /* Reserved above, so this should not happen. */
+        if (!sst_sections[i].load(p, sec.len))
+        {
+            fprintf(stderr, "rp6502-emu: state section '%.4s' did not load; "
+                            "the machine is inconsistent\n",
+                    sec.tag);
+            return false;
+        }
+        p += sst_pad(sec.len);
+    }
+    return true;
+}
+
+bool emu_state_save(const char *path)
+{
+    size_t len;
+    void *blob = emu_state_snapshot(&len);
+    if (!blob)
+    {
+        fprintf(stderr, "rp6502-emu: out of memory saving state\n");
+        return false;
+    }
+    FILE *f = fopen(path, "wb");
+    bool ok = f && fwrite(blob, 1, len, f) == len;
+    if (f && fclose(f))
+        ok = false;
+    free(blob);
+    if (!ok)
+        fprintf(stderr, "rp6502-emu: cannot write state '%s'\n", path);
+    return ok;
+}
+
+bool emu_state_load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "rp6502-emu: cannot open state '%s'\n", path);
+        return false;
+    }
+    uint8_t *blob = NULL;
+    long len = -1;
+    if (!fseek(f, 0, SEEK_END))
+        len = ftell(f);
+    if (len > 0 && !fseek(f, 0, SEEK_SET))
+        blob = malloc((size_t)len);
+    bool ok = blob && fread(blob, 1, (size_t)len, f) == (size_t)len;
+    fclose(f);
+    if (!ok)
+        fprintf(stderr, "rp6502-emu: cannot read state '%s'\n", path);
+    else
+        ok = emu_state_restore(blob, (size_t)len);
+    free(blob);
+    return ok;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _EMU_SYS_SST_H_
+#define _EMU_SYS_SST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Savestates: the whole machine between two frames, as one blob.
+ *
+ * A blob is a header, a run of tagged sections — one per device, each
+ * written and read by that device's *_state_save/_state_load — and a
+ * CRC-32 over all of it. The sections are the devices' own structs, so a
+ * blob loads only into the build that wrote it; the header carries a check
+ * for that, and a blob from anywhere else is refused whole rather than
+ * half-applied.
+ *
+ * What is carried is the machine: the 6502, the VIA, every memory, the
+ * RIA's latches, the clocks, the VGA programming and the console, and the
+ * sound devices. What is not is the host: open files and directories, the
+ * installed ROMs, the window, the debugger. A state taken while the 6502 is
+ * inside a file syscall resumes with the file closed under it, so take one
+ * from a program that is waiting on input or the vsync, which is where a
+ * test wants to fork from anyway.
+ *
+ * Call these only between frames (never from inside sys_run_frame). */
+
+#define EMU_STATE_VERSION 1
+
+/* To and from a file. Both print why on stderr and return false. A load
+ * that fails leaves the machine as it was. */
+bool emu_state_save(const char *path);
+bool emu_state_load(const char *path);
+
+/* To and from memory, for a harness forking many runs from one state
+ * without the file system in between. The snapshot is malloc'd; the caller
+ * frees it. restore wants it, or a copy in malloc'd memory: the devices lay
+ * their structs over their sections. */
+void *emu_state_snapshot(size_t *len);
+bool emu_state_restore(const void *blob, size_t len);
+
+/* Code addresses in a section. ASLR moves a build's functions between runs,
+ * but moves them all together, so a section carries a function as its
+ * distance from one fixed function of the same build. NULL stays 0. */
+uint64_t sst_fn_pack(void (*fn)(void));
+void (*sst_fn_unpack(uint64_t packed))(void);
+
+#endif /* _EMU_SYS_SST_H_ */
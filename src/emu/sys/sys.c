@@ -14,6 +14,7 @@
 #include "emu/sys/cpu.h"
 #include "emu/sys/mem.h"
 #include "emu/sys/ria.h"
+#include "emu/sys/rwd.h"
 #include "emu/sys/sys.h"
 #include "emu/sys/vga.h"
 #include "emu/emu/via.h"
@@ -22,15 +23,25 @@
 #include "ria/str/rln.h"
 #include "vga/term/term.h"
 #include <stdio.h>
+#include <string.h>
 
 /* The system clock, oversampled — see SYS_OVERSAMPLE. Wraps in centuries. */
 static uint64_t sys_clk;
 
+/* The clock of the bus cycle the devices are ticking. Mid-scanline run_until
+ * holds sys_clk in a local, so a device that wants to know when the 6502
+ * touched it (aud_sync, for the write snoop) reads this instead. */
+static uint64_t sys_clk_bus;
+
 /* Absolute, never reset per frame — feeds the exact deadline math below. */
 static uint64_t scanline_n;
 
 static unsigned long frame_count;
 
+/* 6502 cycles run, for throughput reports. Not machine state: a savestate
+ * neither carries nor resets it. */
+static uint64_t cpu_cycles;
+
 /* The bus between run_until calls, which hoists it into locals for the loop. data and
  * the IRQs carry across cycles: the CPU latches the settled data on the next tick, and
  * samples the interrupt line there too. IRQB is wired-OR, but each device keeps its
@@ -41,8 +52,17 @@ static bool bus_read;
 static bool bus_via_irq;
 static bool bus_ria_irq;
 
+/* cpu_exec for the cycles that touch nothing but the SRAM. Off, run_until takes
+ * sys_tick throughout. */
+static bool fast_cpu = true;
+
+void sys_set_fast_cpu(bool on) { fast_cpu = on; }
+bool sys_fast_cpu(void) { return fast_cpu; }
+
 uint64_t sys_clk_now(void) { return sys_clk; }
+uint64_t sys_clk_cycle(void) { return sys_clk_bus; }
 unsigned long sys_frame_count(void) { return frame_count; }
+uint64_t sys_cpu_cycles(void) { return cpu_cycles; }
 
 /* No init: main_init runs exactly once per process, so static zero-initialization
  * is the cold-boot state. (sys_init in ria/sys/sys.h is the firmware's monitor
@@ -128,6 +148,28 @@ static bool run_until(uint64_t deadline, bool dbg)
          * second the debug branch is worth keeping out of the common path. */
         while (clk < deadline && cpu_active())
         {
+            /* The fast path, while skipping the devices changes nothing the 6502
+             * can see. The RIA only moves its line when its window is accessed
+             * (and cpu_exec hands those cycles back) or between scanlines; the
+             * VIA's timers run on regardless, but with no interrupt enabled its
+             * line stays low, so it is caught up after the run instead of
+             * during it. The run's last cycle is the board's, as sys_tick would
+             * do it, so the VIA and the RIA finish on the same pins either way
+             * and the machine is the tick path's, byte for byte. */
+            if (fast_cpu && !via_irq && via_quiet())
+            {
+                const uint64_t left = (deadline - clk + cycle_ticks - 1) / cycle_ticks;
+                const uint32_t n = cpu_exec(ram, left < UINT32_MAX ? (uint32_t)left : UINT32_MAX,
+                                            &addr, &read, &data, ria_irq);
+                via_idle(n - 1);
+                sys_clk_bus = clk + (uint64_t)(n - 1) * cycle_ticks;
+                via_irq = via_tick(addr, read, &data);
+                ria_irq = ria_tick(addr, read, &data);
+                mem_tick(addr, read, &data);
+                clk += (uint64_t)n * cycle_ticks;
+                continue;
+            }
+            sys_clk_bus = clk;
             sys_tick(&addr, &data, &read, &via_irq, &ria_irq);
             clk += cycle_ticks;
         }
@@ -136,6 +178,7 @@ static bool run_until(uint64_t deadline, bool dbg)
     {
         while (clk < deadline && cpu_active())
         {
+            sys_clk_bus = clk;
             sys_tick(&addr, &data, &read, &via_irq, &ria_irq);
             clk += cycle_ticks;
             if (cpu_dbg_cycle_cb)
@@ -148,17 +191,19 @@ static bool run_until(uint64_t deadline, bool dbg)
              * is then abandoned and the machine holds until resume. */
             uint16_t pc;
             uint8_t sp;
-            if (cpu_opcode_fetch(&pc, &sp) && dbg_at_instruction(pc, sp))
+            if (cpu_opcode_fetch(&pc, &sp) && dbg_at_instruction(pc, sp, clk))
             {
-                sys_clk = clk; /* commit both before abandoning the frame */
+                cpu_cycles += (clk - sys_clk) / cycle_ticks;
+                sys_clk = sys_clk_bus = clk; /* commit both before abandoning the frame */
                 bus_park(addr, data, read, via_irq, ria_irq);
                 return true;
             }
         }
     }
+    cpu_cycles += (clk - sys_clk) / cycle_ticks;
     if (clk < deadline)
         clk = deadline; /* halted: keep the clock (time) flowing */
-    sys_clk = clk;
+    sys_clk = sys_clk_bus = clk;
     bus_park(addr, data, read, via_irq, ria_irq);
     return false;
 }
@@ -218,12 +263,15 @@ static void run_frame(bool render)
         scanline_n++;
         if (!vsynced && line + 1 >= vsync_line)
         {
+            vga_check_sprites();
             REGS(0xFFE3) = (uint8_t)(REGS(0xFFE3) + 1); /* VSYNC counter, 8-bit wrap */
             ria_trigger_vsync(); /* latch $FFF0 bit7; raises IRQ only if the program enabled it */
             vsynced = true;
         }
         line++;
     }
+    if (render)
+        vga_budget_frame(); /* every line of it has been placed */
 
     frame_count++;
     /* Drip any typed text into the keyboard ring before the line editor drains it,
@@ -253,11 +301,63 @@ static void run_frame(bool render)
         else
             main_run(); /* start the incoming program; keeps VSYNC + clock */
     }
+    rwd_frame(); /* a whole frame ran: a rewind state, when one is due */
 }
 
-void sys_run_frame(void) { run_frame(true); }
+void sys_run_frame(void)
+{
+    run_frame(true);
+    vga_render_wait(); /* the frame is in the framebuffer on return */
+}
 
 /* Run one frame WITHOUT rendering — a catch-up frame the pacer will not present.
  * CPU/chip/timing/vsync all advance; only the per-scanline pixel work is skipped
  * (most of the per-frame cost), so catching up after a slow/stalled host is cheap. */
 void sys_run_frame_norender(void) { run_frame(false); }
+
+/* Savestates (sys/sst.h): the clocks and the parked bus. A state is only ever
+ * taken between frames, so the bus is parked and scanline_n is on a frame
+ * boundary; the clock carries the scanline deadlines with it. */
+typedef struct
+{
+    uint64_t sys_clk;
+    uint64_t scanline_n;
+    uint64_t frame_count;
+    uint16_t bus_addr;
+    uint8_t bus_data;
+    bool bus_read;
+    bool bus_via_irq;
+    bool bus_ria_irq;
+} sys_state_t;
+
+size_t sys_state_save(void *buf)
+{
+    if (buf)
+    {
+        sys_state_t s;
+        memset(&s, 0, sizeof s);
+        s.sys_clk = sys_clk;
+        s.scanline_n = scanline_n;
+        s.frame_count = frame_count;
+        s.bus_addr = bus_addr;
+        s.bus_data = bus_data;
+        s.bus_read = bus_read;
+        s.bus_via_irq = bus_via_irq;
+        s.bus_ria_irq = bus_ria_irq;
+        memcpy(buf, &s, sizeof s);
+    }
+    return sizeof(sys_state_t);
+}
+
+bool sys_state_load(const void *buf, size_t len)
+{
+    sys_state_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    sys_clk = sys_clk_bus = s.sys_clk;
+    scanline_n = s.scanline_n;
+    frame_count = (unsigned long)s.frame_count;
+    bus_park(s.bus_addr, s.bus_data, s.bus_read, s.bus_via_irq, s.bus_ria_irq);
+    return true;
+}
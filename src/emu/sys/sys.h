@@ -8,6 +8,8 @@
 #ifndef _EMU_SYS_SYS_H_
 #define _EMU_SYS_SYS_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* The firmware contract: sys_init (the monitor's startup banner) and sys_main (the
@@ -27,10 +29,26 @@
 void sys_run_frame(void);
 void sys_run_frame_norender(void);
 
+/* The 6502's fast path (sys.c), on by default. Off, every cycle takes the board's
+ * full tick — the reference the fast path is held to, and slower for it. Either
+ * way the machine runs the same bus, cycle for cycle. */
+void sys_set_fast_cpu(bool on);
+bool sys_fast_cpu(void);
+
 /* The oversampled system clock; pico/time.h's time_us_64 divides it by
  * SYS_TICKS_PER_US to serve the pico monotonic microsecond clock. */
 uint64_t sys_clk_now(void);
 
+/* The clock of the bus cycle being ticked. Between scanlines it is
+ * sys_clk_now; inside one it is the cycle's own, which sys_clk_now is not. */
+uint64_t sys_clk_cycle(void);
+
 unsigned long sys_frame_count(void); /* diagnostic: total frames, advances at 60 Hz */
+uint64_t sys_cpu_cycles(void);       /* diagnostic: total 6502 cycles run */
+
+/* Savestate section (sys/sst.h): the system clock, the scanline count and the
+ * bus. */
+size_t sys_state_save(void *buf);
+bool sys_state_load(const void *buf, size_t len);
 
 #endif /* _EMU_SYS_SYS_H_ */
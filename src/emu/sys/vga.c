@@ -8,11 +8,24 @@
 #include "emu/sys/mem.h"
 #include "ria/sys/pix.h"
 #include "emu/sys/ria.h"
+#include "emu/sys/sst.h"
 #include "emu/sys/vga.h"
+#include "emu/sys/vpx.h"
 #include "vga/modes/mode0.h"
+#include "vga/modes/mode1.h"
+#include "vga/modes/mode2.h"
+#include "vga/modes/mode3.h"
+#include "vga/modes/mode4.h"
+#include "vga/modes/mode5.h"
+#include "vga/modes/mode6.h"
 #include "vga/term/term.h"
 #include "vga/term/font.h"
 #include "vga/scanvideo/pixel_format.h"
+#include "host/host.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* Current canvas geometry. The boot console is 640x480. */
@@ -41,19 +54,28 @@ static vga_prog_t g_prog[VGA_PROG_MAX];
 /* Highest scanline any program renders; vsync fires here (firmware parity). */
 static int16_t g_highest_scanline;
 
-/* RGB555(+alpha bit) -> RGBA8 (0xAABBGGRR). Computed inline rather than through a
- * 256 KB value-indexed table: the shifts vectorize, and keeping the cache free
- * for the CPU core and framebuffer beats a table that thrashes on color-rich
- * content (and it's a large fraction of L2 on the ARM/WASM targets). */
-static inline uint32_t rgb555_to_rgba8(uint16_t px)
+/* Dirty lines. The framebuffer still holds last frame's pixels, so a scanline
+ * whose inputs are what they were when it was drawn is drawn already. A
+ * line's inputs are its program, the XRAM its fills read (the modes' spans,
+ * against sys/mem.h's write stamps), all of XRAM under a sprite plane, and
+ * the console's cells by value (mode0_key). Anything else a line could read —
+ * the canvas, the font, the framebuffer itself — forgets every line when it
+ * changes. drawn is mem_xram_writes when the line was drawn, 0 to redraw. */
+static uint64_t g_line_drawn[VGA_PROG_MAX];
+static uint8_t g_line_key[VGA_PROG_MAX][MODE0_KEY_MAX];
+static uint16_t g_line_key_len[VGA_PROG_MAX];
+static bool g_redraw_all;
+static uint64_t g_lines_drawn;
+
+/* Sprite checks: mem_xram_writes when the sprites were last checked, 0 to
+ * check them again at the next vsync. */
+static uint64_t g_check_writes;
+
+static void vga_forget_lines(int16_t begin, int16_t end)
 {
-    uint32_t r5 = SCANVIDEO_R5_FROM_PIXEL(px);
-    uint32_t g5 = SCANVIDEO_G5_FROM_PIXEL(px);
-    uint32_t b5 = SCANVIDEO_B5_FROM_PIXEL(px);
-    uint32_t r = (r5 << 3) | (r5 >> 2);
-    uint32_t g = (g5 << 3) | (g5 >> 2);
-    uint32_t b = (b5 << 3) | (b5 >> 2);
-    return r | (g << 8) | (b << 16) | 0xFF000000u;
+    g_check_writes = 0;
+    for (int16_t i = begin; i < end; i++)
+        g_line_drawn[i] = 0;
 }
 
 int16_t vga_canvas_height(void)
@@ -105,6 +127,7 @@ bool vga_prog_fill(int16_t plane, int16_t scanline_begin, int16_t scanline_end,
         g_prog[i].fill_config[plane] = config_ptr;
         g_prog[i].fill_fn[plane] = fill_fn;
     }
+    vga_forget_lines(scanline_begin, scanline_end);
     return true;
 }
 
@@ -123,6 +146,7 @@ bool vga_prog_exclusive(int16_t plane, int16_t scanline_begin, int16_t scanline_
         g_prog[i].fill_config[plane] = config_ptr;
         g_prog[i].fill_fn[plane] = fill_fn;
     }
+    vga_forget_lines(0, VGA_PROG_MAX); /* and wherever it was before */
     return true;
 }
 
@@ -139,6 +163,7 @@ bool vga_prog_sprite(int16_t plane, int16_t scanline_begin, int16_t scanline_end
         g_prog[i].sprite_length[plane] = length;
         g_prog[i].sprite_fn[plane] = sprite_fn;
     }
+    vga_forget_lines(scanline_begin, scanline_end);
     return true;
 }
 
@@ -149,6 +174,7 @@ bool vga_prog_sprite(int16_t plane, int16_t scanline_begin, int16_t scanline_end
  * NAKs it. */
 bool vga_set_canvas(uint16_t canvas)
 {
+    vga_render_wait();
     switch (canvas)
     {
     case 1: /* vga_320_240 */
@@ -170,6 +196,7 @@ bool vga_set_canvas(uint16_t canvas)
     g_canvas_code = (vga_canvas_t)canvas;
     memset(g_prog, 0, sizeof(g_prog));
     g_highest_scanline = 0;
+    vga_forget_lines(0, VGA_PROG_MAX);
     if (canvas == vga_canvas_console)
     {
         uint16_t xregs[8] = {0};
@@ -180,7 +207,9 @@ bool vga_set_canvas(uint16_t canvas)
 
 void vga_set_code_page(uint16_t cp)
 {
+    vga_render_wait();
     font_set_code_page(cp);
+    vga_forget_lines(0, VGA_PROG_MAX); /* the built-in fonts are the code page's */
 }
 
 void vga_init(void)
@@ -226,6 +255,93 @@ void vga_canvas_size(int *w, int *h)
     *h = g_canvas_h;
 }
 
+/* Savestates (sys/sst.h): the canvas and the program table. The
+ * renderers in the table are code addresses, so they travel packed; the configs
+ * they point at are XRAM addresses and travel as they are. The modes keep their
+ * own per-line state, in their own sections. */
+typedef struct
+{
+    int16_t canvas_w, canvas_h;
+    uint16_t canvas_code;
+    int16_t highest_scanline;
+    bool needs_reset;
+} vga_state_t;
+
+typedef struct
+{
+    uint64_t fill_fn[SCANVIDEO_PLANE_COUNT];
+    uint64_t sprite_fn[SCANVIDEO_PLANE_COUNT];
+    uint16_t fill_config[SCANVIDEO_PLANE_COUNT];
+    uint16_t sprite_config[SCANVIDEO_PLANE_COUNT];
+    uint16_t sprite_length[SCANVIDEO_PLANE_COUNT];
+} vga_prog_state_t;
+
+#define VGA_STATE_SIZE (sizeof(vga_state_t) + VGA_PROG_MAX * sizeof(vga_prog_state_t))
+
+size_t vga_state_save(void *buf)
+{
+    if (!buf)
+        return VGA_STATE_SIZE;
+    uint8_t *p = buf;
+    vga_state_t s;
+    memset(&s, 0, sizeof s);
+    s.canvas_w = g_canvas_w;
+    s.canvas_h = g_canvas_h;
+    s.canvas_code = (uint16_t)g_canvas_code;
+    s.highest_scanline = g_highest_scanline;
+    s.needs_reset = vga_needs_reset;
+    memcpy(p, &s, sizeof s);
+    p += sizeof s;
+    for (int i = 0; i < VGA_PROG_MAX; i++)
+    {
+        vga_prog_state_t ps;
+        memset(&ps, 0, sizeof ps);
+        for (int j = 0; j < SCANVIDEO_PLANE_COUNT; j++)
+        {
+            ps.fill_fn[j] = sst_fn_pack((void (*)(void))g_prog[i].fill_fn[j]);
+            ps.sprite_fn[j] = sst_fn_pack((void (*)(void))g_prog[i].sprite_fn[j]);
+            ps.fill_config[j] = g_prog[i].fill_config[j];
+            ps.sprite_config[j] = g_prog[i].sprite_config[j];
+            ps.sprite_length[j] = g_prog[i].sprite_length[j];
+        }
+        memcpy(p, &ps, sizeof ps);
+        p += sizeof ps;
+    }
+    return VGA_STATE_SIZE;
+}
+
+bool vga_state_load(const void *buf, size_t len)
+{
+    if (len != VGA_STATE_SIZE)
+        return false;
+    vga_render_wait();
+    const uint8_t *p = buf;
+    vga_state_t s;
+    memcpy(&s, p, sizeof s);
+    p += sizeof s;
+    g_canvas_w = s.canvas_w;
+    g_canvas_h = s.canvas_h;
+    g_canvas_code = (vga_canvas_t)s.canvas_code;
+    g_highest_scanline = s.highest_scanline;
+    vga_needs_reset = s.needs_reset;
+    for (int i = 0; i < VGA_PROG_MAX; i++)
+    {
+        vga_prog_state_t ps;
+        memcpy(&ps, p, sizeof ps);
+        p += sizeof ps;
+        for (int j = 0; j < SCANVIDEO_PLANE_COUNT; j++)
+        {
+            g_prog[i].fill_fn[j] = (fill_fn_t)sst_fn_unpack(ps.fill_fn[j]);
+            g_prog[i].sprite_fn[j] = (sprite_fn_t)sst_fn_unpack(ps.sprite_fn[j]);
+            g_prog[i].fill_config[j] = ps.fill_config[j];
+            g_prog[i].sprite_config[j] = ps.sprite_config[j];
+            g_prog[i].sprite_length[j] = ps.sprite_length[j];
+        }
+    }
+    vga_forget_lines(0, VGA_PROG_MAX);
+    return true;
+}
+
 /* The app-owned framebuffer the scanlines render into (the window's texture
  * staging, main.c's screenshot buffer, a test's assertion buffer). The owner
  * registers storage for the largest canvas before running frames; sokol's
@@ -234,7 +350,406 @@ static uint32_t *g_framebuffer;
 
 void vga_set_framebuffer(uint32_t *fb)
 {
+    vga_render_wait();
     g_framebuffer = fb;
+    vga_forget_lines(0, VGA_PROG_MAX);
+}
+
+void vga_set_redraw_all(bool redraw_all)
+{
+    vga_render_wait();
+    g_redraw_all = redraw_all;
+    vga_forget_lines(0, VGA_PROG_MAX);
+}
+
+uint64_t vga_lines_drawn(void)
+{
+    return g_lines_drawn;
+}
+
+/* Sprite checks. Mode 4 trusts a sprite's opacity metadata over its pixels,
+ * so metadata that disagrees draws some other sprite, and on the hardware
+ * too. Asked for, every vsync after XRAM or a program changed looks at each
+ * sprite table once and tells stderr about each sprite image found wrong,
+ * once; g_flagged is those images, by address. */
+static bool g_check_sprites;
+static uint8_t g_flagged[0x10000 / 8];
+static unsigned g_flagged_n;
+
+void vga_set_sprite_check(bool on)
+{
+    g_check_sprites = on;
+    g_check_writes = 0;
+    memset(g_flagged, 0, sizeof g_flagged);
+    g_flagged_n = 0;
+}
+
+unsigned vga_sprites_flagged(void)
+{
+    return g_flagged_n;
+}
+
+void vga_check_sprites(void)
+{
+    if (!g_check_sprites || g_check_writes == mem_xram_writes)
+        return;
+    g_check_writes = mem_xram_writes;
+    typedef struct
+    {
+        sprite_fn_t fn;
+        uint16_t config, length;
+    } table_t;
+    table_t seen[VGA_PROG_MAX];
+    int n_seen = 0;
+    for (int y = 0; y < g_canvas_h; y++)
+        for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
+        {
+            const vga_prog_t *p = &g_prog[y];
+            if (!p->sprite_fn[i])
+                continue;
+            int k = 0;
+            while (k < n_seen && (seen[k].fn != p->sprite_fn[i] ||
+                                  seen[k].config != p->sprite_config[i] ||
+                                  seen[k].length != p->sprite_length[i]))
+                k++;
+            if (k < n_seen || n_seen == VGA_PROG_MAX)
+                continue;
+            seen[n_seen++] = (table_t){p->sprite_fn[i], p->sprite_config[i], p->sprite_length[i]};
+            mode4_check_t bad[16];
+            const int n = mode4_check(p->sprite_fn[i], p->sprite_config[i], p->sprite_length[i],
+                                      bad, (int)(sizeof bad / sizeof *bad));
+            for (int b = 0; b < n && b < (int)(sizeof bad / sizeof *bad); b++)
+            {
+                const uint16_t ptr = bad[b].xram_sprite_ptr;
+                if (g_flagged[ptr / 8] & (1u << (ptr % 8)))
+                    continue;
+                g_flagged[ptr / 8] |= (uint8_t)(1u << (ptr % 8));
+                g_flagged_n++;
+                fprintf(stderr, "rp6502-emu: mode 4 sprite %u at $%04X: row %u's opacity "
+                                "metadata is $%08lX, its pixels want $%08lX\n",
+                        bad[b].sprite, ptr, bad[b].row,
+                        (unsigned long)bad[b].meta, (unsigned long)bad[b].want);
+            }
+        }
+}
+
+/* Render profile. g_prof_line is each line's cost the last time it was
+ * drawn, which with every line drawing is the last frame; g_prof_sum runs
+ * across frames for the CSV. The clock is read around each renderer only
+ * while profiling, so an unprofiled line pays one branch. The sprite count
+ * is per thread, as the modes declare it under MODES_THREADS. */
+_Thread_local uint32_t modes_sprites_touched;
+_Thread_local uint32_t modes_sprite_pixels;
+
+typedef struct
+{
+    uint64_t fill_ns, sprite_ns, sprites;
+    uint32_t fill_max, sprite_max, sprites_max;
+} vga_prof_sum_t;
+
+static bool g_profile;
+static vga_line_cost_t g_prof_line[VGA_PROG_MAX];
+static vga_prof_sum_t g_prof_sum[VGA_PROG_MAX][VGA_PLANE_COUNT];
+static uint32_t g_prof_draws[VGA_PROG_MAX];
+
+static_assert(VGA_PLANE_COUNT == SCANVIDEO_PLANE_COUNT);
+
+static void vga_profile_add(int y, const vga_line_cost_t *cost)
+{
+    g_prof_draws[y]++;
+    for (int i = 0; i < VGA_PLANE_COUNT; i++)
+    {
+        vga_prof_sum_t *s = &g_prof_sum[y][i];
+        s->fill_ns += cost->fill_ns[i];
+        s->sprite_ns += cost->sprite_ns[i];
+        s->sprites += cost->sprites[i];
+        if (cost->fill_ns[i] > s->fill_max)
+            s->fill_max = cost->fill_ns[i];
+        if (cost->sprite_ns[i] > s->sprite_max)
+            s->sprite_max = cost->sprite_ns[i];
+        if (cost->sprites[i] > s->sprites_max)
+            s->sprites_max = cost->sprites[i];
+    }
+}
+
+void vga_set_profile(bool on)
+{
+    vga_render_wait();
+    g_profile = on;
+}
+
+bool vga_profiling(void)
+{
+    return g_profile;
+}
+
+void vga_profile_reset(void)
+{
+    memset(g_prof_line, 0, sizeof g_prof_line);
+    memset(g_prof_sum, 0, sizeof g_prof_sum);
+    memset(g_prof_draws, 0, sizeof g_prof_draws);
+}
+
+const vga_line_cost_t *vga_profile_lines(void)
+{
+    return g_prof_line;
+}
+
+bool vga_profile_write_csv(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        fprintf(stderr, "rp6502-emu: cannot write %s\n", path);
+        return false;
+    }
+    fprintf(f, "line,plane,draws,fill_ns_mean,fill_ns_max,"
+               "sprite_ns_mean,sprite_ns_max,sprites_mean,sprites_max\n");
+    for (int y = 0; y < VGA_PROG_MAX; y++)
+    {
+        const uint32_t n = g_prof_draws[y];
+        if (!n)
+            continue;
+        for (int i = 0; i < VGA_PLANE_COUNT; i++)
+        {
+            const vga_prof_sum_t *s = &g_prof_sum[y][i];
+            if (!s->fill_max && !s->sprite_max && !s->sprites_max)
+                continue; /* nothing on this plane of this line */
+            fprintf(f, "%d,%d,%" PRIu32 ",%" PRIu64 ",%" PRIu32 ",%" PRIu64 ",%" PRIu32
+                       ",%.2f,%" PRIu32 "\n",
+                    y, i, n, s->fill_ns / n, s->fill_max, s->sprite_ns / n,
+                    s->sprite_max, (double)s->sprites / n, s->sprites_max);
+        }
+    }
+    if (fclose(f) != 0)
+    {
+        fprintf(stderr, "rp6502-emu: cannot write %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+/* Render budget. The VGA runs at 8 x the 25.2 MHz pixel clock of its
+ * 640x480 timing, 6400 cycles a display line, and a 320-wide canvas shows
+ * each line on two. Lines go on a timeline in those cycles, the beam
+ * reaching canvas line 0 at 0 and scanvideo letting the cores start ten
+ * display lines before (vga/scanvideo/scanvideo.c). A line goes to the core
+ * that is free first, once a buffer is: a buffer is held until the beam is
+ * done with its line, or until a line too late to show is finished. A core
+ * that starts once the beam has passed a line takes the one the beam wants
+ * next, and the lines between are never drawn. Each line is placed as it
+ * is drawn, from its cost and the lines before it, so a late one can be
+ * shown late at once. A line late for the first of its two display lines
+ * shows on the second; it is drawn all blue all the same. */
+#define VGA_BUDGET_SYS_HZ 201600000
+#define VGA_BUDGET_DISPLAY_LINE (VGA_BUDGET_SYS_HZ / (VGA_HZ * VGA_SCANLINES))
+#define VGA_BUDGET_BUFFERS 10          /* SCANVIDEO_SCANLINE_BUFFER_COUNT */
+#define VGA_BUDGET_OVERHEAD 400        /* scanvideo's begin and end, the line's program */
+#define VGA_BUDGET_MISSING 0xFFFF0000u /* SCANVIDEO_MISSING_SCANLINE_COLOR */
+
+static unsigned g_budget;
+static vga_line_budget_t g_budget_line[VGA_PROG_MAX];
+static int g_reported_late;
+static int16_t g_reported_worst = -1;
+
+static struct
+{
+    int64_t core[2];                    /* when each is free */
+    int64_t buffer[VGA_BUDGET_BUFFERS]; /* when each is free */
+    unsigned taken;                     /* buffers taken this frame */
+    int last;                           /* the last line taken */
+} g_sched;
+
+void vga_set_budget(unsigned flags)
+{
+    vga_render_wait();
+    if (flags)
+        flags |= VGA_BUDGET_ON;
+    if (g_budget & VGA_BUDGET_SHOW && !(flags & VGA_BUDGET_SHOW))
+        vga_forget_lines(0, VGA_PROG_MAX); /* the blue ones */
+    g_budget = flags;
+    g_reported_late = 0;
+    g_reported_worst = -1;
+}
+
+unsigned vga_budget(void)
+{
+    return g_budget;
+}
+
+uint32_t vga_budget_line_cycles(void)
+{
+    return VGA_BUDGET_DISPLAY_LINE * (VGA_MAX_WIDTH / g_canvas_w);
+}
+
+const vga_line_budget_t *vga_budget_lines(void)
+{
+    return g_budget_line;
+}
+
+static bool vga_fill_cost(const vga_prog_t *p, int i, int y, modes_cost_t *cost)
+{
+    const fill_fn_t fn = p->fill_fn[i];
+    return mode0_cost(fn, (int16_t)i, (int16_t)y, cost) ||
+           mode1_cost(fn, (int16_t)i, (int16_t)y, cost) ||
+           mode2_cost(fn, (int16_t)i, (int16_t)y, cost) ||
+           mode3_cost(fn, (int16_t)i, (int16_t)y, cost) ||
+           mode6_cost(fn, (int16_t)i, (int16_t)y, cost);
+}
+
+/* Line y's cycles from the modes' costs and what its sprite renderers
+ * drew. A renderer no mode describes costs nothing. */
+static uint32_t vga_budget_cycles(const vga_prog_t *p, int y, const vga_line_cost_t *cost)
+{
+    uint32_t cycles = VGA_BUDGET_OVERHEAD;
+    for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
+    {
+        modes_cost_t c;
+        if (p->fill_fn[i] && vga_fill_cost(p, i, y, &c))
+            cycles += c.call + (uint32_t)c.pixel16 * (uint32_t)g_canvas_w / 16;
+        if (p->sprite_fn[i] &&
+            (mode4_cost(p->sprite_fn[i], &c) || mode5_cost(p->sprite_fn[i], &c)))
+            cycles += c.call +
+                      (uint32_t)c.entry * p->sprite_length[i] +
+                      (uint32_t)c.sprite * cost->sprites[i] +
+                      (uint32_t)c.pixel16 * cost->sprite_pixels[i] / 16;
+    }
+    return cycles;
+}
+
+static void vga_budget_add(int y, uint32_t cycles)
+{
+    const int64_t display_line = VGA_BUDGET_DISPLAY_LINE;
+    const int64_t line = vga_budget_line_cycles();
+    if (y == 0)
+    {
+        for (int c = 0; c < 2; c++)
+            g_sched.core[c] = -VGA_BUDGET_BUFFERS * display_line;
+        for (int b = 0; b < VGA_BUDGET_BUFFERS; b++)
+            g_sched.buffer[b] = -VGA_BUDGET_BUFFERS * display_line;
+        g_sched.taken = 0;
+        g_sched.last = -1;
+    }
+    const int c = g_sched.core[0] <= g_sched.core[1] ? 0 : 1;
+    int64_t *const buffer = &g_sched.buffer[g_sched.taken % VGA_BUDGET_BUFFERS];
+    const int64_t start = g_sched.core[c] > *buffer ? g_sched.core[c] : *buffer;
+    const int64_t end = start + cycles;
+    const int64_t due = y * line;
+    int64_t wanted = start < 0 ? 0 : (start + display_line) / line;
+    if (wanted <= g_sched.last)
+        wanted = g_sched.last + 1;
+
+    vga_line_budget_t *const b = &g_budget_line[y];
+    b->cycles = cycles;
+    const int64_t slack = due - end;
+    b->slack = slack < INT32_MIN ? INT32_MIN : slack > INT32_MAX ? INT32_MAX : (int32_t)slack;
+    if (wanted <= y)
+    {
+        g_sched.core[c] = end;
+        *buffer = end <= due + line - display_line ? due + line : end;
+        g_sched.taken++;
+        g_sched.last = y;
+    }
+    else if (b->slack >= 0)
+        b->slack = -1; /* skipped */
+    if (b->slack < 0 && g_budget & VGA_BUDGET_SHOW)
+        for (int x = 0; x < g_canvas_w; x++)
+            g_framebuffer[(size_t)y * g_canvas_w + x] = VGA_BUDGET_MISSING;
+}
+
+int vga_budget_late(int16_t *lines, int max)
+{
+    int n = 0;
+    for (int y = 0; y < g_canvas_h; y++)
+    {
+        const int32_t slack = g_budget_line[y].slack;
+        if (slack >= 0)
+            continue;
+        int k = n < max ? n : max;
+        for (; k > 0 && g_budget_line[lines[k - 1]].slack > slack; k--)
+            if (k < max)
+                lines[k] = lines[k - 1];
+        if (k < max)
+            lines[k] = (int16_t)y;
+        n++;
+    }
+    return n;
+}
+
+void vga_budget_frame(void)
+{
+    if (!(g_budget & VGA_BUDGET_REPORT))
+        return;
+    int16_t worst[3];
+    const int late = vga_budget_late(worst, 3);
+    if (late == g_reported_late && (!late || worst[0] == g_reported_worst))
+        return;
+    g_reported_late = late;
+    g_reported_worst = late ? worst[0] : -1;
+    if (!late)
+    {
+        fprintf(stderr, "rp6502-emu: every scanline on time\n");
+        return;
+    }
+    fprintf(stderr, "rp6502-emu: %d scanline%s late, worst", late, late == 1 ? "" : "s");
+    for (int i = 0; i < late && i < 3; i++)
+        fprintf(stderr, "%s %d by %ld cycles", i ? "," : "", worst[i],
+                -(long)g_budget_line[worst[i]].slack);
+    fprintf(stderr, " (a line has %lu)\n", (unsigned long)vga_budget_line_cycles());
+}
+
+/* The XRAM plane i's fill reads on line y, or -1 when no mode describes it. */
+static int vga_fill_spans(const vga_prog_t *p, int i, int y, modes_span_t *spans)
+{
+    int n = mode1_spans(p->fill_fn[i], (int16_t)i, (int16_t)y, p->fill_config[i], spans);
+    if (n < 0)
+        n = mode2_spans(p->fill_fn[i], (int16_t)i, (int16_t)y, p->fill_config[i], spans);
+    if (n < 0)
+        n = mode3_spans(p->fill_fn[i], (int16_t)i, (int16_t)y, p->fill_config[i], spans);
+    if (n < 0)
+        n = mode6_spans(p->fill_fn[i], (int16_t)i, (int16_t)y, p->fill_config[i], spans);
+    return n;
+}
+
+/* Whether line y would draw what it drew last time, recording its console key
+ * for next time either way. */
+static bool vga_line_current(int y)
+{
+    const vga_prog_t *p = &g_prog[y];
+    const uint64_t drawn = g_line_drawn[y];
+    bool current = drawn != 0;
+    bool keyed = false;
+    for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
+    {
+        /* A sprite table points anywhere: any write at all. */
+        if (p->sprite_fn[i] && mem_xram_writes > drawn)
+            current = false;
+        if (!p->fill_fn[i])
+            continue;
+        modes_span_t spans[MODES_SPANS_MAX];
+        const int n = vga_fill_spans(p, i, y, spans);
+        if (n >= 0)
+        {
+            for (int s = 0; s < n && current; s++)
+                if (mem_xram_written_since(spans[s].begin, spans[s].end, drawn))
+                    current = false;
+            continue;
+        }
+        uint8_t key[MODE0_KEY_MAX];
+        size_t len = mode0_key(p->fill_fn[i], (int16_t)y, (int16_t)g_canvas_w, key);
+        if (!len || keyed)
+            return false; /* a renderer nobody describes: always draw it */
+        keyed = true;
+        if (len != g_line_key_len[y] || memcmp(key, g_line_key[y], len))
+        {
+            memcpy(g_line_key[y], key, len);
+            g_line_key_len[y] = (uint16_t)len;
+            current = false;
+        }
+    }
+    if (!keyed)
+        g_line_key_len[y] = 0;
+    return current;
 }
 
 uint32_t *vga_get_framebuffer(void)
@@ -242,25 +757,32 @@ uint32_t *vga_get_framebuffer(void)
     return g_framebuffer;
 }
 
-/* Render ONE scanline y of the canvas into fb at the canvas's native stride
- * (g_canvas_w). Each plane runs its fill and then its own sprites — slot k's
- * sprites belong to plane k, over a zeroed buffer when no fill ran. (The RIA
- * firmware paints sprites into the lowest filled buffer to skip the memset;
- * that is a bandwidth optimization whose artifacts are not modeled.) The
- * planes composite as scanvideo's PIO does — plane 0 is the unconditional
- * base, black when unfilled, and higher planes overlay where their pixel's
- * alpha bit is set, so e.g. a sprite layer shows through the transparent
- * background of a text layer above it. */
-static void render_scanline(int y, uint32_t *fb)
+
+/* Render ONE scanline y of program p into fb at stride W. Each plane runs its
+ * fill and then its own sprites — slot k's sprites belong to plane k, over a
+ * zeroed buffer when no fill ran. (The RIA firmware paints sprites into the
+ * lowest filled buffer to skip the memset; that is a bandwidth optimization
+ * whose artifacts are not modeled.) The planes composite as scanvideo's PIO
+ * does — plane 0 is the unconditional base, black when unfilled, and higher
+ * planes overlay where their pixel's alpha bit is set, so e.g. a sprite layer
+ * shows through the transparent background of a text layer above it. Reads
+ * nothing of the emulator's but p and what the renderers read, so a render
+ * worker may run it; cost, when not NULL, receives the line's profile. */
+static void draw_line(const vga_prog_t *p, int y, int W, uint32_t *fb, vga_line_cost_t *cost)
 {
-    const int W = g_canvas_w;
     uint16_t plane[SCANVIDEO_PLANE_COUNT][VGA_MAX_WIDTH];
-    const vga_prog_t *p = &g_prog[y];
     bool filled[SCANVIDEO_PLANE_COUNT] = {false, false, false};
+    if (cost)
+        memset(cost, 0, sizeof *cost);
     for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
     {
         if (p->fill_fn[i])
+        {
+            const uint64_t t = cost ? os_mono_ns() : 0;
             filled[i] = p->fill_fn[i](i, (int16_t)y, (int16_t)W, plane[i], p->fill_config[i]);
+            if (cost)
+                cost->fill_ns[i] = (uint32_t)(os_mono_ns() - t);
+        }
         if (p->sprite_fn[i])
         {
             if (!filled[i])
@@ -268,26 +790,248 @@ static void render_scanline(int y, uint32_t *fb)
                 memset(plane[i], 0, (size_t)W * sizeof(uint16_t));
                 filled[i] = true;
             }
+            const uint64_t t = cost ? os_mono_ns() : 0;
+            modes_sprites_touched = modes_sprite_pixels = 0;
             p->sprite_fn[i]((int16_t)y, (int16_t)W, plane[i], p->sprite_config[i], p->sprite_length[i]);
+            if (cost)
+            {
+                cost->sprite_ns[i] = (uint32_t)(os_mono_ns() - t);
+                cost->sprites[i] = (uint16_t)modes_sprites_touched;
+                cost->sprite_pixels[i] = modes_sprite_pixels;
+            }
         }
     }
 
-    uint32_t *dst = fb + (size_t)y * W;
-    for (int x = 0; x < W; x++)
+    const uint16_t *src[VPX_PLANES];
+    for (int i = 0; i < VPX_PLANES; i++)
+        src[i] = filled[i] ? plane[i] : NULL;
+    vpx_composite(fb + (size_t)y * W, src, W);
+}
+
+/* Render workers. Drawing a line is most of a frame's host time and the CPU
+ * does not wait on pixels, so lines can be drawn on other cores while the
+ * 6502 runs on. A queued line must still draw what it would have drawn when
+ * the beam reached it: it carries a copy of its program and reads XRAM
+ * through a snapshot taken then (modes_xram, vga/sys/mem.h). Snapshots are
+ * shared by every line queued between two XRAM writes and brought up to date
+ * from sys/mem.h's page stamps, so a frame that writes a few bytes copies a
+ * few pages. A line with a console fill reads the terminal, which the
+ * emulation thread keeps changing; those draw here, as does everything while
+ * profiling or budgeting. What else a line reads — the fonts, a mode's
+ * per-line options, the canvas — only changes after vga_render_wait. */
+#define VGA_THREADS_MAX 16
+#define VGA_SNAPS 8
+
+typedef struct
+{
+    uint8_t mem[0x10000];
+    uint64_t stamp; /* mem_xram_writes when it was XRAM; 0 never filled */
+    uint64_t page[0x10000 >> MEM_XRAM_PAGE_SHIFT]; /* mem_xram_page_written then */
+    int refs;       /* lines queued or drawing from it */
+} vga_snap_t;
+
+typedef struct
+{
+    vga_prog_t prog;
+    int16_t y, width;
+    uint32_t *fb;
+    vga_snap_t *snap;
+} vga_job_t;
+
+static struct
+{
+    int n;
+    os_thread *thread[VGA_THREADS_MAX];
+    os_lock *lock;
+    os_cond *work, *done;
+    bool quit;
+    vga_job_t job[VGA_PROG_MAX];
+    unsigned head, tail; /* queued lines are [tail, head) */
+    unsigned busy;       /* queued or drawing */
+    vga_snap_t *snap;    /* [VGA_SNAPS] */
+    vga_snap_t *newest;
+} g_pool;
+
+static void vga_worker(void *arg)
+{
+    (void)arg;
+    os_lock_acquire(g_pool.lock);
+    for (;;)
+    {
+        while (g_pool.tail == g_pool.head && !g_pool.quit)
+            os_cond_wait(g_pool.work, g_pool.lock);
+        if (g_pool.tail == g_pool.head)
+            break;
+        vga_job_t *job = &g_pool.job[g_pool.tail++ % VGA_PROG_MAX];
+        os_lock_release(g_pool.lock);
+        modes_xram = job->snap->mem;
+        modes_xram_stamp = &job->snap->stamp;
+        modes_xram_pages = job->snap->page;
+        draw_line(&job->prog, job->y, job->width, job->fb, NULL);
+        os_lock_acquire(g_pool.lock);
+        job->snap->refs--;
+        g_pool.busy--;
+        os_cond_broadcast(g_pool.done);
+    }
+    os_lock_release(g_pool.lock);
+}
+
+void vga_render_wait(void)
+{
+    if (!g_pool.n)
+        return;
+    os_lock_acquire(g_pool.lock);
+    while (g_pool.busy)
+        os_cond_wait(g_pool.done, g_pool.lock);
+    os_lock_release(g_pool.lock);
+}
+
+/* XRAM as it is now, for lines about to be queued. Only this thread writes a
+ * snapshot, and only one no line holds. */
+static vga_snap_t *vga_snap_take(void)
+{
+    vga_snap_t *s = g_pool.newest;
+    if (s && s->stamp == mem_xram_writes)
+        return s;
+    os_lock_acquire(g_pool.lock);
+    for (;;)
+    {
+        s = NULL;
+        for (int i = 0; i < VGA_SNAPS; i++)
+            if (!g_pool.snap[i].refs && (!s || g_pool.snap[i].stamp > s->stamp))
+                s = &g_pool.snap[i]; /* the freshest free one copies least */
+        if (s)
+            break;
+        os_cond_wait(g_pool.done, g_pool.lock);
+    }
+    os_lock_release(g_pool.lock);
+    for (int page = 0; page < 0x10000 >> MEM_XRAM_PAGE_SHIFT; page++)
+        if (!s->stamp || mem_xram_page_written[page] > s->stamp)
+            memcpy(s->mem + (page << MEM_XRAM_PAGE_SHIFT),
+                   (const uint8_t *)xram + (page << MEM_XRAM_PAGE_SHIFT),
+                   1u << MEM_XRAM_PAGE_SHIFT);
+    memcpy(s->page, mem_xram_page_written, sizeof s->page);
+    s->stamp = mem_xram_writes;
+    g_pool.newest = s;
+    return s;
+}
+
+static void vga_pool_stop(void)
+{
+    if (g_pool.n)
+    {
+        vga_render_wait();
+        os_lock_acquire(g_pool.lock);
+        g_pool.quit = true;
+        os_cond_broadcast(g_pool.work);
+        os_lock_release(g_pool.lock);
+        for (int i = 0; i < g_pool.n; i++)
+            os_thread_join(g_pool.thread[i]);
+    }
+    if (g_pool.done)
+        os_cond_free(g_pool.done);
+    if (g_pool.work)
+        os_cond_free(g_pool.work);
+    if (g_pool.lock)
+        os_lock_free(g_pool.lock);
+    free(g_pool.snap);
+    memset(&g_pool, 0, sizeof g_pool);
+}
+
+bool vga_set_render_threads(int n)
+{
+    vga_pool_stop();
+    if (n <= 0)
+        return true;
+    if (n > VGA_THREADS_MAX)
+        n = VGA_THREADS_MAX;
+    const vpx_variant_t *v;
+    vpx_variants(&v); /* settle the compositor's pick before anyone races it */
+    g_pool.snap = calloc(VGA_SNAPS, sizeof *g_pool.snap);
+    g_pool.lock = os_lock_new();
+    g_pool.work = os_cond_new();
+    g_pool.done = os_cond_new();
+    if (!g_pool.snap || !g_pool.lock || !g_pool.work || !g_pool.done)
     {
-        uint16_t px = filled[0] ? plane[0][x] : 0;
-        for (int i = 1; i < SCANVIDEO_PLANE_COUNT; i++)
-            if (filled[i] && (plane[i][x] & SCANVIDEO_ALPHA_MASK))
-                px = plane[i][x];
-        dst[x] = rgb555_to_rgba8(px);
+        vga_pool_stop();
+        return false;
     }
+    while (g_pool.n < n)
+    {
+        os_thread *t = os_thread_start(vga_worker, NULL);
+        if (!t)
+            break;
+        g_pool.thread[g_pool.n++] = t;
+    }
+    if (!g_pool.n)
+    {
+        vga_pool_stop();
+        return false;
+    }
+    return true;
+}
+
+int vga_render_threads(void)
+{
+    return g_pool.n;
+}
+
+/* Whether a worker may draw line y: every fill is one whose reads the modes
+ * can describe (all XRAM), so none is the console's. */
+static bool vga_line_poolable(int y)
+{
+    const vga_prog_t *p = &g_prog[y];
+    for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
+    {
+        modes_span_t spans[MODES_SPANS_MAX];
+        if (p->fill_fn[i] && vga_fill_spans(p, i, y, spans) < 0)
+            return false;
+    }
+    return true;
+}
+
+static void vga_render_queue(int y)
+{
+    vga_snap_t *snap = vga_snap_take();
+    os_lock_acquire(g_pool.lock);
+    while (g_pool.busy == VGA_PROG_MAX)
+        os_cond_wait(g_pool.done, g_pool.lock);
+    vga_job_t *job = &g_pool.job[g_pool.head++ % VGA_PROG_MAX];
+    job->prog = g_prog[y];
+    job->y = (int16_t)y;
+    job->width = g_canvas_w;
+    job->fb = g_framebuffer;
+    job->snap = snap;
+    snap->refs++;
+    g_pool.busy++;
+    os_cond_broadcast(g_pool.work);
+    os_lock_release(g_pool.lock);
 }
 
 /* Render scanline y of the current frame into the registered framebuffer,
  * interleaved with the CPU by sys_run_frame so mid-frame state changes land on
- * later lines (raster effects), matching the real per-scanline VGA scanout. */
+ * later lines (raster effects), matching the real per-scanline VGA scanout.
+ * With render workers the line may still be drawing on return; the frame is
+ * complete after vga_render_wait. */
 void vga_render_scanline(int y)
 {
-    if (g_framebuffer)
-        render_scanline(y, g_framebuffer);
+    if (!g_framebuffer)
+        return;
+    const bool measured = g_profile || g_budget;
+    if (!g_redraw_all && !measured && vga_line_current(y))
+        return;
+    if (g_pool.n && !measured && vga_line_poolable(y))
+        vga_render_queue(y);
+    else
+    {
+        vga_line_cost_t line_cost;
+        vga_line_cost_t *cost = g_profile ? &g_prof_line[y] : measured ? &line_cost : NULL;
+        draw_line(&g_prog[y], y, g_canvas_w, g_framebuffer, cost);
+        if (g_profile)
+            vga_profile_add(y, cost);
+        if (g_budget)
+            vga_budget_add(y, vga_budget_cycles(&g_prog[y], y, cost));
+    }
+    g_line_drawn[y] = mem_xram_writes;
+    g_lines_drawn++;
 }
@@ -37,6 +37,11 @@ int vga_vsync_scanline(void);
 void vga_render_scanline(int y);
 void vga_canvas_size(int *w, int *h);
 
+/* Savestate section (sys/sst.h): the canvas and the per-scanline program
+ * table. */
+size_t vga_state_save(void *buf);
+bool vga_state_load(const void *buf, size_t len);
+
 /* The largest canvas (the 640x480 boot console); framebuffer owners size
  * their storage with these. */
 #define VGA_MAX_WIDTH 640
@@ -53,6 +58,96 @@ void vga_set_framebuffer(uint32_t *fb);
  * without owning them (a screenshot, a frame hash). NULL when none is set. */
 uint32_t *vga_get_framebuffer(void);
 
+/* Only the scanlines whose inputs changed since they were last drawn are
+ * drawn again; the rest keep last frame's pixels. A caller that writes into
+ * the framebuffer itself sets it again, which forgets every line. redraw_all
+ * draws every line every frame regardless, for a test that wants both ways
+ * of reaching a frame to compare. */
+void vga_set_redraw_all(bool redraw_all);
+uint64_t vga_lines_drawn(void); /* diagnostic: scanlines actually drawn */
+
+/* Render workers: n threads draw queued scanlines while the CPU runs on, each
+ * from the XRAM and program its line had when the beam reached it, so the
+ * pixels are the ones a serial render draws. 0 (the default) draws every line
+ * on the caller. False, drawing serially, when the host has no threads.
+ * Console lines, and every line while profiling or budgeting, always draw
+ * on the caller. */
+bool vga_set_render_threads(int n);
+int vga_render_threads(void);
+
+/* Wait until every queued line is in the framebuffer. sys_run_frame does at
+ * frame end; anything that changes what a queued line reads (a mode's
+ * programming, the canvas, the font) does first. */
+void vga_render_wait(void);
+
+/* Render profile: what each scanline's renderers cost on the host, plane by
+ * plane, and how many sprites each sprite renderer drew some of, covering
+ * how many pixels. The real VGA must finish a line's renderers inside a
+ * fixed budget or drop it, so a program whose lines stand out here is one
+ * to look at before it ships. Host nanoseconds are not RP2350 cycles; the
+ * shape is what carries over (the render budget below estimates cycles).
+ * While on, every line is drawn every frame, as the hardware draws them. */
+#define VGA_PLANE_COUNT 3
+
+typedef struct
+{
+    uint32_t fill_ns[VGA_PLANE_COUNT];
+    uint32_t sprite_ns[VGA_PLANE_COUNT];
+    uint16_t sprites[VGA_PLANE_COUNT];
+    uint32_t sprite_pixels[VGA_PLANE_COUNT];
+} vga_line_cost_t;
+
+void vga_set_profile(bool on);
+bool vga_profiling(void);
+void vga_profile_reset(void);
+
+/* [VGA_PROG_MAX], each line as it was last drawn: the last frame. */
+const vga_line_cost_t *vga_profile_lines(void);
+
+/* Every line and plane drawn since the reset, mean and max per column.
+ * Prints why on stderr and returns false. */
+bool vga_profile_write_csv(const char *path);
+
+/* Render budget: what each scanline would cost the VGA's RP2350, from the
+ * modes' cost estimates (modeN_cost, vga/modes/modes.h), and whether it
+ * would be ready when the beam reaches it. The VGA's two cores take lines
+ * in turn as they finish, up to ten lines ahead of the beam; a line not
+ * ready in time is shown blue, and the cores skip to the line the beam
+ * wants next. While on, every line is drawn every frame. REPORT names a
+ * frame's worst late lines on stderr whenever they change; SHOW draws a
+ * late line blue, as the VGA shows it. */
+#define VGA_BUDGET_ON 1
+#define VGA_BUDGET_REPORT 2
+#define VGA_BUDGET_SHOW 4
+
+typedef struct
+{
+    uint32_t cycles; /* its renderers' estimated RP2350 cycles */
+    int32_t slack;   /* cycles ready before the beam reached it; < 0 late */
+} vga_line_budget_t;
+
+void vga_set_budget(unsigned flags); /* 0 turns it off */
+unsigned vga_budget(void);
+uint32_t vga_budget_line_cycles(void); /* what one core has for a line */
+
+/* [VGA_PROG_MAX], the last frame's lines. */
+const vga_line_budget_t *vga_budget_lines(void);
+
+/* The last frame's late lines, worst first, up to max of them into lines;
+ * returns how many there were. */
+int vga_budget_late(int16_t *lines, int max);
+
+/* Once a rendered frame is done: count its late lines and report them. */
+void vga_budget_frame(void);
+
+/* Sprite checks: at vsync, once XRAM or a program has changed, each mode 4
+ * sprite whose opacity metadata disagrees with its pixels (mode4_check,
+ * vga/modes/mode4.h) is named on stderr, once per image. Off by default;
+ * turning it on forgets what was named. */
+void vga_set_sprite_check(bool on);
+void vga_check_sprites(void);
+unsigned vga_sprites_flagged(void); /* images named since it was turned on */
+
 /* ------------------------------------------------------------------ */
 /* Firmware VGA ABI reached by the vendored term.c / rln.c / the mode  */
 /* renderers through the firmware path "sys/vga.h", which the emu       */
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "emu/sys/vpx.h"
+#include "host/simd.h"
+#include "vga/scanvideo/pixel_format.h"
+#include <stdbool.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VPX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* AVX2 is chosen at run time; see host/simd.h. */
+#if VPX_SSE2 && SIMD_X86
+#define VPX_AVX2 1
+#define VPX_AVX2_FN SIMD_AVX2_FN
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define VPX_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__wasm_simd128__)
+#define VPX_WASM 1
+#include <wasm_simd128.h>
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Scalar: the reference                                               */
+/* ------------------------------------------------------------------ */
+
+/* Computed rather than looked up in a 256 KB value-indexed table: the shifts
+ * vectorize, and keeping the cache free for the CPU core and framebuffer beats
+ * a table that thrashes on color-rich content (and it's a large fraction of L2
+ * on the ARM/WASM targets). */
+static inline uint32_t vpx_rgba8(uint16_t px)
+{
+    uint32_t r5 = SCANVIDEO_R5_FROM_PIXEL(px);
+    uint32_t g5 = SCANVIDEO_G5_FROM_PIXEL(px);
+    uint32_t b5 = SCANVIDEO_B5_FROM_PIXEL(px);
+    uint32_t r = (r5 << 3) | (r5 >> 2);
+    uint32_t g = (g5 << 3) | (g5 >> 2);
+    uint32_t b = (b5 << 3) | (b5 >> 2);
+    return r | (g << 8) | (b << 16) | 0xFF000000u;
+}
+
+/* Pixels [x, width) the scalar way: the reference whole, and the tail of a
+ * line that is not a multiple of a vector. */
+static void vpx_tail(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int x, int width)
+{
+    for (; x < width; x++)
+    {
+        uint16_t px = plane[0] ? plane[0][x] : 0;
+        for (int i = 1; i < VPX_PLANES; i++)
+            if (plane[i] && (plane[i][x] & SCANVIDEO_ALPHA_MASK))
+                px = plane[i][x];
+        dst[x] = vpx_rgba8(px);
+    }
+}
+
+static void vpx_scalar(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    vpx_tail(dst, plane, 0, width);
+}
+
+/* Each vector variant is the same five steps on 8 or 16 lanes of uint16:
+ * pick the pixel through the planes by alpha bit, split the three 5-bit
+ * channels, widen each with (c << 3) | (c >> 2), pack R|G<<8 and B|0xFF00,
+ * and interleave those two into the 32-bit RGBA8 pixels. */
+
+/* ------------------------------------------------------------------ */
+/* SSE2 and AVX2                                                       */
+/* ------------------------------------------------------------------ */
+
+#if VPX_SSE2
+static void vpx_sse2(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    const __m128i alpha = _mm_set1_epi16(SCANVIDEO_ALPHA_MASK);
+    const __m128i c5 = _mm_set1_epi16(0x1F);
+    const __m128i opaque = _mm_set1_epi16((short)0xFF00);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i px = plane[0] ? _mm_loadu_si128((const __m128i *)&plane[0][x])
+                              : _mm_setzero_si128();
+        for (int i = 1; i < VPX_PLANES; i++)
+            if (plane[i])
+            {
+                __m128i p = _mm_loadu_si128((const __m128i *)&plane[i][x]);
+                __m128i m = _mm_cmpeq_epi16(_mm_and_si128(p, alpha), alpha);
+                px = _mm_or_si128(_mm_and_si128(m, p), _mm_andnot_si128(m, px));
+            }
+        __m128i r = _mm_and_si128(px, c5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(px, 6), c5);
+        __m128i b = _mm_srli_epi16(px, 11);
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, opaque);
+        _mm_storeu_si128((__m128i *)&dst[x], _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i *)&dst[x + 4], _mm_unpackhi_epi16(rg, ba));
+    }
+    vpx_tail(dst, plane, x, width);
+}
+#endif
+
+#if VPX_AVX2
+static VPX_AVX2_FN void vpx_avx2(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    const __m256i alpha = _mm256_set1_epi16(SCANVIDEO_ALPHA_MASK);
+    const __m256i c5 = _mm256_set1_epi16(0x1F);
+    const __m256i opaque = _mm256_set1_epi16((short)0xFF00);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i px = plane[0] ? _mm256_loadu_si256((const __m256i *)&plane[0][x])
+                              : _mm256_setzero_si256();
+        for (int i = 1; i < VPX_PLANES; i++)
+            if (plane[i])
+            {
+                __m256i p = _mm256_loadu_si256((const __m256i *)&plane[i][x]);
+                __m256i m = _mm256_cmpeq_epi16(_mm256_and_si256(p, alpha), alpha);
+                px = _mm256_blendv_epi8(px, p, m);
+            }
+        __m256i r = _mm256_and_si256(px, c5);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(px, 6), c5);
+        __m256i b = _mm256_srli_epi16(px, 11);
+        r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+        g = _mm256_or_si256(_mm256_slli_epi16(g, 3), _mm256_srli_epi16(g, 2));
+        b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, opaque);
+        /* The unpacks work within each 128-bit half: lo holds pixels 0-3 and
+         * 8-11, hi 4-7 and 12-15. */
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256((__m256i *)&dst[x], _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)&dst[x + 8], _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    vpx_tail(dst, plane, x, width);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* NEON                                                                */
+/* ------------------------------------------------------------------ */
+
+#if VPX_NEON
+static void vpx_neon(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    const uint16x8_t alpha = vdupq_n_u16(SCANVIDEO_ALPHA_MASK);
+    const uint16x8_t c5 = vdupq_n_u16(0x1F);
+    const uint16x8_t opaque = vdupq_n_u16(0xFF00);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint16x8_t px = plane[0] ? vld1q_u16(&plane[0][x]) : vdupq_n_u16(0);
+        for (int i = 1; i < VPX_PLANES; i++)
+            if (plane[i])
+            {
+                uint16x8_t p = vld1q_u16(&plane[i][x]);
+                px = vbslq_u16(vtstq_u16(p, alpha), p, px);
+            }
+        uint16x8_t r = vandq_u16(px, c5);
+        uint16x8_t g = vandq_u16(vshrq_n_u16(px, 6), c5);
+        uint16x8_t b = vshrq_n_u16(px, 11);
+        r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+        g = vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2));
+        b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+        uint16x8x2_t z = vzipq_u16(vorrq_u16(r, vshlq_n_u16(g, 8)), vorrq_u16(b, opaque));
+        vst1q_u32(&dst[x], vreinterpretq_u32_u16(z.val[0]));
+        vst1q_u32(&dst[x + 4], vreinterpretq_u32_u16(z.val[1]));
+    }
+    vpx_tail(dst, plane, x, width);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* WASM SIMD128                                                        */
+/* ------------------------------------------------------------------ */
+
+/* The web build compiles this file with -msimd128. WebAssembly has no way to
+ * ask, so unlike AVX2 it is the build's choice, not the CPU's. */
+#if VPX_WASM
+static void vpx_wasm(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    const v128_t alpha = wasm_i16x8_splat(SCANVIDEO_ALPHA_MASK);
+    const v128_t c5 = wasm_i16x8_splat(0x1F);
+    const v128_t opaque = wasm_i16x8_splat((int16_t)0xFF00);
+    const v128_t zero = wasm_i16x8_splat(0);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        v128_t px = plane[0] ? wasm_v128_load(&plane[0][x]) : zero;
+        for (int i = 1; i < VPX_PLANES; i++)
+            if (plane[i])
+            {
+                v128_t p = wasm_v128_load(&plane[i][x]);
+                px = wasm_v128_bitselect(p, px, wasm_i16x8_ne(wasm_v128_and(p, alpha), zero));
+            }
+        v128_t r = wasm_v128_and(px, c5);
+        v128_t g = wasm_v128_and(wasm_u16x8_shr(px, 6), c5);
+        v128_t b = wasm_u16x8_shr(px, 11);
+        r = wasm_v128_or(wasm_i16x8_shl(r, 3), wasm_u16x8_shr(r, 2));
+        g = wasm_v128_or(wasm_i16x8_shl(g, 3), wasm_u16x8_shr(g, 2));
+        b = wasm_v128_or(wasm_i16x8_shl(b, 3), wasm_u16x8_shr(b, 2));
+        v128_t rg = wasm_v128_or(r, wasm_i16x8_shl(g, 8));
+        v128_t ba = wasm_v128_or(b, opaque);
+        wasm_v128_store(&dst[x], wasm_i16x8_shuffle(rg, ba, 0, 8, 1, 9, 2, 10, 3, 11));
+        wasm_v128_store(&dst[x + 4], wasm_i16x8_shuffle(rg, ba, 4, 12, 5, 13, 6, 14, 7, 15));
+    }
+    vpx_tail(dst, plane, x, width);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Selection                                                           */
+/* ------------------------------------------------------------------ */
+
+static vpx_variant_t vpx_table[4];
+static size_t vpx_count;
+
+/* Widest last. Idempotent: a second caller racing the first writes the same
+ * table. */
+static void vpx_select(void)
+{
+    size_t n = 0;
+    vpx_table[n++] = (vpx_variant_t){"scalar", vpx_scalar};
+#if VPX_SSE2
+    vpx_table[n++] = (vpx_variant_t){"sse2", vpx_sse2};
+#endif
+#if VPX_AVX2
+    if (simd_cpu_avx2())
+        vpx_table[n++] = (vpx_variant_t){"avx2", vpx_avx2};
+#endif
+#if VPX_NEON
+    vpx_table[n++] = (vpx_variant_t){"neon", vpx_neon};
+#endif
+#if VPX_WASM
+    vpx_table[n++] = (vpx_variant_t){"simd128", vpx_wasm};
+#endif
+    vpx_count = n;
+}
+
+size_t vpx_variants(const vpx_variant_t **variants)
+{
+    if (!vpx_count)
+        vpx_select();
+    *variants = vpx_table;
+    return vpx_count;
+}
+
+void vpx_composite(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width)
+{
+    if (!vpx_count)
+        vpx_select();
+    vpx_table[vpx_count - 1].fn(dst, plane, width);
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _EMU_SYS_VPX_H_
+#define _EMU_SYS_VPX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The last step of every scanline: three planes of RGB555 (bit 5 the alpha)
+ * composited as scanvideo's PIO does and widened to the RGBA8 (0xAABBGGRR)
+ * the window presents. Plane 0 is the unconditional base, black when it is
+ * NULL; a higher plane's pixel replaces what is under it where its alpha bit
+ * is set. Each 5-bit channel widens as (c << 3) | (c >> 2).
+ *
+ * At 640x480x60 this is eighteen million pixels a second, so it comes in
+ * vector variants: SSE2 and AVX2, NEON, and WASM SIMD128. The scalar one is
+ * the reference; the others are held to it bit for bit over every input
+ * (tests/vid/test_vpx.c). vpx_composite picks the widest the CPU runs, once,
+ * on first use. */
+
+#define VPX_PLANES 3
+
+typedef void (*vpx_fn_t)(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width);
+
+void vpx_composite(uint32_t *dst, const uint16_t *const plane[VPX_PLANES], int width);
+
+/* Every variant this build has and this CPU can run, the scalar reference
+ * first and the one vpx_composite uses last. */
+typedef struct
+{
+    const char *name;
+    vpx_fn_t fn;
+} vpx_variant_t;
+
+size_t vpx_variants(const vpx_variant_t **variants);
+
+#endif /* _EMU_SYS_VPX_H_ */
@@ -15,7 +15,7 @@
 
 import argparse
 
-from rp6502_rom import API_OP, RIA_TX, Asm, image
+from rp6502_rom import API_OP, RIA_TX, Asm, Rom, image
 
 
 class Prog(Asm):
@@ -94,6 +94,26 @@ def psg_pre_prog():
     return p.b
 
 
+def psg_held_prog():
+    """psg_prog's note with its frequency left at zero, so the envelope
+    runs up and holds while the phase stands still, then "held" on the
+    console. Whatever the gate's timing was, a frequency written between
+    two frames starts the tone at phase zero on the first sample of the
+    next — which is what lets tests/host/emu/audio.txt pin its CRC."""
+    p = Prog()
+    page = 0x8000
+    p.xreg(0, 1, 0, page)
+    p.settle()
+    for reg, val in ((2, 0x80), (3, 0x00), (4, 0x00), (5, 0x00), (6, 0x01)):
+        p.poke(page + reg, val)
+    for ch in b"held\r\n":
+        p.lda(ch)
+        p.putc_a()
+    p.spin()
+    # The other seven channels start silent whatever XRAM held.
+    return Rom().program(p).record(0x10000 + page, bytes(64))
+
+
 def opl_prog():
     p = Prog()
     page = 0xF000
@@ -173,6 +193,7 @@ def main():
     ap = argparse.ArgumentParser()
     ap.add_argument("--emit-psg")
     ap.add_argument("--emit-psg-pre")
+    ap.add_argument("--emit-psg-held")
     ap.add_argument("--emit-opl")
     ap.add_argument("--emit-opl-exit")
     ap.add_argument("--emit-bel")
@@ -182,6 +203,8 @@ def main():
         print(f"psg.rp6502 {emit(a.emit_psg, psg_prog())} bytes")
     if a.emit_psg_pre:
         print(f"psg_pre.rp6502 {emit(a.emit_psg_pre, psg_pre_prog())} bytes")
+    if a.emit_psg_held:
+        print(f"psg_held.rp6502 {psg_held_prog().write(a.emit_psg_held)} bytes")
     if a.emit_opl:
         print(f"opl.rp6502 {emit(a.emit_opl, opl_prog())} bytes")
     if a.emit_opl_exit:
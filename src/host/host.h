@@ -69,6 +69,25 @@ uint64_t os_entropy_64(void);            /* seed material from the host RNG/cloc
 uint64_t os_mono_ns(void);               /* monotonic clock, nanoseconds */
 void os_sleep_until_ns(uint64_t target); /* frame pacer; no-op where the present already paces */
 
+/* Threads, for work the emulation thread hands off. os_thread_start returns
+ * NULL where the host has none to give (the web build has no pthreads); the
+ * caller then does the work itself. A lock and a condition variable are all
+ * the coordination the callers need. */
+typedef struct os_thread os_thread;
+typedef struct os_lock os_lock;
+typedef struct os_cond os_cond;
+os_thread *os_thread_start(void (*fn)(void *), void *arg);
+void os_thread_join(os_thread *t);
+os_lock *os_lock_new(void);
+void os_lock_free(os_lock *l);
+void os_lock_acquire(os_lock *l);
+void os_lock_release(os_lock *l);
+os_cond *os_cond_new(void);
+void os_cond_free(os_cond *c);
+void os_cond_wait(os_cond *c, os_lock *l); /* l held on entry and return */
+void os_cond_broadcast(os_cond *c);
+int os_cpu_count(void); /* online logical CPUs, at least 1 */
+
 /* Broken-down host time (local zone / UTC). False when t is out of the host's range. */
 bool os_localtime(time_t t, struct tm *out);
 bool os_gmtime(time_t t, struct tm *out);
@@ -13,6 +13,7 @@
 #include "ria/api/oem.h"
 #include <errno.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +30,99 @@ uint64_t os_mono_ns(void)
     return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
+/* ---- threads ---- */
+
+struct os_thread
+{
+    pthread_t id;
+    void (*fn)(void *);
+    void *arg;
+};
+
+struct os_lock
+{
+    pthread_mutex_t m;
+};
+
+struct os_cond
+{
+    pthread_cond_t c;
+};
+
+static void *os_thread_main(void *p)
+{
+    os_thread *t = p;
+    t->fn(t->arg);
+    return NULL;
+}
+
+os_thread *os_thread_start(void (*fn)(void *), void *arg)
+{
+    os_thread *t = malloc(sizeof *t);
+    if (!t)
+        return NULL;
+    t->fn = fn;
+    t->arg = arg;
+    if (pthread_create(&t->id, NULL, os_thread_main, t))
+    {
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void os_thread_join(os_thread *t)
+{
+    pthread_join(t->id, NULL);
+    free(t);
+}
+
+os_lock *os_lock_new(void)
+{
+    os_lock *l = malloc(sizeof *l);
+    if (l && pthread_mutex_init(&l->m, NULL))
+    {
+        free(l);
+        return NULL;
+    }
+    return l;
+}
+
+void os_lock_free(os_lock *l)
+{
+    pthread_mutex_destroy(&l->m);
+    free(l);
+}
+
+void os_lock_acquire(os_lock *l) { pthread_mutex_lock(&l->m); }
+void os_lock_release(os_lock *l) { pthread_mutex_unlock(&l->m); }
+
+os_cond *os_cond_new(void)
+{
+    os_cond *c = malloc(sizeof *c);
+    if (c && pthread_cond_init(&c->c, NULL))
+    {
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void os_cond_free(os_cond *c)
+{
+    pthread_cond_destroy(&c->c);
+    free(c);
+}
+
+void os_cond_wait(os_cond *c, os_lock *l) { pthread_cond_wait(&c->c, &l->m); }
+void os_cond_broadcast(os_cond *c) { pthread_cond_broadcast(&c->c); }
+
+int os_cpu_count(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
 /* ---- broken-down time ---- */
 
 bool os_localtime(time_t t, struct tm *out)
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef _HOST_SIMD_H_
+#define _HOST_SIMD_H_
+
+/* x86 vector paths the host build does not target, picked at run time.
+ * SIMD_X86 is set when the compiler will emit SSE4.1 or AVX2 for a single
+ * function of a build that otherwise targets plain x86-64; mark those with
+ * SIMD_SSE41_FN and SIMD_AVX2_FN, and call them only when the matching
+ * simd_cpu_ probe says so. */
+
+#include <stdbool.h>
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64)) &&                     \
+    (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIMD_SSE41_FN
+#define SIMD_AVX2_FN
+#else
+#define SIMD_SSE41_FN __attribute__((target("sse4.1")))
+#define SIMD_AVX2_FN __attribute__((target("avx2")))
+#endif
+
+/* The CPU has it. */
+static inline bool simd_cpu_sse41(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+/* The CPU has it and the OS saves the YMM registers. */
+static inline bool simd_cpu_avx2(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27))) /* OSXSAVE */
+        return false;
+    if ((_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif /* SIMD_X86 */
+
+#endif /* _HOST_SIMD_H_ */
@@ -51,6 +51,91 @@ void os_sleep_until_ns(uint64_t target)
     (void)target; /* the D3D11 Present already paces the loop */
 }
 
+/* ---- threads ---- */
+
+struct os_thread
+{
+    HANDLE h;
+    void (*fn)(void *);
+    void *arg;
+};
+
+struct os_lock
+{
+    SRWLOCK l;
+};
+
+struct os_cond
+{
+    CONDITION_VARIABLE c;
+};
+
+static DWORD WINAPI os_thread_main(LPVOID p)
+{
+    os_thread *t = p;
+    t->fn(t->arg);
+    return 0;
+}
+
+os_thread *os_thread_start(void (*fn)(void *), void *arg)
+{
+    os_thread *t = malloc(sizeof *t);
+    if (!t)
+        return NULL;
+    t->fn = fn;
+    t->arg = arg;
+    t->h = CreateThread(NULL, 0, os_thread_main, t, 0, NULL);
+    if (!t->h)
+    {
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void os_thread_join(os_thread *t)
+{
+    WaitForSingleObject(t->h, INFINITE);
+    CloseHandle(t->h);
+    free(t);
+}
+
+os_lock *os_lock_new(void)
+{
+    os_lock *l = malloc(sizeof *l);
+    if (l)
+        InitializeSRWLock(&l->l);
+    return l;
+}
+
+void os_lock_free(os_lock *l) { free(l); }
+void os_lock_acquire(os_lock *l) { AcquireSRWLockExclusive(&l->l); }
+void os_lock_release(os_lock *l) { ReleaseSRWLockExclusive(&l->l); }
+
+os_cond *os_cond_new(void)
+{
+    os_cond *c = malloc(sizeof *c);
+    if (c)
+        InitializeConditionVariable(&c->c);
+    return c;
+}
+
+void os_cond_free(os_cond *c) { free(c); }
+
+void os_cond_wait(os_cond *c, os_lock *l)
+{
+    SleepConditionVariableSRW(&c->c, &l->l, INFINITE, 0);
+}
+
+void os_cond_broadcast(os_cond *c) { WakeAllConditionVariable(&c->c); }
+
+int os_cpu_count(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+}
+
 /* ---- broken-down time ---- */
 
 bool os_localtime(time_t t, struct tm *out)
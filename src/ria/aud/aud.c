@@ -79,8 +79,11 @@ void aud_stop(void)
     bel_setup();
 }
 
-void aud_setup(void (*irq_fn)(void), uint32_t rate)
+void aud_setup(void (*irq_fn)(void),
+               void (*render_fn)(int16_t *l, int16_t *r, unsigned n),
+               uint32_t rate)
 {
+    (void)render_fn; /* the PWM wrap asks for one sample at a time */
     /* The rate is part of the identity. Comparing only the handler made
      * re-registering the same device at a new rate a silent no-op, which is
      * exactly what a host that hands back a different sample rate needs to
@@ -21,10 +21,14 @@
 void aud_init(void);
 void aud_stop(void);
 
-/* Setup an audio system, tears down any previous setup.
+/* Setup an audio system, tears down any previous setup. irq_fn makes one
+ * sample per interrupt; render_fn makes the same samples n at a time, for a
+ * host that generates in blocks. The RP2350 only ever takes the interrupt.
  */
 
-void aud_setup(void (*irq_fn)(void), uint32_t rate);
+void aud_setup(void (*irq_fn)(void),
+               void (*render_fn)(int16_t *l, int16_t *r, unsigned n),
+               uint32_t rate);
 
 /* Per-sample stereo output level and IRQ acknowledge, called from each audio
  * driver's sample handler. This is the seam where the machine stops being
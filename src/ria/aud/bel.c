@@ -7,6 +7,7 @@
 #include "ria/aud/aud.h"
 #include "ria/aud/bel.h"
 #include <pico/stdlib.h>
+#include <string.h>
 
 #if defined(DEBUG_RIA_AUD) || defined(DEBUG_RIA_AUD_BEL)
 #include <stdio.h>
@@ -310,6 +311,19 @@ generate:;
                      >> 12);
 }
 
+void bel_render(int16_t *buf, unsigned n, uint32_t rate)
+{
+    /* Nothing rings it from inside a block, so idle at the start is idle
+     * throughout; a bell that finishes partway answers zeros itself. */
+    if (!bel_state.active)
+    {
+        memset(buf, 0, n * sizeof *buf);
+        return;
+    }
+    for (unsigned i = 0; i < n; i++)
+        buf[i] = bel_sample(rate);
+}
+
 static __isr void
 __time_critical_func(bel_irq_handler)(void)
 {
@@ -320,11 +334,54 @@ __time_critical_func(bel_irq_handler)(void)
     int16_t sample = bel_sample(aud_native_rate());
     aud_out(sample, sample);
 }
+
+static void bel_irq_render(int16_t *l, int16_t *r, unsigned n)
+{
+    bel_render(l, n, aud_native_rate());
+    memcpy(r, l, n * sizeof *r);
+}
 #pragma GCC pop_options
 
 void bel_setup(void)
 {
     bel_state.noise1 = 0x67452301;
     bel_state.noise2 = 0xEFCDAB89;
-    aud_setup(bel_irq_handler, aud_native_rate());
+    aud_setup(bel_irq_handler, bel_irq_render, aud_native_rate());
+}
+
+/* Savestates: the queue and the voice playing from it. */
+typedef struct
+{
+    ria_bel_t queue[BEL_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t tail;
+    uint8_t state[sizeof bel_state];
+} bel_state_blob_t;
+
+size_t bel_state_save(void *buf)
+{
+    if (buf)
+    {
+        bel_state_blob_t s;
+        memset(&s, 0, sizeof s);
+        memcpy(s.queue, bel_queue, sizeof bel_queue);
+        s.head = bel_queue_head;
+        s.tail = bel_queue_tail;
+        memcpy(s.state, (const void *)&bel_state, sizeof bel_state);
+        memcpy(buf, &s, sizeof s);
+    }
+    return sizeof(bel_state_blob_t);
+}
+
+bool bel_state_load(const void *buf, size_t len)
+{
+    bel_state_blob_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    memcpy(bel_queue, s.queue, sizeof bel_queue);
+    bel_queue_head = s.head;
+    bel_queue_tail = s.tail;
+    memcpy((void *)&bel_state, s.state, sizeof bel_state);
+    return true;
 }
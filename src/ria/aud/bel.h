@@ -39,9 +39,16 @@ void bel_setup(void);
 // Called from IRQ context (BEL, PSG, or OPL handler).
 int16_t bel_sample(uint32_t rate);
 
+// The next n of them. An idle bell is one test for the block.
+void bel_render(int16_t *buf, unsigned n, uint32_t rate);
+
 // Queue a sound to play.
 void bel_add(const ria_bel_t *sound);
 
+// Savestates. save returns the size, writing buf unless it is NULL.
+size_t bel_state_save(void *buf);
+bool bel_state_load(const void *buf, size_t len);
+
 // Preset bell sounds
 extern const ria_bel_t bel_teletype;
 extern const ria_bel_t bel_nfc_fail;
@@ -28,30 +28,27 @@ static int16_t opl_sample;
 
 #pragma GCC push_options
 #pragma GCC optimize("O3")
-static void
-    __isr
-    __time_critical_func(opl_irq_handler)(void)
+/* Four times hot, and the clamp lets the loud parts square off — the
+ * machine has always run its OPL this way. It used to reach the same
+ * ratio by shifting emu8950's sixteen bits down to ten, which threw
+ * six of them away at the source, before any host with a better
+ * converter than the RP2350's PWM could see them. Multiplying instead
+ * of shifting keeps every bit and clips in exactly the same place. */
+static inline __attribute__((always_inline)) int16_t
+opl_mix(int16_t next, int16_t bel)
 {
-    aud_clear_irq();
-
-    // Output previous sample at start to minimize jitter
-    aud_out(opl_sample, opl_sample);
-    int16_t next;
-    OPL_calc_buffer(opl_emu8950, &next, 1);
-    /* Four times hot, and the clamp lets the loud parts square off — the
-     * machine has always run its OPL this way. It used to reach the same
-     * ratio by shifting emu8950's sixteen bits down to ten, which threw
-     * six of them away at the source, before any host with a better
-     * converter than the RP2350's PWM could see them. Multiplying instead
-     * of shifting keeps every bit and clips in exactly the same place. */
-    int32_t s = (int32_t)next * 4 + bel_sample(OPL_SAMPLE_RATE);
+    int32_t s = (int32_t)next * 4 + bel;
     if (s < AUD_SAMPLE_MIN)
         s = AUD_SAMPLE_MIN;
     if (s > AUD_SAMPLE_MAX)
         s = AUD_SAMPLE_MAX;
-    opl_sample = (int16_t)s;
+    return (int16_t)s;
+}
 
-    // Update opl regs from xram
+// Update opl regs from xram
+static inline __attribute__((always_inline)) void
+opl_drain(void)
+{
     uint8_t max_work = 8;
     while (max_work-- && xram_queue_tail != xram_queue_head)
     {
@@ -61,6 +58,53 @@ static void
                      xram_queue[tail][1]);
     }
 }
+
+static void
+    __isr
+    __time_critical_func(opl_irq_handler)(void)
+{
+    aud_clear_irq();
+
+    // Output previous sample at start to minimize jitter
+    aud_out(opl_sample, opl_sample);
+    int16_t next;
+    OPL_calc_buffer(opl_emu8950, &next, 1);
+    opl_sample = opl_mix(next, bel_sample(OPL_SAMPLE_RATE));
+    opl_drain();
+}
+
+/* The handler n times over. Register writes queued before the block go in
+ * a sample at a time, eight a sample, as they would have; once the queue
+ * is empty the rest of the block is one call into emu8950 and one into
+ * the bell. */
+#define OPL_RENDER_CHUNK 64
+
+void opl_render(int16_t *l, int16_t *r, unsigned n)
+{
+    int16_t next[OPL_RENDER_CHUNK];
+    int16_t bel[OPL_RENDER_CHUNK];
+    for (; n && xram_queue_tail != xram_queue_head; n--)
+    {
+        *l++ = *r++ = opl_sample;
+        OPL_calc_buffer(opl_emu8950, next, 1);
+        opl_sample = opl_mix(next[0], bel_sample(OPL_SAMPLE_RATE));
+        opl_drain();
+    }
+    while (n)
+    {
+        unsigned len = n < OPL_RENDER_CHUNK ? n : OPL_RENDER_CHUNK;
+        OPL_calc_buffer(opl_emu8950, next, len);
+        bel_render(bel, len, OPL_SAMPLE_RATE);
+        for (unsigned i = 0; i < len; i++)
+        {
+            l[i] = r[i] = opl_sample;
+            opl_sample = opl_mix(next[i], bel[i]);
+        }
+        l += len;
+        r += len;
+        n -= len;
+    }
+}
 #pragma GCC pop_options
 
 bool opl_xreg(uint16_t word)
@@ -82,6 +126,62 @@ bool opl_xreg(uint16_t word)
     xram_queue_page = word >> 8;
     memset(&xram[word], 0, 256);
     xram_queue_tail = xram_queue_head;
-    aud_setup(opl_irq_handler, OPL_SAMPLE_RATE);
+    aud_setup(opl_irq_handler, opl_render, OPL_SAMPLE_RATE);
+    return true;
+}
+
+/* Savestates. emu8950 is a struct with two kinds of pointer in each slot:
+ * one at its own patch, put back by taking the address again, and one into
+ * a waveform table private to emu8950.c, which a pending waveform update
+ * (UPDATE_WS, bit 0) recomputes before the next sample reads it. */
+#define OPL_UPDATE_WS 1
+
+typedef struct
+{
+    bool present;
+    int16_t sample;
+    OPL chip;
+} opl_state_t;
+
+size_t opl_state_save(void *buf)
+{
+    if (buf)
+    {
+        /* A 3 KB struct: built in place rather than on the stack. */
+        opl_state_t *s = buf;
+        memset(s, 0, sizeof *s);
+        s->present = opl_emu8950 != NULL;
+        s->sample = opl_sample;
+        if (opl_emu8950)
+            memcpy(&s->chip, opl_emu8950, sizeof *opl_emu8950);
+    }
+    return sizeof(opl_state_t);
+}
+
+bool opl_state_reserve(const void *buf, size_t len)
+{
+    const opl_state_t *s = buf;
+    if (len != sizeof *s)
+        return false;
+    if (s->present && !opl_emu8950)
+        opl_emu8950 = OPL_new(OPL_CLOCK_RATE, OPL_SAMPLE_RATE);
+    return !s->present || opl_emu8950;
+}
+
+bool opl_state_load(const void *buf, size_t len)
+{
+    const opl_state_t *s = buf;
+    if (!opl_state_reserve(buf, len))
+        return false;
+    opl_sample = s->sample;
+    if (!s->present)
+        return true;
+    memcpy(opl_emu8950, &s->chip, sizeof *opl_emu8950);
+    for (unsigned i = 0; i < 18; i++)
+    {
+        OPL_SLOT *slot = &opl_emu8950->slot[i];
+        slot->patch = &slot->__patch;
+        slot->update_requests |= OPL_UPDATE_WS;
+    }
     return true;
 }
@@ -19,4 +19,19 @@
 
 bool opl_xreg(uint16_t word);
 
+/* The next n samples, exactly as n interrupts would have made them, for a
+ * host that wants them a block at a time.
+ */
+
+void opl_render(int16_t *l, int16_t *r, unsigned n);
+
+/* Savestates: the emu8950 chip and the sample it is holding. save returns
+ * the size and writes buf unless it is NULL. reserve allocates the chip a
+ * state needs, so that load, called after it, cannot fail.
+ */
+
+size_t opl_state_save(void *buf);
+bool opl_state_reserve(const void *buf, size_t len);
+bool opl_state_load(const void *buf, size_t len);
+
 #endif /* _RIA_AUD_OPL_H_ */
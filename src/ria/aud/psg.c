@@ -8,6 +8,9 @@
 #include "ria/aud/bel.h"
 #include "ria/aud/psg.h"
 #include "ria/sys/mem.h"
+#ifdef PSG_VECTOR
+#include "ria/aud/psv.h"
+#endif
 #include <pico/stdlib.h>
 #include <stddef.h>
 #include <string.h>
@@ -43,6 +46,12 @@ enum psg_adsr_state
     sustain,
 };
 
+#ifdef PSG_VECTOR
+_Static_assert(PSV_RELEASE == release && PSV_ATTACK == attack &&
+                   PSV_DECAY == decay && PSV_SUSTAIN == sustain,
+               "psv numbers the envelope states as psg does");
+#endif
+
 static volatile uint16_t psg_xaddr;
 
 static const uint32_t psg_vol_table[] = {
@@ -134,25 +143,97 @@ void psg_setup(uint32_t rate)
     }
 }
 
+/* One channel's registers, read out of XRAM and through the tables. A block
+ * of samples reads them once, at its start: the emulator lands a write to
+ * the page only between blocks (its aud_sync), so nothing a block would have
+ * read again can have moved. The interrupt has no block to spread them over
+ * and passes no voices: each register is read where it is used, as it
+ * always was, so a channel in release never looks at its attack. */
+struct psg_voice
+{
+    uint8_t wave;
+    uint8_t duty;
+    bool hold;
+    int32_t gain_l;
+    int32_t gain_r;
+    uint32_t attack_rate;
+    uint32_t attack_vol;
+    uint32_t decay_rate;
+    uint32_t decay_vol;
+    uint32_t release_rate;
+};
+
 #pragma GCC push_options
 #pragma GCC optimize("O3")
-static void
-    __isr
-    __time_critical_func(psg_irq_handler)(void)
+/* Pan -64 is off rather than hard left; a gain of zero is the same silence
+ * the old skip was. side is -1 for the left, 1 for the right. */
+static inline __attribute__((always_inline)) int32_t
+psg_pan_gain(const struct psg_channel *ch, int32_t side)
 {
-    aud_clear_irq();
+    int8_t pan = (int8_t)ch->pan_gate / 2;
+    return pan == -64 ? 0 : 63 + side * pan;
+}
 
-    struct psg_channel *channels = (void *)&xram[psg_xaddr];
+static inline __attribute__((always_inline)) void
+psg_load(struct psg_voice *voice)
+{
+    const struct psg_channel *channels = (void *)&xram[psg_xaddr];
+    for (unsigned i = 0; i < PSG_CHANNELS; i++)
+    {
+        struct psg_voice *v = &voice[i];
+        v->gain_l = psg_pan_gain(&channels[i], -1);
+        v->gain_r = psg_pan_gain(&channels[i], 1);
+        v->wave = channels[i].wave_release >> 4;
+        v->duty = channels[i].duty;
+        v->attack_rate = psg_attack_table[channels[i].vol_attack & 0xF];
+        v->attack_vol = psg_vol_table[channels[i].vol_attack >> 4];
+        v->decay_rate = psg_decay_release_table[channels[i].vol_decay & 0xF];
+        v->decay_vol = psg_vol_table[channels[i].vol_decay >> 4];
+        v->hold = v->decay_vol <= v->attack_vol;
+        v->release_rate = psg_decay_release_table[channels[i].wave_release & 0xF];
+    }
+}
 
-    /* Output previous sample at start to minimize jitter.
-     *
-     * The mix accumulates unshifted and rounds once. It used to truncate
-     * twice — after the envelope and again after the pan — and a floor is
-     * not noise, it is a downward bias that every sounding channel adds to.
-     * Eight of them reached -26 dBFS of DC that appeared and vanished with
-     * the notes. The envelope takes thirteen bits here rather than nine:
-     * psg_vol_table is Q24 and at nine bits a long release moved in 256
-     * visible steps, which is the zipper you could hear on a slow fade. */
+/* A voice's registers, from the loaded voice when there is one, else from
+ * its channel when asked. voice is a constant at every call, so each of
+ * these folds to one or the other. */
+#define PSG_REG(ch, v, field, expr) ((v) ? (v)->field : (expr))
+#define PSG_GAIN_L(ch, v) PSG_REG(ch, v, gain_l, psg_pan_gain(ch, -1))
+#define PSG_GAIN_R(ch, v) PSG_REG(ch, v, gain_r, psg_pan_gain(ch, 1))
+#define PSG_WAVE(ch, v) PSG_REG(ch, v, wave, (ch)->wave_release >> 4)
+#define PSG_DUTY(ch, v) PSG_REG(ch, v, duty, (ch)->duty)
+#define PSG_ATTACK_RATE(ch, v) PSG_REG(ch, v, attack_rate, psg_attack_table[(ch)->vol_attack & 0xF])
+#define PSG_ATTACK_VOL(ch, v) PSG_REG(ch, v, attack_vol, psg_vol_table[(ch)->vol_attack >> 4])
+#define PSG_DECAY_RATE(ch, v) PSG_REG(ch, v, decay_rate, psg_decay_release_table[(ch)->vol_decay & 0xF])
+#define PSG_DECAY_VOL(ch, v) PSG_REG(ch, v, decay_vol, psg_vol_table[(ch)->vol_decay >> 4])
+#define PSG_HOLD(ch, v) PSG_REG(ch, v, hold, PSG_DECAY_VOL(ch, v) <= PSG_ATTACK_VOL(ch, v))
+#define PSG_RELEASE_RATE(ch, v) PSG_REG(ch, v, release_rate, psg_decay_release_table[(ch)->wave_release & 0xF])
+
+/* The increments, for frequencies written since the last look. */
+static inline __attribute__((always_inline)) void
+psg_tune(void)
+{
+    const struct psg_channel *channels = (void *)&xram[psg_xaddr];
+    for (unsigned i = 0; i < PSG_CHANNELS; i++)
+        if (channels[i].freq != psg_channel_state[i].freq)
+        {
+            psg_channel_state[i].freq = channels[i].freq;
+            psg_channel_state[i].phase_inc =
+                (uint32_t)(((uint64_t)channels[i].freq << 32) / psg_phase_div);
+        }
+}
+
+/* The mix accumulates unshifted and rounds once. It used to truncate
+ * twice — after the envelope and again after the pan — and a floor is
+ * not noise, it is a downward bias that every sounding channel adds to.
+ * Eight of them reached -26 dBFS of DC that appeared and vanished with
+ * the notes. The envelope takes thirteen bits here rather than nine:
+ * psg_vol_table is Q24 and at nine bits a long release moved in 256
+ * visible steps, which is the zipper you could hear on a slow fade. */
+static inline __attribute__((always_inline)) void
+psg_mix(const struct psg_voice *voice, int32_t bel_mix, int16_t *l, int16_t *r)
+{
+    const struct psg_channel *channels = (void *)&xram[psg_xaddr];
     int32_t acc_l = 0;
     int32_t acc_r = 0;
     for (unsigned i = 0; i < PSG_CHANNELS; i++)
@@ -161,16 +242,12 @@ static void
                               * (int32_t)(psg_channel_state[i].vol >> 12)
                           + (1 << 11))
                          >> 12;
-        int8_t pan = (int8_t)channels[i].pan_gate / 2;
-        if (pan != -64)
-        {
-            acc_l += sample * (63 - pan);
-            acc_r += sample * (63 + pan);
-        }
+        const struct psg_voice *v = voice ? &voice[i] : NULL;
+        acc_l += sample * PSG_GAIN_L(&channels[i], v);
+        acc_r += sample * PSG_GAIN_R(&channels[i], v);
     }
     /* 63/64 rather than 1/2 per side is the pan law this has always had;
      * the shift undoes it and lands on full scale. */
-    int32_t bel_mix = bel_sample(psg_rate);
     acc_l = ((acc_l + 64) >> 7) + bel_mix;
     acc_r = ((acc_r + 64) >> 7) + bel_mix;
     if (acc_l < AUD_SAMPLE_MIN)
@@ -181,16 +258,18 @@ static void
         acc_r = AUD_SAMPLE_MIN;
     if (acc_r > AUD_SAMPLE_MAX)
         acc_r = AUD_SAMPLE_MAX;
-    aud_out((int16_t)acc_l, (int16_t)acc_r);
+    *l = (int16_t)acc_l;
+    *r = (int16_t)acc_r;
+}
 
+static inline __attribute__((always_inline)) void
+psg_step(const struct psg_voice *voice)
+{
+    const struct psg_channel *channels = (void *)&xram[psg_xaddr];
     for (unsigned i = 0; i < PSG_CHANNELS; i++)
     {
-        if (channels[i].freq != psg_channel_state[i].freq)
-        {
-            psg_channel_state[i].freq = channels[i].freq;
-            psg_channel_state[i].phase_inc =
-                (uint32_t)(((uint64_t)channels[i].freq << 32) / psg_phase_div);
-        }
+        const struct psg_channel *ch = &channels[i];
+        const struct psg_voice *v = voice ? &voice[i] : NULL;
         psg_channel_state[i].phase += psg_channel_state[i].phase_inc;
         /* The duty gate still compares the top byte of the phase, so where
          * a wave starts and stops is unchanged. Only the value widens: the
@@ -199,8 +278,8 @@ static void
          * -127 rail scaled. The gate rails to full negative rather than to
          * silence, which is how duty has always worked here. */
         uint32_t phase = psg_channel_state[i].phase >> 24;
-        uint32_t duty = channels[i].duty;
-        switch (channels[i].wave_release >> 4)
+        uint32_t duty = PSG_DUTY(ch, v);
+        switch (PSG_WAVE(ch, v))
         {
         case 0: // sine
             duty >>= 1;
@@ -253,36 +332,40 @@ static void
         switch (psg_channel_state[i].adsr)
         {
         case attack:
-            psg_channel_state[i].vol += psg_attack_table[channels[i].vol_attack & 0xF];
-            if (psg_channel_state[i].vol >= psg_vol_table[channels[i].vol_attack >> 4])
+            psg_channel_state[i].vol += PSG_ATTACK_RATE(ch, v);
+            if (psg_channel_state[i].vol >= PSG_ATTACK_VOL(ch, v))
             {
-                psg_channel_state[i].vol = psg_vol_table[channels[i].vol_attack >> 4];
+                psg_channel_state[i].vol = PSG_ATTACK_VOL(ch, v);
                 psg_channel_state[i].adsr = decay;
             }
             break;
         case decay:
-            if (psg_channel_state[i].vol <= psg_decay_release_table[channels[i].vol_decay & 0xF])
+            if (psg_channel_state[i].vol <= PSG_DECAY_RATE(ch, v))
                 psg_channel_state[i].vol = 0;
             else
-                psg_channel_state[i].vol -= psg_decay_release_table[channels[i].vol_decay & 0xF];
-            if (psg_channel_state[i].vol > psg_vol_table[channels[i].vol_decay >> 4])
+                psg_channel_state[i].vol -= PSG_DECAY_RATE(ch, v);
+            if (psg_channel_state[i].vol > PSG_DECAY_VOL(ch, v))
                 break;
             psg_channel_state[i].adsr = sustain;
             __attribute__((fallthrough));
         case sustain:
-            if (psg_vol_table[channels[i].vol_decay >> 4] <= psg_vol_table[channels[i].vol_attack >> 4])
-                psg_channel_state[i].vol = psg_vol_table[channels[i].vol_decay >> 4];
+            if (PSG_HOLD(ch, v))
+                psg_channel_state[i].vol = PSG_DECAY_VOL(ch, v);
             break;
         case release:
-            if (psg_channel_state[i].vol <= psg_decay_release_table[channels[i].wave_release & 0xF])
+            if (psg_channel_state[i].vol <= PSG_RELEASE_RATE(ch, v))
                 psg_channel_state[i].vol = 0;
             else
-                psg_channel_state[i].vol -= psg_decay_release_table[channels[i].wave_release & 0xF];
+                psg_channel_state[i].vol -= PSG_RELEASE_RATE(ch, v);
             break;
         }
     }
+}
 
-    // Detect gate changes using xram_queue
+// Detect gate changes using xram_queue
+static inline __attribute__((always_inline)) void
+psg_drain(void)
+{
     uint8_t max_work = 32;
     while (max_work-- && xram_queue_tail != xram_queue_head)
     {
@@ -304,6 +387,108 @@ static void
         }
     }
 }
+
+static void
+    __isr
+    __time_critical_func(psg_irq_handler)(void)
+{
+    aud_clear_irq();
+
+    // Output previous sample at start to minimize jitter
+    int16_t l, r;
+    psg_mix(NULL, bel_sample(psg_rate), &l, &r);
+    aud_out(l, r);
+
+    psg_tune();
+    psg_step(NULL);
+    psg_drain();
+}
+
+/* The handler n times over, into l and r. The tables, the registers and
+ * the bell's idle test come out of the sample loop, and so does the gate
+ * queue once it is empty: whatever it held at the start lands in the first
+ * samples, up to 32 a sample, as it would have one interrupt at a time.
+ * The rest goes in chunks, through psv's lanes where the host has them. */
+#define PSG_RENDER_CHUNK 64
+
+#ifdef PSG_VECTOR
+static void psg_to_psv(const struct psg_voice *voice, psv_voices_t *v)
+{
+    for (unsigned i = 0; i < PSG_CHANNELS; i++)
+    {
+        v->phase[i] = psg_channel_state[i].phase;
+        v->phase_inc[i] = psg_channel_state[i].phase_inc;
+        v->vol[i] = psg_channel_state[i].vol;
+        v->adsr[i] = psg_channel_state[i].adsr;
+        v->noise1[i] = psg_channel_state[i].noise1;
+        v->noise2[i] = psg_channel_state[i].noise2;
+        v->sample[i] = psg_channel_state[i].sample;
+        v->wave[i] = voice[i].wave;
+        v->duty[i] = voice[i].duty;
+        v->gain_l[i] = voice[i].gain_l;
+        v->gain_r[i] = voice[i].gain_r;
+        v->attack_rate[i] = voice[i].attack_rate;
+        v->attack_vol[i] = voice[i].attack_vol;
+        v->decay_rate[i] = voice[i].decay_rate;
+        v->decay_vol[i] = voice[i].decay_vol;
+        v->release_rate[i] = voice[i].release_rate;
+        v->hold[i] = voice[i].hold ? UINT32_MAX : 0;
+    }
+}
+
+static void psg_from_psv(const psv_voices_t *v)
+{
+    for (unsigned i = 0; i < PSG_CHANNELS; i++)
+    {
+        psg_channel_state[i].phase = v->phase[i];
+        psg_channel_state[i].vol = v->vol[i];
+        psg_channel_state[i].adsr = (uint8_t)v->adsr[i];
+        psg_channel_state[i].noise1 = v->noise1[i];
+        psg_channel_state[i].noise2 = v->noise2[i];
+        psg_channel_state[i].sample = (int16_t)v->sample[i];
+    }
+}
+#endif
+
+void psg_render(int16_t *l, int16_t *r, unsigned n)
+{
+    struct psg_voice voice[PSG_CHANNELS];
+    psg_load(voice);
+    psg_tune();
+    for (; n && xram_queue_tail != xram_queue_head; n--)
+    {
+        psg_mix(voice, bel_sample(psg_rate), l++, r++);
+        psg_step(voice);
+        psg_drain();
+    }
+    if (!n)
+        return;
+#ifdef PSG_VECTOR
+    psv_voices_t lanes;
+    psg_to_psv(voice, &lanes);
+#endif
+    int16_t bel[PSG_RENDER_CHUNK];
+    while (n)
+    {
+        unsigned len = n < PSG_RENDER_CHUNK ? n : PSG_RENDER_CHUNK;
+        bel_render(bel, len, psg_rate);
+#ifdef PSG_VECTOR
+        psv_render(&lanes, bel, l, r, len);
+#else
+        for (unsigned i = 0; i < len; i++)
+        {
+            psg_mix(voice, bel[i], &l[i], &r[i]);
+            psg_step(voice);
+        }
+#endif
+        l += len;
+        r += len;
+        n -= len;
+    }
+#ifdef PSG_VECTOR
+    psg_from_psv(&lanes);
+#endif
+}
 #pragma GCC pop_options
 
 bool psg_xreg(uint16_t word)
@@ -341,6 +526,45 @@ bool psg_xreg(uint16_t word)
     psg_xaddr = word;
     xram_queue_page = word >> 8;
     xram_queue_tail = xram_queue_head;
-    aud_setup(psg_irq_handler, psg_rate);
+    aud_setup(psg_irq_handler, psg_render, psg_rate);
+    return true;
+}
+
+/* Savestates. The generators and the channel block's address; the tables
+ * and the divisor belong to whatever rate this host runs at, which need not
+ * be the one the state was saved at, so the cached increments are dropped
+ * and come back out of the next sample's freq compare. */
+typedef struct
+{
+    uint16_t xaddr;
+    uint8_t state[sizeof psg_channel_state];
+} psg_state_t;
+
+size_t psg_state_save(void *buf)
+{
+    if (buf)
+    {
+        psg_state_t s;
+        memset(&s, 0, sizeof s);
+        s.xaddr = psg_xaddr;
+        memcpy(s.state, psg_channel_state, sizeof psg_channel_state);
+        memcpy(buf, &s, sizeof s);
+    }
+    return sizeof(psg_state_t);
+}
+
+bool psg_state_load(const void *buf, size_t len)
+{
+    psg_state_t s;
+    if (len != sizeof s)
+        return false;
+    memcpy(&s, buf, sizeof s);
+    psg_xaddr = s.xaddr;
+    memcpy(psg_channel_state, s.state, sizeof psg_channel_state);
+    for (unsigned i = 0; i < PSG_CHANNELS; i++)
+    {
+        psg_channel_state[i].freq = 0;
+        psg_channel_state[i].phase_inc = 0;
+    }
     return true;
 }
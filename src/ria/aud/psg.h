@@ -29,4 +29,19 @@ void psg_setup(uint32_t rate);
 
 bool psg_xreg(uint16_t word);
 
+/* The next n samples, exactly as n interrupts would have made them, for a
+ * host that wants them a block at a time. The channel block is read once,
+ * so it must not be written until the block is done.
+ */
+
+void psg_render(int16_t *l, int16_t *r, unsigned n);
+
+/* Savestates. save returns the size and writes buf unless it is NULL;
+ * load refuses a blob of any other size. Neither installs the handler —
+ * the platform's own audio section carries which device is running.
+ */
+
+size_t psg_state_save(void *buf);
+bool psg_state_load(const void *buf, size_t len);
+
 #endif /* _RIA_AUD_PSG_H_ */
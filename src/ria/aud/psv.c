@@ -0,0 +1,698 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ria/aud/aud.h"
+#include "ria/aud/psv.h"
+#include "host/simd.h"
+#include <stdbool.h>
+
+/* SSE4.1 and AVX2 are both chosen at run time; see host/simd.h. SSE4.1 is
+ * the floor: it is the first with a 32-bit multiply and unsigned compares,
+ * and the envelope is both. */
+#if SIMD_X86
+#define PSV_SSE41 1
+#define PSV_AVX2 1
+#define PSV_SSE41_FN SIMD_SSE41_FN
+#define PSV_AVX2_FN SIMD_AVX2_FN
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define PSV_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* As psg.c: full scale, and the value a closed duty gate rails to. */
+#define PSV_PEAK 32767
+#define PSV_RAIL (-32767)
+
+/* The mix rounded once and the bell added, as psg_mix finishes it. */
+static inline void psv_out(int32_t acc_l, int32_t acc_r, int16_t bel, int16_t *l, int16_t *r)
+{
+    acc_l = ((acc_l + 64) >> 7) + bel;
+    acc_r = ((acc_r + 64) >> 7) + bel;
+    if (acc_l < AUD_SAMPLE_MIN)
+        acc_l = AUD_SAMPLE_MIN;
+    if (acc_l > AUD_SAMPLE_MAX)
+        acc_l = AUD_SAMPLE_MAX;
+    if (acc_r < AUD_SAMPLE_MIN)
+        acc_r = AUD_SAMPLE_MIN;
+    if (acc_r > AUD_SAMPLE_MAX)
+        acc_r = AUD_SAMPLE_MAX;
+    *l = (int16_t)acc_l;
+    *r = (int16_t)acc_r;
+}
+
+/* ------------------------------------------------------------------ */
+/* Scalar: the reference                                               */
+/* ------------------------------------------------------------------ */
+
+/* psg_step for one voice, line for line. */
+static void psv_scalar_step(psv_voices_t *v, unsigned i)
+{
+    v->phase[i] += v->phase_inc[i];
+    uint32_t phase = v->phase[i] >> 24;
+    uint32_t duty = v->duty[i];
+    switch (v->wave[i])
+    {
+    case 0: // sine
+        duty >>= 1;
+        if (phase < 128u - duty || phase >= 128u + duty)
+            v->sample[i] = PSV_RAIL;
+        else
+            v->sample[i] = aud_sine_table[phase];
+        break;
+    case 1: // square
+        v->sample[i] = phase > duty ? PSV_RAIL : PSV_PEAK;
+        break;
+    case 2: // sawtooth
+        if (phase > duty)
+            v->sample[i] = PSV_RAIL;
+        else
+            v->sample[i] = (int16_t)(PSV_PEAK - (int32_t)(v->phase[i] >> 16));
+        break;
+    case 3: // triangle
+        duty >>= 1;
+        if (phase < 128u - duty || phase >= 128u + duty)
+            v->sample[i] = PSV_RAIL;
+        else if (phase >= 128)
+            v->sample[i] = (int16_t)(PSV_PEAK - (int16_t)(v->phase[i] >> 15));
+        else
+            v->sample[i] = (int16_t)((int16_t)(v->phase[i] >> 15) - 32768);
+        break;
+    case 4: // noise
+        if (phase > duty)
+            v->sample[i] = PSV_RAIL;
+        else
+        {
+            v->noise1[i] ^= v->noise2[i];
+            v->sample[i] = (int16_t)(v->noise2[i] & 0xFFFF);
+            v->noise2[i] += v->noise1[i];
+        }
+        break;
+    default:
+        v->sample[i] = 0;
+        break;
+    }
+
+    switch (v->adsr[i])
+    {
+    case PSV_ATTACK:
+        v->vol[i] += v->attack_rate[i];
+        if (v->vol[i] >= v->attack_vol[i])
+        {
+            v->vol[i] = v->attack_vol[i];
+            v->adsr[i] = PSV_DECAY;
+        }
+        break;
+    case PSV_DECAY:
+        if (v->vol[i] <= v->decay_rate[i])
+            v->vol[i] = 0;
+        else
+            v->vol[i] -= v->decay_rate[i];
+        if (v->vol[i] > v->decay_vol[i])
+            break;
+        v->adsr[i] = PSV_SUSTAIN;
+        __attribute__((fallthrough));
+    case PSV_SUSTAIN:
+        if (v->hold[i])
+            v->vol[i] = v->decay_vol[i];
+        break;
+    case PSV_RELEASE:
+        if (v->vol[i] <= v->release_rate[i])
+            v->vol[i] = 0;
+        else
+            v->vol[i] -= v->release_rate[i];
+        break;
+    }
+}
+
+static void psv_scalar(psv_voices_t *v, const int16_t *bel, int16_t *l, int16_t *r, unsigned n)
+{
+    for (unsigned s = 0; s < n; s++)
+    {
+        int32_t acc_l = 0;
+        int32_t acc_r = 0;
+        for (unsigned i = 0; i < PSV_VOICES; i++)
+        {
+            int32_t sample = (v->sample[i] * (int32_t)(v->vol[i] >> 12) + (1 << 11)) >> 12;
+            acc_l += sample * v->gain_l[i];
+            acc_r += sample * v->gain_r[i];
+        }
+        psv_out(acc_l, acc_r, bel[s], &l[s], &r[s]);
+        for (unsigned i = 0; i < PSV_VOICES; i++)
+            psv_scalar_step(v, i);
+    }
+}
+
+/* Each vector variant is the scalar step with its branches turned into
+ * selects: every wave is computed in every lane and the voice's own is kept,
+ * the noise generator advances only where its gate is open, and each
+ * envelope state's outcome is blended in where the lane is in that state.
+ * The sine table is still read a lane at a time; a gather would read two
+ * bytes past its end. The horizontal sums are the other cost, so the x86
+ * ones take a register's width of samples at a time and clamp with a pack. */
+
+/* ------------------------------------------------------------------ */
+/* SSE4.1                                                              */
+/* ------------------------------------------------------------------ */
+
+#if PSV_SSE41
+
+#define PSV_LD(a) _mm_loadu_si128((const __m128i *)(a))
+#define PSV_ST(a, x) _mm_storeu_si128((__m128i *)(a), (x))
+
+static inline PSV_SSE41_FN __m128i psv_sse41_sx16(__m128i x)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+/* Unsigned a <= b and a >= b, which SSE has only as min and max. */
+static inline PSV_SSE41_FN __m128i psv_sse41_le(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi32(_mm_min_epu32(a, b), a);
+}
+
+static inline PSV_SSE41_FN __m128i psv_sse41_ge(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi32(_mm_max_epu32(a, b), a);
+}
+
+/* One sample's step for voices o to o + 3. */
+static inline PSV_SSE41_FN void psv_sse41_step(psv_voices_t *v, unsigned o)
+{
+    const __m128i rail = _mm_set1_epi32(PSV_RAIL);
+    const __m128i peak = _mm_set1_epi32(PSV_PEAK);
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i phase = _mm_add_epi32(PSV_LD(&v->phase[o]), PSV_LD(&v->phase_inc[o]));
+    PSV_ST(&v->phase[o], phase);
+    __m128i p = _mm_srli_epi32(phase, 24);
+    __m128i duty = PSV_LD(&v->duty[o]);
+    __m128i wave = PSV_LD(&v->wave[o]);
+    __m128i half = _mm_srli_epi32(duty, 1);
+    __m128i c128 = _mm_set1_epi32(128);
+    __m128i window = _mm_andnot_si128(_mm_cmplt_epi32(p, _mm_sub_epi32(c128, half)),
+                                      _mm_cmplt_epi32(p, _mm_add_epi32(c128, half)));
+    __m128i closed = _mm_cmpgt_epi32(p, duty);
+
+    int32_t idx[4];
+    PSV_ST(idx, p);
+    __m128i sine = _mm_setr_epi32(aud_sine_table[idx[0]], aud_sine_table[idx[1]],
+                                  aud_sine_table[idx[2]], aud_sine_table[idx[3]]);
+    __m128i w_sine = _mm_blendv_epi8(rail, sine, window);
+    __m128i w_square = _mm_blendv_epi8(peak, rail, closed);
+    __m128i w_saw = _mm_blendv_epi8(_mm_sub_epi32(peak, _mm_srli_epi32(phase, 16)), rail, closed);
+    __m128i t = psv_sse41_sx16(_mm_srli_epi32(phase, 15));
+    __m128i tri = _mm_blendv_epi8(psv_sse41_sx16(_mm_sub_epi32(t, _mm_set1_epi32(32768))),
+                                  psv_sse41_sx16(_mm_sub_epi32(peak, t)),
+                                  _mm_cmpgt_epi32(p, _mm_set1_epi32(127)));
+    __m128i w_tri = _mm_blendv_epi8(rail, tri, window);
+
+    __m128i n1 = PSV_LD(&v->noise1[o]);
+    __m128i n2 = PSV_LD(&v->noise2[o]);
+    __m128i w_noise = _mm_blendv_epi8(psv_sse41_sx16(n2), rail, closed);
+    __m128i is_noise = _mm_cmpeq_epi32(wave, _mm_set1_epi32(4));
+    __m128i noisy = _mm_andnot_si128(closed, is_noise);
+    __m128i n1x = _mm_xor_si128(n1, n2);
+    PSV_ST(&v->noise1[o], _mm_blendv_epi8(n1, n1x, noisy));
+    PSV_ST(&v->noise2[o], _mm_blendv_epi8(n2, _mm_add_epi32(n2, n1x), noisy));
+
+    __m128i sample = zero;
+    sample = _mm_blendv_epi8(sample, w_sine, _mm_cmpeq_epi32(wave, zero));
+    sample = _mm_blendv_epi8(sample, w_square, _mm_cmpeq_epi32(wave, _mm_set1_epi32(1)));
+    sample = _mm_blendv_epi8(sample, w_saw, _mm_cmpeq_epi32(wave, _mm_set1_epi32(2)));
+    sample = _mm_blendv_epi8(sample, w_tri, _mm_cmpeq_epi32(wave, _mm_set1_epi32(3)));
+    sample = _mm_blendv_epi8(sample, w_noise, is_noise);
+    PSV_ST(&v->sample[o], sample);
+
+    __m128i vol = PSV_LD(&v->vol[o]);
+    __m128i adsr = PSV_LD(&v->adsr[o]);
+    __m128i decay_vol = PSV_LD(&v->decay_vol[o]);
+    __m128i hold = _mm_xor_si128(_mm_cmpeq_epi32(PSV_LD(&v->hold[o]), zero), _mm_set1_epi32(-1));
+    __m128i s_attack = _mm_set1_epi32(PSV_ATTACK);
+    __m128i s_decay = _mm_set1_epi32(PSV_DECAY);
+    __m128i s_sustain = _mm_set1_epi32(PSV_SUSTAIN);
+
+    __m128i attack_vol = PSV_LD(&v->attack_vol[o]);
+    __m128i va = _mm_add_epi32(vol, PSV_LD(&v->attack_rate[o]));
+    __m128i reached = psv_sse41_ge(va, attack_vol);
+    va = _mm_blendv_epi8(va, attack_vol, reached);
+    __m128i aa = _mm_blendv_epi8(s_attack, s_decay, reached);
+
+    __m128i decay_rate = PSV_LD(&v->decay_rate[o]);
+    __m128i vd = _mm_andnot_si128(psv_sse41_le(vol, decay_rate), _mm_sub_epi32(vol, decay_rate));
+    __m128i done = psv_sse41_le(vd, decay_vol);
+    vd = _mm_blendv_epi8(vd, decay_vol, _mm_and_si128(done, hold));
+    __m128i ad = _mm_blendv_epi8(s_decay, s_sustain, done);
+
+    __m128i vs = _mm_blendv_epi8(vol, decay_vol, hold);
+
+    __m128i release_rate = PSV_LD(&v->release_rate[o]);
+    __m128i vr = _mm_andnot_si128(psv_sse41_le(vol, release_rate), _mm_sub_epi32(vol, release_rate));
+
+    __m128i in_attack = _mm_cmpeq_epi32(adsr, s_attack);
+    __m128i in_decay = _mm_cmpeq_epi32(adsr, s_decay);
+    vol = _mm_blendv_epi8(vol, va, in_attack);
+    vol = _mm_blendv_epi8(vol, vd, in_decay);
+    vol = _mm_blendv_epi8(vol, vs, _mm_cmpeq_epi32(adsr, s_sustain));
+    vol = _mm_blendv_epi8(vol, vr, _mm_cmpeq_epi32(adsr, _mm_set1_epi32(PSV_RELEASE)));
+    adsr = _mm_blendv_epi8(adsr, aa, in_attack);
+    adsr = _mm_blendv_epi8(adsr, ad, in_decay);
+    PSV_ST(&v->vol[o], vol);
+    PSV_ST(&v->adsr[o], adsr);
+}
+
+/* One voice group's share of the mix, unshifted, as psg_mix sums it. */
+static inline PSV_SSE41_FN void psv_sse41_mix(const psv_voices_t *v, unsigned o, __m128i *l, __m128i *r)
+{
+    __m128i env = _mm_srli_epi32(PSV_LD(&v->vol[o]), 12);
+    __m128i s = _mm_mullo_epi32(PSV_LD(&v->sample[o]), env);
+    s = _mm_srai_epi32(_mm_add_epi32(s, _mm_set1_epi32(1 << 11)), 12);
+    *l = _mm_add_epi32(*l, _mm_mullo_epi32(s, PSV_LD(&v->gain_l[o])));
+    *r = _mm_add_epi32(*r, _mm_mullo_epi32(s, PSV_LD(&v->gain_r[o])));
+}
+
+static inline PSV_SSE41_FN int32_t psv_sse41_sum(__m128i x)
+{
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(x);
+}
+
+/* Four samples' mixes, each still a vector of lane sums, to four samples:
+ * the horizontal adds are shared, and packs is psv_out's clamp. */
+static inline PSV_SSE41_FN void psv_sse41_out4(const __m128i *ml, const __m128i *mr,
+                                               const int16_t *bel, int16_t *l, int16_t *r)
+{
+    __m128i sl = _mm_hadd_epi32(_mm_hadd_epi32(ml[0], ml[1]), _mm_hadd_epi32(ml[2], ml[3]));
+    __m128i sr = _mm_hadd_epi32(_mm_hadd_epi32(mr[0], mr[1]), _mm_hadd_epi32(mr[2], mr[3]));
+    __m128i b = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)bel));
+    const __m128i half = _mm_set1_epi32(64);
+    sl = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sl, half), 7), b);
+    sr = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sr, half), 7), b);
+    __m128i lr = _mm_packs_epi32(sl, sr);
+    _mm_storel_epi64((__m128i *)l, lr);
+    _mm_storel_epi64((__m128i *)r, _mm_unpackhi_epi64(lr, lr));
+}
+
+static PSV_SSE41_FN void psv_sse41(psv_voices_t *v, const int16_t *bel, int16_t *l, int16_t *r, unsigned n)
+{
+    __m128i ml[4], mr[4];
+    for (unsigned s = 0; s < n; s++)
+    {
+        const unsigned k = s & 3;
+        ml[k] = _mm_setzero_si128();
+        mr[k] = _mm_setzero_si128();
+        psv_sse41_mix(v, 0, &ml[k], &mr[k]);
+        psv_sse41_mix(v, 4, &ml[k], &mr[k]);
+        if (k == 3)
+            psv_sse41_out4(ml, mr, &bel[s - 3], &l[s - 3], &r[s - 3]);
+        psv_sse41_step(v, 0);
+        psv_sse41_step(v, 4);
+    }
+    for (unsigned s = n & ~3u; s < n; s++)
+        psv_out(psv_sse41_sum(ml[s & 3]), psv_sse41_sum(mr[s & 3]), bel[s], &l[s], &r[s]);
+}
+
+#undef PSV_LD
+#undef PSV_ST
+#endif
+
+/* ------------------------------------------------------------------ */
+/* AVX2                                                                */
+/* ------------------------------------------------------------------ */
+
+/* The eight voices are one register, so unlike the others this one keeps
+ * the voices in registers for the whole block, and as the waves cannot
+ * change inside one it makes only those some voice is playing. */
+#if PSV_AVX2
+
+#define PSV_LD(a) _mm256_loadu_si256((const __m256i *)(a))
+#define PSV_ST(a, x) _mm256_storeu_si256((__m256i *)(a), (x))
+
+static inline PSV_AVX2_FN __m256i psv_avx2_sx16(__m256i x)
+{
+    return _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+}
+
+static inline PSV_AVX2_FN __m256i psv_avx2_le(__m256i a, __m256i b)
+{
+    return _mm256_cmpeq_epi32(_mm256_min_epu32(a, b), a);
+}
+
+static inline PSV_AVX2_FN __m256i psv_avx2_ge(__m256i a, __m256i b)
+{
+    return _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a);
+}
+
+static inline PSV_AVX2_FN int32_t psv_avx2_sum(__m256i x)
+{
+    __m128i h = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    h = _mm_add_epi32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2)));
+    h = _mm_add_epi32(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(h);
+}
+
+/* psv_sse41_out4 eight wide. */
+static inline PSV_AVX2_FN __m256i psv_avx2_sum8(const __m256i *x)
+{
+    __m256i a = _mm256_hadd_epi32(_mm256_hadd_epi32(x[0], x[1]), _mm256_hadd_epi32(x[2], x[3]));
+    __m256i b = _mm256_hadd_epi32(_mm256_hadd_epi32(x[4], x[5]), _mm256_hadd_epi32(x[6], x[7]));
+    return _mm256_add_epi32(_mm256_permute2x128_si256(a, b, 0x20),
+                            _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+static inline PSV_AVX2_FN void psv_avx2_out8(const __m256i *ml, const __m256i *mr,
+                                             const int16_t *bel, int16_t *l, int16_t *r)
+{
+    __m256i b = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)bel));
+    const __m256i half = _mm256_set1_epi32(64);
+    __m256i sl = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(psv_avx2_sum8(ml), half), 7), b);
+    __m256i sr = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(psv_avx2_sum8(mr), half), 7), b);
+    __m256i lr = _mm256_permute4x64_epi64(_mm256_packs_epi32(sl, sr), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i *)l, _mm256_castsi256_si128(lr));
+    _mm_storeu_si128((__m128i *)r, _mm256_extracti128_si256(lr, 1));
+}
+
+static PSV_AVX2_FN void psv_avx2(psv_voices_t *v, const int16_t *bel, int16_t *l, int16_t *r, unsigned n)
+{
+    const __m256i rail = _mm256_set1_epi32(PSV_RAIL);
+    const __m256i peak = _mm256_set1_epi32(PSV_PEAK);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i s_attack = _mm256_set1_epi32(PSV_ATTACK);
+    const __m256i s_decay = _mm256_set1_epi32(PSV_DECAY);
+    const __m256i s_sustain = _mm256_set1_epi32(PSV_SUSTAIN);
+
+    const __m256i phase_inc = PSV_LD(v->phase_inc);
+    const __m256i duty = PSV_LD(v->duty);
+    const __m256i wave = PSV_LD(v->wave);
+    const __m256i gain_l = PSV_LD(v->gain_l);
+    const __m256i gain_r = PSV_LD(v->gain_r);
+    const __m256i attack_rate = PSV_LD(v->attack_rate);
+    const __m256i attack_vol = PSV_LD(v->attack_vol);
+    const __m256i decay_rate = PSV_LD(v->decay_rate);
+    const __m256i decay_vol = PSV_LD(v->decay_vol);
+    const __m256i release_rate = PSV_LD(v->release_rate);
+    const __m256i hold = _mm256_xor_si256(_mm256_cmpeq_epi32(PSV_LD(v->hold), zero),
+                                          _mm256_set1_epi32(-1));
+    /* Which wave each voice is, and the duty window, do not move. */
+    const __m256i is_sine = _mm256_cmpeq_epi32(wave, zero);
+    const __m256i is_square = _mm256_cmpeq_epi32(wave, _mm256_set1_epi32(1));
+    const __m256i is_saw = _mm256_cmpeq_epi32(wave, _mm256_set1_epi32(2));
+    const __m256i is_tri = _mm256_cmpeq_epi32(wave, _mm256_set1_epi32(3));
+    const __m256i is_noise = _mm256_cmpeq_epi32(wave, _mm256_set1_epi32(4));
+    /* Which lanes a closed duty gate rails, and which a closed window. */
+    const __m256i by_duty = _mm256_or_si256(_mm256_or_si256(is_square, is_saw), is_noise);
+    const __m256i by_window = _mm256_or_si256(is_sine, is_tri);
+    /* And which waves to make at all, since a block rarely has every one. */
+    const bool any_sine = _mm256_movemask_epi8(is_sine) != 0;
+    const bool any_square = _mm256_movemask_epi8(is_square) != 0;
+    const bool any_saw = _mm256_movemask_epi8(is_saw) != 0;
+    const bool any_tri = _mm256_movemask_epi8(is_tri) != 0;
+    const bool any_noise = _mm256_movemask_epi8(is_noise) != 0;
+    const bool any_window = any_sine || any_tri;
+    const __m256i half = _mm256_srli_epi32(duty, 1);
+    const __m256i lo = _mm256_sub_epi32(_mm256_set1_epi32(128), half);
+    const __m256i hi = _mm256_add_epi32(_mm256_set1_epi32(128), half);
+
+    __m256i phase = PSV_LD(v->phase);
+    __m256i vol = PSV_LD(v->vol);
+    __m256i adsr = PSV_LD(v->adsr);
+    __m256i n1 = PSV_LD(v->noise1);
+    __m256i n2 = PSV_LD(v->noise2);
+    __m256i sample = PSV_LD(v->sample);
+
+    __m256i ml[8], mr[8];
+    for (unsigned s = 0; s < n; s++)
+    {
+        const unsigned k = s & 7;
+        __m256i m = _mm256_mullo_epi32(sample, _mm256_srli_epi32(vol, 12));
+        m = _mm256_srai_epi32(_mm256_add_epi32(m, _mm256_set1_epi32(1 << 11)), 12);
+        ml[k] = _mm256_mullo_epi32(m, gain_l);
+        mr[k] = _mm256_mullo_epi32(m, gain_r);
+        if (k == 7)
+            psv_avx2_out8(ml, mr, &bel[s - 7], &l[s - 7], &r[s - 7]);
+
+        phase = _mm256_add_epi32(phase, phase_inc);
+        __m256i p = _mm256_srli_epi32(phase, 24);
+        __m256i closed = _mm256_cmpgt_epi32(p, duty);
+        __m256i railed = _mm256_and_si256(closed, by_duty);
+        __m256i wave_out = zero;
+        if (any_window)
+        {
+            __m256i window = _mm256_andnot_si256(_mm256_cmpgt_epi32(lo, p), _mm256_cmpgt_epi32(hi, p));
+            railed = _mm256_or_si256(railed, _mm256_andnot_si256(window, by_window));
+        }
+        if (any_sine)
+        {
+            int32_t idx[8];
+            PSV_ST(idx, p);
+            __m256i sine = _mm256_setr_epi32(
+                aud_sine_table[idx[0]], aud_sine_table[idx[1]],
+                aud_sine_table[idx[2]], aud_sine_table[idx[3]],
+                aud_sine_table[idx[4]], aud_sine_table[idx[5]],
+                aud_sine_table[idx[6]], aud_sine_table[idx[7]]);
+            wave_out = _mm256_or_si256(wave_out, _mm256_and_si256(is_sine, sine));
+        }
+        if (any_square)
+            wave_out = _mm256_or_si256(wave_out, _mm256_and_si256(is_square, peak));
+        if (any_saw)
+        {
+            __m256i saw = _mm256_sub_epi32(peak, _mm256_srli_epi32(phase, 16));
+            wave_out = _mm256_or_si256(wave_out, _mm256_and_si256(is_saw, saw));
+        }
+        if (any_tri)
+        {
+            __m256i t = psv_avx2_sx16(_mm256_srli_epi32(phase, 15));
+            __m256i tri = _mm256_blendv_epi8(psv_avx2_sx16(_mm256_sub_epi32(t, _mm256_set1_epi32(32768))),
+                                             psv_avx2_sx16(_mm256_sub_epi32(peak, t)),
+                                             _mm256_cmpgt_epi32(p, _mm256_set1_epi32(127)));
+            wave_out = _mm256_or_si256(wave_out, _mm256_and_si256(is_tri, tri));
+        }
+        if (any_noise)
+        {
+            wave_out = _mm256_or_si256(wave_out, _mm256_and_si256(is_noise, psv_avx2_sx16(n2)));
+            __m256i noisy = _mm256_andnot_si256(closed, is_noise);
+            __m256i n1x = _mm256_xor_si256(n1, n2);
+            n2 = _mm256_blendv_epi8(n2, _mm256_add_epi32(n2, n1x), noisy);
+            n1 = _mm256_blendv_epi8(n1, n1x, noisy);
+        }
+        sample = _mm256_blendv_epi8(wave_out, rail, railed);
+
+        __m256i va = _mm256_add_epi32(vol, attack_rate);
+        __m256i reached = psv_avx2_ge(va, attack_vol);
+        va = _mm256_blendv_epi8(va, attack_vol, reached);
+        __m256i aa = _mm256_blendv_epi8(s_attack, s_decay, reached);
+        __m256i vd = _mm256_andnot_si256(psv_avx2_le(vol, decay_rate), _mm256_sub_epi32(vol, decay_rate));
+        __m256i done = psv_avx2_le(vd, decay_vol);
+        vd = _mm256_blendv_epi8(vd, decay_vol, _mm256_and_si256(done, hold));
+        __m256i ad = _mm256_blendv_epi8(s_decay, s_sustain, done);
+        __m256i vs = _mm256_blendv_epi8(vol, decay_vol, hold);
+        __m256i vr = _mm256_andnot_si256(psv_avx2_le(vol, release_rate), _mm256_sub_epi32(vol, release_rate));
+
+        __m256i in_attack = _mm256_cmpeq_epi32(adsr, s_attack);
+        __m256i in_decay = _mm256_cmpeq_epi32(adsr, s_decay);
+        __m256i in_sustain = _mm256_cmpeq_epi32(adsr, s_sustain);
+        __m256i in_release = _mm256_cmpeq_epi32(adsr, zero);
+        /* The states are disjoint, so an OR of the four is a shorter chain
+         * through vol than four blends in a row. */
+        __m256i known = _mm256_or_si256(_mm256_or_si256(in_attack, in_decay),
+                                        _mm256_or_si256(in_sustain, in_release));
+        vol = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(in_attack, va), _mm256_and_si256(in_decay, vd)),
+                            _mm256_or_si256(_mm256_and_si256(in_sustain, vs), _mm256_and_si256(in_release, vr))),
+            _mm256_andnot_si256(known, vol));
+        adsr = _mm256_blendv_epi8(adsr, aa, in_attack);
+        adsr = _mm256_blendv_epi8(adsr, ad, in_decay);
+    }
+    for (unsigned s = n & ~7u; s < n; s++)
+        psv_out(psv_avx2_sum(ml[s & 7]), psv_avx2_sum(mr[s & 7]), bel[s], &l[s], &r[s]);
+
+    PSV_ST(v->phase, phase);
+    PSV_ST(v->vol, vol);
+    PSV_ST(v->adsr, adsr);
+    PSV_ST(v->noise1, n1);
+    PSV_ST(v->noise2, n2);
+    PSV_ST(v->sample, sample);
+}
+
+#undef PSV_LD
+#undef PSV_ST
+#endif
+
+/* ------------------------------------------------------------------ */
+/* NEON                                                                */
+/* ------------------------------------------------------------------ */
+
+#if PSV_NEON
+
+static inline int32x4_t psv_neon_sx16(int32x4_t x)
+{
+    return vshrq_n_s32(vshlq_n_s32(x, 16), 16);
+}
+
+static inline int32_t psv_neon_sum(int32x4_t x)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vaddvq_s32(x);
+#else
+    int32x2_t h = vadd_s32(vget_low_s32(x), vget_high_s32(x));
+    return vget_lane_s32(vpadd_s32(h, h), 0);
+#endif
+}
+
+/* One sample's step for voices o to o + 3. Masks are uint32x4_t and the
+ * signed arithmetic reinterprets, which costs nothing. */
+static inline void psv_neon_step(psv_voices_t *v, unsigned o)
+{
+    const int32x4_t rail = vdupq_n_s32(PSV_RAIL);
+    const int32x4_t peak = vdupq_n_s32(PSV_PEAK);
+
+    uint32x4_t phase = vaddq_u32(vld1q_u32(&v->phase[o]), vld1q_u32(&v->phase_inc[o]));
+    vst1q_u32(&v->phase[o], phase);
+    uint32x4_t p = vshrq_n_u32(phase, 24);
+    uint32x4_t duty = vld1q_u32(&v->duty[o]);
+    uint32x4_t wave = vld1q_u32(&v->wave[o]);
+    uint32x4_t half = vshrq_n_u32(duty, 1);
+    uint32x4_t c128 = vdupq_n_u32(128);
+    uint32x4_t window = vandq_u32(vcgeq_u32(p, vsubq_u32(c128, half)),
+                                  vcltq_u32(p, vaddq_u32(c128, half)));
+    uint32x4_t closed = vcgtq_u32(p, duty);
+
+    uint32_t idx[4];
+    int32_t sine[4];
+    vst1q_u32(idx, p);
+    for (unsigned k = 0; k < 4; k++)
+        sine[k] = aud_sine_table[idx[k]];
+    int32x4_t w_sine = vbslq_s32(window, vld1q_s32(sine), rail);
+    int32x4_t w_square = vbslq_s32(closed, rail, peak);
+    int32x4_t w_saw = vbslq_s32(closed, rail,
+                                vsubq_s32(peak, vreinterpretq_s32_u32(vshrq_n_u32(phase, 16))));
+    int32x4_t t = psv_neon_sx16(vreinterpretq_s32_u32(vshrq_n_u32(phase, 15)));
+    int32x4_t tri = vbslq_s32(vcgtq_u32(p, vdupq_n_u32(127)),
+                              psv_neon_sx16(vsubq_s32(peak, t)),
+                              psv_neon_sx16(vsubq_s32(t, vdupq_n_s32(32768))));
+    int32x4_t w_tri = vbslq_s32(window, tri, rail);
+
+    uint32x4_t n1 = vld1q_u32(&v->noise1[o]);
+    uint32x4_t n2 = vld1q_u32(&v->noise2[o]);
+    uint32x4_t is_noise = vceqq_u32(wave, vdupq_n_u32(4));
+    int32x4_t w_noise = vbslq_s32(closed, rail, psv_neon_sx16(vreinterpretq_s32_u32(n2)));
+    uint32x4_t noisy = vbicq_u32(is_noise, closed);
+    uint32x4_t n1x = veorq_u32(n1, n2);
+    vst1q_u32(&v->noise1[o], vbslq_u32(noisy, n1x, n1));
+    vst1q_u32(&v->noise2[o], vbslq_u32(noisy, vaddq_u32(n2, n1x), n2));
+
+    int32x4_t sample = vdupq_n_s32(0);
+    sample = vbslq_s32(vceqq_u32(wave, vdupq_n_u32(0)), w_sine, sample);
+    sample = vbslq_s32(vceqq_u32(wave, vdupq_n_u32(1)), w_square, sample);
+    sample = vbslq_s32(vceqq_u32(wave, vdupq_n_u32(2)), w_saw, sample);
+    sample = vbslq_s32(vceqq_u32(wave, vdupq_n_u32(3)), w_tri, sample);
+    sample = vbslq_s32(is_noise, w_noise, sample);
+    vst1q_s32(&v->sample[o], sample);
+
+    uint32x4_t vol = vld1q_u32(&v->vol[o]);
+    uint32x4_t adsr = vld1q_u32(&v->adsr[o]);
+    uint32x4_t decay_vol = vld1q_u32(&v->decay_vol[o]);
+    uint32x4_t hold = vtstq_u32(vld1q_u32(&v->hold[o]), vdupq_n_u32(UINT32_MAX));
+    uint32x4_t s_attack = vdupq_n_u32(PSV_ATTACK);
+    uint32x4_t s_decay = vdupq_n_u32(PSV_DECAY);
+    uint32x4_t s_sustain = vdupq_n_u32(PSV_SUSTAIN);
+
+    uint32x4_t attack_vol = vld1q_u32(&v->attack_vol[o]);
+    uint32x4_t va = vaddq_u32(vol, vld1q_u32(&v->attack_rate[o]));
+    uint32x4_t reached = vcgeq_u32(va, attack_vol);
+    va = vbslq_u32(reached, attack_vol, va);
+    uint32x4_t aa = vbslq_u32(reached, s_decay, s_attack);
+
+    uint32x4_t decay_rate = vld1q_u32(&v->decay_rate[o]);
+    uint32x4_t vd = vbicq_u32(vsubq_u32(vol, decay_rate), vcleq_u32(vol, decay_rate));
+    uint32x4_t done = vcleq_u32(vd, decay_vol);
+    vd = vbslq_u32(vandq_u32(done, hold), decay_vol, vd);
+    uint32x4_t ad = vbslq_u32(done, s_sustain, s_decay);
+
+    uint32x4_t vs = vbslq_u32(hold, decay_vol, vol);
+
+    uint32x4_t release_rate = vld1q_u32(&v->release_rate[o]);
+    uint32x4_t vr = vbicq_u32(vsubq_u32(vol, release_rate), vcleq_u32(vol, release_rate));
+
+    uint32x4_t in_attack = vceqq_u32(adsr, s_attack);
+    uint32x4_t in_decay = vceqq_u32(adsr, s_decay);
+    vol = vbslq_u32(in_attack, va, vol);
+    vol = vbslq_u32(in_decay, vd, vol);
+    vol = vbslq_u32(vceqq_u32(adsr, s_sustain), vs, vol);
+    vol = vbslq_u32(vceqq_u32(adsr, vdupq_n_u32(PSV_RELEASE)), vr, vol);
+    adsr = vbslq_u32(in_attack, aa, adsr);
+    adsr = vbslq_u32(in_decay, ad, adsr);
+    vst1q_u32(&v->vol[o], vol);
+    vst1q_u32(&v->adsr[o], adsr);
+}
+
+static inline void psv_neon_mix(const psv_voices_t *v, unsigned o, int32x4_t *l, int32x4_t *r)
+{
+    int32x4_t env = vreinterpretq_s32_u32(vshrq_n_u32(vld1q_u32(&v->vol[o]), 12));
+    int32x4_t s = vmulq_s32(vld1q_s32(&v->sample[o]), env);
+    s = vshrq_n_s32(vaddq_s32(s, vdupq_n_s32(1 << 11)), 12);
+    *l = vmlaq_s32(*l, s, vld1q_s32(&v->gain_l[o]));
+    *r = vmlaq_s32(*r, s, vld1q_s32(&v->gain_r[o]));
+}
+
+static void psv_neon(psv_voices_t *v, const int16_t *bel, int16_t *l, int16_t *r, unsigned n)
+{
+    for (unsigned s = 0; s < n; s++)
+    {
+        int32x4_t acc_l = vdupq_n_s32(0);
+        int32x4_t acc_r = vdupq_n_s32(0);
+        psv_neon_mix(v, 0, &acc_l, &acc_r);
+        psv_neon_mix(v, 4, &acc_l, &acc_r);
+        psv_out(psv_neon_sum(acc_l), psv_neon_sum(acc_r), bel[s], &l[s], &r[s]);
+        psv_neon_step(v, 0);
+        psv_neon_step(v, 4);
+    }
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Selection                                                           */
+/* ------------------------------------------------------------------ */
+
+static psv_variant_t psv_table[4];
+static size_t psv_count;
+
+/* Widest last. Idempotent: a second caller racing the first writes the same
+ * table. */
+static void psv_select(void)
+{
+    size_t n = 0;
+    psv_table[n++] = (psv_variant_t){"scalar", psv_scalar};
+#if PSV_SSE41
+    if (simd_cpu_sse41())
+        psv_table[n++] = (psv_variant_t){"sse4.1", psv_sse41};
+#endif
+#if PSV_AVX2
+    if (simd_cpu_avx2())
+        psv_table[n++] = (psv_variant_t){"avx2", psv_avx2};
+#endif
+#if PSV_NEON
+    psv_table[n++] = (psv_variant_t){"neon", psv_neon};
+#endif
+    psv_count = n;
+}
+
+size_t psv_variants(const psv_variant_t **variants)
+{
+    if (!psv_count)
+        psv_select();
+    *variants = psv_table;
+    return psv_count;
+}
+
+void psv_render(psv_voices_t *v, const int16_t *bel, int16_t *l, int16_t *r, unsigned n)
+{
+    if (!psv_count)
+        psv_select();
+    psv_table[psv_count - 1].fn(v, bel, l, r, n);
+}
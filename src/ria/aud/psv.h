@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _RIA_AUD_PSV_H_
+#define _RIA_AUD_PSV_H_
+
+/* The PSG's eight voices a lane each, for hosts with vector units.
+ *
+ * psg.c renders a block through this when it is built with PSG_VECTOR,
+ * which the emulator does and the RP2350 does not: the firmware makes one
+ * sample an interrupt and has no lanes to put a voice in. It is the same
+ * engine as psg_mix and psg_step — mix the voices as they stand, then
+ * step each one's phase, wave and envelope — with the registers already
+ * read out of XRAM and through the tables, and nothing from the gate
+ * queue, which psg_render drains before it hands a block over.
+ *
+ * It comes in SSE4.1, AVX2 and NEON. The scalar one is the reference; the
+ * others are held to it bit for bit (tests/aud/test_psv.c), and it is held
+ * to psg.c's handler, which the RTL is held to (tests/aud/test_psg.cpp).
+ * psv_render picks the widest the CPU runs, once, on first use.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PSV_VOICES 8
+
+/* Envelope states, numbered as psg.c numbers them. A lane in any other
+ * state is left as it is, as psg.c's switch leaves it. */
+#define PSV_RELEASE 0
+#define PSV_ATTACK 1
+#define PSV_DECAY 2
+#define PSV_SUSTAIN 3
+
+typedef struct
+{
+    /* The voices, read and written back. */
+    uint32_t phase[PSV_VOICES];
+    uint32_t phase_inc[PSV_VOICES];
+    uint32_t vol[PSV_VOICES];
+    uint32_t adsr[PSV_VOICES];
+    uint32_t noise1[PSV_VOICES];
+    uint32_t noise2[PSV_VOICES];
+    int32_t sample[PSV_VOICES]; /* an int16_t, widened */
+    /* The registers, read only. hold is nonzero where sustain holds at
+     * the decay level, psg_voice's hold. */
+    uint32_t wave[PSV_VOICES];
+    uint32_t duty[PSV_VOICES];
+    int32_t gain_l[PSV_VOICES];
+    int32_t gain_r[PSV_VOICES];
+    uint32_t attack_rate[PSV_VOICES];
+    uint32_t attack_vol[PSV_VOICES];
+    uint32_t decay_rate[PSV_VOICES];
+    uint32_t decay_vol[PSV_VOICES];
+    uint32_t release_rate[PSV_VOICES];
+    uint32_t hold[PSV_VOICES];
+} psv_voices_t;
+
+/* n samples into l and r, with bel[i] the bell's mono sample to mix into
+ * the i-th, as psg_mix takes it. */
+typedef void (*psv_fn_t)(psv_voices_t *v, const int16_t *bel,
+                         int16_t *l, int16_t *r, unsigned n);
+
+void psv_render(psv_voices_t *v, const int16_t *bel,
+                int16_t *l, int16_t *r, unsigned n);
+
+/* Every variant this build has and this CPU can run, the scalar reference
+ * first and the one psv_render uses last. */
+typedef struct
+{
+    const char *name;
+    psv_fn_t fn;
+} psv_variant_t;
+
+size_t psv_variants(const psv_variant_t **variants);
+
+#endif /* _RIA_AUD_PSV_H_ */
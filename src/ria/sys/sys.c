@@ -94,6 +94,7 @@ void sys_mon_status(const char *args)
     mon_add_response_utf8(SYS_NAME);
     mon_add_response_utf8(SYS_VERSION);
     mon_add_response_fn(vga_status_response);
+    mon_add_response_fn(vga_balance_response);
     mon_add_response_fn(wfi_status_response);
     mon_add_response_fn(ntp_status_response);
     mon_add_response_fn(tim_status_response);
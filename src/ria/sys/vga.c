@@ -17,6 +17,7 @@
 #include <pico/stdlib.h>
 #include <hardware/clocks.h>
 #include <hardware/timer.h>
+#include <string.h>
 #include <strings.h>
 #include <stdio.h>
 
@@ -34,6 +35,8 @@ static inline void DBG(const char *fmt, ...) { (void)fmt; }
 // with 10ms added for UART drain and safety margin
 // when changing canvas or timing.
 #define VGA_VSYNC_WATCHDOG_MS 44
+// A balance report is 275 bytes at 115200, held out of every VSYNC window.
+#define VGA_BALANCE_WATCHDOG_MS 250
 
 static enum {
     VGA_NOT_FOUND,       // Possibly normal, RP6502-VGA is optional
@@ -63,6 +66,19 @@ static volatile bool vga_vsync_trap_fired;
 static char vga_version_message[VGA_VERSION_MESSAGE_SIZE];
 static size_t vga_version_message_length;
 
+// Scanline balance report, laid out as src/vga/sys/bal.h describes.
+// It arrives a nibble at a time after a start byte.
+#define VGA_BALANCE_CORES 2
+#define VGA_BALANCE_MODES 7
+#define VGA_BALANCE_BUCKETS 8
+#define VGA_BALANCE_SLACK_NONE 127
+#define VGA_BALANCE_WORST (4 + VGA_BALANCE_CORES * 5)
+#define VGA_BALANCE_MODE (VGA_BALANCE_WORST + 4)
+#define VGA_BALANCE_SIZE (VGA_BALANCE_MODE + VGA_BALANCE_MODES * (1 + 2 * VGA_BALANCE_BUCKETS))
+static uint8_t vga_balance[VGA_BALANCE_SIZE];
+static volatile int vga_balance_nibbles = -1; // -1 until the start byte
+static absolute_time_t vga_balance_timer;
+
 static inline void vga_pix_backchannel_disable(void)
 {
     pix_send_blocking(PIX_DEVICE_VGA, 0xF, 0x04, 0);
@@ -188,6 +204,21 @@ static inline void vga_backchannel_command(uint8_t byte)
     case 0xA0:
         pix_nak();
         break;
+    case 0xB0:
+    {
+        int n = vga_balance_nibbles;
+        if (n < 0 || n >= 2 * VGA_BALANCE_SIZE)
+            break;
+        if (n & 1)
+            vga_balance[n / 2] |= (byte & 0xF) << 4;
+        else
+            vga_balance[n / 2] = byte & 0xF;
+        vga_balance_nibbles = n + 1;
+        break;
+    }
+    case 0xC0:
+        vga_balance_nibbles = 0;
+        break;
     }
 }
 
@@ -451,6 +482,73 @@ int vga_status_response(char *buf, size_t buf_size, int state, unsigned)
     return -1;
 }
 
+static uint16_t vga_balance_u16(size_t pos)
+{
+    return vga_balance[pos] | vga_balance[pos + 1] << 8;
+}
+
+static unsigned long vga_balance_u32(size_t pos)
+{
+    return vga_balance_u16(pos) | (unsigned long)vga_balance_u16(pos + 2) << 16;
+}
+
+int vga_balance_response(char *buf, size_t buf_size, int state, unsigned)
+{
+    if (state < 0 || !vga_connected())
+        return -1;
+    switch (state)
+    {
+    case 0:
+        vga_balance_nibbles = -1;
+        vga_balance_timer = make_timeout_time_ms(VGA_BALANCE_WATCHDOG_MS);
+        pix_send_blocking(PIX_DEVICE_VGA, 0xF, 0x04, 3);
+        return 1;
+    case 1:
+        if (vga_balance_nibbles == 2 * VGA_BALANCE_SIZE)
+            return 2;
+        // Older VGA firmware has no report to send.
+        if (time_reached(vga_balance_timer))
+            return -1;
+        return 1;
+    case 2:
+        com_snprintf_utf8(buf, buf_size, STR_STATUS_SCAN_CORES,
+                          vga_balance_u32(4), (int8_t)vga_balance[8],
+                          vga_balance_u32(9), (int8_t)vga_balance[13],
+                          vga_balance_u32(0));
+        return 3;
+    case 3:
+    {
+        int8_t worst = vga_balance[VGA_BALANCE_WORST];
+        uint8_t modes = vga_balance[VGA_BALANCE_WORST + 1];
+        if (worst == VGA_BALANCE_SLACK_NONE)
+            return -1;
+        char list[2 * VGA_BALANCE_MODES + 1] = "";
+        for (unsigned m = 0; m < VGA_BALANCE_MODES; m++)
+            if (modes & (1u << m))
+                snprintf(list + strlen(list), sizeof(list) - strlen(list), " %u", m);
+        com_snprintf_utf8(buf, buf_size, STR_STATUS_SCAN_WORST,
+                          worst, vga_balance_u16(VGA_BALANCE_WORST + 2), list);
+        return 4;
+    }
+    }
+    // Modes with no lines are left out.
+    for (unsigned m = state - 4; m < VGA_BALANCE_MODES; m++)
+    {
+        size_t pos = VGA_BALANCE_MODE + m * (1 + 2 * VGA_BALANCE_BUCKETS);
+        int8_t min = vga_balance[pos];
+        if (min == VGA_BALANCE_SLACK_NONE)
+            continue;
+        uint16_t hist[VGA_BALANCE_BUCKETS];
+        for (unsigned b = 0; b < VGA_BALANCE_BUCKETS; b++)
+            hist[b] = vga_balance_u16(pos + 1 + 2 * b);
+        com_snprintf_utf8(buf, buf_size, STR_STATUS_SCAN_MODE, m, min,
+                          hist[0], hist[1], hist[2], hist[3],
+                          hist[4], hist[5], hist[6], hist[7]);
+        return m + 1 < VGA_BALANCE_MODES ? (int)m + 5 : -1;
+    }
+    return -1;
+}
+
 void vga_load_display_type(const char *str)
 {
     str_parse_uint8(&str, &vga_display_type);
@@ -50,6 +50,8 @@ bool vga_connected(void);
 // Responders for status.
 int vga_boot_response(char *buf, size_t buf_size, int state, unsigned width);
 int vga_status_response(char *buf, size_t buf_size, int state, unsigned width);
+// Asks the VGA for its scanline balance since the last report.
+int vga_balance_response(char *buf, size_t buf_size, int state, unsigned width);
 
 // Configuration setting VGA
 void vga_load_display_type(const char *str);
@@ -110,19 +110,23 @@ bool main_xreg_1(uint8_t channel, uint8_t address, uint16_t word)
         {
             bool ok;
             vga_prog_mode((uint8_t)word, main_xregs[2]);
+            /* The fill engines read a plane's position from its config
+             * alone, so a scroll table the firmware would honor is refused
+             * here rather than drawn unscrolled. */
+            const bool scroll = main_xregs[2] & MODES_OPT_SCROLL;
             switch (word)
             {
             case 0:
                 ok = vid_mode0_prog(main_xregs);
                 break;
             case 1:
-                ok = mode1_prog(main_xregs);
+                ok = !scroll && mode1_prog(main_xregs);
                 break;
             case 2:
-                ok = mode2_prog(main_xregs);
+                ok = !scroll && mode2_prog(main_xregs);
                 break;
             case 3:
-                ok = mode3_prog(main_xregs);
+                ok = !scroll && mode3_prog(main_xregs);
                 break;
             case 4:
                 ok = mode4_prog(main_xregs);
@@ -130,6 +134,12 @@ bool main_xreg_1(uint8_t channel, uint8_t address, uint16_t word)
             case 5:
                 ok = mode5_prog(main_xregs);
                 break;
+            case 6:
+                /* No affine tile engine in the fabric: vid_sched runs
+                 * fills for modes 1 to 3 only, so the firmware's mode 6
+                 * is refused here rather than left a blank plane. */
+                ok = false;
+                break;
             default:
                 ok = false;
                 break;
@@ -12,7 +12,8 @@
  * it marks the plane whose stream is the terminal engine's, the same
  * way the sprite stage is its own engine beside this one. The firmware
  * registers mode 0 exclusively, so the marker is a plain mask with no
- * defense against several.
+ * defense against several. Mode 6, the affine tile map, has no engine
+ * here; the soft core refuses it before it reaches a slot.
  */
 
 module vid_sched (
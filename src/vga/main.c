@@ -11,6 +11,7 @@
 #include "vga/modes/mode3.h"
 #include "vga/modes/mode4.h"
 #include "vga/modes/mode5.h"
+#include "vga/modes/mode6.h"
 #include "vga/sys/com.h"
 #include "vga/sys/led.h"
 #include "vga/sys/pix.h"
@@ -68,6 +69,7 @@ void main_post_reclock(void)
 
 bool main_prog(uint16_t *xregs)
 {
+    vga_prog_mode(xregs[1]);
     switch (xregs[1])
     {
     case 0:
@@ -82,6 +84,8 @@ bool main_prog(uint16_t *xregs)
         return mode4_prog(xregs);
     case 5:
         return mode5_prog(xregs);
+    case 6:
+        return mode6_prog(xregs);
     default:
         return false;
     }
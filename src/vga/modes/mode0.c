@@ -15,6 +15,7 @@
 #include "vga/sys/vga.h"
 #include "vga/term/font.h"
 #include "vga/term/term.h"
+#include <string.h>
 
 static int16_t mode0_scanline_begin;
 
@@ -274,3 +275,68 @@ bool mode0_prog(uint16_t *xregs)
     }
     return false;
 }
+
+// The row's cells, then only the view state the row can show: the cursor on
+// the cursor's row, the blink phase on a row with a blinking cell. A still
+// console with a blinking cursor redraws the cursor's row and nothing else.
+size_t mode0_key(modes_fill_fn_t fill_fn, int16_t scanline_id, int16_t width, uint8_t *key)
+{
+    if (fill_fn != mode0_render)
+        return 0;
+    const int16_t font_height = width == 320 ? 8 : 16;
+    const uint8_t cols = width == 320 ? 40 : 80;
+    const uint8_t logical_row = (uint8_t)((scanline_id - mode0_scanline_begin) / font_height);
+    const term_data_t *cells = term_view_row(logical_row);
+    term_view_t tv;
+    term_view(&tv);
+    size_t len = (size_t)cols * sizeof(term_data_t);
+    memcpy(key, cells, len);
+    uint8_t blinks = 0;
+    for (int i = 0; i < cols; i++)
+        blinks |= cells[i].attributes;
+    key[len++] = (blinks & TERM_ATTR_ANY_BLINK) ? tv.blink_phase : 0;
+    if (logical_row == tv.cursor_y)
+    {
+        key[len++] = 1;
+        key[len++] = tv.cursor_x;
+        key[len++] = tv.cursor_style;
+        key[len++] = tv.cursor_enabled;
+        key[len++] = tv.cursor_lit;
+        memcpy(&key[len], &tv.cursor_color, sizeof tv.cursor_color);
+        len += sizeof tv.cursor_color;
+    }
+    else
+        key[len++] = 0;
+    return len;
+}
+
+#if !PICO_ON_DEVICE
+// A cell is a glyph row, its attributes and eight pixels from two colors;
+// the cursor's cell is drawn twice.
+bool mode0_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost)
+{
+    (void)plane_id;
+    (void)scanline_id;
+    if (fill_fn != mode0_render)
+        return false;
+    *cost = (modes_cost_t){.call = 250, .pixel16 = 40};
+    return true;
+}
+#endif
+
+// Savestates. The first scanline of the console is all the view keeps.
+size_t mode0_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, &mode0_scanline_begin, sizeof mode0_scanline_begin);
+    return sizeof mode0_scanline_begin;
+}
+
+bool mode0_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof mode0_scanline_begin)
+        return false;
+    memcpy(&mode0_scanline_begin, buf, sizeof mode0_scanline_begin);
+    return true;
+}
@@ -10,7 +10,25 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "vga/modes/modes.h"
 
 bool mode0_prog(uint16_t *xregs);
 
+// Dirty-line tracking (modes.h). The console draws from the terminal, not
+// XRAM, so its scanline is described by value instead: what it would draw
+// from, as bytes for the host to compare with last time. Returns the
+// length (at most MODE0_KEY_MAX), or 0 when fill_fn is not mode 0's.
+#define MODE0_KEY_MAX (80 * 8 + 16)
+size_t mode0_key(modes_fill_fn_t fill_fn, int16_t scanline_id, int16_t width, uint8_t *key);
+
+#if !PICO_ON_DEVICE
+// Render budget (modes.h): what one call of fill_fn costs the device.
+bool mode0_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost);
+#endif
+
+// Savestates: where the console starts on the canvas.
+size_t mode0_state_save(void *buf);
+bool mode0_state_load(const void *buf, size_t len);
+
 #endif /* _VGA_MODES_MODE0_H_ */
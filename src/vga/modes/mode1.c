@@ -28,6 +28,9 @@ typedef struct
     uint16_t xram_font_ptr;
 } mode1_config_t;
 
+// The planes, a bit each, whose scanline was programmed with a scroll table.
+static uint8_t mode1_scroll[VGA_PROG_MAX];
+
 typedef struct
 {
     uint8_t glyph_code;
@@ -60,6 +63,31 @@ typedef struct
     uint16_t bg_color;
 } mode1_16bpp_data_t;
 
+// The scroll table pointer after the config, for a plane with
+// MODES_OPT_SCROLL.
+static inline __attribute__((always_inline)) uint16_t
+mode1_scroll_ptr(uint16_t config_ptr)
+{
+    return *(volatile const uint16_t *)&xram[config_ptr + sizeof(mode1_config_t)];
+}
+
+// The config as one scanline of a plane sees it: a copy, moved by the
+// scanline's scroll table entry when the plane has one.
+static inline __attribute__((always_inline)) void
+mode1_get_config(int16_t plane_id, int16_t scanline_id, uint16_t config_ptr, mode1_config_t *config)
+{
+    *config = *(mode1_config_t *)&xram[config_ptr];
+    if (!(mode1_scroll[scanline_id] & (1u << plane_id)))
+        return;
+    const uint32_t at = modes_scroll_at(mode1_scroll_ptr(config_ptr), scanline_id);
+    if (at < 0x10000)
+    {
+        const modes_scroll_t *scroll = (void *)&xram[at];
+        config->x_pos_px += scroll->x;
+        config->y_pos_px += scroll->y;
+    }
+}
+
 static volatile const uint8_t *
 mode1_scanline_to_data(int16_t scanline_id, mode1_config_t *config, size_t cell_size, int16_t font_height, int16_t *row)
 {
@@ -132,6 +160,7 @@ mode1_fill_cols(mode1_config_t *config, uint16_t **rgb, int16_t *col, int16_t *w
         {
             memset(*rgb, 0, sizeof(uint16_t) * (*width));
             *width = 0;
+            return 0;
         }
     }
     int16_t fill_cols = *width;
@@ -142,10 +171,11 @@ mode1_fill_cols(mode1_config_t *config, uint16_t **rgb, int16_t *col, int16_t *w
 }
 
 static inline __attribute__((always_inline)) bool
-mode1_render_1bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
+mode1_render_1bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb,
                   uint16_t config_ptr, int16_t font_height)
 {
-    mode1_config_t *config = (void *)&xram[config_ptr];
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
     int16_t row;
     volatile const mode1_1bpp_data_t *row_data =
         (void *)mode1_scanline_to_data(scanline_id, config, sizeof(mode1_1bpp_data_t), font_height, &row);
@@ -187,22 +217,21 @@ mode1_render_1bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
 static bool
 mode1_render_1bpp_8x8(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_1bpp(scanline_id, width, rgb, config_ptr, 8);
+    return mode1_render_1bpp(plane_id, scanline_id, width, rgb, config_ptr, 8);
 }
 
 static bool
 mode1_render_1bpp_8x16(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_1bpp(scanline_id, width, rgb, config_ptr, 16);
+    return mode1_render_1bpp(plane_id, scanline_id, width, rgb, config_ptr, 16);
 }
 
 static inline __attribute__((always_inline)) bool
-mode1_render_4bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
+mode1_render_4bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb,
                   uint16_t config_ptr, int16_t font_height)
 {
-    mode1_config_t *config = (void *)&xram[config_ptr];
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
     int16_t row;
     volatile const mode1_4bpp_data_t *row_data =
         (void *)mode1_scanline_to_data(scanline_id, config, sizeof(mode1_4bpp_data_t), font_height, &row);
@@ -251,22 +280,21 @@ mode1_render_4bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
 static bool
 mode1_render_4bpp_8x8(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_4bpp(scanline_id, width, rgb, config_ptr, 8);
+    return mode1_render_4bpp(plane_id, scanline_id, width, rgb, config_ptr, 8);
 }
 
 static bool
 mode1_render_4bpp_8x16(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_4bpp(scanline_id, width, rgb, config_ptr, 16);
+    return mode1_render_4bpp(plane_id, scanline_id, width, rgb, config_ptr, 16);
 }
 
 static inline __attribute__((always_inline)) bool
-mode1_render_4bppr(int16_t scanline_id, int16_t width, uint16_t *rgb,
+mode1_render_4bppr(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb,
                    uint16_t config_ptr, int16_t font_height)
 {
-    mode1_config_t *config = (void *)&xram[config_ptr];
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
     int16_t row;
     volatile const mode1_4bppr_data_t *row_data =
         (void *)mode1_scanline_to_data(scanline_id, config, sizeof(mode1_4bppr_data_t), font_height, &row);
@@ -315,22 +343,21 @@ mode1_render_4bppr(int16_t scanline_id, int16_t width, uint16_t *rgb,
 static bool
 mode1_render_4bppr_8x8(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_4bppr(scanline_id, width, rgb, config_ptr, 8);
+    return mode1_render_4bppr(plane_id, scanline_id, width, rgb, config_ptr, 8);
 }
 
 static bool
 mode1_render_4bppr_8x16(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_4bppr(scanline_id, width, rgb, config_ptr, 16);
+    return mode1_render_4bppr(plane_id, scanline_id, width, rgb, config_ptr, 16);
 }
 
 static inline __attribute__((always_inline)) bool
-mode1_render_8bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
+mode1_render_8bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb,
                   uint16_t config_ptr, int16_t font_height)
 {
-    mode1_config_t *config = (void *)&xram[config_ptr];
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
     int16_t row;
     volatile const mode1_8bpp_data_t *row_data =
         (void *)mode1_scanline_to_data(scanline_id, config, sizeof(mode1_8bpp_data_t), font_height, &row);
@@ -379,22 +406,21 @@ mode1_render_8bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
 static bool
 mode1_render_8bpp_8x8(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_8bpp(scanline_id, width, rgb, config_ptr, 8);
+    return mode1_render_8bpp(plane_id, scanline_id, width, rgb, config_ptr, 8);
 }
 
 static bool
 mode1_render_8bpp_8x16(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_8bpp(scanline_id, width, rgb, config_ptr, 16);
+    return mode1_render_8bpp(plane_id, scanline_id, width, rgb, config_ptr, 16);
 }
 
 static inline __attribute__((always_inline)) bool
-mode1_render_16bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
+mode1_render_16bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb,
                    uint16_t config_ptr, int16_t font_height)
 {
-    mode1_config_t *config = (void *)&xram[config_ptr];
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
     int16_t row;
     volatile const mode1_16bpp_data_t *row_data =
         (void *)mode1_scanline_to_data(scanline_id, config, sizeof(mode1_16bpp_data_t), font_height, &row);
@@ -437,15 +463,13 @@ mode1_render_16bpp(int16_t scanline_id, int16_t width, uint16_t *rgb,
 static bool
 mode1_render_16bpp_8x8(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_16bpp(scanline_id, width, rgb, config_ptr, 8);
+    return mode1_render_16bpp(plane_id, scanline_id, width, rgb, config_ptr, 8);
 }
 
 static bool
 mode1_render_16bpp_8x16(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    return mode1_render_16bpp(scanline_id, width, rgb, config_ptr, 16);
+    return mode1_render_16bpp(plane_id, scanline_id, width, rgb, config_ptr, 16);
 }
 
 bool mode1_prog(uint16_t *xregs)
@@ -456,12 +480,14 @@ bool mode1_prog(uint16_t *xregs)
     const int16_t scanline_begin = xregs[5];
     const int16_t scanline_end = xregs[6];
 
+    const size_t config_size =
+        sizeof(mode1_config_t) + (attributes & MODES_OPT_SCROLL ? MODES_SCROLL_PTR_SIZE : 0);
     if (config_ptr & 1 ||
-        config_ptr > 0x10000 - sizeof(mode1_config_t))
+        config_ptr > 0x10000 - config_size)
         return false;
 
     bool (*render_fn)(int16_t, int16_t, int16_t, uint16_t *, uint16_t);
-    switch (attributes)
+    switch (attributes & ~MODES_OPT_SCROLL)
     {
     case 0:
         render_fn = mode1_render_1bpp_8x8;
@@ -497,7 +523,130 @@ bool mode1_prog(uint16_t *xregs)
         return false;
     };
 
-    return vga_prog_fill(plane, scanline_begin, scanline_end, config_ptr, render_fn);
+    const int16_t end = scanline_end ? scanline_end : vga_canvas_height();
+    if (!vga_prog_fill(plane, scanline_begin, end, config_ptr, render_fn))
+        return false;
+    for (int16_t i = scanline_begin; i < end; i++)
+    {
+        if (attributes & MODES_OPT_SCROLL)
+            mode1_scroll[i] |= 1u << plane;
+        else
+            mode1_scroll[i] &= ~(1u << plane);
+    }
+    return true;
+}
+
+// The config, the scroll table entry when the plane has one, the row of
+// cells, and the palette and the glyph row when they are in XRAM. A missing
+// row reads the config alone.
+int mode1_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans)
+{
+    static const struct
+    {
+        modes_fill_fn_t fn;
+        uint8_t cell_size, bpp, font_height; // bpp 0: colors are in the cells
+    } fills[] = {
+        {mode1_render_1bpp_8x8, sizeof(mode1_1bpp_data_t), 1, 8},
+        {mode1_render_4bppr_8x8, sizeof(mode1_4bppr_data_t), 4, 8},
+        {mode1_render_4bpp_8x8, sizeof(mode1_4bpp_data_t), 4, 8},
+        {mode1_render_8bpp_8x8, sizeof(mode1_8bpp_data_t), 8, 8},
+        {mode1_render_16bpp_8x8, sizeof(mode1_16bpp_data_t), 0, 8},
+        {mode1_render_1bpp_8x16, sizeof(mode1_1bpp_data_t), 1, 16},
+        {mode1_render_4bppr_8x16, sizeof(mode1_4bppr_data_t), 4, 16},
+        {mode1_render_4bpp_8x16, sizeof(mode1_4bpp_data_t), 4, 16},
+        {mode1_render_8bpp_8x16, sizeof(mode1_8bpp_data_t), 8, 16},
+        {mode1_render_16bpp_8x16, sizeof(mode1_16bpp_data_t), 0, 16},
+    };
+    size_t i = 0;
+    while (i < sizeof fills / sizeof *fills && fills[i].fn != fill_fn)
+        i++;
+    if (i == sizeof fills / sizeof *fills)
+        return -1;
+    mode1_config_t config_line, *config = &config_line;
+    mode1_get_config(plane_id, scanline_id, config_ptr, config);
+    const bool scroll = mode1_scroll[scanline_id] & (1u << plane_id);
+    int n = 0;
+    spans[n++] = (modes_span_t){config_ptr, (uint32_t)config_ptr + sizeof(mode1_config_t) +
+                                                (scroll ? MODES_SCROLL_PTR_SIZE : 0)};
+    if (scroll)
+    {
+        const uint32_t at = modes_scroll_at(mode1_scroll_ptr(config_ptr), scanline_id);
+        if (at < 0x10000)
+            spans[n++] = (modes_span_t){at, at + sizeof(modes_scroll_t)};
+    }
+    int16_t row;
+    volatile const uint8_t *row_data =
+        mode1_scanline_to_data(scanline_id, config, fills[i].cell_size, fills[i].font_height, &row);
+    if (!row_data)
+        return n;
+    const uint32_t data = (uint32_t)(row_data - xram);
+    spans[n++] = (modes_span_t){data, data + (uint32_t)config->width_chars * fills[i].cell_size};
+    if (fills[i].bpp)
+    {
+        volatile const uint16_t *palette = mode1_get_palette(config, fills[i].bpp);
+        if (palette == (volatile const uint16_t *)&xram[config->xram_palette_ptr])
+            spans[n++] = (modes_span_t){config->xram_palette_ptr,
+                                        config->xram_palette_ptr + (2u << fills[i].bpp)};
+    }
+    volatile const uint8_t *font = mode1_get_font(config, fills[i].font_height);
+    if (font == &xram[config->xram_font_ptr])
+    {
+        const uint32_t glyphs = (uint32_t)config->xram_font_ptr + 256u * (uint32_t)row;
+        spans[n++] = (modes_span_t){glyphs, glyphs + 256};
+    }
+    return n;
+}
+
+#if !PICO_ON_DEVICE
+// A cell is a glyph row and eight pixels from two colors, looked up for
+// each cell when the cell carries them; the palette is copied first.
+bool mode1_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost)
+{
+    (void)plane_id;
+    (void)scanline_id;
+    static const struct
+    {
+        modes_fill_fn_t fn;
+        modes_cost_t cost;
+    } fills[] = {
+        {mode1_render_1bpp_8x8, {.call = 200, .pixel16 = 36}},
+        {mode1_render_4bppr_8x8, {.call = 250, .pixel16 = 52}},
+        {mode1_render_4bpp_8x8, {.call = 250, .pixel16 = 52}},
+        {mode1_render_8bpp_8x8, {.call = 950, .pixel16 = 56}},
+        {mode1_render_16bpp_8x8, {.call = 200, .pixel16 = 48}},
+        {mode1_render_1bpp_8x16, {.call = 200, .pixel16 = 36}},
+        {mode1_render_4bppr_8x16, {.call = 250, .pixel16 = 52}},
+        {mode1_render_4bpp_8x16, {.call = 250, .pixel16 = 52}},
+        {mode1_render_8bpp_8x16, {.call = 950, .pixel16 = 56}},
+        {mode1_render_16bpp_8x16, {.call = 200, .pixel16 = 48}},
+    };
+    for (size_t i = 0; i < sizeof fills / sizeof *fills; i++)
+        if (fills[i].fn == fill_fn)
+        {
+            *cost = fills[i].cost;
+            return true;
+        }
+    return false;
+}
+#endif
+
+// Savestates. The scroll bits are the only per-line state; the rest is in
+// XRAM or is the fill itself.
+size_t mode1_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, mode1_scroll, sizeof mode1_scroll);
+    return sizeof mode1_scroll;
+}
+
+bool mode1_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof mode1_scroll)
+        return false;
+    memcpy(mode1_scroll, buf, sizeof mode1_scroll);
+    return true;
 }
 
 #pragma GCC pop_options
@@ -28,12 +28,75 @@ typedef struct
     uint16_t xram_tile_ptr;
 } mode2_config_t;
 
-// Per-scanline, per-plane validated mode-2 OPTIONS word (bpp, tile size, x/y trim).
+// Per-scanline, per-plane validated mode-2 OPTIONS word (bpp, tile size, x/y trim,
+// scroll table).
 // It is the single source of truth for the selector: mode2_render loads it with one
 // atomic access and derives tile_size and trim from the same word, so a read racing a
 // concurrent reprogram can never pair a tile_size with an out-of-range trim.
 static uint16_t mode2_options[VGA_PROG_MAX][SCANVIDEO_PLANE_COUNT];
 
+#ifdef MODES_TILE_CACHE
+// Tile rows expanded through the palette, for a host with the memory to spare:
+// a tile's row draws as a copy of the pixels the last line to show it made.
+// A plane's rows belong to one tile set, format and palette, and are dropped
+// together when any of them changes. With XRAM write stamps (MODES_THREADS)
+// that is when the tile set or palette was written; without, each row keeps
+// the bytes it was made from and each line the palette, and both are
+// compared. Direct-mapped on the row's place in the tile set, so the first
+// 128 tiles of 8 or 64 of 16 never push each other out.
+#define MODE2_CACHE_ROWS 1024
+
+typedef struct
+{
+    uint32_t tile_mem; // the row's XRAM address
+    uint32_t gen;      // valid while the cache's
+#ifndef MODES_THREADS
+    uint8_t src[16]; // the bytes it was expanded from
+#endif
+    uint16_t px[16];
+} mode2_row_t;
+
+typedef struct
+{
+    uint32_t gen; // 0 before the first line
+    uint16_t tile_ptr, palette_ptr;
+    int16_t bpp, tile_size;
+#ifdef MODES_THREADS
+    uint64_t stamp; // *modes_xram_stamp as of the last line
+#else
+    uint16_t pal[256];
+#endif
+    mode2_row_t row[MODE2_CACHE_ROWS];
+} mode2_cache_t;
+
+static MODES_THREAD_LOCAL mode2_cache_t mode2_cache[SCANVIDEO_PLANE_COUNT];
+#endif
+
+// The scroll table pointer after the config, for a plane with
+// MODES_OPT_SCROLL.
+static inline __attribute__((always_inline)) uint16_t
+mode2_scroll_ptr(uint16_t config_ptr)
+{
+    return *(volatile const uint16_t *)&xram[config_ptr + sizeof(mode2_config_t)];
+}
+
+// The config as one scanline sees it: a copy, moved by the scanline's scroll
+// table entry when its options ask for one.
+static inline __attribute__((always_inline)) void
+mode2_get_config(uint16_t opt, int16_t scanline_id, uint16_t config_ptr, mode2_config_t *config)
+{
+    *config = *(mode2_config_t *)&xram[config_ptr];
+    if (!(opt & MODES_OPT_SCROLL))
+        return;
+    const uint32_t at = modes_scroll_at(mode2_scroll_ptr(config_ptr), scanline_id);
+    if (at < 0x10000)
+    {
+        const modes_scroll_t *scroll = (void *)&xram[at];
+        config->x_pos_px += scroll->x;
+        config->y_pos_px += scroll->y;
+    }
+}
+
 // tile_h is the on-screen tile height: the base tile_size when untrimmed, less
 // when Y-trimmed (then non-power-of-2, hence the modulo). *row is left holding the
 // row within the tile.
@@ -99,6 +162,7 @@ mode2_fill_cols(mode2_config_t *config, uint16_t **rgb, int16_t *col, int16_t *w
         {
             memset(*rgb, 0, sizeof(uint16_t) * (*width));
             *width = 0;
+            return 0;
         }
     }
     int16_t fill_cols = *width;
@@ -204,7 +268,7 @@ mode2_emit_full(mode2_config_t *config, uint16_t *rgb, int16_t width,
             uint16_t index;
             uint32_t tile_mem = mode2_get_tile_row_addr(config, 4, tile_size, col, row, row_data, &index);
             uint8_t bits = xram[tile_mem + index];
-            if (col & 1)
+            if (fill_cols && (col & 1))
             {
                 *rgb++ = pal[bits & 0xF];
                 col++;
@@ -249,53 +313,227 @@ mode2_emit_full(mode2_config_t *config, uint16_t *rgb, int16_t width,
     }
 }
 
-// Trimmed emission. The effective tile is eff_w wide (< tile_size), so on-screen
-// tiles no longer align to data bytes and the byte-walk above can't be used;
-// pixels are read individually. Tile data is still stored at the full tile_size.
+// Pixels [start, start + count) of one data byte, all within it.
+static inline __attribute__((always_inline)) void
+mode2_emit_part(uint16_t **rgb, uint8_t bits, const uint16_t *pal,
+                int16_t start, int16_t count, int16_t bpp)
+{
+    if (bpp == 1)
+        modes_emit_head_1bpp(rgb, bits, pal, start, count);
+    else if (bpp == 2)
+        modes_emit_head_2bpp(rgb, bits, pal, start, count);
+    else if (bpp == 4)
+    {
+        if (!start)
+            *(*rgb)++ = pal[bits >> 4];
+        if (start || count == 2)
+            *(*rgb)++ = pal[bits & 0xF];
+    }
+    else
+        *(*rgb)++ = pal[bits];
+}
+
+// Trimmed emission. The effective tile is eff_w wide (< tile_size) while its data
+// is still stored at the full tile_size, so on-screen tiles no longer align to data
+// bytes. Each tile's run still is: a partial head byte (only where a segment starts
+// inside a tile), whole bytes, a partial tail byte. That schedule is worked out
+// from the column once a segment, then tiles are stepped through, not divided out.
 static inline __attribute__((always_inline)) void
 mode2_emit_trim(mode2_config_t *config, uint16_t *rgb, int16_t width,
                 volatile const uint8_t *row_data, int16_t row, int16_t eff_w,
                 const uint16_t *pal, int16_t tile_size, int16_t bpp)
 {
+    const int16_t pixels_per_byte = 8 / bpp;
     const uint32_t row_size = (uint32_t)tile_size * bpp / 8;
     const uint32_t mem_size = row_size * tile_size;
     const uint32_t row_off = (uint32_t)config->xram_tile_ptr + row_size * row;
     int16_t col = -config->x_pos_px;
     while (width)
+    {
+        int16_t fill_cols = mode2_fill_cols(config, &rgb, &col, &width, eff_w);
+        if (fill_cols <= 0)
+            continue;
+        int16_t tile = col / eff_w;
+        int16_t px = col - tile * eff_w;
+        col += fill_cols;
+        while (fill_cols > 0)
+        {
+            volatile const uint8_t *data = &xram[row_off + mem_size * row_data[tile++]];
+            int16_t end = px + fill_cols;
+            if (end > eff_w)
+                end = eff_w;
+            fill_cols -= end - px;
+            data += px / pixels_per_byte;
+            const int16_t start = px % pixels_per_byte;
+            if (start)
+            {
+                int16_t part = pixels_per_byte - start;
+                if (part > end - px)
+                    part = end - px;
+                mode2_emit_part(&rgb, *data++, pal, start, part, bpp);
+                px += part;
+            }
+            for (; end - px >= pixels_per_byte; px += pixels_per_byte)
+            {
+                const uint8_t bits = *data++;
+                if (bpp == 1)
+                {
+                    modes_render_1bpp(rgb, bits, pal[0], pal[1]);
+                    rgb += 8;
+                }
+                else
+                    mode2_emit_part(&rgb, bits, pal, 0, pixels_per_byte, bpp);
+            }
+            if (px < end)
+                mode2_emit_part(&rgb, *data, pal, 0, end - px, bpp);
+            px = 0;
+        }
+    }
+}
+
+#ifdef MODES_TILE_CACHE
+// Once a line, before its rows are looked up: drop every row if what they
+// were made from may have changed.
+static inline __attribute__((always_inline)) void
+mode2_cache_line(mode2_cache_t *cache, mode2_config_t *config, const uint16_t *pal,
+                 int16_t tile_size, int16_t bpp)
+{
+    const uint16_t tile_ptr = config->xram_tile_ptr;
+    const uint16_t palette_ptr = config->xram_palette_ptr;
+    bool stale = !cache->gen || cache->tile_ptr != tile_ptr ||
+                 cache->palette_ptr != palette_ptr ||
+                 cache->bpp != bpp || cache->tile_size != tile_size;
+#ifdef MODES_THREADS
+    // A line from an older view than the last can't tell what changed since.
+    (void)pal;
+    const uint64_t now = *modes_xram_stamp;
+    if (!stale && now != cache->stamp)
+        stale = now < cache->stamp ||
+                modes_xram_written_since(tile_ptr, tile_ptr + 256u * tile_size * tile_size * bpp / 8,
+                                         cache->stamp) ||
+                modes_xram_written_since(palette_ptr, palette_ptr + (2u << bpp), cache->stamp);
+    cache->stamp = now;
+#else
+    if (!stale)
+        stale = memcmp(cache->pal, pal, sizeof(uint16_t) << bpp) != 0;
+#endif
+    if (!stale)
+        return;
+#ifndef MODES_THREADS
+    memcpy(cache->pal, pal, sizeof(uint16_t) << bpp);
+#endif
+    if (!++cache->gen)
+    {
+        memset(cache->row, 0, sizeof(cache->row));
+        cache->gen = 1;
+    }
+    cache->tile_ptr = tile_ptr;
+    cache->palette_ptr = palette_ptr;
+    cache->bpp = bpp;
+    cache->tile_size = tile_size;
+}
+
+// The tile row at tile_mem as tile_size pixels.
+static inline __attribute__((always_inline)) const uint16_t *
+mode2_cache_row(mode2_cache_t *cache, uint32_t tile_mem, const uint16_t *pal,
+                int16_t tile_size, int16_t bpp)
+{
+    const int16_t row_size = tile_size * bpp / 8;
+    mode2_row_t *r = &cache->row[tile_mem / row_size % MODE2_CACHE_ROWS];
+    const bool held = r->gen == cache->gen && r->tile_mem == tile_mem;
+#ifdef MODES_THREADS
+    if (held)
+        return r->px;
+    uint8_t src[16];
+#else
+    uint8_t *src = r->src;
+    bool same = held;
+#endif
+    for (int16_t i = 0; i < row_size; i++)
+    {
+        const uint8_t b = xram[tile_mem + i];
+#ifndef MODES_THREADS
+        same = same && src[i] == b;
+#endif
+        src[i] = b;
+    }
+#ifndef MODES_THREADS
+    if (same)
+        return r->px;
+#endif
+    for (int16_t px = 0; px < tile_size; px++)
+    {
+        uint8_t idx;
+        if (bpp == 1)
+            idx = (src[px >> 3] >> (7 - (px & 7))) & 0x01;
+        else if (bpp == 2)
+            idx = (src[px >> 2] >> (6 - 2 * (px & 3))) & 0x03;
+        else if (bpp == 4)
+            idx = (px & 1) ? (src[px >> 1] & 0x0F) : (src[px >> 1] >> 4);
+        else
+            idx = src[px];
+        r->px[px] = pal[idx];
+    }
+    r->tile_mem = tile_mem;
+    r->gen = cache->gen;
+    return r->px;
+}
+
+// Trimmed or not, every tile is a copy of the first eff_w of its row.
+static inline __attribute__((always_inline)) void
+mode2_emit_cached(mode2_config_t *config, uint16_t *rgb, int16_t width,
+                  volatile const uint8_t *row_data, int16_t row, int16_t eff_w,
+                  const uint16_t *pal, int16_t tile_size, int16_t bpp, mode2_cache_t *cache)
+{
+    const uint32_t row_size = (uint32_t)tile_size * bpp / 8;
+    const uint32_t mem_size = row_size * tile_size;
+    const uint32_t row_off = (uint32_t)config->xram_tile_ptr + row_size * row;
+    mode2_cache_line(cache, config, pal, tile_size, bpp);
+    int16_t col = -config->x_pos_px;
+    while (width)
     {
         int16_t fill_cols = mode2_fill_cols(config, &rgb, &col, &width, eff_w);
         while (fill_cols > 0)
         {
             const int16_t col_in_tile = col % eff_w;
-            const uint32_t tile_mem = row_off + mem_size * row_data[col / eff_w];
+            const uint16_t *px =
+                mode2_cache_row(cache, row_off + mem_size * row_data[col / eff_w], pal, tile_size, bpp);
             int16_t run = eff_w - col_in_tile;
             if (run > fill_cols)
                 run = fill_cols;
+            memcpy(rgb, px + col_in_tile, sizeof(uint16_t) * run);
+            rgb += run;
             col += run;
             fill_cols -= run;
-            for (int16_t px = col_in_tile; px < col_in_tile + run; px++)
-            {
-                uint8_t idx;
-                if (bpp == 1)
-                    idx = (xram[tile_mem + (px >> 3)] >> (7 - (px & 7))) & 0x01;
-                else if (bpp == 2)
-                    idx = (xram[tile_mem + (px >> 2)] >> (6 - 2 * (px & 3))) & 0x03;
-                else if (bpp == 4)
-                    idx = (px & 1) ? (xram[tile_mem + (px >> 1)] & 0x0F)
-                                   : (xram[tile_mem + (px >> 1)] >> 4);
-                else
-                    idx = xram[tile_mem + px];
-                *rgb++ = pal[idx];
-            }
         }
     }
 }
+#endif
+
+static inline __attribute__((always_inline)) void
+mode2_emit(int16_t plane_id, mode2_config_t *config, uint16_t *rgb, int16_t width,
+           volatile const uint8_t *row_data, int16_t row, int16_t x_trim, int16_t y_trim,
+           const uint16_t *pal, int16_t tile_size, int16_t bpp)
+{
+#ifdef MODES_TILE_CACHE
+    (void)y_trim;
+    mode2_emit_cached(config, rgb, width, row_data, row, tile_size - x_trim, pal,
+                      tile_size, bpp, &mode2_cache[plane_id]);
+#else
+    (void)plane_id;
+    if (x_trim || y_trim)
+        mode2_emit_trim(config, rgb, width, row_data, row, tile_size - x_trim, pal, tile_size, bpp);
+    else
+        mode2_emit_full(config, rgb, width, row_data, row, pal, tile_size, bpp);
+#endif
+}
 
 static inline __attribute__((always_inline)) bool
-mode2_render_1bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
-                  int16_t x_trim, int16_t y_trim, int16_t tile_size)
+mode2_render_1bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
+                  uint16_t opt, int16_t x_trim, int16_t y_trim, int16_t tile_size)
 {
-    mode2_config_t *config = (void *)&xram[config_ptr];
+    mode2_config_t config_line, *config = &config_line;
+    mode2_get_config(opt, scanline_id, config_ptr, config);
     int16_t row;
     volatile const uint8_t *row_data =
         mode2_scanline_to_data(scanline_id, config, tile_size - y_trim, &row);
@@ -303,18 +541,16 @@ mode2_render_1bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t co
         return false;
     volatile const uint16_t *palette = mode2_get_palette(config, 1);
     uint16_t pal[2] = {palette[0], palette[1]};
-    if (x_trim || y_trim)
-        mode2_emit_trim(config, rgb, width, row_data, row, tile_size - x_trim, pal, tile_size, 1);
-    else
-        mode2_emit_full(config, rgb, width, row_data, row, pal, tile_size, 1);
+    mode2_emit(plane_id, config, rgb, width, row_data, row, x_trim, y_trim, pal, tile_size, 1);
     return true;
 }
 
 static inline __attribute__((always_inline)) bool
-mode2_render_2bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
-                  int16_t x_trim, int16_t y_trim, int16_t tile_size)
+mode2_render_2bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
+                  uint16_t opt, int16_t x_trim, int16_t y_trim, int16_t tile_size)
 {
-    mode2_config_t *config = (void *)&xram[config_ptr];
+    mode2_config_t config_line, *config = &config_line;
+    mode2_get_config(opt, scanline_id, config_ptr, config);
     int16_t row;
     volatile const uint8_t *row_data =
         mode2_scanline_to_data(scanline_id, config, tile_size - y_trim, &row);
@@ -322,18 +558,16 @@ mode2_render_2bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t co
         return false;
     volatile const uint16_t *palette = mode2_get_palette(config, 2);
     uint16_t pal[4] = {palette[0], palette[1], palette[2], palette[3]};
-    if (x_trim || y_trim)
-        mode2_emit_trim(config, rgb, width, row_data, row, tile_size - x_trim, pal, tile_size, 2);
-    else
-        mode2_emit_full(config, rgb, width, row_data, row, pal, tile_size, 2);
+    mode2_emit(plane_id, config, rgb, width, row_data, row, x_trim, y_trim, pal, tile_size, 2);
     return true;
 }
 
 static inline __attribute__((always_inline)) bool
-mode2_render_4bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
-                  int16_t x_trim, int16_t y_trim, int16_t tile_size)
+mode2_render_4bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
+                  uint16_t opt, int16_t x_trim, int16_t y_trim, int16_t tile_size)
 {
-    mode2_config_t *config = (void *)&xram[config_ptr];
+    mode2_config_t config_line, *config = &config_line;
+    mode2_get_config(opt, scanline_id, config_ptr, config);
     int16_t row;
     volatile const uint8_t *row_data =
         mode2_scanline_to_data(scanline_id, config, tile_size - y_trim, &row);
@@ -343,18 +577,16 @@ mode2_render_4bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t co
     uint16_t pal[16];
     for (int i = 0; i < 16; i++)
         pal[i] = palette[i];
-    if (x_trim || y_trim)
-        mode2_emit_trim(config, rgb, width, row_data, row, tile_size - x_trim, pal, tile_size, 4);
-    else
-        mode2_emit_full(config, rgb, width, row_data, row, pal, tile_size, 4);
+    mode2_emit(plane_id, config, rgb, width, row_data, row, x_trim, y_trim, pal, tile_size, 4);
     return true;
 }
 
 static inline __attribute__((always_inline)) bool
-mode2_render_8bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
-                  int16_t x_trim, int16_t y_trim, int16_t tile_size)
+mode2_render_8bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
+                  uint16_t opt, int16_t x_trim, int16_t y_trim, int16_t tile_size)
 {
-    mode2_config_t *config = (void *)&xram[config_ptr];
+    mode2_config_t config_line, *config = &config_line;
+    mode2_get_config(opt, scanline_id, config_ptr, config);
     int16_t row;
     volatile const uint8_t *row_data =
         mode2_scanline_to_data(scanline_id, config, tile_size - y_trim, &row);
@@ -364,10 +596,7 @@ mode2_render_8bpp(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t co
     uint16_t pal[256];
     for (int i = 0; i < 256; i++)
         pal[i] = palette[i];
-    if (x_trim || y_trim)
-        mode2_emit_trim(config, rgb, width, row_data, row, tile_size - x_trim, pal, tile_size, 8);
-    else
-        mode2_emit_full(config, rgb, width, row_data, row, pal, tile_size, 8);
+    mode2_emit(plane_id, config, rgb, width, row_data, row, x_trim, y_trim, pal, tile_size, 8);
     return true;
 }
 
@@ -383,21 +612,21 @@ mode2_render(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb
     switch (opt & 0x0F)
     {
     case 0:
-        return mode2_render_1bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 8);
+        return mode2_render_1bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 8);
     case 1:
-        return mode2_render_2bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 8);
+        return mode2_render_2bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 8);
     case 2:
-        return mode2_render_4bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 8);
+        return mode2_render_4bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 8);
     case 3:
-        return mode2_render_8bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 8);
+        return mode2_render_8bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 8);
     case 8:
-        return mode2_render_1bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 16);
+        return mode2_render_1bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 16);
     case 9:
-        return mode2_render_2bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 16);
+        return mode2_render_2bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 16);
     case 10:
-        return mode2_render_4bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 16);
+        return mode2_render_4bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 16);
     case 11:
-        return mode2_render_8bpp(scanline_id, width, rgb, config_ptr, x_trim, y_trim, 16);
+        return mode2_render_8bpp(plane_id, scanline_id, width, rgb, config_ptr, opt, x_trim, y_trim, 16);
     default:
         return false;
     }
@@ -411,10 +640,12 @@ bool mode2_prog(uint16_t *xregs)
     const int16_t scanline_begin = xregs[5];
     const int16_t scanline_end = xregs[6];
 
+    const size_t config_size =
+        sizeof(mode2_config_t) + (options & MODES_OPT_SCROLL ? MODES_SCROLL_PTR_SIZE : 0);
     if (config_ptr & 1 ||
-        config_ptr > 0x10000 - sizeof(mode2_config_t))
+        config_ptr > 0x10000 - config_size)
         return false;
-    if (options & 0xF000 || (options & 0x07) > 3 ||
+    if (options & 0x7000 || (options & 0x07) > 3 ||
         plane < 0 || plane >= SCANVIDEO_PLANE_COUNT)
         return false;
     const int16_t tile_size = (options & 0x08) ? 16 : 8;
@@ -431,4 +662,86 @@ bool mode2_prog(uint16_t *xregs)
     return true;
 }
 
+// The config, the scroll table entry when the options ask for one, the row
+// of tile ids, the palette when it is in XRAM, and the tile set, whole: which
+// tiles a row shows is data, not config. A tile set that runs off the end of
+// XRAM is taken as all of it.
+int mode2_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans)
+{
+    if (fill_fn != mode2_render)
+        return -1;
+    const uint16_t opt = mode2_options[scanline_id][plane_id];
+    mode2_config_t config_line, *config = &config_line;
+    mode2_get_config(opt, scanline_id, config_ptr, config);
+    const bool scroll = opt & MODES_OPT_SCROLL;
+    int n = 0;
+    spans[n++] = (modes_span_t){config_ptr, (uint32_t)config_ptr + sizeof(mode2_config_t) +
+                                                (scroll ? MODES_SCROLL_PTR_SIZE : 0)};
+    if (scroll)
+    {
+        const uint32_t at = modes_scroll_at(mode2_scroll_ptr(config_ptr), scanline_id);
+        if (at < 0x10000)
+            spans[n++] = (modes_span_t){at, at + sizeof(modes_scroll_t)};
+    }
+    if ((opt & 0x0F) > 11 || (opt & 0x07) > 3)
+        return n;
+    const int16_t bpp = 1 << (opt & 0x07);
+    const int16_t tile_size = (opt & 0x08) ? 16 : 8;
+    const int16_t y_trim = (opt >> 8) & 0x0F;
+    int16_t row;
+    volatile const uint8_t *row_data =
+        mode2_scanline_to_data(scanline_id, config, tile_size - y_trim, &row);
+    if (!row_data)
+        return n;
+    const uint32_t data = (uint32_t)(row_data - xram);
+    spans[n++] = (modes_span_t){data, data + (uint32_t)config->width_tiles};
+    if (mode2_get_palette(config, bpp) == (volatile const uint16_t *)&xram[config->xram_palette_ptr])
+        spans[n++] = (modes_span_t){config->xram_palette_ptr,
+                                    config->xram_palette_ptr + (2u << bpp)};
+    const uint32_t tiles_end = (uint32_t)config->xram_tile_ptr +
+                               256u * (uint32_t)(tile_size * bpp / 8) * (uint32_t)tile_size;
+    if (tiles_end > 0x10000)
+        spans[n++] = (modes_span_t){0, 0x10000};
+    else
+        spans[n++] = (modes_span_t){config->xram_tile_ptr, tiles_end};
+    return n;
+}
+
+#if !PICO_ON_DEVICE
+// A pixel is a tile row read and a palette lookup, indexed by the line's
+// options as mode2_render is; the palette is copied first.
+bool mode2_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost)
+{
+    if (fill_fn != mode2_render)
+        return false;
+    static const modes_cost_t by_bpp[] = {
+        {.call = 300, .pixel16 = 36},
+        {.call = 300, .pixel16 = 44},
+        {.call = 350, .pixel16 = 56},
+        {.call = 1100, .pixel16 = 64},
+    };
+    *cost = by_bpp[mode2_options[scanline_id][plane_id] & 0x03];
+    return true;
+}
+#endif
+
+// Savestates. The options table is the only per-line state; the rest is
+// in XRAM.
+size_t mode2_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, mode2_options, sizeof mode2_options);
+    return sizeof mode2_options;
+}
+
+bool mode2_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof mode2_options)
+        return false;
+    memcpy(mode2_options, buf, sizeof mode2_options);
+    return true;
+}
+
 #pragma GCC pop_options
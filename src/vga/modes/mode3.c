@@ -26,6 +26,34 @@ typedef struct
     uint16_t xram_palette_ptr;
 } mode3_config_t;
 
+// The planes, a bit each, whose scanline was programmed with a scroll table.
+static uint8_t mode3_scroll[VGA_PROG_MAX];
+
+// The scroll table pointer after the config, for a plane with
+// MODES_OPT_SCROLL.
+static inline __attribute__((always_inline)) uint16_t
+mode3_scroll_ptr(uint16_t config_ptr)
+{
+    return *(volatile const uint16_t *)&xram[config_ptr + sizeof(mode3_config_t)];
+}
+
+// The config as one scanline of a plane sees it: a copy, moved by the
+// scanline's scroll table entry when the plane has one.
+static inline __attribute__((always_inline)) void
+mode3_get_config(int16_t plane_id, int16_t scanline_id, uint16_t config_ptr, mode3_config_t *config)
+{
+    *config = *(mode3_config_t *)&xram[config_ptr];
+    if (!(mode3_scroll[scanline_id] & (1u << plane_id)))
+        return;
+    const uint32_t at = modes_scroll_at(mode3_scroll_ptr(config_ptr), scanline_id);
+    if (at < 0x10000)
+    {
+        const modes_scroll_t *scroll = (void *)&xram[at];
+        config->x_pos_px += scroll->x;
+        config->y_pos_px += scroll->y;
+    }
+}
+
 static volatile const uint8_t *
 mode3_scanline_to_data(int16_t scanline_id, mode3_config_t *config, int16_t bpp)
 {
@@ -85,6 +113,7 @@ mode3_fill_cols(mode3_config_t *config, uint16_t **rgb, int16_t *col, int16_t *w
         {
             memset(*rgb, 0, sizeof(uint16_t) * (*width));
             *width = 0;
+            return 0;
         }
     }
     int16_t fill_cols = *width;
@@ -97,8 +126,8 @@ mode3_fill_cols(mode3_config_t *config, uint16_t **rgb, int16_t *col, int16_t *w
 static bool
 mode3_render_1bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 1);
     if (!row_data)
         return false;
@@ -134,8 +163,8 @@ mode3_render_1bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t
 static bool
 mode3_render_1bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 1);
     if (!row_data)
         return false;
@@ -171,8 +200,8 @@ mode3_render_1bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width,
 static bool
 mode3_render_2bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 2);
     if (!row_data)
         return false;
@@ -210,8 +239,8 @@ mode3_render_2bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t
 static bool
 mode3_render_2bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 2);
     if (!row_data)
         return false;
@@ -249,8 +278,8 @@ mode3_render_2bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width,
 static bool
 mode3_render_4bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 4);
     if (!row_data)
         return false;
@@ -285,8 +314,8 @@ mode3_render_4bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t
 static bool
 mode3_render_4bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 4);
     if (!row_data)
         return false;
@@ -321,8 +350,8 @@ mode3_render_4bpp_reverse(int16_t plane_id, int16_t scanline_id, int16_t width,
 static bool
 mode3_render_8bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, 8);
     if (!row_data)
         return false;
@@ -345,8 +374,8 @@ mode3_render_8bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t
 static bool
 mode3_render_16bpp(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
 {
-    (void)plane_id;
-    mode3_config_t *config = (void *)&xram[config_ptr];
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
     volatile const uint16_t *row_data = (uint16_t *)mode3_scanline_to_data(scanline_id, config, 16);
     if (!row_data || (uint32_t)row_data & 1)
         return false;
@@ -370,12 +399,14 @@ bool mode3_prog(uint16_t *xregs)
     const int16_t scanline_begin = xregs[5];
     const int16_t scanline_end = xregs[6];
 
+    const size_t config_size =
+        sizeof(mode3_config_t) + (attributes & MODES_OPT_SCROLL ? MODES_SCROLL_PTR_SIZE : 0);
     if (config_ptr & 1 ||
-        config_ptr > 0x10000 - sizeof(mode3_config_t))
+        config_ptr > 0x10000 - config_size)
         return false;
 
     bool (*render_fn)(int16_t, int16_t, int16_t, uint16_t *, uint16_t);
-    switch (attributes)
+    switch (attributes & ~MODES_OPT_SCROLL)
     {
     case 0:
         render_fn = mode3_render_1bpp;
@@ -405,7 +436,116 @@ bool mode3_prog(uint16_t *xregs)
         return false;
     };
 
-    return vga_prog_fill(plane, scanline_begin, scanline_end, config_ptr, render_fn);
+    const int16_t end = scanline_end ? scanline_end : vga_canvas_height();
+    if (!vga_prog_fill(plane, scanline_begin, end, config_ptr, render_fn))
+        return false;
+    for (int16_t i = scanline_begin; i < end; i++)
+    {
+        if (attributes & MODES_OPT_SCROLL)
+            mode3_scroll[i] |= 1u << plane;
+        else
+            mode3_scroll[i] &= ~(1u << plane);
+    }
+    return true;
+}
+
+// The config, the scroll table entry when the plane has one, the row of
+// pixels, and the palette when it is in XRAM. A missing row reads the
+// config alone.
+int mode3_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans)
+{
+    static const struct
+    {
+        modes_fill_fn_t fn;
+        uint8_t bpp;
+    } fills[] = {
+        {mode3_render_1bpp, 1},
+        {mode3_render_2bpp, 2},
+        {mode3_render_4bpp, 4},
+        {mode3_render_8bpp, 8},
+        {mode3_render_16bpp, 16},
+        {mode3_render_1bpp_reverse, 1},
+        {mode3_render_2bpp_reverse, 2},
+        {mode3_render_4bpp_reverse, 4},
+    };
+    size_t i = 0;
+    while (i < sizeof fills / sizeof *fills && fills[i].fn != fill_fn)
+        i++;
+    if (i == sizeof fills / sizeof *fills)
+        return -1;
+    const int16_t bpp = fills[i].bpp;
+    mode3_config_t config_line, *config = &config_line;
+    mode3_get_config(plane_id, scanline_id, config_ptr, config);
+    const bool scroll = mode3_scroll[scanline_id] & (1u << plane_id);
+    int n = 0;
+    spans[n++] = (modes_span_t){config_ptr, (uint32_t)config_ptr + sizeof(mode3_config_t) +
+                                                (scroll ? MODES_SCROLL_PTR_SIZE : 0)};
+    if (scroll)
+    {
+        const uint32_t at = modes_scroll_at(mode3_scroll_ptr(config_ptr), scanline_id);
+        if (at < 0x10000)
+            spans[n++] = (modes_span_t){at, at + sizeof(modes_scroll_t)};
+    }
+    volatile const uint8_t *row_data = mode3_scanline_to_data(scanline_id, config, bpp);
+    if (!row_data)
+        return n;
+    const uint32_t data = (uint32_t)(row_data - xram);
+    spans[n++] = (modes_span_t){data, data + ((uint32_t)config->width_px * bpp + 7) / 8};
+    if (bpp < 16 &&
+        mode3_get_palette(config, bpp) == (volatile const uint16_t *)&xram[config->xram_palette_ptr])
+        spans[n++] = (modes_span_t){config->xram_palette_ptr,
+                                    config->xram_palette_ptr + (2u << bpp)};
+    return n;
+}
+
+#if !PICO_ON_DEVICE
+// A 1bpp or 2bpp byte goes out by table, a deeper pixel is a load and a
+// palette lookup of its own; the palette is copied first.
+bool mode3_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost)
+{
+    (void)plane_id;
+    (void)scanline_id;
+    static const struct
+    {
+        modes_fill_fn_t fn;
+        modes_cost_t cost;
+    } fills[] = {
+        {mode3_render_1bpp, {.call = 150, .pixel16 = 24}},
+        {mode3_render_2bpp, {.call = 150, .pixel16 = 32}},
+        {mode3_render_4bpp, {.call = 200, .pixel16 = 64}},
+        {mode3_render_8bpp, {.call = 900, .pixel16 = 80}},
+        {mode3_render_16bpp, {.call = 150, .pixel16 = 48}},
+        {mode3_render_1bpp_reverse, {.call = 150, .pixel16 = 24}},
+        {mode3_render_2bpp_reverse, {.call = 150, .pixel16 = 32}},
+        {mode3_render_4bpp_reverse, {.call = 200, .pixel16 = 64}},
+    };
+    for (size_t i = 0; i < sizeof fills / sizeof *fills; i++)
+        if (fills[i].fn == fill_fn)
+        {
+            *cost = fills[i].cost;
+            return true;
+        }
+    return false;
+}
+#endif
+
+// Savestates. The scroll bits are the only per-line state; the rest is in
+// XRAM or is the fill itself.
+size_t mode3_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, mode3_scroll, sizeof mode3_scroll);
+    return sizeof mode3_scroll;
+}
+
+bool mode3_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof mode3_scroll)
+        return false;
+    memcpy(mode3_scroll, buf, sizeof mode3_scroll);
+    return true;
 }
 
 #pragma GCC pop_options
@@ -10,7 +10,23 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "vga/modes/modes.h"
 
 bool mode3_prog(uint16_t *xregs);
 
+// Dirty-line tracking (modes.h): the XRAM one scanline of plane_id reads.
+int mode3_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans);
+
+#if !PICO_ON_DEVICE
+// Render budget (modes.h): what one call of fill_fn costs the device.
+bool mode3_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost);
+#endif
+
+// Savestates, for a host that snapshots the machine. save returns the
+// size and writes buf unless it is NULL; load refuses any other size.
+size_t mode3_state_save(void *buf);
+bool mode3_state_load(const void *buf, size_t len);
+
 #endif /* _VGA_MODES_MODE3_H_ */
@@ -9,9 +9,11 @@
 // is based on the sprite system used for the RISCBoy games console.
 
 #include "vga/modes/mode4.h"
+#include "vga/modes/modes.h"
 #include "vga/sys/mem.h"
 #include "vga/sys/vga.h"
 #include <pico/stdlib.h>
+#include <stddef.h>
 #if PICO_ON_DEVICE
 #include <hardware/interp.h>
 #endif
@@ -46,6 +48,15 @@ typedef struct
 // [v] = [ a10 a11 b1 ] * [y] = [a10 * x + a11 * y + b1]
 // [1]   [ 0   0   1  ]   [1]   [           1          ]
 typedef int32_t affine_transform_t[6];
+
+// Both tables bin here, told apart by kind.
+static MODES_THREAD_LOCAL modes_bin_set_t mode4_bins;
+static const modes_bin_layout_t mode4_sprite_layout = {
+    sizeof(mode4_sprite_t), offsetof(mode4_sprite_t, y_pos_px),
+    offsetof(mode4_sprite_t, log_size), 0, 7};
+static const modes_bin_layout_t mode4_asprite_layout = {
+    sizeof(mode4_asprite_t), offsetof(mode4_asprite_t, y_pos_px),
+    offsetof(mode4_asprite_t, log_size), 0, 7};
 static const int32_t AF_ONE = 1 << 16;
 
 static inline int32_t mul_fp1616(int32_t x, int32_t y)
@@ -223,6 +234,7 @@ static inline void sprite_scanline16(
             return;
         span_continuous = !!(meta & (1u << 31));
     }
+    MODES_SPRITE_TOUCHED(isct.size_x);
     uint16_t *dst = scanbuf + sp->x_pos_px + isct.tex_offs_x;
     const uint16_t *src = img + isct.tex_offs_x + isct.tex_offs_y * size;
     if (span_continuous)
@@ -234,8 +246,12 @@ static inline void sprite_scanline16(
 static void mode4_render_sprite(int16_t scanline, int16_t width, uint16_t *rgb, uint16_t config_ptr, uint16_t length)
 {
     const mode4_sprite_t *sprites = (void *)&xram[config_ptr];
-    for (uint16_t i = 0; i < length; i++)
+    uint16_t k, end;
+    const uint16_t *index = modes_bins_band(&mode4_bins, scanline, &xram[config_ptr], config_ptr,
+                                            length, 0, &mode4_sprite_layout, &k, &end);
+    for (; k < end; k++)
     {
+        const uint16_t i = index ? index[k] : k;
         const unsigned px_size = 1u << sprites[i].log_size;
         unsigned byte_size = px_size * px_size * sizeof(uint16_t);
         if (sprites[i].has_opacity_metadata)
@@ -250,38 +266,6 @@ static void mode4_render_sprite(int16_t scanline, int16_t width, uint16_t *rgb,
     }
 }
 
-#if !PICO_ON_DEVICE
-// Software stand-in for the SIO interpolator used by the affine path. The Pico
-// hardware interpolator emits each texel's address and advances the u,v
-// accumulators on every POP; off-device the same arithmetic runs here. Lanes
-// hold u,v in 16.16 fixed point; a POP masks the integer texel index out of
-// each lane, sums them onto the image base, then adds the per-step deltas
-// (the hardware's ADD_RAW accumulator feedback).
-static struct
-{
-    uint32_t accum[2];
-    int32_t step[2];
-    uintptr_t base;
-    uint shift[2];
-    uint32_t mask[2];
-} sw_interp;
-
-static inline uint32_t sw_interp_mask(uint lsb, uint msb)
-{
-    return (((uint32_t)1 << (msb - lsb + 1)) - 1) << lsb;
-}
-
-static inline uintptr_t sw_interp_pop_full(void)
-{
-    uint32_t s0 = (sw_interp.accum[0] >> sw_interp.shift[0]) & sw_interp.mask[0];
-    uint32_t s1 = (sw_interp.accum[1] >> sw_interp.shift[1]) & sw_interp.mask[1];
-    uintptr_t addr = sw_interp.base + s0 + s1;
-    sw_interp.accum[0] += (uint32_t)sw_interp.step[0];
-    sw_interp.accum[1] += (uint32_t)sw_interp.step[1];
-    return addr;
-}
-#endif
-
 // Set up an interpolator to follow a straight line through u,v space
 static inline void setup_interp_affine(
     intersect_t isct,
@@ -418,6 +402,7 @@ static inline void asprite_scanline16(
     intersect_t isct = get_sprite_intersect(sp->x_pos_px, sp->y_pos_px, sp->log_size, raster_y, raster_w);
     if (isct.size_x <= 0)
         return;
+    MODES_SPRITE_TOUCHED(isct.size_x);
     affine_transform_t atrans;
     for (uint16_t j = 0; j < 6; j++)
         atrans[j] = (int32_t)sp->transform[j] << 8;
@@ -431,8 +416,12 @@ static void mode4_render_asprite(
     uint16_t config_ptr, uint16_t length)
 {
     const mode4_asprite_t *sprites = (void *)&xram[config_ptr];
-    for (uint16_t i = 0; i < length; i++)
+    uint16_t k, end;
+    const uint16_t *index = modes_bins_band(&mode4_bins, scanline, &xram[config_ptr], config_ptr,
+                                            length, 1, &mode4_asprite_layout, &k, &end);
+    for (; k < end; k++)
     {
+        const uint16_t i = index ? index[k] : k;
         const unsigned px_size = 1u << sprites[i].log_size;
         unsigned byte_size = px_size * px_size * sizeof(uint16_t);
         if (sprites[i].has_opacity_metadata)
@@ -485,4 +474,86 @@ bool mode4_prog(uint16_t *xregs)
     return vga_prog_sprite(plane, scanline_begin, scanline_end, config_ptr, length, render_fn);
 }
 
+#if !PICO_ON_DEVICE
+// The word a row of pixels makes, and whether the word it has draws them.
+// A span past the row ends where the row does, as the intersect ends it.
+static uint32_t mode4_meta_want(const uint16_t *row, unsigned size)
+{
+    unsigned start = 0, end = 0, opaque = 0;
+    for (unsigned x = 0; x < size; x++)
+        if (row[x] & (1 << 5))
+        {
+            if (!opaque++)
+                start = x;
+            end = x + 1;
+        }
+    if (!opaque)
+        return 0;
+    return (opaque == end - start ? 1u << 31 : 0) | start << 16 | end;
+}
+
+static bool mode4_meta_agrees(const uint16_t *row, unsigned size, uint32_t meta)
+{
+    const unsigned start = (meta >> 16) & 0x7fff;
+    const unsigned end = MIN(meta & 0xffff, size);
+    for (unsigned x = 0; x < size; x++)
+    {
+        const bool opaque = row[x] & (1 << 5);
+        const bool drawn = x >= start && x < end;
+        if (opaque && !drawn)
+            return false;
+        if (!opaque && drawn && (meta & (1u << 31)))
+            return false;
+    }
+    return true;
+}
+
+int mode4_check(modes_sprite_fn_t sprite_fn, uint16_t config_ptr, uint16_t length,
+                mode4_check_t *bad, int max)
+{
+    if (sprite_fn == mode4_render_asprite)
+        return 0;
+    if (sprite_fn != mode4_render_sprite)
+        return -1;
+    const mode4_sprite_t *sprites = (void *)&xram[config_ptr];
+    int n = 0;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (!sprites[i].has_opacity_metadata)
+            continue;
+        const unsigned px_size = 1u << sprites[i].log_size;
+        const unsigned byte_size = px_size * px_size * sizeof(uint16_t) + px_size * sizeof(uint32_t);
+        if (byte_size > 0x10000 || sprites[i].xram_sprite_ptr > 0x10000 - byte_size)
+            continue;
+        const uint16_t *img = (const uint16_t *)&xram[sprites[i].xram_sprite_ptr];
+        const uint32_t *meta = (const uint32_t *)(img + px_size * px_size);
+        for (unsigned y = 0; y < px_size; y++)
+            if (!mode4_meta_agrees(img + y * px_size, px_size, meta[y]))
+            {
+                if (n < max)
+                    bad[n] = (mode4_check_t){i, sprites[i].xram_sprite_ptr, (uint16_t)y,
+                                             meta[y], mode4_meta_want(img + y * px_size, px_size)};
+                n++;
+                break;
+            }
+    }
+    return n;
+}
+
+// The device walks the whole table, so each entry is a test of its Y and
+// size against the line; a sprite drawn is an intersect and its metadata
+// row, and a pixel is a copy, or an alpha test without the metadata; an
+// affine pixel is an interpolator step besides.
+bool mode4_cost(modes_sprite_fn_t sprite_fn, modes_cost_t *cost)
+{
+    if (sprite_fn == mode4_render_sprite)
+        *cost = (modes_cost_t){.call = 150, .entry = 10, .sprite = 120, .pixel16 = 40};
+    else if (sprite_fn == mode4_render_asprite)
+        *cost = (modes_cost_t){.call = 150, .entry = 10, .sprite = 250, .pixel16 = 128};
+    else
+        return false;
+    return true;
+}
+#endif
+
 #pragma GCC pop_options
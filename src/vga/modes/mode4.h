@@ -10,7 +10,36 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "vga/modes/modes.h"
 
 bool mode4_prog(uint16_t *xregs);
 
+#if !PICO_ON_DEVICE
+// Opacity metadata. A sprite with has_opacity_metadata draws each row from
+// the span its word names, without alpha tests when the word says the span
+// is solid. A word that leaves out an opaque pixel, or calls a span with a
+// clear pixel in it solid, draws some other sprite. The word a row's pixels
+// make is the one tools/rp6502.py's sprite command writes: the first opaque
+// pixel in bits 16-30, one past the last in bits 0-15, bit 31 when all
+// between are opaque, and zero for a row with nothing opaque.
+typedef struct
+{
+    uint16_t sprite; // its index in the table
+    uint16_t xram_sprite_ptr;
+    uint16_t row; // the first that disagrees
+    uint32_t meta; // that row's word
+    uint32_t want; // the word its pixels make
+} mode4_check_t;
+
+// The sprites of a table whose metadata disagrees with their pixels: up to
+// max of them into bad, returning how many there are, or -1 when sprite_fn
+// is not mode 4's. Affine sprites are drawn without their metadata, so
+// theirs never disagrees.
+int mode4_check(modes_sprite_fn_t sprite_fn, uint16_t config_ptr, uint16_t length,
+                mode4_check_t *bad, int max);
+
+// Render budget (modes.h): what one call of sprite_fn costs the device.
+bool mode4_cost(modes_sprite_fn_t sprite_fn, modes_cost_t *cost);
+#endif
+
 #endif /* _VGA_MODES_MODE4_H_ */
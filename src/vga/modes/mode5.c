@@ -5,9 +5,11 @@
  */
 
 #include "vga/modes/mode5.h"
+#include "vga/modes/modes.h"
 #include "vga/sys/mem.h"
 #include "vga/sys/vga.h"
 #include "vga/term/color.h"
+#include <stddef.h>
 
 #pragma GCC push_options
 #pragma GCC optimize("O3")
@@ -20,6 +22,9 @@ typedef struct
     uint16_t palette_ptr;
 } mode5_sprite_t;
 
+// Tables of each size bin apart, as they reach different bands.
+static MODES_THREAD_LOCAL modes_bin_set_t mode5_bins;
+
 static inline const uint16_t *
 mode5_get_palette(uint16_t palette_ptr, int16_t bpp)
 {
@@ -31,6 +36,82 @@ mode5_get_palette(uint16_t palette_ptr, int16_t bpp)
     return color_256;
 }
 
+// Which of a palette's entries are see-through, one bit each. Below 8bpp
+// that is every index, so a source byte whose pixels would all be clear is
+// passed over whole. At 8bpp only index 0 is asked about, and the rest are
+// alpha-tested as they are drawn.
+static inline __attribute__((always_inline)) uint16_t
+mode5_clear_mask(const uint16_t *palette, int16_t bpp)
+{
+    const int16_t n = bpp < 8 ? 1 << bpp : 1;
+    uint16_t mask = 0;
+    for (int16_t idx = 0; idx < n; idx++)
+        if (!(palette[idx] & (1 << 5)))
+            mask |= 1 << idx;
+    return mask;
+}
+
+static inline __attribute__((always_inline)) bool
+mode5_byte_clear(uint8_t bits, uint16_t mask, int16_t bpp)
+{
+    switch (bpp)
+    {
+    case 1:
+        return (bits == 0x00 || mask & 2) && (bits == 0xFF || mask & 1);
+    case 2:
+        return mask >> (bits >> 6) & mask >> (bits >> 4 & 3) &
+               mask >> (bits >> 2 & 3) & mask >> (bits & 3) & 1;
+    case 4:
+        return mask >> (bits >> 4) & mask >> (bits & 15) & 1;
+    default:
+        return !bits && mask & 1;
+    }
+}
+
+// The index of pixel k of a source byte, counting from its high bits.
+static inline __attribute__((always_inline)) uint8_t
+mode5_index(uint8_t bits, int16_t k, int16_t bpp)
+{
+    return bpp == 8 ? bits : (bits >> (8 - bpp * (k + 1))) & ((1 << bpp) - 1);
+}
+
+static inline __attribute__((always_inline)) void
+mode5_put(uint16_t *dst, uint16_t color)
+{
+    if (color & (1 << 5))
+        *dst = color;
+}
+
+// One clipped sprite row, pixels px to end of row_data at dst. The partial
+// bytes at either end go a pixel at a time; between them each byte is read
+// once and its pixels drawn from it, unless the mask says none would show.
+static inline __attribute__((always_inline)) void
+mode5_emit(uint16_t *dst, const uint8_t *row_data, int16_t px, int16_t end,
+           const uint16_t *palette, uint16_t mask, int16_t bpp)
+{
+    const int16_t per_byte = 8 / bpp;
+    if (px % per_byte)
+    {
+        const uint8_t bits = row_data[px / per_byte];
+        for (; px < end && px % per_byte; px++, dst++)
+            mode5_put(dst, palette[mode5_index(bits, px % per_byte, bpp)]);
+    }
+    for (; px + per_byte <= end; px += per_byte, dst += per_byte)
+    {
+        const uint8_t bits = row_data[px / per_byte];
+        if (mode5_byte_clear(bits, mask, bpp))
+            continue;
+        for (int16_t k = 0; k < per_byte; k++)
+            mode5_put(dst + k, palette[mode5_index(bits, k, bpp)]);
+    }
+    if (px < end)
+    {
+        const uint8_t bits = row_data[px / per_byte];
+        for (int16_t k = 0; px < end; px++, k++, dst++)
+            mode5_put(dst, palette[mode5_index(bits, k, bpp)]);
+    }
+}
+
 static inline __attribute__((always_inline)) void
 mode5_render(int16_t scanline, int16_t width, uint16_t *rgb,
              uint16_t config_ptr, uint16_t length,
@@ -42,9 +123,19 @@ mode5_render(int16_t scanline, int16_t width, uint16_t *rgb,
         return;
 
     const mode5_sprite_t *sprites = (const mode5_sprite_t *)&xram[config_ptr];
+    const modes_bin_layout_t layout = {
+        sizeof(mode5_sprite_t), offsetof(mode5_sprite_t, y_pos_px), 0, sprite_size, 0};
+    uint16_t k, end;
+    const uint16_t *index = modes_bins_band(&mode5_bins, scanline, &xram[config_ptr], config_ptr,
+                                            length, sprite_size, &layout, &k, &end);
 
-    for (uint16_t i = 0; i < length; i++)
+    // Sprites mostly share a palette, so its mask is kept until one doesn't.
+    const uint16_t *mask_palette = NULL;
+    uint16_t mask = 0;
+
+    for (; k < end; k++)
     {
+        const uint16_t i = index ? index[k] : k;
         int16_t tex_y = scanline - sprites[i].y_pos_px;
         if (tex_y < 0 || tex_y >= sprite_size)
             continue;
@@ -66,29 +157,17 @@ mode5_render(int16_t scanline, int16_t width, uint16_t *rgb,
 
         if (sprites[i].xram_sprite_ptr > 0x10000 - sprite_data_size)
             continue;
+        MODES_SPRITE_TOUCHED(size_x);
 
         const uint16_t *palette = mode5_get_palette(sprites[i].palette_ptr, bpp);
-        const uint8_t *row_data =
-            (const uint8_t *)&xram[sprites[i].xram_sprite_ptr + tex_y * bytes_per_row];
-        uint16_t *dst = rgb + x_start;
-
-        for (int16_t px = tex_x; px < tex_x + size_x; px++)
+        if (palette != mask_palette)
         {
-            uint8_t idx;
-            if (bpp == 1)
-                idx = (row_data[px / 8] >> (7 - (px & 7))) & 0x01;
-            else if (bpp == 2)
-                idx = (row_data[px / 4] >> (6 - 2 * (px & 3))) & 0x03;
-            else if (bpp == 4)
-                idx = (px & 1) ? (row_data[px / 2] & 0x0F) : (row_data[px / 2] >> 4);
-            else
-                idx = row_data[px];
-
-            uint16_t color = palette[idx];
-            if (color & (1 << 5))
-                *dst = color;
-            dst++;
+            mask = mode5_clear_mask(palette, bpp);
+            mask_palette = palette;
         }
+        const uint8_t *row_data =
+            (const uint8_t *)&xram[sprites[i].xram_sprite_ptr + tex_y * bytes_per_row];
+        mode5_emit(rgb + x_start, row_data, tex_x, tex_x + size_x, palette, mask, bpp);
     }
 }
 
@@ -352,4 +431,36 @@ bool mode5_prog(uint16_t *xregs)
     return vga_prog_sprite(plane, scanline_begin, scanline_end, config_ptr, length, render_fn);
 }
 
+#if !PICO_ON_DEVICE
+// The device walks the whole table, so each entry is a test of its Y
+// against the line; a sprite drawn finds its row and its palette's clear
+// mask, and a pixel is an index out of its byte and a palette lookup; a
+// byte of clear pixels is skipped whole.
+bool mode5_cost(modes_sprite_fn_t sprite_fn, modes_cost_t *cost)
+{
+    static const modes_sprite_fn_t fns[4][7] = {
+        {mode5_render_1bpp_8x8, mode5_render_1bpp_16x16, mode5_render_1bpp_32x32,
+         mode5_render_1bpp_64x64, mode5_render_1bpp_128x128, mode5_render_1bpp_256x256,
+         mode5_render_1bpp_512x512},
+        {mode5_render_2bpp_8x8, mode5_render_2bpp_16x16, mode5_render_2bpp_32x32,
+         mode5_render_2bpp_64x64, mode5_render_2bpp_128x128, mode5_render_2bpp_256x256,
+         mode5_render_2bpp_512x512},
+        {mode5_render_4bpp_8x8, mode5_render_4bpp_16x16, mode5_render_4bpp_32x32,
+         mode5_render_4bpp_64x64, mode5_render_4bpp_128x128, mode5_render_4bpp_256x256},
+        {mode5_render_8bpp_8x8, mode5_render_8bpp_16x16, mode5_render_8bpp_32x32,
+         mode5_render_8bpp_64x64, mode5_render_8bpp_128x128, mode5_render_8bpp_256x256},
+    };
+    static const uint16_t pixel16_by_bpp[4] = {32, 40, 48, 56};
+    for (int b = 0; b < 4; b++)
+        for (int i = 0; i < 7; i++)
+            if (fns[b][i] && fns[b][i] == sprite_fn)
+            {
+                *cost = (modes_cost_t){.call = 150, .entry = 8, .sprite = 100,
+                                       .pixel16 = pixel16_by_bpp[b]};
+                return true;
+            }
+    return false;
+}
+#endif
+
 #pragma GCC pop_options
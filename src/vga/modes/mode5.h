@@ -10,7 +10,13 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "vga/modes/modes.h"
 
 bool mode5_prog(uint16_t *xregs);
 
+#if !PICO_ON_DEVICE
+// Render budget (modes.h): what one call of sprite_fn costs the device.
+bool mode5_cost(modes_sprite_fn_t sprite_fn, modes_cost_t *cost);
+#endif
+
 #endif /* _VGA_MODES_MODE5_H_ */
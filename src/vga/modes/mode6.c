@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// Affine tile map: a mode 2 style map of tile ids, drawn through a 2x2
+// matrix so the plane rotates, scales and shears. Each scanline starts at a
+// u,v in the map and steps du,dv per pixel, both 16.16 map pixels. They come
+// from the config's matrix, or per scanline from a table in XRAM for the
+// raster effects a single matrix can't do. The walk is the mode 4 affine
+// sprite's: an interpolator emits each pixel's map cell address.
+
+#include "vga/modes/mode6.h"
+#include "vga/modes/modes.h"
+#include "vga/sys/vga.h"
+#include "vga/sys/mem.h"
+#include "vga/scanvideo/pixel_format.h"
+#include "vga/term/color.h"
+#include <pico/stdlib.h>
+#include <string.h>
+#if PICO_ON_DEVICE
+#include <hardware/interp.h>
+#endif
+
+#pragma GCC push_options
+#pragma GCC optimize("O3")
+
+typedef struct
+{
+    bool x_wrap;
+    bool y_wrap;
+    uint8_t width_log;  // map width in tiles, log2, 1..8
+    uint8_t height_log; // map height in tiles, log2, 1..8
+    int32_t u;          // map position of canvas 0,0
+    int32_t v;
+    int32_t du_dx; // step per pixel
+    int32_t dv_dx;
+    int32_t du_dy; // step per scanline
+    int32_t dv_dy;
+    uint16_t xram_data_ptr;
+    uint16_t xram_palette_ptr;
+    uint16_t xram_tile_ptr;
+    uint16_t xram_line_ptr; // mode6_line_t per scanline, or unaligned for none
+} mode6_config_t;
+
+typedef struct
+{
+    int32_t u;
+    int32_t v;
+    int32_t du_dx;
+    int32_t dv_dx;
+} mode6_line_t;
+
+// Per-scanline, per-plane validated mode-6 OPTIONS word (bpp, tile size).
+static uint8_t mode6_options[VGA_PROG_MAX][SCANVIDEO_PLANE_COUNT];
+
+// The map is read whole, so all of it must be in XRAM.
+static inline bool
+mode6_map_fits(mode6_config_t *config)
+{
+    const unsigned width_log = config->width_log;
+    const unsigned height_log = config->height_log;
+    return width_log >= 1 && width_log <= 8 && height_log >= 1 && height_log <= 8 &&
+           (1u << (width_log + height_log)) <= 0x10000u - config->xram_data_ptr;
+}
+
+// The scanline's own table entry when there is one, else the config's
+// matrix carried down to it.
+static inline uint32_t
+mode6_get_line(mode6_config_t *config, int16_t scanline_id, mode6_line_t *line)
+{
+    const uint32_t at = config->xram_line_ptr + (uint32_t)scanline_id * sizeof(mode6_line_t);
+    if (!(config->xram_line_ptr & 3) && at <= 0x10000 - sizeof(mode6_line_t))
+    {
+        *line = *(mode6_line_t *)&xram[at];
+        return at;
+    }
+    line->u = (int32_t)((uint32_t)config->u + (uint32_t)config->du_dy * (uint32_t)scanline_id);
+    line->v = (int32_t)((uint32_t)config->v + (uint32_t)config->dv_dy * (uint32_t)scanline_id);
+    line->du_dx = config->du_dx;
+    line->dv_dx = config->dv_dx;
+    return 0x10000;
+}
+
+static volatile const uint16_t *
+mode6_get_palette(mode6_config_t *config, int16_t bpp)
+{
+    if (!(config->xram_palette_ptr & 1) &&
+        config->xram_palette_ptr <= 0x10000 - sizeof(uint16_t) * (1 << bpp))
+        return (uint16_t *)&xram[config->xram_palette_ptr];
+    if (bpp == 1)
+        return color_2;
+    return color_256;
+}
+
+// Set up an interpolator to walk the scanline through the map. Lane 0 masks
+// the tile column out of u, lane 1 the tile row out of v already shifted up
+// past the columns, so POP_FULL is the map cell's address; the map being a
+// power of two on both sides, the masks are also the wrap.
+static inline void
+mode6_setup_interp(const mode6_line_t *line, volatile const uint8_t *map,
+                   unsigned tile_log, unsigned width_log, unsigned height_log)
+{
+#if PICO_ON_DEVICE
+    interp_config c0 = interp_default_config();
+    interp_config_set_add_raw(&c0, true);
+    interp_config_set_shift(&c0, 16 + tile_log);
+    interp_config_set_mask(&c0, 0, width_log - 1);
+    interp_set_config(interp0, 0, &c0);
+
+    interp_config c1 = interp_default_config();
+    interp_config_set_add_raw(&c1, true);
+    interp_config_set_shift(&c1, 16 + tile_log - width_log);
+    interp_config_set_mask(&c1, width_log, width_log + height_log - 1);
+    interp_set_config(interp0, 1, &c1);
+
+    interp_set_base(interp0, 2, (uint32_t)map);
+    interp0->accum[0] = line->u;
+    interp0->accum[1] = line->v;
+    interp0->base[0] = line->du_dx;
+    interp0->base[1] = line->dv_dx;
+#else
+    sw_interp.shift[0] = 16 + tile_log;
+    sw_interp.mask[0] = sw_interp_mask(0, width_log - 1);
+    sw_interp.shift[1] = 16 + tile_log - width_log;
+    sw_interp.mask[1] = sw_interp_mask(width_log, width_log + height_log - 1);
+    sw_interp.base = (uintptr_t)map;
+    sw_interp.accum[0] = (uint32_t)line->u;
+    sw_interp.accum[1] = (uint32_t)line->v;
+    sw_interp.step[0] = line->du_dx;
+    sw_interp.step[1] = line->dv_dx;
+#endif
+}
+
+// bpp and tile_log are compile-time per caller, so each instantiation folds
+// to one depth's texel fetch.
+static inline __attribute__((always_inline)) bool
+mode6_render_tiles(int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr,
+                   int16_t bpp, unsigned tile_log)
+{
+    mode6_config_t *config = (void *)&xram[config_ptr];
+    if (!mode6_map_fits(config))
+        return false;
+    const unsigned width_log = config->width_log;
+    const unsigned height_log = config->height_log;
+    mode6_line_t line;
+    mode6_get_line(config, scanline_id, &line);
+    volatile const uint16_t *palette = mode6_get_palette(config, bpp);
+    uint16_t pal[256];
+    for (int i = 0; i < (1 << bpp); i++)
+        pal[i] = palette[i];
+
+    // A u or v outside the map has bits above it set, negative ones included;
+    // a wrapping axis lets the interpolator's mask fold it back.
+    const uint32_t outside_u = config->x_wrap ? 0 : ~(((uint32_t)1 << (16 + tile_log + width_log)) - 1);
+    const uint32_t outside_v = config->y_wrap ? 0 : ~(((uint32_t)1 << (16 + tile_log + height_log)) - 1);
+    const uint32_t tile_mask = (1u << tile_log) - 1;
+    const uint32_t row_size = (bpp << tile_log) / 8;
+    const uint32_t mem_size = row_size << tile_log;
+    const uint32_t tile_ptr = config->xram_tile_ptr;
+
+    mode6_setup_interp(&line, &xram[config->xram_data_ptr], tile_log, width_log, height_log);
+    for (int16_t i = 0; i < width; i++)
+    {
+#if PICO_ON_DEVICE
+        const uint32_t u = interp0->accum[0];
+        const uint32_t v = interp0->accum[1];
+        const uint8_t tile_id = *(volatile const uint8_t *)interp0->pop[2];
+#else
+        const uint32_t u = sw_interp.accum[0];
+        const uint32_t v = sw_interp.accum[1];
+        const uint8_t tile_id = *(volatile const uint8_t *)sw_interp_pop_full();
+#endif
+        if ((u & outside_u) | (v & outside_v))
+        {
+            rgb[i] = 0;
+            continue;
+        }
+        const uint32_t col = (u >> 16) & tile_mask;
+        const uint32_t row = (v >> 16) & tile_mask;
+        const uint8_t bits = xram[(tile_ptr + mem_size * tile_id + row_size * row +
+                                   col * bpp / 8) &
+                                  0xFFFF];
+        if (bpp == 8)
+            rgb[i] = pal[bits];
+        else
+            rgb[i] = pal[(bits >> (8 - bpp - (col * bpp & 7))) & ((1 << bpp) - 1)];
+    }
+    return true;
+}
+
+// Single fill_fn for every mode-6 scanline; the switch keeps bpp and tile
+// size compile-time per branch.
+static bool
+mode6_render(int16_t plane_id, int16_t scanline_id, int16_t width, uint16_t *rgb, uint16_t config_ptr)
+{
+    switch (mode6_options[scanline_id][plane_id])
+    {
+    case 0:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 1, 3);
+    case 1:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 2, 3);
+    case 2:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 4, 3);
+    case 3:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 8, 3);
+    case 8:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 1, 4);
+    case 9:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 2, 4);
+    case 10:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 4, 4);
+    case 11:
+        return mode6_render_tiles(scanline_id, width, rgb, config_ptr, 8, 4);
+    default:
+        return false;
+    }
+}
+
+bool mode6_prog(uint16_t *xregs)
+{
+    const uint16_t options = xregs[2];
+    const uint16_t config_ptr = xregs[3];
+    const int16_t plane = xregs[4];
+    const int16_t scanline_begin = xregs[5];
+    const int16_t scanline_end = xregs[6];
+
+    if (config_ptr & 3 ||
+        config_ptr > 0x10000 - sizeof(mode6_config_t))
+        return false;
+    if (options & 0xFFF0 || (options & 0x07) > 3 ||
+        plane < 0 || plane >= SCANVIDEO_PLANE_COUNT)
+        return false;
+
+    const int16_t end = scanline_end ? scanline_end : vga_canvas_height();
+    if (!vga_prog_fill(plane, scanline_begin, end, config_ptr, mode6_render))
+        return false;
+    for (int16_t i = scanline_begin; i < end; i++)
+        mode6_options[i][plane] = (uint8_t)options;
+    return true;
+}
+
+// The config, the scanline's table entry when it has one, the palette when
+// it is in XRAM, and the map and tile set, whole: a rotated scanline can
+// cross any cell of the map. A tile set that runs off the end of XRAM is
+// taken as all of it.
+int mode6_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans)
+{
+    if (fill_fn != mode6_render)
+        return -1;
+    mode6_config_t *config = (void *)&xram[config_ptr];
+    int n = 0;
+    spans[n++] = (modes_span_t){config_ptr, (uint32_t)config_ptr + sizeof(mode6_config_t)};
+    const uint8_t opt = mode6_options[scanline_id][plane_id];
+    if (opt > 11 || (opt & 0x07) > 3)
+        return n;
+    mode6_line_t line;
+    const uint32_t at = mode6_get_line(config, scanline_id, &line);
+    if (at < 0x10000)
+        spans[n++] = (modes_span_t){at, at + sizeof(mode6_line_t)};
+    if (!mode6_map_fits(config))
+        return n;
+    const int16_t bpp = 1 << (opt & 0x07);
+    const uint32_t tile_size = (opt & 0x08) ? 16 : 8;
+    spans[n++] = (modes_span_t){config->xram_data_ptr,
+                                config->xram_data_ptr + (1u << (config->width_log + config->height_log))};
+    if (mode6_get_palette(config, bpp) == (volatile const uint16_t *)&xram[config->xram_palette_ptr])
+        spans[n++] = (modes_span_t){config->xram_palette_ptr,
+                                    config->xram_palette_ptr + (2u << bpp)};
+    const uint32_t tiles_end = (uint32_t)config->xram_tile_ptr +
+                               256u * (tile_size * bpp / 8) * tile_size;
+    if (tiles_end > 0x10000)
+        spans[n++] = (modes_span_t){0, 0x10000};
+    else
+        spans[n++] = (modes_span_t){config->xram_tile_ptr, tiles_end};
+    return n;
+}
+
+#if !PICO_ON_DEVICE
+// A pixel is an interpolator step, a map read, a tile read and a palette
+// lookup, at every depth; the palette is copied first.
+bool mode6_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost)
+{
+    if (fill_fn != mode6_render)
+        return false;
+    static const uint16_t call_by_bpp[] = {300, 300, 350, 1100};
+    *cost = (modes_cost_t){.call = call_by_bpp[mode6_options[scanline_id][plane_id] & 0x03],
+                           .pixel16 = 160};
+    return true;
+}
+#endif
+
+// Savestates. The options table is the only per-line state; the rest is
+// in XRAM.
+size_t mode6_state_save(void *buf)
+{
+    if (buf)
+        memcpy(buf, mode6_options, sizeof mode6_options);
+    return sizeof mode6_options;
+}
+
+bool mode6_state_load(const void *buf, size_t len)
+{
+    if (len != sizeof mode6_options)
+        return false;
+    memcpy(mode6_options, buf, sizeof mode6_options);
+    return true;
+}
+
+#pragma GCC pop_options
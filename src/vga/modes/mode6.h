@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _VGA_MODES_MODE6_H_
+#define _VGA_MODES_MODE6_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "vga/modes/modes.h"
+
+bool mode6_prog(uint16_t *xregs);
+
+// Dirty-line tracking (modes.h): the XRAM one scanline of plane_id reads.
+int mode6_spans(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                uint16_t config_ptr, modes_span_t *spans);
+
+#if !PICO_ON_DEVICE
+// Render budget (modes.h): what one call of fill_fn costs the device.
+bool mode6_cost(modes_fill_fn_t fill_fn, int16_t plane_id, int16_t scanline_id,
+                modes_cost_t *cost);
+#endif
+
+// Savestates, for a host that snapshots the machine. save returns the
+// size and writes buf unless it is NULL; load refuses any other size.
+size_t mode6_state_save(void *buf);
+bool mode6_state_load(const void *buf, size_t len);
+
+#endif /* _VGA_MODES_MODE6_H_ */
@@ -13,6 +13,301 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// A fill renderer, as vga_prog_fill takes it.
+typedef bool (*modes_fill_fn_t)(int16_t plane_id, int16_t scanline_id,
+                                int16_t width, uint16_t *rgb, uint16_t config_ptr);
+
+// A sprite renderer, as vga_prog_sprite takes it.
+typedef void (*modes_sprite_fn_t)(int16_t scanline_id, int16_t width, uint16_t *rgb,
+                                  uint16_t config_ptr, uint16_t length);
+
+// Dirty-line tracking, for a host that keeps last frame's pixels and redraws
+// a scanline only when something it reads has changed. A span is XRAM
+// [begin, end) that one scanline of a fill reads; a mode that fills from
+// XRAM reports its scanline's spans through its modeN_spans, which return
+// the count, or -1 when fill_fn is not that mode's.
+typedef struct
+{
+    uint32_t begin, end;
+} modes_span_t;
+#define MODES_SPANS_MAX 5
+
+// Per-scanline scroll (mode1, mode2, mode3). A plane programmed with
+// MODES_OPT_SCROLL in its options also reads the word after its config: a
+// pointer to a table of one modes_scroll_t per canvas scanline, added to the
+// config's x_pos_px and y_pos_px for that scanline alone. Line scroll and
+// parallax splits then cost the 6502 nothing per line. An odd pointer, or a
+// scanline whose entry is past the end of XRAM, adds nothing. A plane without
+// the bit neither reads the word nor needs room for it.
+#define MODES_OPT_SCROLL 0x8000
+#define MODES_SCROLL_PTR_SIZE 2 // the pointer's bytes after the config
+
+typedef struct
+{
+    int16_t x, y;
+} modes_scroll_t;
+
+// The XRAM address of scanline_id's entry in the table at table_ptr, or
+// 0x10000 when it has none.
+static inline uint32_t
+modes_scroll_at(uint16_t table_ptr, int16_t scanline_id)
+{
+    const uint32_t at = table_ptr + (uint32_t)scanline_id * sizeof(modes_scroll_t);
+    if (table_ptr & 1 || scanline_id < 0 || at > 0x10000 - sizeof(modes_scroll_t))
+        return 0x10000;
+    return at;
+}
+
+// A host that renders scanlines on worker threads builds the modes with
+// MODES_THREADS: their scratch state is per thread, and they read XRAM
+// through modes_xram (vga/sys/mem.h), which a worker points at the copy its
+// line was taken from. Such a host also stamps XRAM writes: modes_xram_stamp
+// points at the write count that view is as of, and modes_xram_written_since
+// says whether XRAM [begin, end) may have been written after a count.
+#ifdef MODES_THREADS
+#define MODES_THREAD_LOCAL _Thread_local
+extern _Thread_local const volatile uint64_t *modes_xram_stamp;
+bool modes_xram_written_since(uint32_t begin, uint32_t end, uint64_t since);
+#else
+#define MODES_THREAD_LOCAL
+#endif
+
+// Render profiling, for a host that times each renderer per scanline. A
+// sprite renderer counts the sprites it draws any of on its scanline, and
+// the pixels of them it covers; the host zeroes the counts before the call
+// and reads them after. Only a build that defines MODES_PROFILE counts, so
+// the device pays nothing.
+#ifdef MODES_PROFILE
+extern MODES_THREAD_LOCAL uint32_t modes_sprites_touched;
+extern MODES_THREAD_LOCAL uint32_t modes_sprite_pixels;
+#define MODES_SPRITE_TOUCHED(pixels) (modes_sprites_touched++, modes_sprite_pixels += (pixels))
+#else
+#define MODES_SPRITE_TOUCHED(pixels) ((void)0)
+#endif
+
+#if !PICO_ON_DEVICE
+// Render budget, for a host that estimates what a scanline would cost the
+// VGA's RP2350. A mode's modeN_cost says what one call of its renderer
+// costs there and returns false when the renderer is not that mode's: the
+// cycles of the call, of each sprite in the table it looks at and of each
+// sprite it draws any of, and sixteenths of a cycle for each pixel — every
+// pixel of the width for a fill, the ones its sprites cover for a sprite
+// renderer. They are counted from the inner loops as the device builds
+// them, one instruction a cycle and SRAM loads at two, not measured.
+typedef struct
+{
+    uint16_t call;
+    uint16_t entry;
+    uint16_t sprite;
+    uint16_t pixel16;
+} modes_cost_t;
+#endif
+
+// Sprite bins (mode4, mode5). A sprite renderer runs for every scanline of
+// its plane and would test every sprite in the table against it. Bins sort a
+// table's sprites by band of MODES_BIN_LINES scanlines, keeping table order,
+// so a line walks only the sprites that can reach its band. They are sorted
+// again when any sprite's rows change — its Y or its height — and everything
+// else about a sprite is still read and checked as it is drawn.
+//
+// Noticing a change is the cost, so only a host that stamps XRAM writes
+// (MODES_THREADS, vga/sys/mem.h) bins: it looks at a table again only after
+// it was written. The VGA firmware's XRAM arrives by DMA unannounced, and
+// finding out would take a look at every sprite on every scanline, which is
+// the walk bins save; there modes_bins_band hands back the whole table and
+// the bins take no SRAM.
+
+// Where a table keeps each sprite's rows: entries stride bytes apart, Y an
+// int16_t at y_offs. Height is fixed_rows, or when that is 0, 1 << the byte
+// at log_offs, none past max_log (too big for XRAM; the renderer skips it).
+typedef struct
+{
+    uint16_t stride, y_offs, log_offs;
+    uint16_t fixed_rows;
+    uint8_t max_log;
+} modes_bin_layout_t;
+
+#ifdef MODES_THREADS
+#define MODES_BIN_SHIFT 4
+#define MODES_BIN_LINES (1 << MODES_BIN_SHIFT)
+#define MODES_BIN_BANDS (512 >> MODES_BIN_SHIFT) // past the tallest canvas
+#define MODES_BIN_SPRITES 256                    // longer tables walk whole
+#define MODES_BIN_ENTRIES 1024                   // sprite-bands; past it, whole
+#define MODES_BIN_TABLES 3                       // one per plane
+
+typedef struct
+{
+    uint16_t config_ptr, length, kind; // kind: the renderer's layout and size
+    bool whole;                        // too many sprite-bands: walk them all
+    uint64_t stamp;                    // *modes_xram_stamp when last known current
+    int16_t top[MODES_BIN_SPRITES];      // each sprite's first row, as binned
+    uint16_t rows[MODES_BIN_SPRITES];    // and how many; 0 never drawn
+    uint16_t first[MODES_BIN_BANDS + 1]; // band b is index[first[b]..first[b + 1])
+    uint16_t index[MODES_BIN_ENTRIES];
+} modes_bins_t;
+
+typedef struct
+{
+    modes_bins_t table[MODES_BIN_TABLES];
+    unsigned next; // the one to reuse
+} modes_bin_set_t;
+
+static inline __attribute__((always_inline)) void
+modes_bin_rows(const volatile uint8_t *entry, const modes_bin_layout_t *l,
+               int16_t *top, uint16_t *rows)
+{
+    *top = *(const volatile int16_t *)(entry + l->y_offs);
+    if (l->fixed_rows)
+        *rows = l->fixed_rows;
+    else
+    {
+        const uint8_t log_size = entry[l->log_offs];
+        *rows = log_size <= l->max_log ? (uint16_t)(1u << log_size) : 0;
+    }
+}
+
+static inline void
+modes_bins_sort(modes_bins_t *b, const volatile uint8_t *table, const modes_bin_layout_t *l)
+{
+    uint16_t count[MODES_BIN_BANDS] = {0};
+    unsigned entries = 0;
+    for (uint16_t i = 0; i < b->length; i++)
+    {
+        modes_bin_rows(table + i * l->stride, l, &b->top[i], &b->rows[i]);
+        const int y0 = b->top[i] < 0 ? 0 : b->top[i];
+        int y1 = b->top[i] + b->rows[i];
+        if (y1 > MODES_BIN_BANDS * MODES_BIN_LINES)
+            y1 = MODES_BIN_BANDS * MODES_BIN_LINES;
+        for (int band = y0 >> MODES_BIN_SHIFT; y0 < y1 && band <= (y1 - 1) >> MODES_BIN_SHIFT; band++)
+            count[band]++, entries++;
+    }
+    b->whole = entries > MODES_BIN_ENTRIES;
+    if (b->whole)
+        return;
+    b->first[0] = 0;
+    for (int band = 0; band < MODES_BIN_BANDS; band++)
+    {
+        b->first[band + 1] = b->first[band] + count[band];
+        count[band] = b->first[band]; // now where the band's next goes
+    }
+    for (uint16_t i = 0; i < b->length; i++)
+    {
+        const int y0 = b->top[i] < 0 ? 0 : b->top[i];
+        int y1 = b->top[i] + b->rows[i];
+        if (y1 > MODES_BIN_BANDS * MODES_BIN_LINES)
+            y1 = MODES_BIN_BANDS * MODES_BIN_LINES;
+        for (int band = y0 >> MODES_BIN_SHIFT; y0 < y1 && band <= (y1 - 1) >> MODES_BIN_SHIFT; band++)
+            b->index[count[band]++] = i;
+    }
+}
+
+static inline bool
+modes_bins_current(const modes_bins_t *b, const volatile uint8_t *table, const modes_bin_layout_t *l)
+{
+    for (uint16_t i = 0; i < b->length; i++)
+    {
+        int16_t top;
+        uint16_t rows;
+        modes_bin_rows(table + i * l->stride, l, &top, &rows);
+        if (top != b->top[i] || rows != b->rows[i])
+            return false;
+    }
+    return true;
+}
+
+// The sprites of table, the one at config_ptr in XRAM, that scanline may
+// show, as indices into it: [*begin, *end) of the returned array, or of the
+// table itself (every sprite, in order) when it returns NULL.
+static inline const uint16_t *
+modes_bins_band(modes_bin_set_t *set, int16_t scanline, const volatile uint8_t *table,
+                uint16_t config_ptr, uint16_t length, uint16_t kind,
+                const modes_bin_layout_t *l, uint16_t *begin, uint16_t *end)
+{
+    *begin = 0;
+    *end = length;
+    if (length > MODES_BIN_SPRITES || scanline < 0 ||
+        scanline >= MODES_BIN_BANDS * MODES_BIN_LINES)
+        return NULL;
+    modes_bins_t *b = NULL;
+    for (int t = 0; t < MODES_BIN_TABLES; t++)
+        if (set->table[t].config_ptr == config_ptr && set->table[t].length == length &&
+            set->table[t].kind == kind)
+            b = &set->table[t];
+    const uint64_t now = *modes_xram_stamp;
+    if (!b)
+    {
+        b = &set->table[set->next++ % MODES_BIN_TABLES];
+        b->config_ptr = config_ptr;
+        b->length = length;
+        b->kind = kind;
+        modes_bins_sort(b, table, l);
+    }
+    else if (now < b->stamp ||
+             (now > b->stamp &&
+              modes_xram_written_since(config_ptr, config_ptr + (uint32_t)length * l->stride, b->stamp)))
+    {
+        if (!modes_bins_current(b, table, l))
+            modes_bins_sort(b, table, l);
+    }
+    b->stamp = now;
+    if (b->whole)
+        return NULL;
+    const int band = scanline >> MODES_BIN_SHIFT;
+    *begin = b->first[band];
+    *end = b->first[band + 1];
+    return b->index;
+}
+#else
+typedef struct
+{
+    uint8_t unused;
+} modes_bin_set_t;
+
+static inline const uint16_t *
+modes_bins_band(modes_bin_set_t *set, int16_t scanline, const volatile uint8_t *table,
+                uint16_t config_ptr, uint16_t length, uint16_t kind,
+                const modes_bin_layout_t *l, uint16_t *begin, uint16_t *end)
+{
+    (void)set, (void)scanline, (void)table, (void)config_ptr, (void)kind, (void)l;
+    *begin = 0;
+    *end = length;
+    return NULL;
+}
+#endif
+
+#if !PICO_ON_DEVICE
+// Software stand-in for the SIO interpolator the affine renderers (mode4,
+// mode6) use. The Pico hardware interpolator emits each texel's address and
+// advances the u,v accumulators on every POP; off-device the same arithmetic
+// runs here. Lanes hold u,v in 16.16 fixed point; a POP masks an index out of
+// each lane, sums them onto the base, then adds the per-step deltas (the
+// hardware's ADD_RAW accumulator feedback). Each renderer sets up every field
+// before it pops, so one per thread serves them all.
+static MODES_THREAD_LOCAL struct
+{
+    uint32_t accum[2];
+    int32_t step[2];
+    uintptr_t base;
+    unsigned shift[2];
+    uint32_t mask[2];
+} sw_interp __attribute__((unused));
+
+static inline uint32_t sw_interp_mask(unsigned lsb, unsigned msb)
+{
+    return (((uint32_t)1 << (msb - lsb + 1)) - 1) << lsb;
+}
+
+static inline uintptr_t sw_interp_pop_full(void)
+{
+    uint32_t s0 = (sw_interp.accum[0] >> sw_interp.shift[0]) & sw_interp.mask[0];
+    uint32_t s1 = (sw_interp.accum[1] >> sw_interp.shift[1]) & sw_interp.mask[1];
+    uintptr_t addr = sw_interp.base + s0 + s1;
+    sw_interp.accum[0] += (uint32_t)sw_interp.step[0];
+    sw_interp.accum[1] += (uint32_t)sw_interp.step[1];
+    return addr;
+}
+#endif
+
 static inline __attribute__((always_inline)) void
 modes_render_1bpp(uint16_t *buf, uint8_t bits, uint16_t bg, uint16_t fg)
 {
@@ -163,6 +163,7 @@ static uint32_t _missing_scanline_data[] = {
     /*width-3*/ 0u | (COMPOSABLE_RAW_1P << 16u),
     0u | (COMPOSABLE_EOL_ALIGN << 16u)};
 static full_scanline_buffer_t _missing_scanline_buffer;
+static volatile uint32_t _missing_scanline_count;
 
 // Blank scanline: black on base plane, empty overlays
 static uint32_t _blank_scanline_data[] = {
@@ -520,7 +521,10 @@ static void __not_in_flash_func(prepare_for_active_scanline_irqs_enabled)(void)
 
     spin_unlock(shared_state.scanline.lock, save);
     if (!fsb || fsb->core.scanline_id != shared_state.scanline.next_scanline_id)
+    {
         fsb = &_missing_scanline_buffer;
+        _missing_scanline_count++;
+    }
 
     update_dma_transfer_state_irqs_enabled(true, &buffers_to_free_count);
     recover_scanline_sms();
@@ -804,6 +808,16 @@ void __not_in_flash_func(scanvideo_end_scanline_generation)(
     spin_unlock(shared_state.scanline.lock, save);
 }
 
+uint32_t __not_in_flash_func(scanvideo_get_next_scanline_id)(void)
+{
+    return shared_state.scanline.next_scanline_id;
+}
+
+uint32_t scanvideo_missing_count(void)
+{
+    return _missing_scanline_count;
+}
+
 static void scanvideo_set_scanline_repeat_fn(scanvideo_scanline_repeat_count_fn fn)
 {
     _scanline_repeat_count_fn = fn ? fn : default_scanvideo_scanline_repeat_count_fn;
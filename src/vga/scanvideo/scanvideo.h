@@ -82,6 +82,11 @@ void scanvideo_set_mode(const scanvideo_view_t *mode);
 scanvideo_scanline_buffer_t *scanvideo_begin_scanline_generation(void);
 void scanvideo_end_scanline_generation(scanvideo_scanline_buffer_t *scanline_buffer);
 
+// The scanline the next content line will show, and how many content lines
+// showed the missing scanline because nothing was generated in time.
+uint32_t scanvideo_get_next_scanline_id(void);
+uint32_t scanvideo_missing_count(void);
+
 static inline uint16_t scanvideo_scanline_number(uint32_t scanline_id)
 {
     return (uint16_t)scanline_id;
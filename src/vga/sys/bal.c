@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "vga/sys/bal.h"
+#include <string.h>
+
+static void bal_clear(bal_core_t *core, uint32_t seen)
+{
+    memset(core, 0, sizeof(*core));
+    core->seen = seen;
+    core->min_slack = BAL_SLACK_NONE;
+    core->worst_slack = BAL_SLACK_NONE;
+    for (unsigned m = 0; m < BAL_MODES; m++)
+        core->mode_min[m] = BAL_SLACK_NONE;
+}
+
+void bal_init(bal_t *bal)
+{
+    bal->reset = 0;
+    bal->repeats_base = 0;
+    for (unsigned c = 0; c < BAL_CORES; c++)
+        bal_clear(&bal->core[c], 0);
+}
+
+void bal_reset(bal_t *bal, uint32_t repeats)
+{
+    bal->repeats_base = repeats;
+    bal->reset = bal->reset + 1;
+}
+
+int bal_slack(uint32_t scanline_id, uint32_t next_scanline_id, int16_t height)
+{
+    int16_t frames = (int16_t)(uint16_t)((scanline_id >> 16) - (next_scanline_id >> 16));
+    int line = (uint16_t)scanline_id;
+    int next = (uint16_t)next_scanline_id;
+    int slack;
+    if (frames > 1)
+        slack = INT8_MAX;
+    else if (frames < -1)
+        slack = INT8_MIN;
+    else
+        slack = line - next + frames * height;
+    if (slack > INT8_MAX)
+        return INT8_MAX;
+    if (slack < INT8_MIN)
+        return INT8_MIN;
+    return slack;
+}
+
+unsigned bal_bucket(int slack)
+{
+    if (slack < 0)
+        return 0;
+    if (slack < 3)
+        return 1 + slack;
+    if (slack < 5)
+        return 4;
+    if (slack < 8)
+        return 5;
+    if (slack < 12)
+        return 6;
+    return 7;
+}
+
+void bal_line(bal_t *bal, unsigned core_num, int16_t scanline, uint8_t modes, int slack)
+{
+    bal_core_t *core = &bal->core[core_num];
+    uint32_t reset = bal->reset;
+    if (core->seen != reset)
+        bal_clear(core, reset);
+    core->lines++;
+    if (slack < core->min_slack)
+        core->min_slack = slack;
+    if (slack < core->worst_slack)
+    {
+        core->worst_slack = slack;
+        core->worst_modes = modes;
+        core->worst_scanline = scanline;
+    }
+    unsigned bucket = bal_bucket(slack);
+    for (unsigned m = 0; modes; m++, modes >>= 1)
+        if (modes & 1 && m < BAL_MODES)
+        {
+            core->hist[m][bucket]++;
+            if (slack < core->mode_min[m])
+                core->mode_min[m] = slack;
+        }
+}
+
+static uint8_t *bal_put16(uint8_t *p, uint32_t v)
+{
+    if (v > UINT16_MAX)
+        v = UINT16_MAX;
+    *p++ = v;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint8_t *bal_put32(uint8_t *p, uint32_t v)
+{
+    p = bal_put16(p, v & 0xFFFF);
+    return bal_put16(p, v >> 16);
+}
+
+size_t bal_report(const bal_t *bal, uint32_t repeats, uint8_t *buf, size_t size)
+{
+    if (size < BAL_REPORT_SIZE)
+        return 0;
+    // A core that hasn't rendered since the reset still holds the old counts.
+    bal_core_t empty;
+    const bal_core_t *core[BAL_CORES];
+    bal_clear(&empty, 0);
+    for (unsigned c = 0; c < BAL_CORES; c++)
+        core[c] = bal->core[c].seen == bal->reset ? &bal->core[c] : &empty;
+
+    uint8_t *p = bal_put32(buf, repeats - bal->repeats_base);
+    const bal_core_t *worst = core[0];
+    for (unsigned c = 0; c < BAL_CORES; c++)
+    {
+        p = bal_put32(p, core[c]->lines);
+        *p++ = (uint8_t)core[c]->min_slack;
+        if (core[c]->worst_slack < worst->worst_slack)
+            worst = core[c];
+    }
+    *p++ = (uint8_t)worst->worst_slack;
+    *p++ = worst->worst_modes;
+    p = bal_put16(p, (uint16_t)worst->worst_scanline);
+    for (unsigned m = 0; m < BAL_MODES; m++)
+    {
+        int8_t min = BAL_SLACK_NONE;
+        for (unsigned c = 0; c < BAL_CORES; c++)
+            if (core[c]->mode_min[m] < min)
+                min = core[c]->mode_min[m];
+        *p++ = (uint8_t)min;
+        for (unsigned b = 0; b < BAL_BUCKETS; b++)
+        {
+            uint32_t count = 0;
+            for (unsigned c = 0; c < BAL_CORES; c++)
+                count += core[c]->hist[m][b];
+            p = bal_put16(p, count);
+        }
+    }
+    return BAL_REPORT_SIZE;
+}
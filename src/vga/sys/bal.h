@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _VGA_SYS_BAL_H_
+#define _VGA_SYS_BAL_H_
+
+/* Scanline balance between the two render cores.
+ * Pure accounting with no Pico SDK, so the host tests build it as is.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BAL_CORES 2
+#define BAL_MODES 7
+
+// Slack is how many canvas scanlines ahead of the beam a line was finished.
+// Negative is late: scanvideo showed its missing line instead.
+// Buckets: late, 0, 1, 2, 3-4, 5-7, 8-11, 12 and up.
+#define BAL_BUCKETS 8
+#define BAL_SLACK_NONE INT8_MAX
+
+typedef struct
+{
+    uint32_t seen; // bal_t.reset this block last cleared for
+    uint32_t lines;
+    int8_t min_slack;
+    int8_t worst_slack;
+    uint8_t worst_modes;
+    int16_t worst_scanline;
+    int8_t mode_min[BAL_MODES];
+    uint32_t hist[BAL_MODES][BAL_BUCKETS];
+} bal_core_t;
+
+// Each core writes only its own block, so rendering takes no lock. A reset
+// is a request each core honors on its next line.
+typedef struct
+{
+    volatile uint32_t reset;
+    uint32_t repeats_base;
+    bal_core_t core[BAL_CORES];
+} bal_t;
+
+// Report on the wire, little endian, in this order:
+//   u32 repeats since reset
+//   per core:  u32 lines, i8 min slack
+//   i8 worst slack, u8 worst line's mode mask, u16 worst scanline
+//   per mode:  i8 min slack, u16 hist[BAL_BUCKETS] (saturating)
+// BAL_SLACK_NONE marks a core or mode with no lines.
+#define BAL_REPORT_SIZE (4 + BAL_CORES * 5 + 4 + BAL_MODES * (1 + 2 * BAL_BUCKETS))
+
+void bal_init(bal_t *bal);
+void bal_reset(bal_t *bal, uint32_t repeats);
+
+// Canvas scanlines between a finished scanline_id and the one scanvideo
+// fetches next, across frame boundaries. Clamped to int8_t.
+int bal_slack(uint32_t scanline_id, uint32_t next_scanline_id, int16_t height);
+unsigned bal_bucket(int slack);
+
+// One finished line. Modes is a mask of (1 << mode) for every plane on it.
+void bal_line(bal_t *bal, unsigned core, int16_t scanline, uint8_t modes, int slack);
+
+// Fills buf with BAL_REPORT_SIZE bytes. Returns the size or 0 if too small.
+size_t bal_report(const bal_t *bal, uint32_t repeats, uint8_t *buf, size_t size);
+
+#endif /* _VGA_SYS_BAL_H_ */
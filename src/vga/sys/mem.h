@@ -15,6 +15,13 @@
 #include <stdbool.h>
 
 // 64KB Extended RAM
+#ifdef MODES_THREADS
+// The modes as a threaded host builds them (modes/modes.h): each thread's
+// own view, the live memory until the thread says otherwise.
+extern _Thread_local volatile uint8_t *modes_xram;
+#define xram modes_xram
+#else
 extern volatile uint8_t *const xram;
+#endif
 
 #endif /* _VGA_SYS_MEM_H_ */
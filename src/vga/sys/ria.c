@@ -6,8 +6,10 @@
 
 #include "vga.pio.h"
 #include "vga/sys/com.h"
+#include "vga/sys/bal.h"
 #include "vga/sys/ria.h"
 #include "vga/sys/sys.h"
+#include "vga/sys/vga.h"
 #include <pico/stdlib.h>
 #include <hardware/clocks.h>
 #include <hardware/sync.h>
@@ -27,6 +29,11 @@ static uint32_t ria_vsync_us;
 static bool ria_vsync_seen;
 static uint8_t ria_held; // 0 when nothing is waiting for the window to clear
 
+// A balance report streams one nibble per byte, after a start byte, so every
+// byte has the high bit the RIA dispatches on. Position counts nibbles.
+static uint8_t ria_report[BAL_REPORT_SIZE];
+static int ria_report_pos = -1; // -1 idle, 0 start byte next
+
 // Is a VSYNC expected close enough that nothing else may be sent?
 static bool ria_locked_out(void)
 {
@@ -92,6 +99,29 @@ void ria_task(void)
         }
         spin_unlock(ria_lock, save);
     }
+
+    // Low priority, one byte at a time, and only into an empty FIFO so none
+    // can still be queued when the VSYNC window opens.
+    if (ria_report_pos >= 0 && !ria_held && !version_pos &&
+        pio_sm_is_tx_fifo_empty(RIA_BACKCHAN_PIO, RIA_BACKCHAN_SM))
+    {
+        uint32_t save = spin_lock_blocking(ria_lock);
+        if (!ria_locked_out())
+        {
+            if (!ria_report_pos)
+                pio_sm_put(RIA_BACKCHAN_PIO, RIA_BACKCHAN_SM, 0xC0);
+            else
+            {
+                int nibble = ria_report_pos - 1;
+                uint8_t byte = ria_report[nibble / 2];
+                pio_sm_put(RIA_BACKCHAN_PIO, RIA_BACKCHAN_SM,
+                           0xB0 | ((nibble & 1) ? byte >> 4 : byte & 0xF));
+            }
+            if (++ria_report_pos > 2 * BAL_REPORT_SIZE)
+                ria_report_pos = -1;
+        }
+        spin_unlock(ria_lock, save);
+    }
 }
 
 void ria_pre_reclock(void)
@@ -117,6 +147,7 @@ void ria_backchan(uint16_t word)
         gpio_set_function(RIA_BACKCHAN_PIN, GPIO_FUNC_UART);
         ria_vsync_seen = false;
         ria_held = 0;
+        ria_report_pos = -1;
         break;
     case 1: // attach backchannel (PIO drives pin) and queue version string
         pio_gpio_init(RIA_BACKCHAN_PIO, RIA_BACKCHAN_PIN);
@@ -125,6 +156,10 @@ void ria_backchan(uint16_t word)
     case 2: // reply to identification request
         uart_write_blocking(COM_UART_INTERFACE, (uint8_t *)"VGA1", 4);
         break;
+    case 3: // queue a scanline balance report
+        vga_balance_report(ria_report, sizeof(ria_report));
+        ria_report_pos = 0;
+        break;
     }
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include "vga/main.h"
+#include "vga/sys/bal.h"
 #include "vga/sys/ria.h"
 #include "vga/sys/vga.h"
 #include "vga/sys/mem.h"
@@ -34,8 +35,14 @@ typedef struct
                                              uint16_t length);
     uint16_t sprite_config[SCANVIDEO_PLANE_COUNT];
     uint16_t sprite_length[SCANVIDEO_PLANE_COUNT];
+
+    // Which mode programmed each function, for the balance statistics.
+    uint8_t fill_mode[SCANVIDEO_PLANE_COUNT];
+    uint8_t sprite_mode[SCANVIDEO_PLANE_COUNT];
 } vga_prog_t;
 static vga_prog_t vga_prog[VGA_PROG_MAX];
+static uint8_t vga_prog_mode_current;
+static bal_t vga_bal;
 
 static mutex_t vga_scanline_mutex;
 static volatile bool vga_rendering[2];
@@ -324,6 +331,17 @@ static void vga_render_scanline(void)
             break;
         }
     }
+    uint8_t modes = 0;
+    for (int i = 0; i < SCANVIDEO_PLANE_COUNT; i++)
+    {
+        if (prog.fill_fn[i])
+            modes |= 1u << prog.fill_mode[i];
+        if (prog.sprite_fn[i])
+            modes |= 1u << prog.sprite_mode[i];
+    }
+    uint32_t next_scanline_id = scanvideo_get_next_scanline_id();
+    bal_line(&vga_bal, get_core_num(), scanline_id, modes,
+             bal_slack(buffer_scanline_id, next_scanline_id, vga_view_current->height));
     scanvideo_end_scanline_generation(scanline_buffer);
     vga_scanline_complete(buffer_scanline_id);
     vga_rendering[get_core_num()] = false;
@@ -413,6 +431,7 @@ void vga_init(void)
     assert(!((uintptr_t)xram & 0xFFFF));
 
     mutex_init(&vga_scanline_mutex);
+    bal_init(&vga_bal);
     vga_set_display(vga_sd);
     vga_xreg_canvas(NULL);
     vga_scanvideo_switch();
@@ -425,6 +444,18 @@ void vga_task(void)
     vga_render_scanline();
 }
 
+size_t vga_balance_report(uint8_t *buf, size_t size)
+{
+    size_t len = bal_report(&vga_bal, scanvideo_missing_count(), buf, size);
+    bal_reset(&vga_bal, scanvideo_missing_count());
+    return len;
+}
+
+void vga_prog_mode(uint8_t mode)
+{
+    vga_prog_mode_current = mode;
+}
+
 static bool vga_prog_valid(int16_t plane, int16_t scanline_begin, int16_t *scanline_end)
 {
     if (!*scanline_end)
@@ -454,6 +485,7 @@ bool vga_prog_fill(int16_t plane, int16_t scanline_begin, int16_t scanline_end,
     {
         vga_prog[i].fill_config[plane] = config_ptr;
         vga_prog[i].fill_fn[plane] = fill_fn;
+        vga_prog[i].fill_mode[plane] = vga_prog_mode_current;
     }
     return true;
 }
@@ -477,6 +509,7 @@ bool vga_prog_exclusive(int16_t plane, int16_t scanline_begin, int16_t scanline_
     {
         vga_prog[i].fill_config[plane] = config_ptr;
         vga_prog[i].fill_fn[plane] = fill_fn;
+        vga_prog[i].fill_mode[plane] = vga_prog_mode_current;
     }
     return true;
 }
@@ -498,6 +531,7 @@ bool vga_prog_sprite(int16_t plane, int16_t scanline_begin, int16_t scanline_end
         vga_prog[i].sprite_config[plane] = config_ptr;
         vga_prog[i].sprite_length[plane] = length;
         vga_prog[i].sprite_fn[plane] = sprite_fn;
+        vga_prog[i].sprite_mode[plane] = vga_prog_mode_current;
     }
     return true;
 }
@@ -43,6 +43,14 @@ void vga_set_display(vga_display_t display);
 void vga_xreg_canvas(uint16_t *xregs);
 int16_t vga_canvas_height(void);
 
+// Scanline balance statistics since the last report, encoded as
+// vga/sys/bal.h describes. Resets them. They span canvas and mode changes,
+// so a program's lines are still there when the monitor asks after it ends.
+size_t vga_balance_report(uint8_t *buf, size_t size);
+
+// Tags what the vga_prog_* calls that follow are programming.
+void vga_prog_mode(uint8_t mode);
+
 // Number of programmable scanlines, also bounds scanline_id.
 #define VGA_PROG_MAX 512
 
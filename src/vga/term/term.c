@@ -2665,3 +2665,99 @@ void term_set_height(uint8_t width, uint8_t height)
 {
     term_state_set_height(width == 40 ? &term_40 : &term_80, height);
 }
+
+// Savestates. Every pointer in a term_state_t points into the term itself or
+// into its static cell store, so a blob carries none of them: the cell stores
+// travel as cells, the write pointer as an offset into the active screen, and
+// load rebuilds the rest from alt_active. The palette OSC 4 edits goes too.
+typedef struct
+{
+    term_state_t term;
+    uint32_t ptr_offset;
+} term_blob_t;
+
+static size_t term_cells_size(const term_state_t *term)
+{
+    return (size_t)term->width * TERM_MAX_HEIGHT * sizeof(term_data_t);
+}
+
+static uint8_t *term_save_one(uint8_t *p, const term_state_t *term)
+{
+    term_blob_t blob;
+    memset(&blob, 0, sizeof blob);
+    memcpy(&blob.term, term, sizeof *term);
+    blob.ptr_offset = (uint32_t)(term->ptr - term->screen->mem);
+    blob.term.bufs[0].mem = NULL;
+    blob.term.bufs[1].mem = NULL;
+    blob.term.screen = NULL;
+    blob.term.cur = NULL;
+    blob.term.ptr = NULL;
+    memcpy(p, &blob, sizeof blob);
+    p += sizeof blob;
+    for (int i = 0; i < 2; i++)
+        if (term->bufs[i].mem)
+        {
+            memcpy(p, term->bufs[i].mem, term_cells_size(term));
+            p += term_cells_size(term);
+        }
+    return p;
+}
+
+static const uint8_t *term_load_one(const uint8_t *p, term_state_t *term)
+{
+    term_data_t *mem[2] = {term->bufs[0].mem, term->bufs[1].mem};
+    term_blob_t blob;
+    memcpy(&blob, p, sizeof blob);
+    p += sizeof blob;
+    memcpy(term, &blob.term, sizeof *term);
+    term->bufs[0].mem = mem[0];
+    term->bufs[1].mem = mem[1];
+    term->screen = &term->bufs[term->alt_active ? 1 : 0];
+    term->cur = &term->screen->cs;
+    term->ptr = term->screen->mem + blob.ptr_offset;
+    for (int i = 0; i < 2; i++)
+        if (mem[i])
+        {
+            memcpy(mem[i], p, term_cells_size(term));
+            p += term_cells_size(term);
+        }
+    return p;
+}
+
+static size_t term_state_size(void)
+{
+    size_t size = sizeof color_256_term + 2 * sizeof(term_blob_t);
+    for (int i = 0; i < 2; i++)
+    {
+        if (term_40.bufs[i].mem)
+            size += term_cells_size(&term_40);
+        if (term_80.bufs[i].mem)
+            size += term_cells_size(&term_80);
+    }
+    return size;
+}
+
+size_t term_state_save(void *buf)
+{
+    if (buf)
+    {
+        uint8_t *p = buf;
+        memcpy(p, color_256_term, sizeof color_256_term);
+        p += sizeof color_256_term;
+        p = term_save_one(p, &term_40);
+        term_save_one(p, &term_80);
+    }
+    return term_state_size();
+}
+
+bool term_state_load(const void *buf, size_t len)
+{
+    if (len != term_state_size())
+        return false;
+    const uint8_t *p = buf;
+    memcpy(color_256_term, p, sizeof color_256_term);
+    p += sizeof color_256_term;
+    p = term_load_one(p, &term_40);
+    term_load_one(p, &term_80);
+    return true;
+}
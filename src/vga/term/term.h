@@ -95,4 +95,11 @@ const term_data_t *term_view_row(uint8_t y);
 // The view reports its geometry: rows of the 40- or 80-column terminal.
 void term_set_height(uint8_t width, uint8_t height);
 
+// Savestates: both terminals, their cells and the palette, for a host that
+// snapshots the machine. save returns the size and writes buf unless it is
+// NULL; load refuses a blob of any other size, which is also what a build
+// with a different TERM_ALT_SCREEN or TERM_MAX_HEIGHT produces.
+size_t term_state_save(void *buf);
+bool term_state_load(const void *buf, size_t len);
+
 #endif /* _VGA_TERM_TERM_H_ */
@@ -7,7 +7,8 @@
  * the vendored DSP against the verilated engine with no emulator in
  * between: XRAM and its write-notify queue with the RW engine's push
  * (emu/sys/ria.c's), and the sample output capture. The bell is the
- * real bel.c, linked whole.
+ * real bel.c, linked whole. test_render stands the block renderers on the
+ * same seams.
  */
 
 #include "psg_shim.h"
@@ -16,7 +17,11 @@
 #include "ria/aud/bel.h"
 #include "ria/sys/mem.h"
 
-#include "aud_sine_tables.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 static uint8_t xram_backing[0x10000];
 uint8_t *const xram = xram_backing;
@@ -28,12 +33,16 @@ volatile uint8_t xram_queue[256][2];
 int16_t aud_sine_table[256];
 
 static void (*handler)(void);
+static void (*render)(int16_t *l, int16_t *r, unsigned n);
 static int16_t out_l, out_r;
 
-void aud_setup(void (*fn)(void), uint32_t rate)
+void aud_setup(void (*fn)(void),
+               void (*render_fn)(int16_t *l, int16_t *r, unsigned n),
+               uint32_t rate)
 {
     (void)rate;
     handler = fn;
+    render = render_fn;
 }
 
 /* The bench steps the engine itself, so the only thing this answers is what
@@ -56,10 +65,12 @@ void aud_stop(void)
     bel_setup();
 }
 
+/* ria/aud/aud.c's table, which aud_sine_gen.py also burns into the RTL's
+ * ROM; test_font holds the two to each other. */
 void shim_init(void)
 {
     for (int i = 0; i < 256; i++)
-        aud_sine_table[i] = AUD_SINE_TABLE[i];
+        aud_sine_table[i] = (int16_t)lround(cos(M_PI * 2.0 / 256 * i) * -32767);
 }
 
 void shim_sample(int16_t *l, int16_t *r)
@@ -69,6 +80,11 @@ void shim_sample(int16_t *l, int16_t *r)
     *r = out_r;
 }
 
+void shim_render(int16_t *l, int16_t *r, unsigned n)
+{
+    render(l, r, n);
+}
+
 void shim_xram_write(uint16_t addr, uint8_t val)
 {
     xram_backing[addr] = val;
@@ -26,6 +26,8 @@
  * through the queue filters, the mute over a sounding channel, the
  * halfword block loaded to its seventeenth word, and an envelope sweep
  * that pins every table constant the song phases left dark.
+ * test_render holds psg_render, the block form the emulator calls, to the
+ * handler this holds to the RTL.
  */
 
 #include "Vaud_psg.h"
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The PSG's vector kernel against its scalar reference. Every variant this
+ * machine can run takes the same voices and the same bell and must turn out
+ * the same samples and leave the same voices behind, word for word. The
+ * voices are random but not uniformly so: every wave including the unused
+ * ones, every envelope state, volumes sitting on the rates they step by, and
+ * duties at both ends, because those are the compares a select gets wrong.
+ *
+ * The scalar one is pinned by a few sums worked by hand, so the variants
+ * cannot all agree on something wrong. Then psg.c, built with PSG_VECTOR as
+ * the emulator builds it, runs one schedule of writes twice over the flat
+ * shims: once through its interrupt handler, which is scalar, and once a
+ * block at a time through the lanes. Those must agree too.
+ */
+
+#include "psg_shim.h"
+
+#include "ria/aud/aud.h"
+#include "ria/aud/bel.h"
+#include "ria/aud/psg.h"
+#include "ria/aud/psv.h"
+#include "utest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+UTEST_MAIN();
+
+static uint32_t g_seed = 0x2545F491;
+
+static uint32_t rnd(void)
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 17;
+    g_seed ^= g_seed << 5;
+    return g_seed;
+}
+
+/* Some of psg_vol_table's levels. */
+static uint32_t rnd_vol(void)
+{
+    static const uint32_t level[] = {256, 204, 120, 61, 7, 0};
+    return level[rnd() % 6] << 16;
+}
+
+static void rnd_voices(psv_voices_t *v)
+{
+    for (unsigned i = 0; i < PSV_VOICES; i++)
+    {
+        v->phase[i] = rnd();
+        v->phase_inc[i] = rnd() % 4 ? rnd() >> (rnd() % 16) : 0;
+        v->adsr[i] = rnd() % 4;
+        v->noise1[i] = rnd();
+        v->noise2[i] = rnd();
+        v->sample[i] = (int16_t)rnd();
+        v->wave[i] = rnd() % 4 ? rnd() % 5 : rnd() % 16;
+        static const uint32_t duty[] = {0, 1, 127, 128, 129, 254, 255};
+        v->duty[i] = rnd() % 2 ? duty[rnd() % 7] : rnd() % 256;
+        int32_t pan = (int8_t)rnd() / 2;
+        v->gain_l[i] = pan == -64 ? 0 : 63 - pan;
+        v->gain_r[i] = pan == -64 ? 0 : 63 + pan;
+        v->attack_rate[i] = (1u << 24) / (1 + rnd() % 400000);
+        v->attack_vol[i] = rnd_vol();
+        v->decay_rate[i] = (1u << 24) / (1 + rnd() % 400000);
+        v->decay_vol[i] = rnd_vol();
+        v->release_rate[i] = (1u << 24) / (1 + rnd() % 400000);
+        v->hold[i] = v->decay_vol[i] <= v->attack_vol[i] ? UINT32_MAX : 0;
+        /* On the edges the envelope compares. */
+        switch (rnd() % 6)
+        {
+        case 0:
+            v->vol[i] = v->release_rate[i];
+            break;
+        case 1:
+            v->vol[i] = v->decay_rate[i] + v->decay_vol[i];
+            break;
+        case 2:
+            v->vol[i] = v->attack_vol[i] - v->attack_rate[i];
+            break;
+        default:
+            v->vol[i] = rnd() % (257u << 16);
+            break;
+        }
+        /* An envelope never strays a step past full, and the mix's
+         * product is only sized for that. */
+        if (v->vol[i] > 512u << 16)
+            v->vol[i] = 0;
+    }
+}
+
+UTEST(psv, scalar_reference)
+{
+    shim_init();
+    const psv_variant_t *var;
+    ASSERT_GE(psv_variants(&var), (size_t)1);
+    ASSERT_STREQ(var[0].name, "scalar");
+
+    /* One square at full volume, centred, holding full: 32767 through a
+     * 4096 envelope is 32767, through 63/64 and the shift is 16128. */
+    psv_voices_t v;
+    memset(&v, 0, sizeof v);
+    v.wave[0] = 1;
+    v.duty[0] = 255;
+    v.gain_l[0] = v.gain_r[0] = 63;
+    v.sample[0] = 32767;
+    v.vol[0] = v.attack_vol[0] = v.decay_vol[0] = 256 << 16;
+    v.adsr[0] = PSV_SUSTAIN;
+    v.hold[0] = UINT32_MAX;
+    int16_t bel[3] = {0, 100, 32767};
+    int16_t l[3], r[3];
+    var[0].fn(&v, bel, l, r, 3);
+    ASSERT_EQ(l[0], 16128);
+    ASSERT_EQ(r[0], 16128);
+    /* The bell adds after the shift, and the sum clamps. */
+    ASSERT_EQ(l[1], 16228);
+    ASSERT_EQ(l[2], AUD_SAMPLE_MAX);
+    ASSERT_EQ(v.vol[0], 256u << 16);
+
+    /* Hard right is 0 and 126 of 128; an attack that reaches its level
+     * moves on to decay that same step. */
+    memset(&v, 0, sizeof v);
+    v.sample[0] = -32767;
+    v.vol[0] = 256 << 16;
+    v.gain_l[0] = 0;
+    v.gain_r[0] = 126;
+    v.adsr[0] = PSV_ATTACK;
+    v.attack_rate[0] = 1;
+    v.attack_vol[0] = 256 << 16;
+    v.wave[0] = 7;
+    var[0].fn(&v, bel, l, r, 1);
+    ASSERT_EQ(l[0], 0);
+    ASSERT_EQ(r[0], -32255);
+    ASSERT_EQ(v.adsr[0], (uint32_t)PSV_DECAY);
+    ASSERT_EQ(v.sample[0], 0);
+}
+
+UTEST(psv, every_variant_matches_scalar)
+{
+    shim_init();
+    const psv_variant_t *var;
+    const size_t nvar = psv_variants(&var);
+    for (size_t k = 0; k < nvar; k++)
+        printf("  %s\n", var[k].name);
+
+    static const unsigned len[] = {0, 1, 2, 7, 64, 255};
+    int16_t bel[256], want_l[256], want_r[256], got_l[256], got_r[256];
+    for (unsigned round = 0; round < 4000; round++)
+    {
+        psv_voices_t start;
+        rnd_voices(&start);
+        const unsigned n = len[round % 6];
+        for (unsigned i = 0; i < n; i++)
+            bel[i] = round % 3 ? 0 : (int16_t)rnd();
+        psv_voices_t want = start;
+        var[0].fn(&want, bel, want_l, want_r, n);
+        for (size_t k = 1; k < nvar; k++)
+        {
+            psv_voices_t got = start;
+            memset(got_l, 0x55, sizeof got_l);
+            memset(got_r, 0x55, sizeof got_r);
+            var[k].fn(&got, bel, got_l, got_r, n);
+            for (unsigned i = 0; i < n; i++)
+            {
+                ASSERT_EQ(got_l[i], want_l[i]);
+                ASSERT_EQ(got_r[i], want_r[i]);
+            }
+            /* Nothing past the block. */
+            ASSERT_EQ((uint16_t)got_l[n], 0x5555);
+            ASSERT_EQ(memcmp(&got, &want, sizeof got), 0);
+        }
+    }
+}
+
+UTEST(psv, render_is_the_widest)
+{
+    shim_init();
+    const psv_variant_t *var;
+    const size_t nvar = psv_variants(&var);
+    psv_voices_t a, b;
+    rnd_voices(&a);
+    b = a;
+    int16_t bel[64] = {0}, al[64], ar[64], bl[64], br[64];
+    psv_render(&a, bel, al, ar, 64);
+    var[nvar - 1].fn(&b, bel, bl, br, 64);
+    ASSERT_EQ(memcmp(al, bl, sizeof al), 0);
+    ASSERT_EQ(memcmp(ar, br, sizeof ar), 0);
+    ASSERT_EQ(memcmp(&a, &b, sizeof a), 0);
+}
+
+#define PSG_BASE 0x1200
+#define PSG_BLOCKS 60
+
+/* A pass of the schedule the seed names, from the saved state: a few
+ * writes anywhere in the channel block, then a block of samples, one at a
+ * time through the handler or all at once through the lanes. */
+static size_t psg_pass(uint32_t seed, const void *saved, size_t size, bool blocks,
+                       int16_t *out)
+{
+    for (uint16_t i = 0; i < 64; i++)
+        shim_xram_write((uint16_t)(PSG_BASE + i), 0);
+    psg_xreg(PSG_BASE);
+    psg_state_load(saved, size);
+    g_seed = seed;
+    size_t total = 0;
+    for (unsigned k = 0; k < PSG_BLOCKS; k++)
+    {
+        for (unsigned w = rnd() % 12; w; w--)
+            shim_xram_write((uint16_t)(PSG_BASE + rnd() % 64), (uint8_t)rnd());
+        const unsigned n = k % 4 ? 1 + rnd() % 300 : 1 + rnd() % 3;
+        int16_t l[300], r[300];
+        if (blocks)
+            shim_render(l, r, n);
+        else
+            for (unsigned i = 0; i < n; i++)
+                shim_sample(&l[i], &r[i]);
+        for (unsigned i = 0; i < n; i++)
+        {
+            *out++ = l[i];
+            *out++ = r[i];
+        }
+        total += n;
+    }
+    return total;
+}
+
+UTEST(psv, psg_lanes_are_its_handler)
+{
+    shim_init();
+    psg_setup(PSG_SHIM_RATE);
+    bel_setup();
+    for (uint16_t i = 0; i < 64; i++)
+        shim_xram_write((uint16_t)(PSG_BASE + i), 0);
+    ASSERT_TRUE(psg_xreg(PSG_BASE));
+    static uint8_t saved[4096];
+    const size_t size = psg_state_save(NULL);
+    ASSERT_LE(size, sizeof saved);
+    psg_state_save(saved);
+
+    static int16_t one[PSG_BLOCKS * 300 * 2], block[PSG_BLOCKS * 300 * 2];
+    size_t sounding = 0;
+    for (uint32_t seed = 1; seed <= 20; seed++)
+    {
+        const size_t n = psg_pass(seed * 0x9E3779B9, saved, size, false, one);
+        ASSERT_EQ(psg_pass(seed * 0x9E3779B9, saved, size, true, block), n);
+        for (size_t i = 0; i < n * 2; i++)
+        {
+            if (one[i] != block[i])
+                fprintf(stderr, "  seed %u sample %zu %s: handler %d, lanes %d\n",
+                        (unsigned)seed, i / 2, i & 1 ? "R" : "L", one[i], block[i]);
+            ASSERT_EQ(one[i], block[i]);
+            sounding += one[i] != 0;
+        }
+    }
+    psg_xreg(0xFFFF);
+    ASSERT_GT(sounding, (size_t)PSG_BLOCKS * 300);
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The block renderers against the handlers they were hoisted out of, with
+ * no RTL and no emulator in it. Each device runs one schedule of writes
+ * twice from the same saved state: once an interrupt at a time, and once a
+ * block at a time with the writes landing between blocks, which is the only
+ * place the emulator lets them land. The blocks straddle the renderers'
+ * chunks, and one burst of writes is longer than a sample's drain, so it
+ * has to spill into the block. The two must agree sample for sample.
+ *
+ * psg.c is built scalar here, as the firmware builds it; test_psv holds its
+ * vector lanes to the same handler.
+ */
+
+#include "psg_shim.h"
+
+#include "ria/aud/bel.h"
+#include "ria/aud/opl.h"
+#include "ria/aud/psg.h"
+#include "utest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+UTEST_MAIN();
+
+static const unsigned render_block[] = {1, 5, 63, 64, 65, 130, 1, 800, 17, 333, 2};
+#define RENDER_BLOCKS (sizeof(render_block) / sizeof(*render_block))
+#define RENDER_SAMPLES 1481 /* the blocks' sum */
+#define PSG_BASE 0x1200
+#define OPL_BASE 0x1300
+
+static int16_t g_one[RENDER_SAMPLES * 2];
+static int16_t g_block[RENDER_SAMPLES * 2];
+
+static void psg_writes(unsigned k)
+{
+    static const uint8_t waves[] = {0x00, 0x10, 0x20, 0x30, 0x40, 0x11, 0x23, 0x04};
+    switch (k)
+    {
+    case 0:
+        for (int ch = 0; ch < 8; ch++)
+        {
+            uint16_t at = (uint16_t)(PSG_BASE + ch * 8);
+            uint16_t freq = (uint16_t)(110 + 97 * ch);
+            shim_xram_write(at + 0, (uint8_t)freq);
+            shim_xram_write(at + 1, (uint8_t)(freq >> 8));
+            shim_xram_write(at + 2, (uint8_t)(40 + 25 * ch));
+            shim_xram_write(at + 3, (uint8_t)(ch << 4 | ch));
+            shim_xram_write(at + 4, (uint8_t)((7 - ch) << 4 | 1));
+            shim_xram_write(at + 5, waves[ch]);
+            shim_xram_write(at + 6, (uint8_t)((ch * 36 - 128) & 0xFE) | 1);
+        }
+        break;
+    case 2:
+        shim_xram_write(PSG_BASE + 8 + 0, 0x34);
+        shim_xram_write(PSG_BASE + 8 + 1, 0x12);
+        shim_xram_write(PSG_BASE + 16 + 6, 0x41);
+        break;
+    case 3:
+        shim_xram_write(PSG_BASE + 0 + 6, 0x00);
+        shim_xram_write(PSG_BASE + 24 + 6, 0x00);
+        break;
+    case 4:
+        for (int i = 0; i < 41; i++)
+            shim_xram_write(PSG_BASE + 32 + 6, (uint8_t)(i & 1 ? 0x00 : 0x01));
+        break;
+    case 6:
+        shim_xram_write(PSG_BASE + 40 + 5, 0x42);
+        shim_xram_write(PSG_BASE + 40 + 2, 0x80);
+        shim_xram_write(PSG_BASE + 0 + 6, 0x01);
+        break;
+    case 7:
+        shim_xram_write(PSG_BASE + 48 + 6, 0x81);
+        break;
+    case 9:
+        for (int ch = 0; ch < 8; ch++)
+            shim_xram_write((uint16_t)(PSG_BASE + ch * 8 + 6), 0x00);
+        break;
+    }
+}
+
+/* A register of the chip, by its queue: the low byte of the write is the
+ * register, as opl_drain hands it to emu8950. */
+static void opl_reg(uint8_t reg, uint8_t val)
+{
+    shim_xram_write((uint16_t)(OPL_BASE + reg), val);
+}
+
+static void opl_writes(unsigned k)
+{
+    switch (k)
+    {
+    case 0:
+        opl_reg(0x01, 0x20); /* waveform select on */
+        for (uint8_t ch = 0; ch < 3; ch++)
+        {
+            /* The channel's two operators, at slots ch and ch + 3. */
+            for (uint8_t op = ch; op <= ch + 3; op += 3)
+            {
+                opl_reg(0x20 + op, (uint8_t)(0x21 + ch));
+                opl_reg(0x40 + op, (uint8_t)(op == ch ? 0x18 : 0x00));
+                opl_reg(0x60 + op, 0xF4);
+                opl_reg(0x80 + op, 0x35);
+                opl_reg(0xE0 + op, ch);
+            }
+            opl_reg(0xC0 + ch, (uint8_t)(ch << 1 | 0x30));
+            opl_reg(0xA0 + ch, (uint8_t)(0x41 + 40 * ch));
+            opl_reg(0xB0 + ch, (uint8_t)(0x20 | (4 + ch) << 2 | 1));
+        }
+        break;
+    case 2:
+        opl_reg(0xA0 + 1, 0x98);
+        opl_reg(0xB0 + 1, 0x31);
+        break;
+    case 3:
+        opl_reg(0xB0 + 0, 0x11); /* key off */
+        break;
+    case 4:
+        for (int i = 0; i < 21; i++)
+            opl_reg(0xB0 + 2, (uint8_t)(i & 1 ? 0x11 : 0x31));
+        break;
+    case 6:
+        opl_reg(0xBD, 0x20); /* rhythm on */
+        opl_reg(0xBD, 0x3F);
+        break;
+    case 9:
+        for (uint8_t ch = 0; ch < 3; ch++)
+            opl_reg(0xB0 + ch, 0x00);
+        break;
+    }
+}
+
+/* The schedule, from the device's saved state, into out. */
+static void render_pass(void (*writes)(unsigned k), bool (*load)(const void *, size_t),
+                        const void *saved, size_t size, bool blocks, int16_t *out)
+{
+    load(saved, size);
+    for (unsigned k = 0; k < RENDER_BLOCKS; k++)
+    {
+        writes(k);
+        int16_t l[800], r[800];
+        if (blocks)
+            shim_render(l, r, render_block[k]);
+        else
+            for (unsigned i = 0; i < render_block[k]; i++)
+                shim_sample(&l[i], &r[i]);
+        for (unsigned i = 0; i < render_block[k]; i++)
+        {
+            *out++ = l[i];
+            *out++ = r[i];
+        }
+    }
+}
+
+/* Whether the two passes agree, naming where they do not; and how many of
+ * the samples are not silence. */
+static bool render_agree(size_t *sounding)
+{
+    bool agree = true;
+    *sounding = 0;
+    for (size_t i = 0; i < RENDER_SAMPLES * 2; i++)
+    {
+        if (g_one[i] != g_block[i])
+        {
+            fprintf(stderr, "  sample %zu %s: handler %d, render %d\n",
+                    i / 2, i & 1 ? "R" : "L", g_one[i], g_block[i]);
+            agree = false;
+        }
+        *sounding += g_one[i] != 0;
+    }
+    return agree;
+}
+
+UTEST(render, a_psg_block_is_its_samples)
+{
+    shim_init();
+    psg_setup(PSG_SHIM_RATE);
+    bel_setup();
+    for (uint16_t i = 0; i < 64; i++)
+        shim_xram_write((uint16_t)(PSG_BASE + i), 0);
+    ASSERT_TRUE(psg_xreg(PSG_BASE));
+    static uint8_t saved[4096];
+    const size_t size = psg_state_save(NULL);
+    ASSERT_LE(size, sizeof saved);
+    psg_state_save(saved);
+
+    render_pass(psg_writes, psg_state_load, saved, size, false, g_one);
+    for (uint16_t i = 0; i < 64; i++)
+        shim_xram_write((uint16_t)(PSG_BASE + i), 0);
+    ASSERT_TRUE(psg_xreg(PSG_BASE));
+    render_pass(psg_writes, psg_state_load, saved, size, true, g_block);
+    psg_xreg(0xFFFF);
+
+    size_t sounding;
+    ASSERT_TRUE(render_agree(&sounding));
+    ASSERT_GT(sounding, (size_t)RENDER_SAMPLES);
+}
+
+UTEST(render, an_opl_block_is_its_samples)
+{
+    shim_init();
+    bel_setup();
+    ASSERT_TRUE(opl_xreg(OPL_BASE));
+    const size_t size = opl_state_save(NULL);
+    uint8_t *saved = malloc(size);
+    ASSERT_TRUE(saved != NULL);
+    opl_state_save(saved);
+
+    render_pass(opl_writes, opl_state_load, saved, size, false, g_one);
+    ASSERT_TRUE(opl_xreg(OPL_BASE));
+    render_pass(opl_writes, opl_state_load, saved, size, true, g_block);
+    opl_xreg(0xFFFF);
+    free(saved);
+
+    size_t sounding;
+    ASSERT_TRUE(render_agree(&sounding));
+    ASSERT_GT(sounding, (size_t)RENDER_SAMPLES);
+}
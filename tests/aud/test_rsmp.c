@@ -227,3 +227,140 @@ UTEST(rsmp, upsampling_is_the_same_machine)
     for (int i = 32; i < n; i++)
         ASSERT_EQ(out[i], dc);
 }
+
+/* The resampler as it was before the ring: a history shifted down one on
+ * every push and two scalar MACs straight off the table. Kept here as the
+ * thing the ring and the vector variants are held to, word for word. */
+typedef struct
+{
+    int32_t hist[RSMP_TAPS];
+    uint64_t phase;
+    bool primed;
+} shift_t;
+
+static int shift_push(shift_t *r, int32_t x, uint64_t step, int32_t *out, int max_out)
+{
+    if (!r->primed)
+    {
+        for (int i = 0; i < RSMP_TAPS; i++)
+            r->hist[i] = x;
+        r->primed = true;
+    }
+    else
+    {
+        for (int i = 0; i < RSMP_TAPS - 1; i++)
+            r->hist[i] = r->hist[i + 1];
+        r->hist[RSMP_TAPS - 1] = x;
+    }
+    int n = 0;
+    while (r->phase < ((uint64_t)1 << 32) && n < max_out)
+    {
+        const uint32_t mu = (uint32_t)r->phase;
+        const unsigned p = mu >> 25;
+        const int64_t f = (mu >> 9) & 0xFFFF;
+        int64_t a = 0, b = 0;
+        for (int i = 0; i < RSMP_TAPS; i++)
+        {
+            a += (int64_t)rsmp_coef[p][i] * r->hist[i];
+            b += (int64_t)rsmp_coef[p + 1][i] * r->hist[i];
+        }
+        const int64_t v = a + (((b - a) * f) >> 16);
+        out[n++] = (int32_t)((v + (1 << (RSMP_Q - 1))) >> RSMP_Q);
+        r->phase += step;
+    }
+    if (r->phase >= ((uint64_t)1 << 32))
+        r->phase -= (uint64_t)1 << 32;
+    return n;
+}
+
+static uint32_t g_seed = 0x9E3779B9;
+
+static uint32_t rnd(void)
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 17;
+    g_seed ^= g_seed << 5;
+    return g_seed;
+}
+
+/* A loud tone with full-scale clicks in it, so the overshoot is exercised
+ * and no two pushes look alike. */
+static int32_t gen_rough(int n, void *ctx)
+{
+    (void)ctx;
+    if (rnd() % 64 == 0)
+        return rnd() % 2 ? 32767 : -32768;
+    return (int32_t)lround(30000.0 * sin(n * 0.37)) + (int32_t)(rnd() % 513) - 256;
+}
+
+UTEST(rsmp, the_ring_is_the_shift)
+{
+    static const uint32_t rates[][2] = {
+        {POCKET_IN, POCKET_OUT}, {49716, 44100}, {49716, 96000}, {24000, 96000}, {96000, 8000}};
+    for (unsigned k = 0; k < sizeof rates / sizeof *rates; k++)
+    {
+        const uint64_t step = rsmp_step(rates[k][0], rates[k][1]);
+        rsmp_t r;
+        rsmp_stereo_t s;
+        shift_t ref_l, ref_r;
+        rsmp_reset(&r);
+        rsmp_stereo_reset(&s);
+        memset(&ref_l, 0, sizeof ref_l);
+        memset(&ref_r, 0, sizeof ref_r);
+        for (int i = 0; i < 20000; i++)
+        {
+            const int32_t xl = gen_rough(i, NULL), xr = gen_rough(i, NULL);
+            int32_t want_l[16], want_r[16], got[16], got2[32];
+            const int n = shift_push(&ref_l, xl, step, want_l, 16);
+            ASSERT_EQ(shift_push(&ref_r, xr, step, want_r, 16), n);
+            ASSERT_EQ(rsmp_push(&r, xl, step, got, 16), n);
+            ASSERT_EQ(rsmp_stereo_push(&s, xl, xr, step, got2, 16), n);
+            for (int j = 0; j < n; j++)
+            {
+                ASSERT_EQ(got[j], want_l[j]);
+                ASSERT_EQ(got2[j * 2 + 0], want_l[j]);
+                ASSERT_EQ(got2[j * 2 + 1], want_r[j]);
+            }
+        }
+    }
+}
+
+UTEST(rsmp, every_variant_matches_scalar)
+{
+    /* Every row pair, against histories anywhere in int32. A product needs
+     * 49 bits and the sum of 24 of them 54, so nothing here can overflow
+     * and any order of adding them is the same number. */
+    const rsmp_variant_t *v;
+    const size_t n = rsmp_variants(&v);
+    ASSERT_GE(n, (size_t)1);
+    ASSERT_STREQ(v[0].name, "scalar");
+    for (size_t k = 0; k < n; k++)
+        fprintf(stderr, "  %s\n", v[k].name);
+
+    int32_t h[RSMP_TAPS * 2];
+    for (int round = 0; round < 64; round++)
+    {
+        for (int i = 0; i < RSMP_TAPS * 2; i++)
+            h[i] = round % 2 ? (int32_t)rnd() : (int16_t)rnd();
+        for (unsigned p = 0; p < RSMP_PHASES; p++)
+        {
+            int64_t a[2], b[2], wa[2], wb[2];
+            v[0].mono(h, rsmp_coef[p], rsmp_coef[p + 1], &wa[0], &wb[0]);
+            for (size_t k = 1; k < n; k++)
+            {
+                v[k].mono(h, rsmp_coef[p], rsmp_coef[p + 1], &a[0], &b[0]);
+                ASSERT_EQ(a[0], wa[0]);
+                ASSERT_EQ(b[0], wb[0]);
+            }
+            v[0].stereo(h, rsmp_coef[p], rsmp_coef[p + 1], wa, wb);
+            for (size_t k = 1; k < n; k++)
+            {
+                v[k].stereo(h, rsmp_coef[p], rsmp_coef[p + 1], a, b);
+                ASSERT_EQ(a[0], wa[0]);
+                ASSERT_EQ(a[1], wa[1]);
+                ASSERT_EQ(b[0], wb[0]);
+                ASSERT_EQ(b[1], wb[1]);
+            }
+        }
+    }
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Where in a frame a write to the sound device is heard.
+ *
+ * The firmware's interrupt runs once a sample and sees every write the 6502
+ * made before it. The emulator generates a frame's samples in one go at the
+ * frame's end, so without help every write of a frame lands at its first
+ * sample: a note keyed a quarter of the way in starts early, and a gate
+ * opened and closed inside one frame is never heard at all. aud_sync is that
+ * help, and this holds it to the sample.
+ *
+ * The writes are the 6502's, through RW0 on the emulated bus, so they reach
+ * the device the way a program's do: ria.c's rw_write calls aud_sync with
+ * the clock of the bus cycle run_until is ticking. Each program is
+ * assembled here cycle by cycle, so the test knows when its writes land to
+ * within the reset sequence. test_psg already holds the handler's reply to
+ * a gate at a sample index to the RTL; this is the grid those indices sit on.
+ */
+
+#include "emu/emu/aud.h"
+#include "emu/sys/cpu.h"
+#include "emu/sys/mem.h"
+#include "emu/sys/vga.h"
+#include "ria/aud/psg.h"
+#include "ria/sys/mem.h"
+#include "emu_boot.h"
+
+#include <string.h>
+
+#define BASE 0xF000 /* the channel block; one page, so one queue page */
+#define RW0_DATA 0xFFE4
+#define RW0_STEP 0xFFE5
+#define RW0_ADDR 0xFFE6
+#define CH_PAN_GATE 6 /* struct psg_channel in ria/aud/psg.c */
+#define FRAME_TICKS ((uint64_t)SYS_TICKS_PER_US * 1000000 / VGA_HZ)
+
+/* The handler plays the previous sample first and takes gates last, so a
+ * gate taken at sample i moves the envelope at i + 1 and is heard at i + 2. */
+#define LATENCY 2
+
+static float g_buf[4096 * 2];
+
+/* The program, at ORG, and how many cycles it has taken by each point from
+ * its first opcode fetch. A taken branch that crosses a page costs a cycle
+ * more, so no loop is let straddle one. */
+#define ORG 0x0300
+static uint16_t g_pc;
+static uint64_t g_cycles;
+
+/* The reset sequence runs before the first fetch. The core's is a few
+ * cycles; RESET_MAX bounds it, a small part of one sample. */
+#define RESET_MAX 16
+
+static void emit(uint8_t b)
+{
+    ram[g_pc++] = b;
+}
+
+static void emit_abs(uint8_t op, uint16_t a)
+{
+    emit(op);
+    emit((uint8_t)a);
+    emit((uint8_t)(a >> 8));
+}
+
+/* lda #v; sta a. Returns the cycle the store writes on, its last. */
+static uint64_t store(uint16_t a, uint8_t v)
+{
+    emit(0xA9); /* lda # */
+    emit(v);
+    emit_abs(0x8D, a); /* sta */
+    g_cycles += 6;
+    return g_cycles - 1;
+}
+
+/* Up to the cycle at, short by under a loop's step. */
+static void delay_to(uint64_t at)
+{
+    while (g_cycles + 6 <= at)
+    {
+        if ((g_pc & 0xFF) > 0xFF - 5)
+        {
+            emit(0xEA); /* nop, past a page end */
+            g_cycles += 2;
+            continue;
+        }
+        uint64_t k = (at - g_cycles - 1) / 5; /* ldx #k; dex; bne: 5k + 1 */
+        if (k > 256)
+            k = 256;
+        emit(0xA2); /* ldx # */
+        emit((uint8_t)k);
+        emit(0xCA); /* dex */
+        emit(0xD0); /* bne -3 */
+        emit(0xFD);
+        g_cycles += 5 * k + 1;
+    }
+}
+
+/* Channel 0 a full-volume square with the fastest envelope, centred and
+ * gated off; the PSG takes it; then the frame grid is lined up and emptied.
+ * The program starts at the start of the next frame, and first points RW0
+ * at the gate, with no step. */
+static uint64_t setup(void)
+{
+    main_stop();
+    memset(&xram[BASE], 0, 64);
+    xram[BASE + 0] = 440 & 0xFF;
+    xram[BASE + 1] = 440 >> 8;
+    xram[BASE + 2] = 128;  /* duty */
+    xram[BASE + 3] = 0x00; /* full volume, fastest attack */
+    xram[BASE + 4] = 0x00; /* sustain at full */
+    xram[BASE + 5] = 0x10; /* square, fastest release */
+    psg_xreg(BASE);
+    sys_run_frame_norender();
+    while (aud_read(g_buf, 4096))
+        ;
+    REGS(0xFFFC) = ram[0xFFFC] = ORG & 0xFF; /* as rom_load publishes them */
+    REGS(0xFFFD) = ram[0xFFFD] = ORG >> 8;
+    g_pc = ORG;
+    g_cycles = 0;
+    store(RW0_STEP, 0);
+    store(RW0_ADDR, (BASE + CH_PAN_GATE) & 0xFF);
+    store(RW0_ADDR + 1, (BASE + CH_PAN_GATE) >> 8);
+    return sys_clk_now();
+}
+
+/* The gate, at cycle at or just before, or as soon as it can be. Returns
+ * the cycle it landed on. */
+static uint64_t gate(uint64_t at, uint8_t on)
+{
+    delay_to(at > 5 ? at - 5 : 0);
+    return store(RW0_DATA, on);
+}
+
+/* The program is done: it spins, and the machine starts it. */
+static void run(void)
+{
+    emit_abs(0x4C, g_pc); /* jmp * */
+    main_run();
+}
+
+/* The earliest and latest clock the program's cycle c can fall on, the
+ * program started at start. */
+static uint64_t clk_lo(uint64_t start, uint64_t c)
+{
+    return start + c * cpu_cycle_ticks();
+}
+
+static uint64_t clk_hi(uint64_t start, uint64_t c)
+{
+    return start + (c + RESET_MAX) * cpu_cycle_ticks();
+}
+
+/* The cycle d ticks into the frame. */
+static uint64_t cycle_at(uint64_t d)
+{
+    return d / cpu_cycle_ticks();
+}
+
+/* One frame's samples, left channel. */
+static int frame(void)
+{
+    sys_run_frame_norender();
+    return aud_read(g_buf, 4096);
+}
+
+static int first_sound(int n)
+{
+    for (int i = 0; i < n; i++)
+        if (g_buf[i * 2] != 0.0f)
+            return i;
+    return -1;
+}
+
+/* The sample a write at d ticks into the frame is taken by: every sample
+ * whose time is at or before d has already been made. */
+static int taken_at(uint64_t d, int n)
+{
+    return (int)(d * (uint64_t)n / FRAME_TICKS) + 1;
+}
+
+/* Whether sound starts where a write made somewhere in [lo, hi] ticks into
+ * the frame puts it. */
+static bool sounds_from(int first, uint64_t lo, uint64_t hi, int n)
+{
+    return first >= taken_at(lo, n) + LATENCY && first <= taken_at(hi, n) + LATENCY;
+}
+
+UTEST(timing, a_gate_is_heard_from_its_own_sample)
+{
+    static const uint64_t at[] = {0, FRAME_TICKS / 4, FRAME_TICKS / 2 + 12345, FRAME_TICKS * 9 / 10};
+    for (unsigned k = 0; k < sizeof(at) / sizeof(*at); k++)
+    {
+        const uint64_t start = setup();
+        const uint64_t c = gate(cycle_at(at[k]), 0x01);
+        run();
+        const int n = frame();
+        ASSERT_GT(n, 0);
+        ASSERT_TRUE(sounds_from(first_sound(n), clk_lo(start, c) - start,
+                                clk_hi(start, c) - start, n));
+    }
+}
+
+UTEST(timing, a_gate_inside_one_frame_still_sounds)
+{
+    const uint64_t start = setup();
+    const uint64_t c_on = gate(cycle_at(FRAME_TICKS / 4), 0x01);
+    const uint64_t c_off = gate(cycle_at(FRAME_TICKS / 2), 0x00);
+    run();
+    const int n = frame();
+    ASSERT_GT(n, 0);
+    const int on = first_sound(n);
+    ASSERT_TRUE(sounds_from(on, clk_lo(start, c_on) - start, clk_hi(start, c_on) - start, n));
+    const int off = taken_at(clk_lo(start, c_off) - start, n) + LATENCY;
+    /* Sounding the whole way between; the release starts after it. */
+    for (int i = on + 1; i < off; i++)
+        ASSERT_NE(g_buf[i * 2], 0.0f);
+    float peak = 0;
+    for (int i = on; i < off; i++)
+        if (g_buf[i * 2] > peak)
+            peak = g_buf[i * 2];
+    ASSERT_GT(peak, 0.25f);
+}
+
+UTEST(timing, a_gate_frames_later_is_heard_in_its_own)
+{
+    /* The clock runs on across frames, and so does the bus's. */
+    const uint64_t start = setup();
+    const uint64_t c = gate(cycle_at(FRAME_TICKS * 2 + FRAME_TICKS / 3), 0x01);
+    run();
+    ASSERT_EQ(first_sound(frame()), -1);
+    ASSERT_EQ(first_sound(frame()), -1);
+    const uint64_t third = sys_clk_now();
+    ASSERT_LT(third, clk_lo(start, c));
+    const int n = frame();
+    ASSERT_TRUE(sounds_from(first_sound(n), clk_lo(start, c) - third,
+                            clk_hi(start, c) - third, n));
+}
+
+UTEST(timing, a_sync_past_the_frame_makes_it_and_no_more)
+{
+    /* A clock beyond this frame's samples (a frame a debugger held long)
+     * makes them all and no more. */
+    const uint64_t start = setup();
+    run();
+    aud_sync(start + FRAME_TICKS * 3);
+    const int n = frame();
+    ASSERT_GT(n, 0);
+    ASSERT_EQ(n, frame());
+}
+
+UTEST_MAIN_EMU();
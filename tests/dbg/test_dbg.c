@@ -11,9 +11,12 @@
 #include "emu/dbg/dbg.h"
 #include "emu/sys/mem.h"
 #include "emu/sys/cpu.h"
+#include "emu/sys/rwd.h"
+#include "emu/sys/sst.h"
 #include "emu/sys/vga.h"
 #include "emu/hid/kbd.h"
 #include "emu_boot.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* The first instruction the CPU fetches after reset = the RESET vector target. */
@@ -212,6 +215,130 @@ UTEST(dbg, stop_sweeps_pending_output_to_framebuffer)
     vga_set_framebuffer(NULL);
 }
 
+/* Rewind states come back as they were taken: the clock each was taken at and
+ * the RAM it had, whichever of them is asked for and in any order. */
+UTEST(dbg, rewind_restores_what_it_recorded)
+{
+    ASSERT_TRUE(load());
+    rwd_set_interval(2);
+    uint32_t crc[8];
+    uint64_t clk[8];
+    size_t n = 0;
+    for (int i = 0; i < 40 && n < 8; i++)
+    {
+        sys_run_frame_norender();
+        if (rwd_count() > n)
+        {
+            crc[n] = mem_crc32(0, ram, sizeof ram);
+            clk[n] = sys_clk_now();
+            ASSERT_EQ(rwd_clock(n), clk[n]);
+            n++;
+        }
+    }
+    ASSERT_EQ(n, (size_t)8);
+    size_t len;
+    free(emu_state_snapshot(&len));
+    ASSERT_LT(rwd_bytes(), 2 * len); /* one state and deltas, not eight states */
+
+    static const size_t order[] = {3, 7, 0, 5, 5, 1};
+    for (size_t i = 0; i < sizeof order / sizeof *order; i++)
+    {
+        ASSERT_TRUE(rwd_restore(order[i]));
+        ASSERT_EQ(sys_clk_now(), clk[order[i]]);
+        ASSERT_EQ(mem_crc32(0, ram, sizeof ram), crc[order[i]]);
+    }
+    ASSERT_EQ(rwd_count(), (size_t)8); /* going back keeps the history */
+    ASSERT_FALSE(rwd_restore(8));
+
+    rwd_set_interval(0);
+    ASSERT_EQ(rwd_count(), (size_t)0);
+}
+
+/* Run on to the next stop, a frame at a time. */
+static void run_to_stop(void)
+{
+    dbg_continue();
+    for (int i = 0; i < 60 && !dbg_is_stopped(); i++)
+        sys_run_frame_norender();
+}
+
+/* Blocked on the keyboard, adventure spins on the RIA's BRA -2 at $FFF1: a
+ * breakpoint there hits every few cycles. Reverse continue goes back to the
+ * hit before, and running forward again from there stops where it stopped
+ * before, at the same clock. */
+UTEST(dbg, reverse_continue_returns_to_the_previous_hit)
+{
+    ASSERT_TRUE(load());
+    rwd_set_interval(1);
+    dbg_set_active(true);
+    for (int i = 0; i < 90; i++)
+        sys_run_frame_norender();
+    ASSERT_GT(rwd_count(), (size_t)0);
+
+    dbg_add_breakpoint(0xFFF1);
+    uint64_t hit[3];
+    for (int i = 0; i < 3; i++)
+    {
+        run_to_stop();
+        ASSERT_TRUE(dbg_is_stopped());
+        ASSERT_EQ((int)dbg_stop_pc(), 0xFFF1);
+        hit[i] = sys_clk_now();
+    }
+    ASSERT_LT(hit[0], hit[1]);
+    ASSERT_LT(hit[1], hit[2]);
+
+    ASSERT_TRUE(dbg_reverse_continue());
+    ASSERT_TRUE(dbg_is_stopped());
+    ASSERT_EQ(dbg_stop_reason(), (int)DBG_REASON_BREAKPOINT);
+    ASSERT_EQ((int)dbg_stop_pc(), 0xFFF1);
+    ASSERT_EQ(sys_clk_now(), hit[1]);
+
+    ASSERT_TRUE(dbg_reverse_continue());
+    ASSERT_EQ(sys_clk_now(), hit[0]);
+
+    run_to_stop();
+    ASSERT_TRUE(dbg_is_stopped());
+    ASSERT_EQ(sys_clk_now(), hit[1]);
+
+    rwd_set_interval(0);
+    disarm();
+}
+
+/* Step back undoes a step: the pc and the clock of the stop before it. */
+UTEST(dbg, step_back_undoes_a_step)
+{
+    ASSERT_TRUE(load());
+    rwd_set_interval(1);
+    dbg_set_active(true);
+    for (int i = 0; i < 30; i++)
+        sys_run_frame_norender();
+    dbg_request_break();
+    sys_run_frame_norender();
+    ASSERT_TRUE(dbg_is_stopped());
+    const uint16_t pc0 = dbg_stop_pc();
+    const uint64_t clk0 = sys_clk_now();
+
+    dbg_step(DBG_STEP_INSTR);
+    sys_run_frame_norender();
+    ASSERT_TRUE(dbg_is_stopped());
+    const uint16_t pc1 = dbg_stop_pc();
+    const uint64_t clk1 = sys_clk_now();
+    ASSERT_GT(clk1, clk0);
+
+    ASSERT_TRUE(dbg_step_back());
+    ASSERT_EQ(dbg_stop_reason(), (int)DBG_REASON_STEP);
+    ASSERT_EQ((int)dbg_stop_pc(), (int)pc0);
+    ASSERT_EQ(sys_clk_now(), clk0);
+
+    dbg_step(DBG_STEP_INSTR);
+    sys_run_frame_norender();
+    ASSERT_EQ((int)dbg_stop_pc(), (int)pc1);
+    ASSERT_EQ(sys_clk_now(), clk1);
+
+    rwd_set_interval(0);
+    disarm();
+}
+
 /* Continue after a stop resumes free execution: the program runs to completion.
  * Adventure blocks on input, so drive it to its quit and let it exit, with the
  * engine no longer reporting stopped. */
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * A --wav recording, read back. The header is what a player believes, and
+ * it is only patched with the real sizes when the recording closes, so this
+ * opens the file the way a player would: every field of the canonical 44
+ * bytes, a data chunk that is exactly the frames run at 800 samples each,
+ * and after it the same bytes the machine handed its taps.
+ */
+
+#include "emu/app/wav.h"
+#include "emu/emu/aud.h"
+#include "emu/sys/mem.h"
+#include "emu/sys/sys.h"
+#include "emu_boot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FRAMES 120
+#define WAV_SAMPLES (WAV_FRAMES * 48000 / 60)
+
+static uint32_t g_crc;
+static unsigned long g_samples;
+
+/* What a tap hears, in the bytes a WAV holds: 16-bit little-endian stereo. */
+static void count_tap(const int16_t *l, const int16_t *r, unsigned n, uint32_t rate)
+{
+    (void)rate;
+    for (unsigned i = 0; i < n; i++)
+    {
+        const uint8_t b[4] = {(uint8_t)l[i], (uint8_t)((uint16_t)l[i] >> 8),
+                              (uint8_t)r[i], (uint8_t)((uint16_t)r[i] >> 8)};
+        g_crc = mem_crc32(g_crc, b, sizeof b);
+    }
+    g_samples += n;
+}
+
+static uint32_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+static uint32_t le32(const uint8_t *p) { return le16(p) | le16(p + 2) << 16; }
+
+/* The whole file, or NULL. */
+static uint8_t *slurp(const char *path, long *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+    uint8_t *buf = NULL;
+    if (!fseek(f, 0, SEEK_END) && (*size = ftell(f)) >= 0 && !fseek(f, 0, SEEK_SET))
+    {
+        buf = malloc((size_t)*size + 1);
+        if (buf && fread(buf, 1, (size_t)*size, f) != (size_t)*size)
+        {
+            free(buf);
+            buf = NULL;
+        }
+    }
+    fclose(f);
+    return buf;
+}
+
+UTEST(wav, reads_back_as_recorded)
+{
+    char path[512];
+    snprintf(path, sizeof path, "%s/test_wav.wav", TEST_SCRATCH);
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    g_crc = 0;
+    g_samples = 0;
+    ASSERT_TRUE(aud_add_tap(count_tap));
+    ASSERT_TRUE(wav_open(path));
+    for (int i = 0; i < WAV_FRAMES; i++)
+        sys_run_frame();
+    ASSERT_TRUE(wav_close());
+    aud_remove_tap(count_tap);
+    ASSERT_EQ(g_samples, (unsigned long)WAV_SAMPLES);
+
+    long size;
+    uint8_t *w = slurp(path, &size);
+    ASSERT_TRUE(w != NULL);
+    ASSERT_EQ(size, 44L + WAV_SAMPLES * 4);
+    EXPECT_EQ(memcmp(w, "RIFF", 4), 0);
+    EXPECT_EQ(le32(w + 4), (uint32_t)size - 8);
+    EXPECT_EQ(memcmp(w + 8, "WAVEfmt ", 8), 0);
+    EXPECT_EQ(le32(w + 16), 16u);     /* a plain PCM format chunk */
+    EXPECT_EQ(le16(w + 20), 1u);      /* PCM */
+    EXPECT_EQ(le16(w + 22), 2u);      /* stereo */
+    EXPECT_EQ(le32(w + 24), aud_native_rate());
+    EXPECT_EQ(le32(w + 28), aud_native_rate() * 4);
+    EXPECT_EQ(le16(w + 32), 4u);      /* a frame is both sides */
+    EXPECT_EQ(le16(w + 34), 16u);
+    EXPECT_EQ(memcmp(w + 36, "data", 4), 0);
+    EXPECT_EQ(le32(w + 40), (uint32_t)WAV_SAMPLES * 4);
+    EXPECT_EQ(mem_crc32(0, w + 44, (size_t)size - 44), g_crc);
+    free(w);
+}
+
+/* Closed with nothing played, it is still a file a player opens: the sizes
+ * are zero and the rate is the one the machine would have made. */
+UTEST(wav, an_empty_recording_is_a_valid_file)
+{
+    char path[512];
+    snprintf(path, sizeof path, "%s/test_wav_empty.wav", TEST_SCRATCH);
+    ASSERT_TRUE(wav_open(path));
+    ASSERT_TRUE(wav_close());
+
+    long size;
+    uint8_t *w = slurp(path, &size);
+    ASSERT_TRUE(w != NULL);
+    ASSERT_EQ(size, 44L);
+    EXPECT_EQ(le32(w + 4), 36u);
+    EXPECT_EQ(le32(w + 24), aud_native_rate());
+    EXPECT_EQ(le32(w + 40), 0u);
+    free(w);
+}
+
+UTEST_MAIN_EMU();
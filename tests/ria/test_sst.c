@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Savestates. The claim is not that a state loads but that the machine it
+ * loads is the machine that was saved: run on from a restored state and every
+ * frame after is the frame the original run produced. A second snapshot taken
+ * after the same number of frames down each path is the whole machine, so the
+ * two must be equal byte for byte — any device a section left out, or put back
+ * wrong, shows up there as a difference.
+ */
+
+#include "emu/sys/mem.h"
+#include "emu/sys/sst.h"
+#include "emu/sys/vga.h"
+#include "emu_boot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t fb[VGA_MAX_WIDTH * VGA_MAX_HEIGHT];
+
+static void run_frames(int n)
+{
+    for (int i = 0; i < n; i++)
+        sys_run_frame();
+}
+
+static uint32_t fb_crc(void)
+{
+    int w, h;
+    vga_canvas_size(&w, &h);
+    return mem_crc32(0, fb, (size_t)w * h * sizeof *fb);
+}
+
+UTEST(sst, restore_replays_exactly)
+{
+    vga_set_framebuffer(fb);
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    run_frames(30);
+    size_t a_len;
+    void *a = emu_state_snapshot(&a_len);
+    ASSERT_TRUE(a != NULL);
+
+    run_frames(60);
+    uint32_t want_fb = fb_crc();
+    size_t b_len;
+    void *b = emu_state_snapshot(&b_len);
+    ASSERT_TRUE(b != NULL);
+
+    ASSERT_TRUE(emu_state_restore(a, a_len));
+    run_frames(60);
+    ASSERT_EQ(fb_crc(), want_fb);
+    size_t c_len;
+    void *c = emu_state_snapshot(&c_len);
+    ASSERT_TRUE(c != NULL);
+    ASSERT_EQ(c_len, b_len);
+    ASSERT_EQ(memcmp(b, c, b_len), 0);
+
+    free(a);
+    free(b);
+    free(c);
+}
+
+/* And across a program restart, which is what --load-state does: the ROM is
+ * booted fresh and the state is put over it. */
+UTEST(sst, restore_over_a_fresh_boot)
+{
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    run_frames(45);
+    size_t a_len;
+    void *a = emu_state_snapshot(&a_len);
+    ASSERT_TRUE(a != NULL);
+    run_frames(15);
+    size_t b_len;
+    void *b = emu_state_snapshot(&b_len);
+    ASSERT_TRUE(b != NULL);
+
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    ASSERT_TRUE(emu_state_restore(a, a_len));
+    run_frames(15);
+    size_t c_len;
+    void *c = emu_state_snapshot(&c_len);
+    ASSERT_TRUE(c != NULL);
+    ASSERT_EQ(c_len, b_len);
+    ASSERT_EQ(memcmp(b, c, b_len), 0);
+
+    free(a);
+    free(b);
+    free(c);
+}
+
+UTEST(sst, file_round_trip)
+{
+    char path[512];
+    snprintf(path, sizeof path, "%s/sst.state", TEST_SCRATCH);
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    run_frames(20);
+    ASSERT_TRUE(emu_state_save(path));
+    size_t a_len;
+    void *a = emu_state_snapshot(&a_len);
+    ASSERT_TRUE(a != NULL);
+
+    run_frames(20);
+    ASSERT_TRUE(emu_state_load(path));
+    size_t b_len;
+    void *b = emu_state_snapshot(&b_len);
+    ASSERT_TRUE(b != NULL);
+    ASSERT_EQ(b_len, a_len);
+    ASSERT_EQ(memcmp(a, b, a_len), 0);
+
+    free(a);
+    free(b);
+    remove(path);
+}
+
+/* A blob that fails its checks changes nothing: the machine after the refusal
+ * is the machine before it. */
+UTEST(sst, refuses_whole)
+{
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    run_frames(10);
+    size_t len;
+    uint8_t *good = emu_state_snapshot(&len);
+    ASSERT_TRUE(good != NULL);
+    run_frames(10);
+    size_t before_len;
+    void *before = emu_state_snapshot(&before_len);
+    ASSERT_TRUE(before != NULL);
+
+    uint8_t *bad = malloc(len);
+    ASSERT_TRUE(bad != NULL);
+    memcpy(bad, good, len);
+    bad[len / 2] ^= 0x01; /* somewhere in memory: only the CRC can see it */
+    ASSERT_FALSE(emu_state_restore(bad, len));
+    memcpy(bad, good, len);
+    bad[0] = 'X'; /* not a state at all */
+    ASSERT_FALSE(emu_state_restore(bad, len));
+    ASSERT_FALSE(emu_state_restore(good, len - 8)); /* truncated */
+    ASSERT_FALSE(emu_state_restore(good, 4));
+
+    size_t after_len;
+    void *after = emu_state_snapshot(&after_len);
+    ASSERT_TRUE(after != NULL);
+    ASSERT_EQ(after_len, before_len);
+    ASSERT_EQ(memcmp(before, after, before_len), 0);
+
+    free(good);
+    free(bad);
+    free(before);
+    free(after);
+}
+
+UTEST_MAIN_EMU()
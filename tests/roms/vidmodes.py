@@ -17,14 +17,23 @@
 # are real cc65-built programs with no generator, which is why they stay.
 
 import argparse
+import importlib.util
 import sys
 from pathlib import Path
 
 # The assembler and the container live with the other generators; this
 # one lives beside the corpus it writes.
-sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "src" / "gen"))
+ROOT = Path(__file__).resolve().parents[2]
+sys.path.insert(0, str(ROOT / "src" / "gen"))
 from rp6502_rom import Asm, Rom  # noqa: E402
 
+# Mode 4 opacity metadata as projects get it: from the developer tool's
+# sprite command, which is a script rather than a module.
+_tool = importlib.util.spec_from_file_location(
+    "rp6502_tool", ROOT / "tools" / "rp6502.py")
+rp6502_tool = importlib.util.module_from_spec(_tool)
+_tool.loader.exec_module(rp6502_tool)
+
 ap = argparse.ArgumentParser(description=__doc__)
 ap.add_argument("--out", type=Path, required=True,
                 help="directory to write the corpus into")
@@ -68,8 +77,16 @@ def le16(*vals):
     return b
 
 
+def le32(*vals):
+    b = bytearray()
+    for v in vals:
+        b += (v & 0xFFFFFFFF).to_bytes(4, "little")
+    return b
+
+
 def mode3(name, canvas, attr, bpp, w, h, x, y, xram_pal,
-          x_wrap=False, y_wrap=False, config_ptr=0x0100, pal_ptr=0x0200):
+          x_wrap=False, y_wrap=False, config_ptr=0x0100, pal_ptr=0x0200,
+          scroll=None):
     if not xram_pal:
         pal_ptr = 0xFFFF
     data_ptr = 0x0800
@@ -81,11 +98,13 @@ def mode3(name, canvas, attr, bpp, w, h, x, y, xram_pal,
     if xram_pal:
         chunks.append((pal_ptr, le16(*((0x0020 | (i * 2657))
                                        for i in range(1 << bpp)))))
+    attr = scroll_table(attr, cfg, chunks, scroll)
     rom(name, canvas, [(3, attr, config_ptr, 0, 0, 0)], chunks)
 
 
 def mode1(name, canvas, attr, wchars, hchars, x, y, xram_pal, xram_font,
-          x_wrap=False, y_wrap=False, pal_ptr=0x0200, config_ptr=0x0100):
+          x_wrap=False, y_wrap=False, pal_ptr=0x0200, config_ptr=0x0100,
+          scroll=None):
     fmt = attr & 7
     fh = 16 if attr & 8 else 8
     if not xram_pal:
@@ -115,29 +134,68 @@ def mode1(name, canvas, attr, wchars, hchars, x, y, xram_pal, xram_font,
     if xram_font:
         chunks.append((0x4000, bytes((i * 7 + 3) & 0xFF
                                      for i in range(256 * fh))))
+    attr = scroll_table(attr, cfg, chunks, scroll)
     rom(name, canvas, [(1, attr, config_ptr, 0, 0, 0)], chunks)
 
 
 def mode2(name, canvas, attr, wt, ht, x, y, x_wrap, y_wrap, xram_pal,
-          pal_ptr=0x0200):
-    bpp = 1 << (attr & 3)
-    tile_size = 16 if attr & 8 else 8
-    n_tiles = 6
-    if not xram_pal:
-        pal_ptr = 0xFFFF
+          pal_ptr=0x0200, scroll=None):
     data_ptr = 0x0800
     tile_ptr = 0x4000
     cfg = bytearray((1 if x_wrap else 0, 1 if y_wrap else 0)) \
-        + le16(x, y, wt, ht, data_ptr, pal_ptr, tile_ptr)
+        + le16(x, y, wt, ht, data_ptr, pal_ptr if xram_pal else 0xFFFF,
+               tile_ptr)
+    chunks = [(0x0100, cfg)] + tile_map(attr, wt, ht, data_ptr, tile_ptr,
+                                         pal_ptr if xram_pal else None)
+    attr = scroll_table(attr, cfg, chunks, scroll)
+    rom(name, canvas, [(2, attr, 0x0100, 0, 0, 0)], chunks)
+
+
+def scroll_table(attr, cfg, chunks, scroll):
+    # scroll: an (x, y) per canvas scanline, added to the plane's position
+    # on that line. The table's pointer is the word after the config, and
+    # bit 15 of the options is what makes the plane read it.
+    if scroll is None:
+        return attr
+    table_ptr = 0x9000
+    cfg += le16(table_ptr)
+    chunks.append((table_ptr, b"".join(le16(*xy) for xy in scroll)))
+    return attr | 0x8000
+
+
+def tile_map(attr, wt, ht, data_ptr, tile_ptr, pal_ptr):
+    # The map, tile set and palette of a mode 2 plane, which mode 6 draws
+    # too: the same chunks under an identity matrix are the same picture.
+    bpp = 1 << (attr & 3)
+    tile_size = 16 if attr & 8 else 8
+    n_tiles = 6
     tmap = bytes((i * 5 + 2) % n_tiles for i in range(wt * ht))
     mem_size = tile_size * bpp // 8 * tile_size
     tiles = bytes((t // mem_size * 31 + t % mem_size * 7 + 3) & 0xFF
                   for t in range(n_tiles * mem_size))
-    chunks = [(0x0100, cfg), (data_ptr, tmap), (tile_ptr, tiles)]
-    if xram_pal:
+    chunks = [(data_ptr, tmap), (tile_ptr, tiles)]
+    if pal_ptr is not None:
         chunks.append((pal_ptr, le16(*((0x0020 | (i * 2657))
                                       for i in range(1 << bpp)))))
-    rom(name, canvas, [(2, attr, 0x0100, 0, 0, 0)], chunks)
+    return chunks
+
+
+def mode6(name, canvas, attr, width_log, height_log, matrix,
+          x_wrap=False, y_wrap=False, lines=None):
+    # matrix: the six 16.16 words {u, v, du_dx, dv_dx, du_dy, dv_dy};
+    # lines: a {u, v, du_dx, dv_dx} per scanline, overriding it.
+    data_ptr = 0x0800
+    tile_ptr = 0x4000
+    line_ptr = 0x8000 if lines else 0xFFFF
+    cfg = bytearray((1 if x_wrap else 0, 1 if y_wrap else 0,
+                     width_log, height_log)) \
+        + le32(*matrix) + le16(data_ptr, 0x0200, tile_ptr, line_ptr)
+    chunks = [(0x0100, cfg)] + tile_map(attr, 1 << width_log,
+                                        1 << height_log, data_ptr,
+                                        tile_ptr, 0x0200)
+    if lines:
+        chunks.append((line_ptr, b"".join(le32(*ln) for ln in lines)))
+    rom(name, canvas, [(6, attr, 0x0100, 0, 0, 0)], chunks)
 
 
 def mode5(name, canvas, attr, plane, sprites, n_pals=1,
@@ -293,6 +351,28 @@ mode2("mode2_trimx8", 2, 0x013, 20, 8, 100, 50, False, False, True)
 mode2("mode2_trimy", 2, 0x500, 24, 14, 6, 1, False, False, False)
 composite("mode2_composite")
 
+# Per-scanline scroll tables, emulator only — the RTL machine refuses the
+# option bit, so the FPGA suite lists none of these. Each slides its plane
+# sideways by a ramp and steps it up and down in bands, every window still
+# leaving black around itself.
+SCROLL = [((y * 5) % 23 - 11, (y // 30) % 3 - 1) for y in range(240)]
+mode1("mode1_scroll", 1, 10, 20, 8, 40, 50, True, False, scroll=SCROLL)
+mode2("mode2_scroll", 1, 0x002, 20, 10, 60, 40, False, False, True,
+      scroll=SCROLL)
+mode3("mode3_scroll", 1, 3, 8, 100, 80, 80, 60, True, scroll=SCROLL)
+
+# Mode 6: the affine tile map, emulator only — the RTL machine has no
+# engine for it and refuses the mode, so the FPGA suite lists none of
+# these. A mode 2 plane of the same map at the origin is the reference
+# picture: identity draws it, a quarter turn draws it transposed, and a
+# line table slides each of its rows on its own.
+ONE = 1 << 16
+mode2("mode2_map32", 1, 0x003, 32, 16, 0, 0, False, False, True)
+mode6("mode6_id", 1, 0x003, 5, 4, (0, 0, ONE, 0, 0, ONE))
+mode6("mode6_rot", 1, 0x003, 5, 4, (255 * ONE, 0, 0, ONE, -ONE, 0))
+mode6("mode6_lines", 1, 0x003, 5, 4, (0, 0, 0, 0, 0, 0),
+      lines=[((y * 7 % 19) * ONE, y * ONE, ONE, 0) for y in range(240)])
+
 # Mode 5: a sprite-only plane (the zeroed claimed layer), sprites over a
 # fill on the same plane, sprites under a text plane above, and the big
 # squares on the letterboxed canvas from a non-zero plane — with clips
@@ -437,6 +517,57 @@ rom("mode4a_sizes", 1, [(4, 1, 0x0102, 2, 0, 0, 0)],
 mode5("sprite_overrun", 1, 27, 0,
       [(i * 6, 40, 0, 0) for i in range(48)])
 
+
+def packed(name):
+    # Mode 4 metadata from the sprite command, emulator only like the
+    # check it feeds. One 16x16 image: empty rows, solid rows, rows with
+    # gaps, its clear pixels all colored so a wrongly solid span shows.
+    # Drawn with its metadata at (40, 40) and without it at (140, 40),
+    # which must come out alike.
+    size = 16
+    pixels = []
+    for y in range(size):
+        for x in range(size):
+            inside = abs(2 * x - 15) + abs(2 * y - 15) < 24 and 1 < y < 14
+            gap = y % 3 == 0 and x % 4 == 1
+            pixels.append((0x20 if inside and not gap else 0)
+                          | ((x * 2657 + y * 40503) & 0xFFDF))
+    img = rp6502_tool.Sprite(pixels, size).pack()
+    cfg = le16(40, 40, 0x4000) + bytes((4, 1)) \
+        + le16(140, 40, 0x4000) + bytes((4, 0))
+    rom(name, 1, [(4, 0, 0x0100, 2, 0, 0, 0)],
+        [(0x0100, cfg), (0x4000, img)])
+
+
+packed("mode4_packed")
+
+
+def overrun(name):
+    # Past the render budget, emulator only like the budget that sees it:
+    # two 8bpp bitmaps the width of the wide canvas, wrapped down it, and
+    # over them forty 64-pixel sprites side by side on lines 100-163, more
+    # than the VGA's two cores can draw in the time the beam gives them.
+    # The lines above the band are on time.
+    pal = le16(0, *((0x0020 | (i * 2657)) for i in range(1, 256)))
+    cfg0 = bytearray((0, 1)) + le16(0, 0, 640, 8, 0x0800, 0x0400)
+    cfg1 = bytearray((0, 1)) + le16(0, 0, 640, 8, 0x2000, 0x0600)
+    m4 = bytearray()
+    for i in range(40):
+        m4 += le16(i * 15, 100, 0x4000) + bytes((6, 0))
+    rom(name, 3,
+        [(3, 3, 0x0300, 0, 0, 0),
+         (3, 3, 0x0320, 1, 0, 0),
+         (4, 0, 0x0100, 40, 2, 0, 0)],
+        [(0x0100, m4), (0x0300, cfg0), (0x0320, cfg1),
+         (0x0400, pal), (0x0600, pal),
+         (0x0800, bytes((i * 13 + 7) & 0xFF for i in range(640 * 8))),
+         (0x2000, bytes((i * 11 + 3) & 0xFF for i in range(640 * 8))),
+         (0x4000, le16(*((0x0020 | (t * 13 + 5)) & 0xFFFF
+                         for t in range(64 * 64))))])
+
+
+overrun("budget_overrun")
+
 # Mode 0 as a slot: the terminal over a mode-3 bitmap, its
 # default-background cells transparent and its inked ones opaque, on
 # every canvas geometry — the 80-column faces at 640 wide, the
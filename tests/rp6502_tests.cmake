@@ -27,13 +27,15 @@ if(NOT TARGET rp6502_test_corpus)
     # It assembles through src/gen/rp6502_rom.py like every other ROM
     # generator, so a change there is a change to the corpus.
     set(RP6502_CORPUS_ASM ${RP6502_ROOT}/src/gen/rp6502_rom.py)
+    # Its mode 4 opacity metadata comes from the developer tool's packer.
+    set(RP6502_CORPUS_TOOL ${RP6502_ROOT}/tools/rp6502.py)
     # A stamp rather than the forty-one names: listing them here would be the
     # same duplication in a different file.
     add_custom_command(OUTPUT ${CMAKE_BINARY_DIR}/roms.stamp
         COMMAND ${CMAKE_COMMAND} -E env python3
             ${RP6502_CORPUS_GEN} --out ${RP6502_TEST_CORPUS}
         COMMAND ${CMAKE_COMMAND} -E touch ${CMAKE_BINARY_DIR}/roms.stamp
-        DEPENDS ${RP6502_CORPUS_GEN} ${RP6502_CORPUS_ASM}
+        DEPENDS ${RP6502_CORPUS_GEN} ${RP6502_CORPUS_ASM} ${RP6502_CORPUS_TOOL}
         COMMENT "Generating the video-mode ROM corpus"
         VERBATIM)
     add_custom_target(rp6502_test_corpus DEPENDS ${CMAKE_BINARY_DIR}/roms.stamp)
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * mode2.c as the VGA firmware builds it, beside the emulator's copy: no
+ * tile cache, so trimmed tiles go through its trimmed emitter. Included
+ * rather than linked, with its public names renamed so it stands apart from
+ * emu_core's mode2.c. It reads the emulator's XRAM and programs the
+ * emulator's planes, so both builds draw through the same compositor.
+ */
+
+#include "mode2_shim.h"
+
+#define mode2_prog shim_mode2_prog
+#define mode2_spans shim_mode2_spans
+#define mode2_cost shim_mode2_cost
+#define mode2_state_save shim_mode2_state_save
+#define mode2_state_load shim_mode2_state_load
+#include "vga/modes/mode2.c"
+
+#define SHIM_PALETTE 0x0200
+#define SHIM_DATA 0x0800
+#define SHIM_TILES 0x4000
+#define SHIM_COLS 23
+#define SHIM_ROWS 7
+
+void shim_fill(uint32_t seed)
+{
+    for (uint32_t i = 0; i < 0x10000; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        xram[i] = (uint8_t)(seed >> 16);
+    }
+    /* Sixteen 16x16 8bpp tiles end well inside XRAM. */
+    for (uint32_t i = 0; i < SHIM_COLS * SHIM_ROWS; i++)
+        xram[SHIM_DATA + i] &= 0x0F;
+}
+
+void shim_config(bool wrap, int16_t x_pos_px)
+{
+    mode2_config_t *config = (void *)&xram[SHIM_CONFIG];
+    config->x_wrap = wrap;
+    config->y_wrap = wrap;
+    config->x_pos_px = x_pos_px;
+    config->y_pos_px = 3;
+    config->width_tiles = SHIM_COLS;
+    config->height_tiles = SHIM_ROWS;
+    config->xram_data_ptr = SHIM_DATA;
+    config->xram_palette_ptr = SHIM_PALETTE;
+    config->xram_tile_ptr = SHIM_TILES;
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _TESTS_VID_MODE2_SHIM_H_
+#define _TESTS_VID_MODE2_SHIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Where shim_config puts its plane config. */
+#define SHIM_CONFIG 0x0100
+
+/* XRAM filled from seed, with a tile map that stays inside it. Written
+ * directly: the caller reports it to emu/sys/mem.h. */
+void shim_fill(uint32_t seed);
+
+/* A plane config at SHIM_CONFIG over that map, wrapping both ways or
+ * neither. */
+void shim_config(bool wrap, int16_t x_pos_px);
+
+/* mode2_prog as the VGA firmware builds it: the same registers program the
+ * emulator's plane, but with a renderer that has no tile cache. */
+bool shim_mode2_prog(uint16_t *xregs);
+
+#endif /* _TESTS_VID_MODE2_SHIM_H_ */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The VGA firmware's scanline balance accounting, off the board. Slack is
+ * measured against scanvideo's next scanline_id, so it is pinned across the
+ * frame boundary where the two ids disagree on the frame. Then lines from
+ * both cores and several modes go in, and the report comes out in the byte
+ * layout the RIA's status command decodes, resets and all.
+ */
+
+#include "vga/sys/bal.h"
+#include "utest.h"
+
+#include <string.h>
+
+UTEST_MAIN();
+
+#define ID(frame, line) ((uint32_t)(frame) << 16 | (line))
+
+static uint16_t get16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | (uint32_t)get16(p + 2) << 16;
+}
+
+/* Offsets within the report, as bal.h lays it out. */
+#define R_CORE(c) (4 + 5 * (c))
+#define R_WORST (4 + 5 * BAL_CORES)
+#define R_MODE(m) (R_WORST + 4 + (m) * (1 + 2 * BAL_BUCKETS))
+#define R_HIST(m, b) (R_MODE(m) + 1 + 2 * (b))
+
+UTEST(bal, slack_across_frames)
+{
+    ASSERT_EQ(bal_slack(ID(7, 100), ID(7, 96), 240), 4);
+    ASSERT_EQ(bal_slack(ID(7, 96), ID(7, 96), 240), 0);
+    ASSERT_EQ(bal_slack(ID(7, 95), ID(7, 96), 240), -1);
+    /* In vblank the next id is already line 0 of the coming frame. */
+    ASSERT_EQ(bal_slack(ID(8, 3), ID(8, 0), 240), 3);
+    /* The top of the next frame, from the bottom of this one. */
+    ASSERT_EQ(bal_slack(ID(8, 2), ID(7, 238), 240), 4);
+    ASSERT_EQ(bal_slack(ID(7, 239), ID(8, 1), 240), -2);
+    /* The frame counter wraps at 16 bits. */
+    ASSERT_EQ(bal_slack(ID(0, 1), ID(0xFFFF, 239), 240), 2);
+    /* Far off either way saturates rather than wrapping. */
+    ASSERT_EQ(bal_slack(ID(7, 400), ID(7, 0), 480), INT8_MAX);
+    ASSERT_EQ(bal_slack(ID(7, 0), ID(7, 400), 480), INT8_MIN);
+    ASSERT_EQ(bal_slack(ID(9, 0), ID(7, 0), 480), INT8_MAX);
+    ASSERT_EQ(bal_slack(ID(5, 0), ID(7, 0), 480), INT8_MIN);
+}
+
+UTEST(bal, bucket_edges)
+{
+    static const int slack[] = {INT8_MIN, -1, 0, 1, 2, 3, 4, 5, 7, 8, 11, 12, INT8_MAX};
+    static const unsigned bucket[] = {0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7};
+    for (unsigned i = 0; i < sizeof(slack) / sizeof(*slack); i++)
+        ASSERT_EQ(bal_bucket(slack[i]), bucket[i]);
+}
+
+UTEST(bal, cores_modes_and_worst)
+{
+    static bal_t bal;
+    bal_init(&bal);
+    /* Core 0 renders mode 3 alone; core 1 mode 3 under mode 4 sprites. */
+    bal_line(&bal, 0, 10, 1 << 3, 6);
+    bal_line(&bal, 0, 12, 1 << 3, 2);
+    bal_line(&bal, 1, 11, 1 << 3 | 1 << 4, 1);
+    bal_line(&bal, 1, 13, 1 << 3 | 1 << 4, -1);
+    bal_line(&bal, 1, 15, 1 << 3 | 1 << 4, 9);
+
+    uint8_t r[BAL_REPORT_SIZE];
+    ASSERT_EQ(bal_report(&bal, 5, r, sizeof(r) - 1), (size_t)0);
+    ASSERT_EQ(bal_report(&bal, 5, r, sizeof(r)), (size_t)BAL_REPORT_SIZE);
+    EXPECT_EQ(get32(r), 5u);
+    EXPECT_EQ(get32(r + R_CORE(0)), 2u);
+    EXPECT_EQ((int8_t)r[R_CORE(0) + 4], 2);
+    EXPECT_EQ(get32(r + R_CORE(1)), 3u);
+    EXPECT_EQ((int8_t)r[R_CORE(1) + 4], -1);
+    EXPECT_EQ((int8_t)r[R_WORST], -1);
+    EXPECT_EQ(r[R_WORST + 1], 1 << 3 | 1 << 4);
+    EXPECT_EQ(get16(r + R_WORST + 2), 13);
+
+    /* A line counts toward every mode on it. */
+    EXPECT_EQ((int8_t)r[R_MODE(3)], -1);
+    EXPECT_EQ((int8_t)r[R_MODE(4)], -1);
+    EXPECT_EQ((int8_t)r[R_MODE(0)], BAL_SLACK_NONE);
+    static const uint16_t mode3[BAL_BUCKETS] = {1, 0, 1, 1, 0, 1, 1, 0};
+    static const uint16_t mode4[BAL_BUCKETS] = {1, 0, 1, 0, 0, 0, 1, 0};
+    for (unsigned b = 0; b < BAL_BUCKETS; b++)
+    {
+        EXPECT_EQ(get16(r + R_HIST(3, b)), mode3[b]);
+        EXPECT_EQ(get16(r + R_HIST(4, b)), mode4[b]);
+        EXPECT_EQ(get16(r + R_HIST(0, b)), 0);
+    }
+}
+
+UTEST(bal, reset_between_reports)
+{
+    static bal_t bal;
+    bal_init(&bal);
+    bal_line(&bal, 0, 0, 1 << 0, 3);
+    bal_line(&bal, 1, 1, 1 << 0, -4);
+    bal_reset(&bal, 100);
+
+    /* Only core 0 renders after the reset. Core 1's old counts, still in its
+     * block, must not reach the report. */
+    bal_line(&bal, 0, 2, 1 << 2, 5);
+    uint8_t r[BAL_REPORT_SIZE];
+    ASSERT_EQ(bal_report(&bal, 103, r, sizeof(r)), (size_t)BAL_REPORT_SIZE);
+    EXPECT_EQ(get32(r), 3u);
+    EXPECT_EQ(get32(r + R_CORE(0)), 1u);
+    EXPECT_EQ(get32(r + R_CORE(1)), 0u);
+    EXPECT_EQ((int8_t)r[R_CORE(1) + 4], BAL_SLACK_NONE);
+    EXPECT_EQ((int8_t)r[R_WORST], 5);
+    EXPECT_EQ(r[R_WORST + 1], 1 << 2);
+    EXPECT_EQ((int8_t)r[R_MODE(0)], BAL_SLACK_NONE);
+    EXPECT_EQ(get16(r + R_HIST(0, 0)), 0);
+    EXPECT_EQ(get16(r + R_HIST(2, 5)), 1);
+
+    /* Nothing at all since a reset is an empty report. */
+    bal_reset(&bal, 103);
+    ASSERT_EQ(bal_report(&bal, 103, r, sizeof(r)), (size_t)BAL_REPORT_SIZE);
+    EXPECT_EQ(get32(r), 0u);
+    EXPECT_EQ((int8_t)r[R_WORST], BAL_SLACK_NONE);
+    for (unsigned m = 0; m < BAL_MODES; m++)
+        EXPECT_EQ((int8_t)r[R_MODE(m)], BAL_SLACK_NONE);
+}
+
+UTEST(bal, counts_saturate)
+{
+    static bal_t bal;
+    bal_init(&bal);
+    for (unsigned i = 0; i < 40000; i++)
+    {
+        bal_line(&bal, 0, 0, 1 << 1, 20);
+        bal_line(&bal, 1, 0, 1 << 1, 20);
+    }
+    uint8_t r[BAL_REPORT_SIZE];
+    ASSERT_EQ(bal_report(&bal, 0, r, sizeof(r)), (size_t)BAL_REPORT_SIZE);
+    /* The line counts are 32 bits; the histogram pins at 16. */
+    EXPECT_EQ(get32(r + R_CORE(0)) + get32(r + R_CORE(1)), 80000u);
+    EXPECT_EQ(get16(r + R_HIST(1, 7)), UINT16_MAX);
+}
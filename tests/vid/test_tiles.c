@@ -8,14 +8,22 @@
  * scrolls it; on a key press it reprograms with 16x16 tiles and scrolls again.
  * This exercises the xreg mode dispatch, the mode2 scanline renderer (tile fetch
  * + palette), and the HID keyboard XRAM bitmap.
+ *
+ * The VGA firmware's trimmed-tile emitter is also checked, for every trim,
+ * against the emulator's tile cache, through mode2_shim.c.
  */
 
 #include "emu/hid/kbd.h"
 #include "emu/sys/cpu.h"
 #include "emu/sys/mem.h"
+#include "emu/sys/sst.h"
 #include "emu/sys/vga.h"
+#include "vga/modes/mode2.h"
 #include "vga/term/color.h"
 #include "emu_boot.h"
+#include "mode2_shim.h"
+#include <stdlib.h>
+#include <string.h>
 
 static uint32_t fb[VGA_MAX_WIDTH * VGA_MAX_HEIGHT];
 
@@ -104,4 +112,132 @@ UTEST(mode2, stop_resets_canvas_to_console)
     ASSERT_EQ(vga_get_canvas(), vga_canvas_console);
 }
 
+/* Dirty lines. Every frame of a run that redraws only what changed is the
+ * frame a run that redraws everything makes: the scroll, the two key presses,
+ * the reprogram to 16x16 tiles, the exit to the console and the console
+ * sitting still. And sitting still is nearly free. */
+#define DIRTY_FRAMES 80
+
+static void dirty_run(uint32_t *crcs, uint64_t *still_lines)
+{
+    for (int f = 0; f < DIRTY_FRAMES; f++)
+    {
+        if (f == 20 || f == 40)
+            kbd_hid_set(0x2C, true); /* space */
+        if (f == 25 || f == 45)
+            kbd_hid_set(0x2C, false);
+        if (f == DIRTY_FRAMES - 10)
+            *still_lines = vga_lines_drawn();
+        sys_run_frame();
+        int cw, ch;
+        vga_canvas_size(&cw, &ch);
+        crcs[f] = mem_crc32(0, fb, (size_t)cw * ch * sizeof *fb);
+    }
+    *still_lines = vga_lines_drawn() - *still_lines;
+}
+
+UTEST(mode2, dirty_lines_draw_what_a_full_redraw_draws)
+{
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    vga_set_framebuffer(fb);
+    size_t len;
+    void *start = emu_state_snapshot(&len);
+    ASSERT_TRUE(start != NULL);
+
+    static uint32_t dirty[DIRTY_FRAMES], full[DIRTY_FRAMES];
+    uint64_t dirty_still, full_still;
+    dirty_run(dirty, &dirty_still);
+    ASSERT_TRUE(cpu_halted()); /* both loops ran and the program exited */
+
+    ASSERT_TRUE(emu_state_restore(start, len));
+    vga_set_redraw_all(true);
+    dirty_run(full, &full_still);
+    vga_set_redraw_all(false);
+    free(start);
+
+    for (int f = 0; f < DIRTY_FRAMES; f++)
+        ASSERT_EQ(dirty[f], full[f]);
+    ASSERT_EQ(full_still, (uint64_t)10 * VGA_MAX_HEIGHT);
+    ASSERT_LT(dirty_still, (uint64_t)VGA_MAX_HEIGHT); /* the cursor row, blinking */
+}
+
+/* Render workers. Lines drawn behind the CPU from the XRAM they had when the
+ * beam reached them are the lines drawn in step with it, every frame: the
+ * scroll writes land on the lines after them either way. Every line redraws,
+ * so every line goes through the queue. */
+UTEST(mode2, render_threads_draw_what_one_thread_draws)
+{
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    vga_set_framebuffer(fb);
+    size_t len;
+    void *start = emu_state_snapshot(&len);
+    ASSERT_TRUE(start != NULL);
+
+    static uint32_t serial[DIRTY_FRAMES], threaded[DIRTY_FRAMES];
+    uint64_t lines;
+    vga_set_redraw_all(true);
+    dirty_run(serial, &lines);
+
+    ASSERT_TRUE(emu_state_restore(start, len));
+    ASSERT_TRUE(vga_set_render_threads(4));
+    ASSERT_EQ(vga_render_threads(), 4);
+    dirty_run(threaded, &lines);
+    ASSERT_TRUE(cpu_halted());
+    ASSERT_TRUE(vga_set_render_threads(0));
+    vga_set_redraw_all(false);
+    free(start);
+
+    for (int f = 0; f < DIRTY_FRAMES; f++)
+        ASSERT_EQ(serial[f], threaded[f]);
+}
+
+/* Trimmed tiles: every bpp, tile size and trim on both axes, scrolled to land
+ * tiles on and off byte boundaries, with and without wrap. The firmware's
+ * emitter and the emulator's tile cache are separate code, so each draws the
+ * plane and the pictures must match. */
+#define TRIM_LINES 24
+#define TRIM_WIDTH 320
+
+static void trim_draw(uint32_t *out)
+{
+    for (int16_t y = 0; y < TRIM_LINES; y++)
+        vga_render_scanline(y);
+    vga_render_wait();
+    memcpy(out, fb, sizeof(uint32_t) * TRIM_WIDTH * TRIM_LINES);
+}
+
+UTEST(mode2, trimmed_tiles_draw_what_the_tile_cache_draws)
+{
+    static uint32_t want[TRIM_WIDTH * TRIM_LINES], got[TRIM_WIDTH * TRIM_LINES];
+    ASSERT_TRUE(vga_set_canvas(1));
+    vga_set_framebuffer(fb);
+    vga_set_redraw_all(true);
+    shim_fill(0x6502);
+    static const int16_t x_pos[] = {0, 5, -13, 37};
+    for (int wrap = 0; wrap < 2; wrap++)
+        for (unsigned x = 0; x < sizeof x_pos / sizeof *x_pos; x++)
+        {
+            shim_config(wrap, x_pos[x]);
+            mem_xram_touch(0, 0x10000);
+            for (uint16_t format = 0; format < 16; format++)
+            {
+                if ((format & 0x07) > 3)
+                    continue;
+                const int16_t tile_size = (format & 0x08) ? 16 : 8;
+                for (int16_t x_trim = 0; x_trim < tile_size; x_trim++)
+                    for (int16_t y_trim = 0; y_trim < tile_size; y_trim++)
+                    {
+                        const uint16_t options = format | x_trim << 4 | y_trim << 8;
+                        uint16_t xregs[8] = {0, 2, options, SHIM_CONFIG, 0, 0, TRIM_LINES, 0};
+                        ASSERT_TRUE(mode2_prog(xregs));
+                        trim_draw(want);
+                        ASSERT_TRUE(shim_mode2_prog(xregs));
+                        trim_draw(got);
+                        ASSERT_EQ(memcmp(want, got, sizeof want), 0);
+                    }
+            }
+        }
+    vga_set_redraw_all(false);
+}
+
 UTEST_MAIN_EMU()
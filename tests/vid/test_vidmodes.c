@@ -11,7 +11,11 @@
  * pin both implementations to one corpus.
  */
 
+#include "emu/sys/mem.h"
 #include "emu/sys/vga.h"
+#include "ria/sys/mem.h"
+#include "vga/modes/mode5.h"
+#include "vga/term/color.h"
 #include "emu_boot.h"
 
 #include <string.h>
@@ -49,8 +53,10 @@ static void run_case(int *utest_result, const char *name, int width, int height)
         ASSERT_GT(n_black, (size_t)0);
 
     memcpy(settled, fb, total * sizeof(uint32_t));
+    uint64_t drawn = vga_lines_drawn();
     run_frames(5);
     ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+    ASSERT_EQ(vga_lines_drawn(), drawn); /* a still picture is not redrawn */
 }
 
 UTEST(vidmodes, mode3_8bpp)
@@ -288,4 +294,450 @@ UTEST(vidmodes, mode0_return)
     run_case(utest_result, "mode0_return", 640, 480);
 }
 
+/* Sprite bins follow a table that moves: every sprite's Y shifted down dy
+ * in XRAM draws the settled picture dy lower, and shifted back draws it
+ * again. Catches bins kept from before a move, on either thread's path. */
+static void move_sprites(uint16_t stride, uint16_t y_offs, int count, int dy)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const uint16_t at = 0x0100 + i * stride + y_offs;
+        const uint16_t y = (uint16_t)(xram[at] | xram[at + 1] << 8) + dy;
+        xram[at] = (uint8_t)y;
+        xram[at + 1] = (uint8_t)(y >> 8);
+    }
+    mem_xram_touch(0x0100, (uint32_t)count * stride);
+}
+
+static void run_moved(int *utest_result, const char *name, int width, int height,
+                      uint16_t stride, uint16_t y_offs, int count)
+{
+    const int dy = 37;
+    run_case(utest_result, name, width, height);
+    move_sprites(stride, y_offs, count, dy);
+    run_frames(1);
+    for (int y = 0; y + dy < height; y++)
+        ASSERT_EQ(memcmp(&settled[(size_t)y * width], &fb[(size_t)(y + dy) * width],
+                         width * sizeof(uint32_t)), 0);
+    move_sprites(stride, y_offs, count, -dy);
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, (size_t)width * height * sizeof(uint32_t)), 0);
+}
+
+UTEST(vidmodes, mode4_8_moved)
+{
+    run_moved(utest_result, "mode4_8", 320, 240, 8, 2, 7);
+}
+
+UTEST(vidmodes, mode4a_id_moved)
+{
+    run_moved(utest_result, "mode4a_id", 320, 240, 20, 14, 1);
+}
+
+UTEST(vidmodes, mode5_8x8_moved)
+{
+    run_moved(utest_result, "mode5_8x8", 320, 240, 8, 2, 8);
+}
+
+/* Mode 5's byte runs: every bpp and sprite size, with sprites hanging off
+ * the left and the right edge by each offset within a source byte, is drawn
+ * by the per-pixel loop the runs replaced, kept here as a sprite renderer of
+ * its own. Both go over the same fill and through the same compositor, so
+ * the two pictures must match. Four palettes: index 0 clear, all clear, all
+ * opaque and every other one, and every fifth sprite takes the built-in. */
+#define RUN5_CONFIG 0x0100
+#define RUN5_PALETTE 0x0200
+#define RUN5_SPRITES 24
+#define RUN5_WIDTH 320
+#define RUN5_HEIGHT 240
+
+typedef struct
+{
+    int16_t x_pos_px;
+    int16_t y_pos_px;
+    uint16_t xram_sprite_ptr;
+    uint16_t palette_ptr;
+} run5_sprite_t;
+
+static int16_t run5_size, run5_bpp;
+
+/* Something under the sprites, so a pixel left alone is seen. */
+static bool run5_fill(int16_t plane, int16_t scanline, int16_t width,
+                      uint16_t *rgb, uint16_t config_ptr)
+{
+    (void)plane;
+    (void)config_ptr;
+    for (int16_t x = 0; x < width; x++)
+        rgb[x] = (uint16_t)(((uint32_t)(x + scanline * width) * 2654435761u) >> 16) | 1 << 5;
+    return true;
+}
+
+/* mode5_render before the byte runs: every pixel decoded on its own behind
+ * a bpp branch and alpha-tested. */
+static void run5_ref(int16_t scanline, int16_t width, uint16_t *rgb,
+                     uint16_t config_ptr, uint16_t length)
+{
+    const int16_t sprite_size = run5_size, bpp = run5_bpp;
+    const int16_t bytes_per_row = sprite_size * bpp / 8;
+    const uint32_t sprite_data_size = (uint32_t)sprite_size * bytes_per_row;
+    const run5_sprite_t *sprites = (const run5_sprite_t *)&xram[config_ptr];
+    for (uint16_t i = 0; i < length; i++)
+    {
+        int16_t tex_y = scanline - sprites[i].y_pos_px;
+        if (tex_y < 0 || tex_y >= sprite_size)
+            continue;
+
+        int16_t x_start = sprites[i].x_pos_px;
+        int16_t tex_x = 0;
+        int16_t size_x = sprite_size;
+
+        if (x_start < 0)
+        {
+            tex_x = -x_start;
+            size_x += x_start;
+            x_start = 0;
+        }
+        if (x_start + size_x > width)
+            size_x = width - x_start;
+        if (size_x <= 0)
+            continue;
+
+        if (sprites[i].xram_sprite_ptr > 0x10000 - sprite_data_size)
+            continue;
+
+        const uint16_t palette_ptr = sprites[i].palette_ptr;
+        const uint16_t *palette = bpp == 1 ? color_2 : color_256;
+        if (!(palette_ptr & 1) && palette_ptr <= 0x10000 - sizeof(uint16_t) * (1 << bpp))
+            palette = (const uint16_t *)&xram[palette_ptr];
+        const uint8_t *row_data =
+            (const uint8_t *)&xram[sprites[i].xram_sprite_ptr + tex_y * bytes_per_row];
+        uint16_t *dst = rgb + x_start;
+
+        for (int16_t px = tex_x; px < tex_x + size_x; px++, dst++)
+        {
+            uint8_t idx;
+            if (bpp == 1)
+                idx = (row_data[px / 8] >> (7 - (px & 7))) & 0x01;
+            else if (bpp == 2)
+                idx = (row_data[px / 4] >> (6 - 2 * (px & 3))) & 0x03;
+            else if (bpp == 4)
+                idx = (row_data[px / 2] >> (4 - 4 * (px & 1))) & 0x0F;
+            else
+                idx = row_data[px];
+            const uint16_t color = palette[idx];
+            if (color & (1 << 5))
+                *dst = color;
+        }
+    }
+}
+
+/* Random sprite data, a third of its bytes zero so whole bytes go clear,
+ * the four palettes, and the table for this size. */
+static void run5_xram(uint16_t attributes, uint32_t seed)
+{
+    run5_size = (int16_t)(8 << (attributes >> 3));
+    run5_bpp = (int16_t)(1 << (attributes & 0x03));
+    for (uint32_t i = 0; i < 0x10000; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        xram[i] = (seed >> 16) % 3 ? (uint8_t)(seed >> 8) : 0;
+    }
+    uint16_t *palette = (uint16_t *)&xram[RUN5_PALETTE];
+    for (int i = 0; i < 4 * 256; i++)
+    {
+        const int p = i / 256, idx = i % 256;
+        const bool opaque = p == 0 ? idx != 0 : p == 1 ? false : p == 2 ? true : idx & 1;
+        palette[i] = (uint16_t)(((i * 40503u) & ~(1u << 5)) | (opaque ? 1u << 5 : 0));
+    }
+    const uint32_t data_size = (uint32_t)run5_size * run5_size * run5_bpp / 8;
+    run5_sprite_t *sprites = (run5_sprite_t *)&xram[RUN5_CONFIG];
+    for (int16_t i = 0; i < RUN5_SPRITES; i++)
+    {
+        /* The first eight hang off the left by 1 to 8 pixels, the next
+         * eight off the right, and the rest land anywhere between. */
+        if (i < 8)
+            sprites[i].x_pos_px = -1 - i;
+        else if (i < 16)
+            sprites[i].x_pos_px = RUN5_WIDTH - run5_size + 1 + (i - 8);
+        else
+            sprites[i].x_pos_px = (int16_t)((i * 97) % RUN5_WIDTH - run5_size / 2);
+        sprites[i].y_pos_px = (int16_t)((i * 29) % RUN5_HEIGHT - i % 5);
+        sprites[i].xram_sprite_ptr = (uint16_t)((0x1000u * i) % (0x10001u - data_size));
+        sprites[i].palette_ptr = i % 5 == 4 ? 0xFFFF : RUN5_PALETTE + 0x200 * (i % 5);
+    }
+    mem_xram_touch(0, 0x10000);
+}
+
+UTEST(vidmodes, mode5_runs_draw_what_pixels_draw)
+{
+    static const uint16_t attributes[] = {0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19, 24,
+                                          25, 26, 27, 32, 33, 34, 35, 40, 41, 42, 43, 48, 49};
+    const size_t total = (size_t)RUN5_WIDTH * RUN5_HEIGHT;
+    run_case(utest_result, "mode5_8x8", RUN5_WIDTH, RUN5_HEIGHT);
+    for (size_t a = 0; a < sizeof attributes / sizeof *attributes; a++)
+    {
+        run5_xram(attributes[a], 0x5EED0000u + attributes[a]);
+        ASSERT_TRUE(vga_set_canvas(1));
+        ASSERT_TRUE(vga_prog_fill(0, 0, 0, 0, run5_fill));
+        run_frames(1);
+        memcpy(settled, fb, total * sizeof(uint32_t));
+
+        uint16_t xregs[8] = {0, 0, attributes[a], RUN5_CONFIG, RUN5_SPRITES, 0, 0, 0};
+        ASSERT_TRUE(mode5_prog(xregs));
+        run_frames(1);
+        ASSERT_NE(memcmp(settled, fb, total * sizeof(uint32_t)), 0); /* it drew */
+        memcpy(settled, fb, total * sizeof(uint32_t));
+
+        ASSERT_TRUE(vga_prog_sprite(0, 0, 0, RUN5_CONFIG, RUN5_SPRITES, run5_ref));
+        run_frames(1);
+        for (int y = 0; y < RUN5_HEIGHT; y++)
+            ASSERT_EQ(memcmp(&settled[y * RUN5_WIDTH], &fb[y * RUN5_WIDTH],
+                             RUN5_WIDTH * sizeof(uint32_t)), 0);
+    }
+}
+
+/* Mode 2's tile rows are drawn from the rows the last line expanded, so a
+ * picture must still follow its tile set, its palette and its scroll: each
+ * change shows, and undone, the settled picture returns. The ROM's tile set
+ * is at $4000, its palette at $0200 and its config at $0100. */
+static void poke(uint16_t addr, uint8_t value)
+{
+    xram[addr] = value;
+    mem_xram_touch(addr, 1);
+}
+
+UTEST(vidmodes, mode2_tiles_rewritten)
+{
+    const int width = 320, height = 180;
+    const size_t total = (size_t)width * height;
+    run_case(utest_result, "mode2_8bpp16wrap", width, height);
+
+    const uint8_t tile = xram[0x4000], color = xram[0x0200];
+    poke(0x4000, (uint8_t)~tile);
+    run_frames(1);
+    ASSERT_NE(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+    poke(0x4000, tile);
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+
+    poke(0x0200, (uint8_t)~color);
+    run_frames(1);
+    ASSERT_NE(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+    poke(0x0200, color);
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+
+    /* x_pos_px down 5: every row shows the settled one 5 further left. */
+    const int dx = 5;
+    const uint16_t x = (uint16_t)(xram[0x0102] | xram[0x0103] << 8);
+    poke(0x0102, (uint8_t)(x - dx));
+    poke(0x0103, (uint8_t)((x - dx) >> 8));
+    run_frames(1);
+    for (int y = 0; y < height; y++)
+        ASSERT_EQ(memcmp(&settled[(size_t)y * width + dx], &fb[(size_t)y * width],
+                         (width - dx) * sizeof(uint32_t)), 0);
+    poke(0x0102, (uint8_t)x);
+    poke(0x0103, (uint8_t)(x >> 8));
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+}
+
+/* Mode 6 against mode 2: the affine map through identity is the mode 2
+ * plane of the same map at the origin, and every other matrix is that
+ * picture moved where it moves it. The map is 256x128 pixels on a 320x240
+ * canvas, so the reference's bottom right corner is off it, black. */
+static uint32_t reference[VGA_MAX_WIDTH * VGA_MAX_HEIGHT];
+
+static void run_reference(int *utest_result)
+{
+    run_case(utest_result, "mode2_map32", 320, 240);
+    memcpy(reference, settled, sizeof(reference));
+}
+
+UTEST(vidmodes, mode6_id)
+{
+    run_reference(utest_result);
+    run_case(utest_result, "mode6_id", 320, 240);
+    ASSERT_EQ(memcmp(settled, reference, (size_t)320 * 240 * sizeof(uint32_t)), 0);
+}
+
+/* A quarter turn: canvas x walks down the map, canvas y leftward from its
+ * right edge. */
+UTEST(vidmodes, mode6_rot)
+{
+    run_reference(utest_result);
+    run_case(utest_result, "mode6_rot", 320, 240);
+    const uint32_t black = reference[239 * 320 + 319];
+    for (int y = 0; y < 240; y++)
+        for (int x = 0; x < 320; x++)
+            ASSERT_EQ(settled[y * 320 + x], x < 240 ? reference[x * 320 + 255 - y] : black);
+}
+
+/* A line table sliding each row left by its own amount. */
+UTEST(vidmodes, mode6_lines)
+{
+    run_reference(utest_result);
+    run_case(utest_result, "mode6_lines", 320, 240);
+    const uint32_t black = reference[239 * 320 + 319];
+    for (int y = 0; y < 240; y++)
+    {
+        const int dx = y * 7 % 19;
+        for (int x = 0; x < 320; x++)
+            ASSERT_EQ(settled[y * 320 + x], x + dx < 320 ? reference[y * 320 + x + dx] : black);
+    }
+}
+
+/* A scroll table against the program it replaces: with the table switched
+ * off (an odd pointer), a plane whose position is rewritten before each
+ * scanline draws what the plane reading the table drew. Restored, the
+ * table draws it again. */
+static void poke16(uint16_t addr, uint16_t value)
+{
+    poke(addr, (uint8_t)value);
+    poke(addr + 1, (uint8_t)(value >> 8));
+}
+
+static uint16_t peek16(uint16_t addr)
+{
+    return (uint16_t)(xram[addr] | xram[addr + 1] << 8);
+}
+
+static void run_scroll(int *utest_result, const char *name, uint16_t table_ptr_at)
+{
+    const int width = 320, height = 240;
+    const size_t total = (size_t)width * height;
+    run_case(utest_result, name, width, height);
+
+    const uint16_t x = peek16(0x0102), y = peek16(0x0104);
+    const uint16_t table = peek16(table_ptr_at);
+    poke16(table_ptr_at, table | 1);
+    for (int line = 0; line < height; line++)
+    {
+        poke16(0x0102, x + peek16(table + 4 * line));
+        poke16(0x0104, y + peek16(table + 4 * line + 2));
+        vga_render_scanline(line);
+        vga_render_wait();
+    }
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+
+    poke16(0x0102, x);
+    poke16(0x0104, y);
+    poke16(table_ptr_at, table);
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+}
+
+UTEST(vidmodes, mode1_scroll)
+{
+    run_scroll(utest_result, "mode1_scroll", 0x0110);
+}
+
+UTEST(vidmodes, mode2_scroll)
+{
+    run_scroll(utest_result, "mode2_scroll", 0x0110);
+}
+
+UTEST(vidmodes, mode3_scroll)
+{
+    run_scroll(utest_result, "mode3_scroll", 0x010E);
+}
+
+/* Metadata written by the sprite command draws what the bare image draws,
+ * and the check finds nothing wrong with it until one row with gaps is
+ * called solid. mode4_meta16's metadata disagrees with both its images on
+ * purpose; its third sprite shares the first's image, named once. */
+UTEST(vidmodes, mode4_packed_check)
+{
+    run_case(utest_result, "mode4_packed", 320, 240);
+    for (int y = 40; y < 56; y++)
+        ASSERT_EQ(memcmp(&settled[y * 320 + 40], &settled[y * 320 + 140],
+                         16 * sizeof(uint32_t)), 0);
+    vga_set_sprite_check(true);
+    run_frames(1);
+    ASSERT_EQ(vga_sprites_flagged(), 0u);
+    poke16(0x4000 + 16 * 16 * 2 + 6 * 4 + 2, 0x8000); /* row 6: $00000010 */
+    run_frames(1);
+    ASSERT_EQ(vga_sprites_flagged(), 1u);
+    vga_set_sprite_check(false);
+
+    run_case(utest_result, "mode4_meta16", 320, 240);
+    vga_set_sprite_check(true);
+    run_frames(1);
+    ASSERT_EQ(vga_sprites_flagged(), 2u);
+    vga_set_sprite_check(false);
+}
+
+/* The render profile watches without touching: the settled picture is the
+ * same with it on, every line is drawn every frame as the hardware draws
+ * them, and the sprite renderers report the sprites they drew. */
+UTEST(vidmodes, profile_sprite_stress)
+{
+    run_case(utest_result, "sprite_stress", 640, 480);
+    const size_t total = (size_t)VGA_MAX_WIDTH * VGA_MAX_HEIGHT;
+    vga_set_profile(true);
+    vga_profile_reset();
+    uint64_t drawn = vga_lines_drawn();
+    run_frames(3);
+    vga_set_profile(false);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+    ASSERT_EQ(vga_lines_drawn() - drawn, (uint64_t)3 * VGA_MAX_HEIGHT);
+
+    const vga_line_cost_t *lines = vga_profile_lines();
+    unsigned sprites = 0, timed = 0;
+    for (int y = 0; y < VGA_MAX_HEIGHT; y++)
+        for (int i = 0; i < VGA_PLANE_COUNT; i++)
+        {
+            sprites += lines[y].sprites[i];
+            timed += lines[y].sprite_ns[i] > 0;
+        }
+    ASSERT_GT(sprites, 0u);
+    ASSERT_GT(timed, 0u);
+}
+
+/* The render budget: the documented budget's scene has no late line and
+ * draws as it does without the budget. A band of sprites past the budget
+ * makes late lines from inside the band on, and they alone are drawn blue
+ * until the budget is off again. The band's ROM has no black to find, so
+ * it is settled here rather than by run_case. */
+UTEST(vidmodes, budget_overrun)
+{
+    const size_t total = (size_t)VGA_MAX_WIDTH * VGA_MAX_HEIGHT;
+    int16_t worst[4];
+    run_case(utest_result, "sprite_stress", 640, 480);
+    vga_set_budget(VGA_BUDGET_ON);
+    run_frames(2);
+    ASSERT_EQ(vga_budget_late(worst, 4), 0);
+    ASSERT_GT(vga_budget_lines()[40].cycles, vga_budget_lines()[200].cycles);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+    vga_set_budget(0);
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/budget_overrun.rp6502", ROMS_DIR);
+    ASSERT_TRUE(emu_restart(path));
+    vga_set_framebuffer(fb);
+    run_frames(20);
+    memcpy(settled, fb, total * sizeof(uint32_t));
+
+    vga_set_budget(VGA_BUDGET_SHOW);
+    run_frames(2);
+    const vga_line_budget_t *lines = vga_budget_lines();
+    ASSERT_GT(vga_budget_late(worst, 4), 0);
+    ASSERT_GT(lines[worst[0]].cycles, vga_budget_line_cycles());
+    for (int y = 0; y < VGA_MAX_HEIGHT; y++)
+    {
+        const uint32_t *row = &fb[y * VGA_MAX_WIDTH];
+        if (lines[y].slack >= 0)
+        {
+            ASSERT_EQ(memcmp(row, &settled[y * VGA_MAX_WIDTH], VGA_MAX_WIDTH * sizeof(uint32_t)), 0);
+            continue;
+        }
+        ASSERT_GE(y, 100);
+        for (int x = 0; x < VGA_MAX_WIDTH; x++)
+            ASSERT_EQ(row[x], 0xFFFF0000u);
+    }
+    vga_set_budget(0);
+    run_frames(1);
+    ASSERT_EQ(memcmp(settled, fb, total * sizeof(uint32_t)), 0);
+}
+
 UTEST_MAIN_EMU()
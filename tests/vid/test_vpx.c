@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The scanline compositor's vector variants against its scalar reference.
+ * A pixel is sixteen bits, so "every input" is small enough to mean it: each
+ * value goes through as the base and as each overlay, and every variant this
+ * machine can run must turn out the same words as the scalar one. Then lines
+ * the way the renderer hands them over — any width, planes missing, loads
+ * off alignment — so the tails and the NULL paths are held to it too.
+ *
+ * The reference itself is pinned by a handful of known pixels, so the
+ * variants cannot all agree on something wrong.
+ */
+
+#include "emu/sys/vpx.h"
+#include "utest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALL 65536
+
+UTEST_MAIN();
+
+static uint16_t vals[ALL];
+static uint16_t base[ALL];
+static uint32_t want[ALL];
+static uint32_t got[ALL];
+
+static void fill_inputs(void)
+{
+    for (int i = 0; i < ALL; i++)
+    {
+        vals[i] = (uint16_t)i;
+        base[i] = (uint16_t)(i * 40503u); /* odd: also a permutation */
+    }
+}
+
+UTEST(vpx, scalar_reference)
+{
+    const vpx_variant_t *v;
+    ASSERT_GE(vpx_variants(&v), (size_t)1);
+    ASSERT_STREQ(v[0].name, "scalar");
+
+    static const uint16_t px[] = {0x0000, 0xFFFF, 0x001F, 0x07C0, 0xF800, 0x0020, 0x0041};
+    static const uint32_t rgba[] = {0xFF000000, 0xFFFFFFFF, 0xFF0000FF, 0xFF00FF00,
+                                    0xFFFF0000, 0xFF000000, 0xFF000808};
+    uint32_t out[7];
+    const uint16_t *const planes[VPX_PLANES] = {px, NULL, NULL};
+    v[0].fn(out, planes, 7);
+    for (int i = 0; i < 7; i++)
+        ASSERT_EQ(out[i], rgba[i]);
+
+    /* Overlays show where their alpha bit is set and nowhere else; a missing
+     * base is black. */
+    static const uint16_t under[] = {0x001F, 0x001F, 0x001F};
+    static const uint16_t mid[] = {0x07C0, 0x07E0, 0x07E0};
+    static const uint16_t top[] = {0xF800, 0xF800, 0xF820};
+    const uint16_t *const stack[VPX_PLANES] = {under, mid, top};
+    v[0].fn(out, stack, 3);
+    ASSERT_EQ(out[0], 0xFF0000FFu);
+    ASSERT_EQ(out[1], 0xFF00FF00u);
+    ASSERT_EQ(out[2], 0xFFFF0000u);
+    const uint16_t *const none[VPX_PLANES] = {NULL, NULL, NULL};
+    v[0].fn(out, none, 3);
+    for (int i = 0; i < 3; i++)
+        ASSERT_EQ(out[i], 0xFF000000u);
+}
+
+UTEST(vpx, every_value_every_plane)
+{
+    fill_inputs();
+    const vpx_variant_t *v;
+    const size_t n = vpx_variants(&v);
+    const uint16_t *const cases[][VPX_PLANES] = {
+        {vals, NULL, NULL},
+        {base, vals, NULL},
+        {base, NULL, vals},
+        {NULL, vals, base},
+        {base, vals, base},
+    };
+    for (size_t c = 0; c < sizeof cases / sizeof cases[0]; c++)
+    {
+        v[0].fn(want, cases[c], ALL);
+        for (size_t k = 1; k < n; k++)
+        {
+            memset(got, 0, sizeof got);
+            v[k].fn(got, cases[c], ALL);
+            EXPECT_EQ(memcmp(want, got, sizeof want), 0);
+            if (memcmp(want, got, sizeof want))
+                printf("  %s differs on case %u\n", v[k].name, (unsigned)c);
+        }
+    }
+}
+
+UTEST(vpx, lines_any_width_any_planes)
+{
+    fill_inputs();
+    const vpx_variant_t *v;
+    const size_t n = vpx_variants(&v);
+    srand(6502);
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        const int width = 1 + rand() % 700;
+        const uint16_t *planes[VPX_PLANES];
+        for (int i = 0; i < VPX_PLANES; i++)
+        {
+            /* A random offset keeps the loads off any one alignment. */
+            const int off = rand() % (ALL - width);
+            planes[i] = (rand() % 4) ? (i & 1 ? vals : base) + off : NULL;
+        }
+        const int at = rand() % 7;
+        v[0].fn(want + at, planes, width);
+        for (size_t k = 1; k < n; k++)
+        {
+            got[at + width] = 0x5A5A5A5A;
+            v[k].fn(got + at, planes, width);
+            ASSERT_EQ(memcmp(want + at, got + at, (size_t)width * sizeof *got), 0);
+            ASSERT_EQ(got[at + width], 0x5A5A5A5Au); /* and not a word past it */
+        }
+    }
+}
+
+/* vpx_composite is the last variant, whichever that is on this machine. */
+UTEST(vpx, composite_is_the_widest)
+{
+    fill_inputs();
+    const vpx_variant_t *v;
+    const size_t n = vpx_variants(&v);
+    const uint16_t *const planes[VPX_PLANES] = {base, vals, NULL};
+    v[n - 1].fn(want, planes, 640);
+    vpx_composite(got, planes, 640);
+    ASSERT_EQ(memcmp(want, got, 640 * sizeof *got), 0);
+    printf("  composite: %s of %u variant(s)\n", v[n - 1].name, (unsigned)n);
+}
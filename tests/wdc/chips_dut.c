@@ -6,12 +6,16 @@
  * The emulator's CPU (vendor/chips w65c02.h) as a dut_t, so the suites in this
  * directory can hold it to the same evidence as the FPGA core's w65c02.sv.
  *
- * Standalone by necessity: CHIPS_IMPL lives here, so nothing that links this
+ * Standalone by default: CHIPS_IMPL lives here, so nothing that links this
  * can also link emu_core, which carries its own copy and wires the CPU to the
- * RP6502 bus rather than the flat memory the suites assume.
+ * RP6502 bus rather than the flat memory the suites assume. A suite that wants
+ * both defines CHIPS_DUT_EXTERN_IMPL and takes emu_core's copy of the code; the
+ * CPU here is still its own instance.
  */
 
+#ifndef CHIPS_DUT_EXTERN_IMPL
 #define CHIPS_IMPL
+#endif
 #include "chips/chips/w65c02.h"
 
 #include "chips_dut.h"
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The emulator's fast path as a dut_t. The harness asks for one cycle at a
+ * time; cpu_exec does not work that way, so this runs it ahead and deals out
+ * what it recorded. It runs against a copy of the image of its own, which is
+ * the point: every byte it reads is one it got from memory itself, never from
+ * the harness, so a cycle it serviced wrongly shows up as a difference on the
+ * bus rather than being papered over by the harness's byte.
+ *
+ * A run ahead stops where the emulator's does: at any access above $FEFF,
+ * which the board services (here, the flat memory again), and at the next
+ * scripted pin change, which is as far as the line is known to hold. Only IRQ
+ * is wired to the emulator's 6502, so a script that drives NMI, RDY or RES is
+ * refused.
+ */
+
+#include "chips/chips/w65c02.h" /* the pin layout only; emu_core has the code */
+#include "emu/sys/cpu.h"
+#include "fast_dut.h"
+
+#include <assert.h>
+#include <string.h>
+
+typedef struct
+{
+    uint16_t addr;
+    uint8_t data;
+    bool read, sync;
+} fast_cycle_t;
+
+static uint8_t fast_mem[0x10000];
+static const lockstep_ev_t *fast_evs;
+static size_t fast_n_evs;
+static bool fast_irq;
+
+/* Cycles run but not yet dealt, and the one being dealt now. cycle counts the
+ * cycles the harness has been dealt. */
+#define FAST_QUEUE 4096
+static fast_cycle_t fast_queue[FAST_QUEUE];
+static size_t fast_head, fast_tail;
+static fast_cycle_t fast_now;
+static uint64_t fast_cycle;
+
+void fast_dut_load(const uint8_t *image, const lockstep_ev_t *evs, size_t n_evs)
+{
+    memcpy(fast_mem, image, sizeof fast_mem);
+    fast_evs = evs;
+    fast_n_evs = n_evs;
+}
+
+static void fast_record(uint16_t addr, uint8_t data, bool read, bool sync)
+{
+    assert(fast_tail < FAST_QUEUE);
+    fast_queue[fast_tail++] = (fast_cycle_t){addr, data, read, sync};
+}
+
+/* The board's half of a cycle cpu_exec handed back: the memory rule the
+ * harness uses, over the whole space. */
+static void fast_service(uint16_t addr, bool read, uint8_t *data)
+{
+    if (read)
+        *data = fast_mem[addr];
+    else
+        fast_mem[addr] = *data;
+    uint16_t pc;
+    uint8_t sp;
+    fast_record(addr, *data, read, cpu_opcode_fetch(&pc, &sp));
+}
+
+static void fast_reset(void)
+{
+    cpu_run();
+    fast_head = fast_tail = 0;
+    fast_cycle = 0;
+    const uint64_t pins = cpu_dbg_pins();
+    uint8_t data = W65C02_GET_DATA(pins);
+    fast_service(W65C02_GET_ADDR(pins), (pins & W65C02_RW) != 0, &data);
+    fast_now = fast_queue[fast_head++];
+}
+
+static void fast_begin(const dut_regs_t *regs)
+{
+    (void)regs;
+    assert(!"the fast path starts from reset only");
+}
+
+static void fast_bus(uint16_t *addr, bool *read, bool *sync)
+{
+    *addr = fast_now.addr;
+    *read = fast_now.read;
+    *sync = fast_now.sync;
+}
+
+/* Run ahead from the cycle being dealt to the next scripted pin change. The
+ * harness applies a change before the cycle it names, and the cycle being
+ * dealt is past any change at its own number. */
+static void fast_run(void)
+{
+    uint64_t until = fast_cycle + FAST_QUEUE / 2;
+    for (size_t i = 0; i < fast_n_evs; i++)
+        if (fast_evs[i].cycle > fast_cycle)
+        {
+            if (fast_evs[i].cycle < until)
+                until = fast_evs[i].cycle;
+            break;
+        }
+    fast_head = fast_tail = 0;
+    uint16_t addr;
+    bool read;
+    uint8_t data = fast_now.data;
+    cpu_exec_trace = fast_record;
+    (void)cpu_exec(fast_mem, (uint32_t)(until - fast_cycle), &addr, &read,
+                   &data, fast_irq);
+    cpu_exec_trace = NULL;
+    fast_service(addr, read, &data);
+}
+
+static void fast_tick(uint8_t *data)
+{
+    *data = fast_now.data;
+    if (fast_head == fast_tail)
+        fast_run();
+    fast_now = fast_queue[fast_head++];
+    fast_cycle++;
+}
+
+static void fast_end(dut_regs_t *regs)
+{
+    const w65c02_t *c = cpu_chip();
+    regs->pc = c->PC;
+    regs->s = c->S;
+    regs->a = c->A;
+    regs->x = c->X;
+    regs->y = c->Y;
+    regs->p = c->P;
+}
+
+static void fast_pins(bool irq, bool nmi, bool rdy, bool res)
+{
+    assert(!nmi && !rdy && !res);
+    (void)nmi;
+    (void)rdy;
+    (void)res;
+    fast_irq = irq;
+}
+
+const dut_t fast_dut = {
+    .name = "emu fast path",
+    .reset = fast_reset,
+    .begin = fast_begin,
+    .bus = fast_bus,
+    .tick = fast_tick,
+    .end = fast_end,
+    .pins = fast_pins,
+};
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef _TESTS_CPU_FAST_DUT_H_
+#define _TESTS_CPU_FAST_DUT_H_
+
+#include "lockstep.h"
+
+/* The emulator's fast path (cpu_exec in emu/sys/cpu.c) as a dut_t. It runs
+ * ahead against memory of its own, so it needs the image and the pin script
+ * before lockstep_run starts it: the same two things lockstep_run is given. */
+void fast_dut_load(const uint8_t *image, const lockstep_ev_t *evs, size_t n_evs);
+
+extern const dut_t fast_dut;
+
+#endif /* _TESTS_CPU_FAST_DUT_H_ */
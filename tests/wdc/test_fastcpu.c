@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 Rumbledethumps
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * The emulator's 6502 fast path against the tick path it skips. cpu_exec
+ * services SRAM cycles itself and leaves the VIA to be caught up afterwards;
+ * the claim is that none of that is visible, first on the bus and then in the
+ * machine.
+ *
+ * On the bus, by lockstep: chips_dut is the core as the tick path drives it,
+ * fast_dut is cpu_exec running ahead, and every cycle must match under the
+ * pin scenarios test_w65c02_chips replays. Only the IRQ ones — IRQ is the one
+ * line the emulator wires — and the pin fuzz with the other lines held quiet.
+ *
+ * In the machine, by savestate: the same frames from the same state, once
+ * each way, must leave identical machines behind.
+ */
+
+#include "chips_dut.h"
+#include "emu/emu/via.h"
+#include "emu/sys/sst.h"
+#include "emu/sys/sys.h"
+#include "emu_boot.h"
+#include "fast_dut.h"
+#include "lockstep_scen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint8_t image[0x10000];
+
+static bool run(const lockstep_scen_t *scen)
+{
+    lockstep_scen_image(image, scen->entry);
+    fast_dut_load(image, scen->evs, scen->n_evs);
+    lockstep_result_t r;
+    bool ok = lockstep_run(&chips_dut, &fast_dut, image, scen->evs,
+                           scen->n_evs, scen->cycles, &r);
+    if (!ok)
+        printf("%s: %s\n", scen->name, r.detail);
+    return ok;
+}
+
+#define FASTCPU(name)                            \
+    UTEST(fastcpu, name)                         \
+    {                                            \
+        ASSERT_TRUE(run(&lockstep_scen_##name)); \
+    }
+
+FASTCPU(reset_only)
+FASTCPU(irq_pulse)
+FASTCPU(irq_level_held)
+FASTCPU(irq_masked)
+FASTCPU(wai_irq)
+FASTCPU(wai_irq_masked_continues)
+FASTCPU(branch_pip_irq)
+FASTCPU(bne_loop_irq)
+
+UTEST(fastcpu, irq_fuzz)
+{
+    static lockstep_ev_t evs[LOCKSTEP_FUZZ_EVENTS];
+    lockstep_scen_fuzz(evs);
+    for (size_t i = 0; i < LOCKSTEP_FUZZ_EVENTS; i++)
+        evs[i].nmi = evs[i].rdy = evs[i].res = false;
+
+    lockstep_scen_image(image, LOCKSTEP_FUZZ_ENTRY);
+    fast_dut_load(image, evs, LOCKSTEP_FUZZ_EVENTS);
+    lockstep_result_t r;
+    bool ok = lockstep_run(&chips_dut, &fast_dut, image, evs,
+                           LOCKSTEP_FUZZ_EVENTS, LOCKSTEP_FUZZ_CYCLES, &r);
+    if (!ok)
+        printf("%s\n", r.detail);
+    ASSERT_TRUE(ok);
+}
+
+/* The catch-up rule on its own: idle cycles then one real tick leave the VIA
+ * exactly as that many real ticks off its window do, timers running. */
+UTEST(fastcpu, via_idle_is_off_window_ticks)
+{
+    static const struct
+    {
+        uint16_t addr;
+        uint8_t data;
+    } setup[] = {
+        {0xFFDB, 0x40}, /* ACR: T1 free-running */
+        {0xFFD4, 0x34}, /* T1 latch low */
+        {0xFFD5, 0x12}, /* T1 counter high: starts it */
+        {0xFFD8, 0x99}, /* T2 low */
+        {0xFFD9, 0x00}, /* T2 high: starts it */
+    };
+    size_t len = via_state_save(NULL);
+    uint8_t *ref = malloc(len), *got = malloc(len);
+    ASSERT_TRUE(ref && got);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        via_run();
+        for (size_t i = 0; i < sizeof setup / sizeof *setup; i++)
+        {
+            uint8_t data = setup[i].data;
+            (void)via_tick(setup[i].addr, false, &data);
+        }
+        uint8_t data = 0x5A;
+        if (pass == 0)
+            for (int i = 0; i < 10000; i++)
+                (void)via_tick(0x1234, true, &data);
+        else
+        {
+            via_idle(9999);
+            (void)via_tick(0x1234, true, &data);
+        }
+        via_state_save(pass == 0 ? ref : got);
+    }
+    ASSERT_EQ(memcmp(ref, got, len), 0);
+    free(ref);
+    free(got);
+}
+
+static void run_frames(int n)
+{
+    for (int i = 0; i < n; i++)
+        sys_run_frame();
+}
+
+UTEST(fastcpu, machine_matches_tick_path)
+{
+    ASSERT_TRUE(emu_restart(TEST_FIXTURE));
+    run_frames(10);
+    size_t start_len;
+    void *start = emu_state_snapshot(&start_len);
+    ASSERT_TRUE(start != NULL);
+
+    sys_set_fast_cpu(true);
+    run_frames(120);
+    size_t fast_len;
+    void *fast = emu_state_snapshot(&fast_len);
+    ASSERT_TRUE(fast != NULL);
+
+    ASSERT_TRUE(emu_state_restore(start, start_len));
+    sys_set_fast_cpu(false);
+    run_frames(120);
+    sys_set_fast_cpu(true);
+    size_t tick_len;
+    void *tick = emu_state_snapshot(&tick_len);
+    ASSERT_TRUE(tick != NULL);
+
+    ASSERT_EQ(tick_len, fast_len);
+    ASSERT_EQ(memcmp(fast, tick, fast_len), 0);
+    free(start);
+    free(fast);
+    free(tick);
+}
+
+UTEST_MAIN_EMU()
@@ -11,6 +11,7 @@ import os
 import re
 import time
 import binascii
+import zlib
 import argparse
 import configparser
 import platform
@@ -1090,6 +1091,198 @@ class ROM:
                 return addr, bytearray(self.data[addr + i] for i in range(length))
         return None, None
 
+    def write(self, file: str):
+        """Write the ROM file: memory chunks first, then the named assets."""
+        with open(file, "wb+") as f:
+            f.write(f"#!{SCRIPT_NAME}\r\n".encode("ascii"))
+            # Build null asset (memory chunks blob)
+            chunks = b""
+            addr, data = self.next_rom_data(0)
+            while data is not None:
+                header = f"${addr:04X} ${len(data):03X} ${binascii.crc32(data):08X}\r\n"
+                chunks += header.encode("ascii") + bytes(data)
+                addr += len(data)
+                addr, data = self.next_rom_data(addr)
+            if chunks:
+                f.write(
+                    f"#>${len(chunks):08X} ${binascii.crc32(chunks):08X}\r\n".encode(
+                        "ascii"
+                    )
+                )
+                f.write(chunks)
+            # Write named assets
+            for asset_name, asset_data in self.assets:
+                f.write(
+                    f"#>${len(asset_data):08X} ${binascii.crc32(asset_data):08X} {asset_name}\r\n".encode(
+                        "ascii"
+                    )
+                )
+                f.write(asset_data)
+
+
+class Sprite:
+    """Mode 4 sprite builder: RGB555 pixels and their opacity metadata."""
+
+    # Mode 4 draws square sprites with sides a power of two, and a sprite
+    # with its metadata must fit in XRAM.
+    MAX_SIZE = 128
+
+    def __init__(self, pixels: list, size: int):
+        """Row-major pixels, as the sixteen-bit words mode 4 draws."""
+        if size < 1 or size > Sprite.MAX_SIZE or size & (size - 1):
+            raise ROMException(
+                f"Sprite must be square, a power of two up to {Sprite.MAX_SIZE}: {size}"
+            )
+        if len(pixels) != size * size:
+            raise ROMException(f"Sprite is not {size}x{size}")
+        self.pixels = pixels
+        self.size = size
+
+    @staticmethod
+    def rgb555(r: int, g: int, b: int, a: int) -> int:
+        """One 8-bit RGBA pixel as mode 4 draws it; alpha is on or off."""
+        return (r >> 3) | (g >> 3) << 6 | (b >> 3) << 11 | (0x20 if a >= 0x80 else 0)
+
+    @staticmethod
+    def from_raw(data: bytes) -> "Sprite":
+        """Little-endian sixteen-bit pixels, already in mode 4's format."""
+        size = int((len(data) // 2) ** 0.5)
+        if len(data) % 2 or size * size * 2 != len(data):
+            raise ROMException(f"Raw sprite is not square: {len(data)} bytes")
+        return Sprite(
+            [data[i] | data[i + 1] << 8 for i in range(0, len(data), 2)], size
+        )
+
+    @staticmethod
+    def from_png(data: bytes) -> "Sprite":
+        """A non-interlaced PNG of any color type, at 8 bits or fewer per
+        sample (16-bit samples keep their high byte)."""
+        if data[:8] != b"\x89PNG\r\n\x1a\n":
+            raise ROMException("Not a PNG file")
+        i = 8
+        width = None
+        idat = b""
+        plte = b""
+        trns = b""
+        while i + 8 <= len(data):
+            length = int.from_bytes(data[i : i + 4], "big")
+            kind = data[i + 4 : i + 8]
+            body = data[i + 8 : i + 8 + length]
+            i += 12 + length
+            if kind == b"IHDR":
+                width, height = int.from_bytes(body[0:4], "big"), int.from_bytes(
+                    body[4:8], "big"
+                )
+                depth, color, interlace = body[8], body[9], body[12]
+            elif kind == b"PLTE":
+                plte = body
+            elif kind == b"tRNS":
+                trns = body
+            elif kind == b"IDAT":
+                idat += body
+            elif kind == b"IEND":
+                break
+        if width is None:
+            raise ROMException("PNG has no header")
+        if interlace:
+            raise ROMException("Interlaced PNG is not supported")
+        if width != height:
+            raise ROMException(f"Sprite is not square: {width}x{height}")
+        channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+        bits = depth * channels
+        stride = (width * bits + 7) // 8
+        step = max(1, bits // 8)
+        raw = zlib.decompress(idat)
+        rows = []
+        prev = bytearray(stride)
+        for y in range(height):
+            at = y * (stride + 1)
+            kind, line = raw[at], bytearray(raw[at + 1 : at + 1 + stride])
+            for x in range(stride):
+                a = line[x - step] if x >= step else 0
+                b = prev[x]
+                c = prev[x - step] if x >= step else 0
+                if kind == 1:
+                    line[x] = (line[x] + a) & 0xFF
+                elif kind == 2:
+                    line[x] = (line[x] + b) & 0xFF
+                elif kind == 3:
+                    line[x] = (line[x] + (a + b) // 2) & 0xFF
+                elif kind == 4:
+                    p = a + b - c
+                    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                    pred = a if pa <= pb and pa <= pc else b if pb <= pc else c
+                    line[x] = (line[x] + pred) & 0xFF
+            rows.append(line)
+            prev = line
+
+        def sample(line, n):
+            """Sample n of a row, scaled to eight bits."""
+            if depth == 16:
+                return line[n * 2]
+            if depth == 8:
+                return line[n]
+            v = line[n * depth // 8] >> (8 - depth - n * depth % 8) & ((1 << depth) - 1)
+            return v if color == 3 else v * 255 // ((1 << depth) - 1)
+
+        pixels = []
+        for line in rows:
+            for x in range(width):
+                if color == 3:
+                    idx = sample(line, x)
+                    r, g, b = plte[idx * 3 : idx * 3 + 3]
+                    a = trns[idx] if idx < len(trns) else 0xFF
+                elif color in (0, 4):
+                    r = g = b = sample(line, x * channels)
+                    a = sample(line, x * 2 + 1) if color == 4 else 0xFF
+                    if color == 0 and len(trns) >= 2:
+                        key = int.from_bytes(trns[0:2], "big")
+                        if depth < 8:
+                            key = key * 255 // ((1 << depth) - 1)
+                        if r == (key >> 8 if depth == 16 else key):
+                            a = 0
+                else:
+                    r, g, b = (sample(line, x * channels + k) for k in range(3))
+                    a = sample(line, x * 4 + 3) if color == 6 else 0xFF
+                    if color == 2 and len(trns) >= 6:
+                        key = tuple(trns[k * 2 + (0 if depth == 16 else 1)] for k in range(3))
+                        if (r, g, b) == key:
+                            a = 0
+                pixels.append(Sprite.rgb555(r, g, b, a))
+        return Sprite(pixels, width)
+
+    @staticmethod
+    def from_file(file: str) -> "Sprite":
+        """A PNG by its signature, else raw pixels."""
+        with open(file, "rb") as f:
+            data = f.read()
+        if data[:8] == b"\x89PNG\r\n\x1a\n":
+            return Sprite.from_png(data)
+        return Sprite.from_raw(data)
+
+    def metadata(self) -> bytes:
+        """A word per row: the first opaque pixel in bits 16-30, one past the
+        last in bits 0-15, and bit 31 when every pixel between is opaque. A
+        row with nothing opaque is zero, which mode 4 skips outright."""
+        meta = bytearray()
+        for y in range(self.size):
+            row = self.pixels[y * self.size : (y + 1) * self.size]
+            opaque = [x for x, p in enumerate(row) if p & 0x20]
+            word = 0
+            if opaque:
+                start, end = opaque[0], opaque[-1] + 1
+                word = start << 16 | end
+                if len(opaque) == end - start:
+                    word |= 1 << 31
+            meta += word.to_bytes(4, "little")
+        return bytes(meta)
+
+    def pack(self) -> bytes:
+        """The image as a sprite's xram_sprite_ptr points at it, with the
+        metadata that has_opacity_metadata says follows."""
+        img = b"".join(p.to_bytes(2, "little") for p in self.pixels)
+        return img + self.metadata()
+
 
 class Emulator:
     """rp6502-emu discovery and debug-adapter error reporting."""
@@ -1210,6 +1403,10 @@ def exec_args():
             "Create local ROM file from a file. Additional local ROM files will be merged.",
             "+",
         ),
+        "sprite": (
+            "Convert a PNG or raw RGB555 image to a mode 4 sprite with opacity metadata.",
+            1,
+        ),
     }
     parsers = {}
     for cmd, (desc, nargs) in cmds.items():
@@ -1522,31 +1719,30 @@ def exec_args():
         for file in args.filename[extras_start:]:
             print(f"[{os.path.basename(__file__)}] Adding ROM asset {file}")
             rom.add_rom_file(file)
-        with open(args.out, "wb+") as file:
-            file.write(f"#!{SCRIPT_NAME}\r\n".encode("ascii"))
-            # Build null asset (memory chunks blob)
-            chunks = b""
-            addr, data = rom.next_rom_data(0)
-            while data is not None:
-                header = f"${addr:04X} ${len(data):03X} ${binascii.crc32(data):08X}\r\n"
-                chunks += header.encode("ascii") + bytes(data)
-                addr += len(data)
-                addr, data = rom.next_rom_data(addr)
-            if chunks:
-                file.write(
-                    f"#>${len(chunks):08X} ${binascii.crc32(chunks):08X}\r\n".encode(
-                        "ascii"
-                    )
-                )
-                file.write(chunks)
-            # Write named assets
-            for asset_name, asset_data in rom.assets:
-                file.write(
-                    f"#>${len(asset_data):08X} ${binascii.crc32(asset_data):08X} {asset_name}\r\n".encode(
-                        "ascii"
-                    )
-                )
-                file.write(asset_data)
+        rom.write(args.out)
+
+    if args.command == "sprite":
+        # Without an address this is the sprite's bytes, for a build that
+        # places them itself; with one it is a ROM file for `create` to merge.
+        if not args.out:
+            parser.error("argument -o: sprite requires an output filename")
+        args.address = str_to_address_or_name(args.address)
+        if args.address is True:
+            parser.error("argument -a/--address: 'file' does not apply to sprite")
+        print(f"[{os.path.basename(__file__)}] Reading sprite {args.filename[0]}")
+        sprite = Sprite.from_file(args.filename[0])
+        data = sprite.pack()
+        print(f"[{os.path.basename(__file__)}] Creating {args.out}")
+        if args.address is None:
+            with open(args.out, "wb+") as file:
+                file.write(data)
+        else:
+            rom = ROM()
+            if isinstance(args.address, str):
+                rom.add_asset(args.address, data)
+            else:
+                rom.add_binary_data(data, args.address)
+            rom.write(args.out)
 
     if args.command == "emu":
         # `emu` exists to launch the emulator as the IDE's debug adapter, which